@@ -9,6 +9,7 @@ namespace Constants {
     constexpr int MAX_DISPLAY_WIDTH = 80;
     constexpr int SCREEN_WIDTH = 800;
     constexpr int SCREEN_HEIGHT = 600;
+    constexpr int PLAYER_REFRESH_MS = 500;
     
     // File types
     enum class FileType {
@@ -21,13 +22,88 @@ namespace Constants {
     const std::string AUDIO_EXTENSIONS[] = {".mp3", ".wav", ".ogg", ".flac", ".aac"};
     const std::string VIDEO_EXTENSIONS[] = {".mp4", ".avi", ".mkv", ".mov"};
     
-    // S32K144 Board settings
+    // Library index (see MediaLibrary::saveIndex): tags pre-built by "index build", read on first scan
+    constexpr char LIBRARY_INDEX_FILE[] = ".mbplibrary";  // Looked for at the top of a scanned directory
+    constexpr char LIBRARY_INDEX_MAGIC[] = "#MBPLIBRARY"; // First line of index files
+    constexpr int LIBRARY_INDEX_VERSION = 3;              // 2 added content signatures, 3 probed video; older ones are still read
+    constexpr size_t CONTENT_SIGNATURE_BLOCK = 64 * 1024; // Payload bytes hashed at each end (see utils/ContentSignature.h)
+    
+    // S32K144 Board settings (S32K144_PORT / S32K144_BAUD environment variables override these)
     constexpr int S32K144_BAUDRATE = 9600;
+    constexpr int S32K144_MAX_BAUDRATE = 921600;
     constexpr char S32K144_PORT[] = "/dev/ttyACM0";
+    constexpr int S32K144_TELEMETRY_MS = 250;       // Minimum gap between now-playing frames
+    constexpr int S32K144_TELEMETRY_KEEPALIVE_MS = 1000; // Resend unchanged state this often
+    constexpr int S32K144_TX_BACKLOG_LIMIT = 256;   // Skip a frame if the UART queue holds more bytes
     
     // Playlist settings
     constexpr char PLAYLISTS_DIR[] = "/home/namanh/code/MediaBrowserPlayer/playlists/";
     constexpr char PLAYLIST_EXT[] = ".playlist";
+    constexpr char PLAYLIST_MAGIC[] = "#MBPLAYLIST";   // First line of versioned playlist files
+    constexpr int PLAYLIST_FORMAT_VERSION = 3;         // 3 added the save generation; older ones are still read
+    constexpr size_t MAX_RESIDENT_PLAYLISTS = 16;      // Playlists kept fully loaded in memory
+    constexpr size_t PLAYLIST_COMPACT_SLACK = 64;      // Emptied track slots tolerated beyond the track count
+    constexpr char PLAYLIST_JOURNAL_EXT[] = ".journal"; // Edit log next to each playlist file
+    constexpr size_t PLAYLIST_JOURNAL_MAX_EDITS = 256; // Logged edits before the playlist file is rewritten
+    constexpr size_t PLAYLIST_UNDO_LIMIT = 100;        // Undo steps kept per playlist
+    constexpr char SMART_PLAYLISTS_FILE[] = "smart_playlists.rules"; // Smart playlist rules, in the playlists directory
+    
+    // Library watcher (inotify)
+    constexpr int LIBRARY_WATCH_DEBOUNCE_MS = 200;   // Quiet time before a batch of file events is processed
+    constexpr int LIBRARY_WATCH_MAX_DELAY_MS = 1000; // Process a batch at least this often while events keep coming
+    
+    // Tracing (see utils/Trace.h)
+    constexpr size_t TRACE_RING_EVENTS = 8192;       // Zones kept per thread (power of two), oldest dropped first
+    constexpr char TRACE_DUMP_DIR[] = "/tmp";        // Default dump location unless MBP_TRACE_FILE is set
+    
+    // Metrics (see utils/Metrics.h, services/MetricsServer.h)
+    constexpr size_t METRICS_SHARDS = 16;             // Per-thread slots of each counter/histogram
+    constexpr char METRICS_SOCKET_PATH[] = "/tmp/MediaBrowserPlayer.metrics.sock"; // Unless MBP_METRICS_SOCKET is set
+    constexpr int METRICS_REQUEST_TIMEOUT_MS = 100;   // How long a client may take to send its (optional) HTTP request
+    constexpr int METRICS_SEND_TIMEOUT_MS = 1000;     // Give up on a client that doesn't read the response
+    constexpr double AUDIO_UNDERRUN_FACTOR = 1.5;     // Mixer callback this many buffer periods late counts as an underrun
+    
+    // Daemon mode (see controllers/DaemonController.h)
+    constexpr char DAEMON_SOCKET_PATH[] = "/tmp/MediaBrowserPlayer.sock"; // Unless --socket or MBP_CONTROL_SOCKET is given
+    constexpr size_t DAEMON_MAX_CLIENTS = 32;         // Further connections are refused
+    constexpr size_t DAEMON_MAX_LINE = 4096;          // Longest command line accepted
+    constexpr size_t DAEMON_MAX_PENDING_OUTPUT = 1 << 20; // A client this far behind on reading is dropped
+    constexpr size_t DAEMON_SEARCH_LIMIT = 500;       // Most results a search returns
+    constexpr int DAEMON_POLL_MS = 250;               // Library changes are applied at least this often
+    
+    // Acoustic fingerprints and duplicate detection (see utils/AudioFingerprint.h, models/FingerprintIndex.h)
+    constexpr int FINGERPRINT_SAMPLE_RATE = 5512;      // Audio is downmixed and decimated to about this rate
+    constexpr size_t FINGERPRINT_FRAME = 2048;          // FFT block (~0.37 s)
+    constexpr size_t FINGERPRINT_HOP = 512;             // Block step (~93 ms); one 32-bit word per step
+    constexpr double FINGERPRINT_SECONDS = 30.0;        // Audio covered, from the first sample above FINGERPRINT_SILENCE
+    constexpr float FINGERPRINT_SILENCE = 0.01f;        // Leading samples below this level are skipped (aligns copies)
+    constexpr double FINGERPRINT_MAX_BIT_ERROR = 0.3;   // Fingerprints at most this far apart are the same recording
+    constexpr int FINGERPRINT_MAX_SHIFT = 2;            // Words of misalignment tried when comparing
+    constexpr size_t FINGERPRINT_LSH_TABLES = 32;       // Hash tables of the duplicate search
+    constexpr size_t FINGERPRINT_LSH_BITS = 12;         // Sampled bits per table key
+    constexpr size_t FINGERPRINT_LSH_WORDS = 64;        // Bits are sampled from the first this many words (~6 s)
+    constexpr size_t FINGERPRINT_LSH_MAX_BUCKET = 128;  // Larger buckets (e.g. silence) are not compared pairwise
+    
+    // Waveform seek bar (see models/WaveformPeaks.h, services/WaveformService.h)
+    constexpr size_t WAVEFORM_BASE_BIN = 1024;          // Samples per bin of the finest level (~23 ms at 44.1 kHz)
+    constexpr size_t WAVEFORM_LEVEL_FACTOR = 4;         // Each coarser level merges this many bins
+    constexpr size_t WAVEFORM_LEVELS = 4;
+    constexpr size_t WAVEFORM_PREFETCH_TRACKS = 2;      // Upcoming playlist tracks prepared after the current one
+    constexpr size_t WAVEFORM_MAX_RESIDENT = 32;        // Peaks kept in memory; the sidecar cache holds the rest
+    constexpr double WAVEFORM_MAX_SECONDS = 1200.0;     // Longer tracks get no waveform (bounds the decode's memory)
+    constexpr size_t WAVEFORM_CACHE_MAX_BYTES = 64 * 1024 * 1024; // Sidecar cache limit; least recently used files go first
+    constexpr char WAVEFORM_CACHE_DIR[] = "/tmp/MediaBrowserPlayer-waveforms"; // Unless MBP_WAVEFORM_DIR or $HOME is set
+    
+    // Spectrum analyzer on the player screen (see services/SpectrumAnalyzer.h)
+    constexpr int SPECTRUM_REFRESH_MS = 33;             // Analysis and redraw interval (~30 fps)
+    constexpr size_t SPECTRUM_FFT_SIZE = 2048;          // Samples per analysis (~46 ms at 44.1 kHz)
+    constexpr size_t SPECTRUM_RING_SAMPLES = 32768;     // Tap buffer; holds several mixer callbacks of output
+    constexpr size_t SPECTRUM_BANDS = 32;               // Bars, log-spaced between the two frequencies below
+    constexpr double SPECTRUM_MIN_HZ = 50.0;
+    constexpr double SPECTRUM_MAX_HZ = 16000.0;
+    constexpr double SPECTRUM_FLOOR_DB = -60.0;         // Bars and the level meter start here (0 dB = full scale)
+    constexpr float SPECTRUM_DECAY = 0.85f;             // Falling bars keep this share of their height per frame
+    constexpr int SPECTRUM_HEIGHT = 8;                  // Rows of bars
     
     // Metadata keys
     namespace MetadataKeys {
@@ -41,6 +117,9 @@ namespace Constants {
         constexpr char CODEC[] = "codec";
         constexpr char PUBLISHER[] = "publisher";
         constexpr char TRACK_NUMBER[] = "track_number";
+        constexpr char AUDIO_CODEC[] = "audio_codec";
+        constexpr char RESOLUTION[] = "resolution";
+        constexpr char FRAME_RATE[] = "frame_rate";
     }
     
     // Player states
@@ -9,6 +9,8 @@
 #include "HardwareController.h"
 #include "../models/MediaLibrary.h"
 #include "../models/PlaylistManager.h"
+#include "../services/LibraryWatcher.h"
+#include "../services/MetricsServer.h"
 
 class ApplicationController {
 public:
@@ -40,6 +42,9 @@ public:
     void changeDirectory();
     void changeDirectory(const std::string& directory);
     
+    // Write the recorded trace zones to Trace::getDefaultPath()
+    void dumpTrace();
+    
     // Method to configure hardware settings
     void configureHardware();
     
@@ -60,14 +65,26 @@ private:
     std::shared_ptr<MediaLibrary> mediaLibrary;
     std::shared_ptr<PlaylistManager> playlistManager;
     
+    // Picks up files added/removed under the scanned directories
+    std::unique_ptr<LibraryWatcher> libraryWatcher;
+    
+    // Prometheus text for fleet monitoring on a local socket
+    std::unique_ptr<MetricsServer> metricsServer;
+    
     // Current directory
     std::string currentDirectory;
 
     // Signal handler
     bool running;
     
+    // Point playlist tracks at files the last scan found moved, and save them
+    void relinkMovedFiles();
+    
     // Show main menu and get user choice
     int showMainMenu();
+    
+    // Apply what the library watcher found since the last call (UI thread only); true if anything changed
+    bool applyLibraryChanges();
 };
 
 #endif // APPLICATIONCONTROLLER_H
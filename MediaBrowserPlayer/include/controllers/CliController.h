@@ -0,0 +1,79 @@
+#ifndef CLICONTROLLER_H
+#define CLICONTROLLER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include "../models/MediaLibrary.h"
+#include "../models/MediaFile.h"
+
+// Batch mode: one subcommand runs against the library and playlist code without
+// the menu, writes its results to stdout and exits. A build server can run
+// "index build" on a media tree and ship the resulting LIBRARY_INDEX_FILE with it;
+// the first scan on the device then only re-tags files that changed since.
+//
+//   scan <dir> [--jobs N] [--json]            every media file below dir
+//   index build <dir> [--jobs N] [--output FILE]
+//                                             write the index (default <dir>/LIBRARY_INDEX_FILE)
+//   search <query> [--dir DIR] [--jobs N] [--json]
+//                                             files whose name contains query (DIR defaults to .)
+//   playlist list [--playlists DIR]           "<name>\t<tracks>\t<seconds>" per playlist
+//   playlist export <name> [--format m3u|pls] [--library DIR] [--jobs N] [--playlists DIR]
+//                                             the playlist as M3U/PLS; tracks are titled from
+//                                             the library at DIR if given
+//
+// File lists are "<type>\t<seconds>\t<title>\t<path>" lines (tabs, newlines and
+// backslashes escaped as \t, \n and \\), or one JSON object per line with --json.
+// --jobs defaults to the number of CPUs. Exit status: 0 done, 1 failed, 2 usage error.
+class CliController {
+public:
+    CliController(const std::string& programName, const std::vector<std::string>& arguments);
+
+    // True if name is one of the subcommands above
+    static bool isSubcommand(const std::string& name);
+
+    // Run the subcommand. Returns the exit status
+    int run();
+
+private:
+    // Command line after the subcommand
+    struct Options {
+        std::vector<std::string> positional;
+        unsigned jobs = 1;
+        bool json = false;
+        std::string output;
+        std::string directory;
+        std::string library;
+        std::string format = "m3u";
+        std::string playlists;
+    };
+
+    std::string programName;
+    std::vector<std::string> arguments;
+    Options options;
+
+    // Split arguments into options; false (after printing why) on an unknown or incomplete option
+    bool parseOptions();
+
+    // Subcommands
+    int runScan();
+    int runIndex();
+    int runSearch();
+    int runPlaylist();
+
+    // Scan directory into library with options.jobs threads, calling onAdded (if set) for
+    // each file as it is added; false if it isn't a directory
+    bool scanLibrary(const std::string& directory, MediaLibrary& library,
+                     const std::function<void(const MediaFile&)>& onAdded = nullptr);
+
+    // Directory playlists are read from
+    std::string getPlaylistsDir() const;
+
+    // Write one file as a list line or a JSON object
+    void writeFile(std::ostream& out, const MediaFile& file) const;
+
+    int usage() const;
+};
+
+#endif // CLICONTROLLER_H
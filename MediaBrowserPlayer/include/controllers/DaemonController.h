@@ -0,0 +1,91 @@
+#ifndef DAEMONCONTROLLER_H
+#define DAEMONCONTROLLER_H
+
+#include <memory>
+#include <string>
+#include <map>
+#include "PlayerController.h"
+#include "../views/HeadlessView.h"
+#include "../models/MediaLibrary.h"
+#include "../models/Playlist.h"
+#include "../services/LibraryWatcher.h"
+#include "../services/MetricsServer.h"
+
+// Headless mode: no terminal UI, the player is driven over a Unix domain socket.
+// One thread serves every client with epoll; SIGINT/SIGTERM stop it cleanly.
+//
+// Protocol: one command per line, one reply per command. A reply is "OK",
+// "OK <value>" or "ERR <reason>"; list replies are "OK <n>" followed by n lines
+// of tab-separated fields (tabs, newlines and backslashes in fields are escaped
+// as \t, \n and \\).
+//
+//   status                 OK state=<playing|paused|stopped> volume=<0-100> position=<s> duration=<s> track=<i> title=<rest of line>
+//   play [N]               play the queue from entry N (default 0); an empty queue plays the whole library
+//   pause | resume | toggle | stop | next | prev
+//   seek <S> | seek +S | seek -S    absolute or relative position in seconds
+//   volume [N | +N | -N]   report or change the volume; replies OK <volume>
+//   queue                  OK <n>, then "<entry>\t<duration>\t<title>\t<path>" lines
+//   queue add <path>       append a library track; replies OK <queue length>
+//   queue remove <N> | queue clear
+//   search <text>          OK <n>, then "<duration>\t<title>\t<path>" lines (at most DAEMON_SEARCH_LIMIT)
+//   help | quit
+//
+// Queue edits take effect on the next "play".
+class DaemonController {
+public:
+    DaemonController(const std::string& directory, const std::string& socketPath);
+    ~DaemonController();
+
+    // Scan, start playback and serve the control socket until SIGINT/SIGTERM. Returns the exit status
+    int run();
+
+    // $MBP_CONTROL_SOCKET if set, else DAEMON_SOCKET_PATH
+    static std::string getDefaultSocketPath();
+
+private:
+    struct Client {
+        std::string input;
+        std::string output;
+        bool closing = false;   // Close once output is flushed
+    };
+
+    std::string directory;
+    std::string socketPath;
+
+    std::shared_ptr<HeadlessView> view;
+    std::shared_ptr<MediaLibrary> mediaLibrary;
+    std::shared_ptr<PlayerController> playerController;
+    std::unique_ptr<LibraryWatcher> libraryWatcher;
+    std::unique_ptr<MetricsServer> metricsServer;
+    Playlist queue;
+
+    int listenFd;
+    int epollFd;
+    int signalFd;
+    std::map<int, Client> clients;
+
+    // Scan the library, start audio and open the sockets
+    bool initialize();
+
+    // Close clients and sockets, stop playback
+    void shutdown();
+
+    // Socket events
+    void acceptClients();
+    void readClient(int fd, Client& client);
+    void flushClient(int fd, Client& client);
+    void closeClient(int fd);
+
+    // Execute one command line and append the reply to client.output
+    void handleCommand(const std::string& line, Client& client);
+
+    // Command helpers; each returns the reply without the trailing newline
+    std::string handleStatus();
+    std::string handlePlay(const std::string& argument);
+    std::string handleSeek(const std::string& argument);
+    std::string handleVolume(const std::string& argument);
+    std::string handleQueue(const std::string& argument);
+    std::string handleSearch(const std::string& argument);
+};
+
+#endif // DAEMONCONTROLLER_H
@@ -4,7 +4,9 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <functional>
+#include <string>
 #include "../utils/S32K144Communication.h"
 
 // Forward declaration
@@ -31,9 +33,21 @@ private:
     
     std::thread inputThread;
     std::atomic<bool> stopInputThread;
+
+    // Last now-playing state the board accepted, and when it went out
+    S32K144Protocol::NowPlaying lastTelemetry;
+    bool hasSentTelemetry;
+    std::chrono::steady_clock::time_point lastTelemetryTime;
     
-    // Thread function to read input from hardware
+    // Thread function for the board link: sleeps in epoll until the board sends data
+    // or the next telemetry tick is due
     void readHardwareInput();
+
+    // Push the current player state to the board if it changed (runs on the input thread)
+    void publishTelemetry();
+
+    // Dispatch one decoded board event to the player
+    void handleBoardEvent(const S32K144Protocol::BoardEvent& event);
 };
 
 #endif // HARDWARECONTROLLER_H
@@ -2,6 +2,7 @@
 #define MEDIACONTROLLER_H
 
 #include <memory>
+#include <functional>
 #include "../models/MediaLibrary.h"
 #include "../models/PlaylistManager.h"
 #include "../views/MediaListView.h"
@@ -33,8 +34,8 @@ public:
     // Show media file details
     void showMediaFileDetails(size_t index);
 
-    // Show media file details in playlist
-    void showMediaFileDetailsInPlaylist(size_t index, size_t playlistIndex);
+    // Show details of library file index, shown as track trackIndex of playlist playlistIndex
+    void showMediaFileDetailsInPlaylist(size_t index, size_t playlistIndex, size_t trackIndex);
     
     // Edit media file metadata
     void editMediaFileMetadata(size_t index);
@@ -42,6 +43,10 @@ public:
     // Search for media files
     void searchMediaFiles(const std::string& query);
     
+    // Fingerprint the library's audio files, list groups of duplicates and offer to
+    // remove all but the highest bitrate copy of each from the library. True if any were removed
+    bool findDuplicates();
+    
     // Filter media files by type
     void filterMediaFilesByType(Constants::FileType type);
     
@@ -51,6 +56,10 @@ public:
     // Check if Media File exists and return its index
     int MediaFileExists(const MediaFile& file) const;
     
+    // Set how pending library watcher changes are applied (called at the top of each screen loop);
+    // the function returns true if the library changed
+    void setLibraryRefresh(const std::function<bool()>& refresh);
+    
 private:
     // View pointer
     std::shared_ptr<MediaListView> mediaListView;
@@ -66,9 +75,18 @@ private:
     
     int currentPage;
     
+    // Applies pending library watcher changes; may be empty
+    std::function<bool()> libraryRefresh;
+    
+    // Apply pending library changes; true if the library changed
+    bool refreshLibrary();
+    
     // Calculate total pages based on items per page
     int calculateTotalPages() const;
     
+    // Point playlist tracks at files the last scan found moved, and save them
+    void relinkPlaylists();
+    
     // Update media file metadata
     bool updateMetadata(size_t index, const Metadata& metadata);
     
@@ -2,6 +2,7 @@
 #define PLAYERCONTROLLER_H
 
 #include <memory>
+#include <functional>
 #include <thread>
 #include <atomic>
 #include <condition_variable>
@@ -9,8 +10,20 @@
 #include "../models/AudioState.h"
 #include "../views/PlayerView.h"
 #include "../services/AudioService.h"
+#include "../services/WaveformService.h"
+#include "../services/SpectrumAnalyzer.h"
 #include "../models/Playlist.h"
 #include "../models/MediaLibrary.h"
+#include "../utils/TerminalInput.h"
+
+// Consistent copy of the player state for consumers outside the UI thread
+struct PlayerSnapshot {
+    Constants::PlayerState state;
+    int volume;
+    double position;    // seconds
+    double duration;    // seconds
+    std::string title;
+};
 
 class PlayerController {
 public:
@@ -25,6 +38,7 @@ public:
     
     // Play a specific track from a playlist
     bool playPlaylist();
+    bool playPlaylist(const Playlist& playlist, int startIndex);
     
     // Play/pause toggle
     void togglePlayPause();
@@ -38,6 +52,10 @@ public:
     // Skip to previous track
     void previous();
     
+    // Queue a jump within the current track (seconds) for the music thread; false when stopped.
+    // A format that can't seek reports it on the player screen
+    bool seek(double position);
+    
     // Adjust volume
     void setVolume(int volume);
     void increaseVolume();
@@ -46,11 +64,14 @@ public:
     // Show player interface
     void showPlayer();
     
-    // Update player view (called from playback thread)
+    // Redraw the player view
     void updatePlayerView();
     
     // Get audio state
     AudioState& getAudioState();
+
+    // Take a snapshot of the current state (thread-safe)
+    PlayerSnapshot getStateSnapshot();
     
     // Check if player is active
     bool isPlaying() const;
@@ -58,6 +79,10 @@ public:
     // Check if player view is active
     bool _isDisplaying() const;
     
+    // Set how pending library watcher changes are applied (called at the top of each screen loop);
+    // the function returns true if the library changed
+    void setLibraryRefresh(const std::function<bool()>& refresh);
+    
 private:
     // Model
     AudioState audioState;
@@ -77,21 +102,47 @@ private:
     std::atomic<bool> nextMusic = false;
     std::atomic<bool> preMusic = false;
     std::atomic<bool> loadNewSource = false;
+    std::atomic<bool> seekMusic = false;
+    std::atomic<double> seekPosition = 0.0; // Target of the pending seek (last one wins)
     std::mutex audioStateMutex;
 
-    // Display thread
-    SDL_Thread* updateViewThread;
-    std::atomic<bool> isRunning = true;
+    // Wakes the music thread as soon as a command flag is set
+    std::mutex commandMutex;
+    std::condition_variable commandCondition;
+    
+    // steady_clock time (ns) of the oldest command the music thread hasn't started on, 0 if none
+    std::atomic<int64_t> commandIssuedAt = 0;
+
+    // Waveform seek bar: peaks are prepared in the background for the current and next tracks
+    WaveformService waveformService;
+    std::string waveformTrack;      // Track the last request was made for
+    
+    // Spectrum under the player, toggled with 'V'; analysed only while the screen shows it
+    SpectrumAnalyzer spectrumAnalyzer;
+    bool showSpectrum = false;
+    
+    // Player screen: raw keyboard input and render tick share one loop
+    TerminalInput terminalInput;
     std::atomic<bool> isDisplaying = false;
-    // Create SDL mutex for thread synchronization
-    SDL_mutex* mutex;
-    SDL_cond* condition;
+    
+    // Applies pending library watcher changes on the render tick; may be empty
+    std::function<bool()> libraryRefresh;
 
     // Function to play music in music thread
     static int musicThreadFunc(void* data);
 
-    // Function to update view in updateView thread
-    static int updateViewThreadFunc(void *data);
+    // Wake up the music thread to handle a new command
+    void notifyMusicThread();
+
+    // Ask the player screen loop to redraw (safe from any thread)
+    void requestViewUpdate();
+    
+    // Draw the latest spectrum frame below the player (inPlace: over the previous one)
+    void drawSpectrum(bool inPlace);
+    
+    // Hand the current track's peaks to the view, requesting them on a track change
+    // (call with audioStateMutex held)
+    void updateWaveform();
 };
 
 #endif // PLAYERCONTROLLER_H
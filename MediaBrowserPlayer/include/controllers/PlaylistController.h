@@ -2,11 +2,13 @@
 #define PLAYLISTCONTROLLER_H
 
 #include <memory>
+#include <functional>
 #include "../models/PlaylistManager.h"
 #include "PlayerController.h"
 #include "MediaController.h"
 #include "../views/PlaylistView.h"
 #include "../services/FileService.h"
+#include "../services/PlaylistFormatService.h"
 #include "../models/MediaLibrary.h"
 #include "../views/IView.h"
 
@@ -44,6 +46,18 @@ public:
     // Move a track within a playlist
     void moveTrackInPlaylist(size_t playlistIndex, size_t fromIndex, size_t toIndex);
     
+    // Apply several moves to a playlist and save it once
+    void moveTracksInPlaylist(size_t playlistIndex, const std::vector<Playlist::TrackMove>& moves);
+    
+    // Show, create and play smart playlists
+    void showSmartPlaylists();
+    
+    // Import an M3U/M3U8/PLS file as a new playlist
+    void importPlaylist();
+    
+    // Export a playlist to an M3U/M3U8/PLS file
+    void exportPlaylist(size_t index);
+    
     // Show menu
     void showMenu();
     
@@ -53,6 +67,10 @@ public:
     // Get playlist manager
     std::shared_ptr<PlaylistManager>& getPlaylistManager();
     
+    // Set how pending library watcher changes are applied (called at the top of each screen loop);
+    // the function returns true if the library changed
+    void setLibraryRefresh(const std::function<bool()>& refresh);
+    
 private:
     // View
     std::shared_ptr<PlaylistView> playlistView;
@@ -63,16 +81,26 @@ private:
 
     // Controller
     FileService fileService;
+    PlaylistFormatService playlistFormatService;
     std::shared_ptr<PlayerController> playerController;
     std::shared_ptr<MediaController> mediaController;
     
     int currentPage;
     
+    // Applies pending library watcher changes; may be empty
+    std::function<bool()> libraryRefresh;
+    
+    // Apply pending library changes; true if the library changed
+    bool refreshLibrary();
+    
     // Calculate total pages based on items per page
     int calculateTotalPages(const Playlist& playlist) const;
     
     // Display playlist options menu
     void showPlaylistOptionsMenu();
+
+    // Page through tracks and return the chosen 0-based index, or -1 if cancelled
+    int pickTrack(const Playlist::TrackList& tracks, const std::string& title, const std::string& prompt);
     
     // Load playlists from files
     void loadPlaylists();
@@ -0,0 +1,57 @@
+#ifndef FINGERPRINTINDEX_H
+#define FINGERPRINTINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "../utils/FileStamp.h"
+
+class MediaLibrary;
+
+// Acoustic fingerprints of library files (see utils/AudioFingerprint.h), keyed by
+// track ID and valid while the file's size and modification time are unchanged.
+// Kept beside TrackCatalog rather than in it: the catalog is rebuilt whenever the
+// library is cleared, and fingerprints take a full decode to recompute.
+//
+// Near-duplicates are found with bit-sampling LSH: each of FINGERPRINT_LSH_TABLES
+// tables keys a fingerprint by FINGERPRINT_LSH_BITS fixed bit positions of its first
+// words, so copies of a recording (few differing bits) share a key in some table
+// with high probability while unrelated tracks rarely do. Only tracks sharing a
+// bucket are compared in full.
+class FingerprintIndex {
+public:
+    FingerprintIndex();
+
+    // Stored fingerprint of filePath if the file is unchanged since, else nullptr.
+    // An empty fingerprint means the file was tried and couldn't be fingerprinted
+    const std::vector<uint32_t>* find(const std::string& filePath) const;
+
+    // Store the fingerprint of filePath as of stamp
+    void store(const std::string& filePath, const FileStamp& stamp, std::vector<uint32_t> fingerprint);
+
+    // Move the fingerprint of oldPath to newPath, a moved copy of the same audio now
+    // stamped stamp. Nothing happens if oldPath had none
+    void relink(const std::string& oldPath, const std::string& newPath, const FileStamp& stamp);
+
+    // Number of stored fingerprints
+    size_t size() const;
+
+    // Drop every fingerprint
+    void clear();
+
+    // Groups of library indices whose audio files are the same recording. Every group
+    // has at least two entries sorted by index; groups are ordered by their first index
+    std::vector<std::vector<size_t>> findDuplicates(const MediaLibrary& library) const;
+
+private:
+    struct Entry {
+        std::string path;
+        FileStamp stamp;
+        std::vector<uint32_t> words;
+    };
+
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+#endif // FINGERPRINTINDEX_H
@@ -2,9 +2,13 @@
 #define MEDIAFILE_H
 
 #include <string>
+#include <cstdint>
 #include "../Constants.h"
 #include "Metadata.h"
 
+class RecordReader;
+class RecordWriter;
+
 class MediaFile {
 public:
     MediaFile();
@@ -23,6 +27,12 @@ public:
     // Extract file name from path
     std::string getFileName() const;
     
+    // Stable track ID used by playlist files (hash of the file path)
+    uint64_t getTrackId() const;
+    
+    // Track ID for a path (64-bit FNV-1a)
+    static uint64_t computeTrackId(const std::string& filePath);
+    
     // Check if the file exists
     bool exists() const;
     
@@ -32,6 +42,10 @@ public:
     // Deserialize from string
     static MediaFile fromString(const std::string& serialized);
     
+    // Append/read this file as fields of the current record (path|type|metadata...)
+    void write(RecordWriter& writer) const;
+    static bool read(RecordReader& reader, MediaFile& file);
+    
 private:
     std::string filePath;
     Metadata metadata;
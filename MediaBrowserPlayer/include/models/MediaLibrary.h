@@ -3,17 +3,32 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <functional>
+#include <cstdint>
 #include "MediaFile.h"
 #include "Playlist.h"
+#include "TrackCatalog.h"
+#include "FingerprintIndex.h"
 #include "../Constants.h"
 #include "../services/MetadataService.h"
+#include "../utils/FileStamp.h"
 
 class MediaLibrary {
 public:
     MediaLibrary();
     
-    // Scan a directory for media files
-    void scanDirectory(const std::string& directoryPath, bool recursive = true);
+    // Scan a directory for media files. Tags are read by up to jobs threads; files are
+    // added in directory order either way. Files seen unchanged by an earlier scan (same
+    // size and modification time) are not re-tagged, nor are files listed in the
+    // directory's LIBRARY_INDEX_FILE with the same size and either the same modification
+    // second or the same content signature (copying a tree rarely keeps exact times). A new path whose content signature matches a known file that
+    // is no longer at its old path is taken as that file moved: it keeps its tags and
+    // fingerprint, replaces the old entry, and is reported by takeMovedFiles().
+    // onAdded, if set, is called with each file as it is added (while later files are still read)
+    void scanDirectory(const std::string& directoryPath, bool recursive = true, unsigned jobs = 1,
+                       const std::function<void(const MediaFile&)>& onAdded = nullptr);
     
     // Scan a mounted USB device
     void scanUSBDevice(const std::string& mountPoint, bool recursive = true);
@@ -33,7 +48,20 @@ public:
     // Get total count of media files
     size_t getMediaFileCount() const;
     
-    // Clear all media files
+    // Find a media file by track ID / path, or nullptr if it isn't in the library
+    const MediaFile* findByTrackId(uint64_t trackId) const;
+    const MediaFile* findByPath(const std::string& filePath) const;
+    
+    // Index of the media file with this path, or -1
+    int findIndexByPath(const std::string& filePath) const;
+    
+    // Resolve a playlist entry: the library copy if known, otherwise a bare file entry
+    MediaFile resolveTrack(uint64_t trackId, const std::string& filePath) const;
+    
+    // Files recognised as moved by scans since the last call, as (old path, new path)
+    std::vector<std::pair<std::string, std::string>> takeMovedFiles();
+    
+    // Clear all media files (what is known about their contents is kept for the next scan)
     void clear();
     
     // Add a single media file
@@ -42,9 +70,55 @@ public:
     // Update a media file's metadata
     bool updateMediaFileMetadata(size_t index, const Metadata& metadata);
     
+    // Replace the entry with the same path, or add the file if it is new. Returns true if added
+    bool addOrUpdateMediaFile(const MediaFile& file);
+    
+    // Remove the file with this path / every file below a directory. The last entry
+    // takes the removed one's place, so indices of other files may change
+    bool removeMediaFile(const std::string& filePath);
+    size_t removeDirectory(const std::string& directoryPath);
+    
+    // Write the library files below directoryPath as an index for scanDirectory (paths
+    // relative to directoryPath). Returns the number of files written, or -1 on error
+    long long saveIndex(const std::string& directoryPath, const std::string& indexPath) const;
+    
+    // Columnar copy of the tags, kept in step with the library (row i == media file i)
+    const TrackCatalog& getCatalog() const;
+    
+    // Acoustic fingerprints of the library's files (kept across clear(); stale entries are ignored)
+    FingerprintIndex& getFingerprints();
+    const FingerprintIndex& getFingerprints() const;
+    
 private:
     Playlist root;
+    
+    // Track ID -> index in root
+    std::unordered_map<uint64_t, size_t> trackIndex;
+    TrackCatalog catalog;
+    FingerprintIndex fingerprints;
     MetadataService metadataService;
+    
+    // What a scan or library index established about a file's contents
+    struct KnownFile {
+        FileStamp stamp;
+        uint64_t signature = 0;     // ContentSignature, 0 if not computed
+        Metadata metadata;
+        bool fromIndex = false;     // Read from a LIBRARY_INDEX_FILE, not seen by a scan here
+    };
+    
+    // Path -> what was known when the file last had that stamp, and content
+    // signature -> path of the file last seen with it. Both outlive clear(); a scan
+    // drops the entries of files below its directory that no longer exist
+    std::unordered_map<std::string, KnownFile> knownFiles;
+    std::unordered_map<uint64_t, std::string> signatureIndex;
+    std::vector<std::pair<std::string, std::string>> movedFiles;
+    
+    // Add the files of an index (paths relative to directoryPath) to knownFiles; entries
+    // already known from a scan are kept. False if there is no usable index
+    bool loadIndex(const std::string& indexPath, const std::string& directoryPath);
+    
+    // Remove entry index by moving the last entry into its place
+    void removeAt(size_t index);
 };
 
 #endif // MEDIALIBRARY_H
@@ -4,6 +4,9 @@
 #include <string>
 #include <map>
 
+class RecordReader;
+class RecordWriter;
+
 class Metadata {
 public:
     Metadata();
@@ -30,6 +33,10 @@ public:
     // Deserialize from string
     static Metadata fromString(const std::string& serialized);
     
+    // Append/read this metadata as fields of the current record
+    void write(RecordWriter& writer) const;
+    static bool read(RecordReader& reader, Metadata& metadata);
+    
 private:
     std::string name;
     double duration; // in seconds
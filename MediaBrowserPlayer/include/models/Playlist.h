@@ -3,10 +3,69 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <string_view>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
 #include "MediaFile.h"
+#include "PlaylistHeader.h"
+#include "../utils/TrackOrder.h"
 
 class Playlist {
 public:
+    // Turns a stored (track ID, path) pair back into a MediaFile, normally via the library
+    using TrackResolver = std::function<MediaFile(uint64_t trackId, const std::string& filePath)>;
+    
+    // One step of a batch reorder: the track at fromIndex ends up at toIndex
+    struct TrackMove {
+        size_t fromIndex;
+        size_t toIndex;
+    };
+    
+    // Read-only view of the tracks in playlist order. Taking it never changes the
+    // playlist; it is invalidated by the playlist's next edit
+    class TrackList {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = MediaFile;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const MediaFile*;
+            using reference = const MediaFile&;
+            
+            Iterator(const TrackList* list, size_t position) : list(list), position(position) {}
+            reference operator*() const { return (*list)[position]; }
+            pointer operator->() const { return &(*list)[position]; }
+            Iterator& operator++() { ++position; return *this; }
+            bool operator==(const Iterator& other) const { return position == other.position; }
+            bool operator!=(const Iterator& other) const { return position != other.position; }
+            
+        private:
+            const TrackList* list;
+            size_t position;
+        };
+        
+        size_t size() const;
+        bool empty() const;
+        const MediaFile& operator[](size_t position) const;
+        const MediaFile& back() const;
+        Iterator begin() const;
+        Iterator end() const;
+        
+        // Copy of the tracks
+        std::vector<MediaFile> toVector() const;
+        
+    private:
+        friend class Playlist;
+        TrackList(const std::vector<MediaFile>& storage, std::vector<uint32_t> handles, bool ordered);
+        
+        const std::vector<MediaFile>* storage;
+        std::vector<uint32_t> handles;  // Storage slot of each position, unless ordered
+        bool ordered;
+    };
+    
     Playlist();
     Playlist(const std::string& name);
     Playlist(const std::string& name, std::vector<MediaFile> trackList);
@@ -14,22 +73,52 @@ public:
     const std::string& getName() const;
     void setName(const std::string& name);
     
+    // Counts the rewrites of the playlist file; journal records name the one they apply to
+    uint64_t getGeneration() const;
+    void setGeneration(uint64_t generation);
+    
     void addTrack(const MediaFile& track);
+    void insertTrack(size_t index, const MediaFile& track);
+    void setTrack(size_t index, const MediaFile& track);
     void removeTrack(size_t index);
     void moveTrack(size_t fromIndex, size_t toIndex);
     
-    const std::vector<MediaFile>& getTracks() const;
+    // Apply moves one after another (each in O(log n)); invalid moves are skipped
+    void moveTracks(const std::vector<TrackMove>& moves);
+    
+    // Move count tracks starting at first as a block so it starts at toIndex
+    void moveRange(size_t first, size_t count, size_t toIndex);
+    
+    // Tracks in playlist order: no copy while the storage is in order, else one
+    // handle per track (see compact())
+    TrackList getTracks() const;
     MediaFile getTrack(size_t index) const;
     size_t getTrackCount() const;
     bool isEmpty() const;
     
     void clear();
     
-    // Save playlist to file
+    // Rewrite the storage in playlist order and drop emptied slots (O(n)), so
+    // getTracks() needs no handles until the next removal or move
+    void compact();
+    
+    // Save playlist to file (atomically: temp file, fsync, rename)
     bool save(const std::string& directory = "") const;
+
+    // Path of this playlist's file in a directory
+    std::string getFilePath(const std::string& directory = "") const;
+    
+    // Load playlist from file. Tracks are resolved through resolver (bare path entries if none);
+    // isLegacy is set for old files that embed full metadata
+    static Playlist load(const std::string& filePath, const TrackResolver& resolver = nullptr,
+                         bool* isLegacy = nullptr);
     
-    // Load playlist from file
-    static Playlist load(const std::string& filePath);
+    // Read only the name/count/duration lines of a playlist file.
+    // Returns false for old-format files, which have no summary and must be fully loaded
+    static bool readHeader(const std::string& filePath, PlaylistHeader& header);
+    
+    // Summary of this playlist (as stored in directory)
+    PlaylistHeader getHeader(const std::string& directory = "") const;
     
     // Serialize to string
     std::string toString() const;
@@ -38,9 +127,27 @@ public:
     double getTotalDuration() const;
     std::string getTotalDurationString() const;
     
+    // Format seconds as H:MM:SS or M:SS
+    static std::string formatDuration(double totalDuration);
+    
 private:
     std::string name;
+    uint64_t generation;
+    
+    // Track storage. While `ordered` is set it is the playlist in order; after the first
+    // removal or move the order lives in `order` (handles are indices into tracks, removed
+    // slots are emptied) until compact() is called or removals leave most slots empty.
+    // Appends keep it ordered. Const methods only read, so a copy can be saved on another
+    // thread while the original is copied again.
     std::vector<MediaFile> tracks;
+    TrackOrder order;
+    bool ordered;
+    
+    // Switch from plain storage order to the handle sequence
+    void detachOrder();
+    
+    // Parse a "#MBPLAYLIST <version>" line; false if this isn't one
+    static bool parseFormatLine(std::string_view line, int& version);
 };
 
 #endif // PLAYLIST_H
@@ -0,0 +1,30 @@
+#ifndef PLAYLISTHEADER_H
+#define PLAYLISTHEADER_H
+
+#include <string>
+
+// Summary of a playlist that can be read without loading its tracks
+class PlaylistHeader {
+public:
+    PlaylistHeader();
+    PlaylistHeader(const std::string& name, size_t trackCount, double totalDuration,
+                   const std::string& filePath = "");
+    
+    const std::string& getName() const;
+    size_t getTrackCount() const;
+    
+    // Total duration in seconds / formatted (H:MM:SS or M:SS)
+    double getTotalDuration() const;
+    std::string getTotalDurationString() const;
+    
+    // File the playlist body is loaded from ("" if it was never saved)
+    const std::string& getFilePath() const;
+    
+private:
+    std::string name;
+    size_t trackCount;
+    double totalDuration;
+    std::string filePath;
+};
+
+#endif // PLAYLISTHEADER_H
@@ -0,0 +1,101 @@
+#ifndef PLAYLISTJOURNAL_H
+#define PLAYLISTJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "Playlist.h"
+
+// Undo/redo history of one playlist plus the edit log that goes with it.
+// Small edits (insert/remove/move) are appended to "<playlist file>.journal" as one
+// record each instead of rewriting the playlist; on startup the log is replayed on
+// top of the playlist file and folded back into it. Each record carries the
+// generation of the playlist file it applies to, so records already folded into a
+// newer file (crash before the journal was removed) or logged after a save that
+// never made it to disk are skipped. Renames and whole-list replacements change
+// the file itself, so they are kept for undo but saved by rewriting the playlist.
+class PlaylistJournal {
+public:
+    // One reversible change
+    struct Edit {
+        enum class Type {
+            INSERT,     // track inserted at position
+            REMOVE,     // track removed from position
+            MOVE,       // count tracks at position moved so they start at toIndex
+            RENAME,     // oldName -> newName
+            REPLACE     // oldTracks -> tracks (e.g. clear)
+        };
+        
+        Type type = Type::INSERT;
+        size_t position = 0;
+        size_t count = 1;
+        size_t toIndex = 0;
+        MediaFile track;
+        std::string oldName;
+        std::string newName;
+        std::vector<MediaFile> oldTracks;
+        std::vector<MediaFile> tracks;
+    };
+    
+    // How an edit got into the log (replay rebuilds the history from this)
+    enum class Kind : char {
+        EDIT = 'E',
+        UNDO = 'U',
+        REDO = 'R'
+    };
+    
+    PlaylistJournal();
+    
+    // Remember a new edit (drops anything that could have been redone)
+    void record(const Edit& edit);
+    
+    // Edit to revert / re-apply, or nullptr if there is none. Moves the history cursor
+    const Edit* undo();
+    const Edit* redo();
+    
+    bool canUndo() const;
+    bool canRedo() const;
+    
+    // Forget the history
+    void clear();
+    
+    // Queue an applied edit (for UNDO: the inverse that was applied) for the log file,
+    // on top of the playlist file of the given generation
+    void log(Kind kind, uint64_t generation, const Edit& edit);
+    
+    // Records not written yet; clears them
+    std::string takeUnsaved();
+    
+    // Drop the log because the playlist file is being rewritten with everything in it
+    void resetLog();
+    
+    // Edits logged since the playlist file was last written (saved or not)
+    size_t getLoggedCount() const;
+    
+    // Apply an edit to a playlist
+    static void apply(Playlist& playlist, const Edit& edit);
+    
+    // The edit that undoes edit
+    static Edit inverse(const Edit& edit);
+    
+    // Whether the edit can go into the log (false: the playlist must be rewritten)
+    static bool isLoggable(const Edit& edit);
+    
+    // Log file belonging to a playlist file
+    static std::string getJournalPath(const std::string& playlistPath);
+    
+    // Apply the log at journalPath to playlist and rebuild journal's history from it.
+    // Records of another generation than the playlist's and a torn last record (crash
+    // during append) are ignored. Returns the number of records applied
+    static size_t replay(const std::string& journalPath, Playlist& playlist,
+                         const Playlist::TrackResolver& resolver, PlaylistJournal& journal);
+    
+private:
+    std::deque<Edit> history;
+    size_t cursor;          // Edits before cursor are applied, the rest can be redone
+    std::string unsaved;
+    size_t loggedCount;
+};
+
+#endif // PLAYLISTJOURNAL_H
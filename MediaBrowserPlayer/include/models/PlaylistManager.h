@@ -3,23 +3,68 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <utility>
 #include "Playlist.h"
+#include "PlaylistHeader.h"
+#include "PlaylistJournal.h"
+#include "SmartPlaylist.h"
 
+class MediaLibrary;
+
+// Owns all playlists. Only headers (name, track count, duration) are read at
+// startup; track lists are loaded on first access and the least recently used
+// ones are dropped again once more than MAX_RESIDENT_PLAYLISTS are in memory.
+// Track edits made through addTrack/removeTrack/moveTracks are appended to a
+// per-playlist journal and can be undone; see PlaylistJournal.
+// Playlists are addressed by their position in getPlaylistHeaders(), or by a
+// Handle that keeps referring to the same playlist while others are added,
+// deleted or renamed.
 class PlaylistManager {
 public:
+    // Stable reference to one playlist; a handle of a deleted playlist never resolves again
+    struct Handle {
+        uint32_t slot = 0;
+        uint32_t generation = 0; // 0 = no playlist
+
+        bool isValid() const { return generation != 0; }
+        bool operator==(const Handle& other) const { return slot == other.slot && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
     PlaylistManager();
+    ~PlaylistManager();
     
-    // Get all playlists
-    const std::vector<Playlist>& getPlaylists() const;
+    // Get the summaries of all playlists (never loads track lists)
+    const std::vector<PlaylistHeader>& getPlaylistHeaders() const;
     
-    // Get playlist by index
-    Playlist getPlaylist(size_t index) const;
+    // Get playlist by index (loads its tracks if needed). The reference is only valid
+    // until the playlist is deleted or another playlist is loaded; edit through the manager
+    const Playlist& getPlaylist(size_t index) const;
     
-    // Get playlist by name
+    // Get playlist by handle, or nullptr if it was deleted (same lifetime as above)
+    const Playlist* getPlaylist(Handle handle) const;
+    
+    // Get playlist by name; the pointer is only valid until another playlist is accessed.
+    // Call markDirty() after changing it
     Playlist* getPlaylistByName(const std::string& name);
     
-    // Add new playlist
-    void addPlaylist(const Playlist& playlist);
+    // Handle of the playlist at index / with this name (invalid handle if there is none)
+    Handle getHandle(size_t index) const;
+    Handle findPlaylist(const std::string& name) const;
+    
+    // Current index of a handle's playlist; false if it was deleted
+    bool findIndex(Handle handle, size_t& index) const;
+    
+    // Add new playlist and return its handle
+    Handle addPlaylist(const Playlist& playlist);
     
     // Update existing playlist
     bool updatePlaylist(size_t index, const Playlist& playlist);
@@ -27,20 +72,161 @@ public:
     // Delete playlist
     bool deletePlaylist(size_t index);
     
+    // Mark a playlist as changed (for edits made through getPlaylistByName; drops its undo history)
+    void markDirty(size_t index);
+    
+    // Undoable edits of playlist index. Each returns false if the index or position is invalid
+    bool addTrack(size_t index, const MediaFile& track);
+    bool removeTrack(size_t index, size_t position);
+    bool moveTracks(size_t index, const std::vector<Playlist::TrackMove>& moves);
+    bool renamePlaylist(size_t index, const std::string& name);
+    bool clearPlaylist(size_t index);
+    
+    // Revert / re-apply the last edit of playlist index
+    bool undo(size_t index);
+    bool redo(size_t index);
+    bool canUndo(size_t index) const;
+    bool canRedo(size_t index) const;
+    
+    // Number of playlists whose tracks are currently loaded
+    size_t getResidentCount() const;
+    
     // Check if a playlist with the given name exists
     bool playlistExists(const std::string& name) const;
     
-    // Load all playlists from the playlists directory
+    // Name based on base that no playlist uses yet ("Mix", "Mix (2)", ...)
+    std::string makeUniqueName(const std::string& base) const;
+    
+    // Set how stored track IDs are turned back into media files when loading
+    void setTrackResolver(const Playlist::TrackResolver& resolver);
+    
+    // Point tracks at files' new paths (moves as (old path, new path), see
+    // MediaLibrary::takeMovedFiles). Returns the number of tracks changed; call
+    // savePlaylists() afterwards to write them
+    size_t relinkTracks(const std::vector<std::pair<std::string, std::string>>& moves);
+    
+    // Load all playlists from the playlists directory (old-format files are converted in memory
+    // and keep their file until the playlist is next saved)
     void loadPlaylists(const std::string& directory = "");
     
-    // Save all playlists to the playlists directory
-    void savePlaylists(const std::string& directory = "") const;
+    // Queue changed playlists (and removed files) for the background writer; returns immediately
+    void savePlaylists(const std::string& directory = "");
+    
+    // Queue pending changes and wait until they are on disk
+    void flush();
     
     // Get count of playlists
     size_t getPlaylistCount() const;
     
+    // Smart playlists: rules evaluated against the library instead of stored track lists
+    const std::vector<SmartPlaylist>& getSmartPlaylists() const;
+    
+    // Compile and add a rule (saved right away). On failure error says why
+    bool addSmartPlaylist(const std::string& name, const std::string& rule, std::string& error);
+    
+    // Delete a smart playlist
+    bool deleteSmartPlaylist(size_t index);
+    
+    // Bring every smart playlist's match count up to date with the library
+    void refreshSmartPlaylists(const MediaLibrary& library);
+    
+    // Current tracks of smart playlist index; only library entries changed since the last call are re-checked
+    Playlist evaluateSmartPlaylist(size_t index, const MediaLibrary& library);
+    
 private:
-    std::vector<Playlist> playlists;
+    std::vector<PlaylistHeader> headers;
+
+    // Loaded track lists (nullptr until first access or after eviction) and their last use
+    mutable std::vector<std::shared_ptr<Playlist>> bodies;
+    mutable std::vector<uint64_t> lastUsed;
+    mutable uint64_t useClock;
+    mutable size_t residentCount;
+
+    // dirty[i] is set when playlist i must be rewritten; dirty playlists are never evicted
+    std::vector<bool> dirty;
+
+    // Undo history and unwritten journal records; playlists with a journal on disk stay resident
+    mutable std::vector<PlaylistJournal> journals;
+
+    // Handles: slots[i] is the slot of playlist i. A slot remembers the playlist's current
+    // index and is reused after a delete with a new generation, so old handles stop resolving
+    std::vector<uint32_t> slots;
+    std::vector<size_t> slotIndices;
+    std::vector<uint32_t> slotGenerations;
+    std::vector<uint32_t> freeSlots;
+    uint32_t handleClock;
+
+    // Playlist name -> slot, kept in step with the headers
+    std::unordered_map<std::string, uint32_t> nameIndex;
+
+    // Files of deleted/renamed playlists that still have to be removed, each with the
+    // name of the playlist that replaced it ("" after a delete)
+    std::map<std::string, std::string> removedNames;
+
+    // Directory the playlists were loaded from
+    std::string storageDir;
+
+    // Smart playlist rules, stored together in SMART_PLAYLISTS_FILE
+    std::vector<SmartPlaylist> smartPlaylists;
+
+    // Resolves track IDs against the library on load
+    Playlist::TrackResolver trackResolver;
+
+    // Background writer: pending work is keyed by playlist name, so repeated
+    // saves of the same playlist collapse into one write
+    std::thread writerThread;
+    mutable std::mutex writerMutex;
+    std::condition_variable writerCondition;
+    std::condition_variable idleCondition;
+    std::map<std::string, Playlist> pendingWrites;
+    std::map<std::string, Playlist> inFlightWrites;
+    std::map<std::string, std::string> pendingAppends;
+    std::map<std::string, std::string> pendingRemovals;
+
+    // Removals held back because the replacing playlist isn't on disk yet; queued
+    // again by the next savePlaylists()
+    std::map<std::string, std::string> deferredRemovals;
+
+    // Copies the writer failed to save; the next savePlaylists() marks their playlists
+    // dirty again, and until then loadBody() reads them instead of the older file
+    std::map<std::string, Playlist> failedWrites;
+    std::string pendingDir;
+    bool writerBusy;
+    bool stopWriter;
+    int flushWaiters;
+
+    // Writer thread loop
+    void writerLoop();
+
+    // Append a playlist with a fresh slot and return its handle
+    Handle appendPlaylist(const PlaylistHeader& header, std::shared_ptr<Playlist> body, bool isDirty,
+                          const PlaylistJournal& journal);
+
+    // Drop name from the name index if it points at slot (another playlist may share the name)
+    void unindexName(const std::string& name, uint32_t slot);
+
+    // Make playlist index resident and return it
+    Playlist& loadBody(size_t index) const;
+
+    // Drop least recently used clean bodies (never keepIndex) until under the limit
+    void evictBodies(size_t keepIndex) const;
+
+    // Directory playlists are stored in
+    std::string getStorageDir() const;
+
+    // Remember that the file for this name must be removed on the next save; after a
+    // rename, only once the file of replacement has been written
+    void scheduleRemoval(const std::string& name, const std::string& replacement = "");
+
+    // Apply an edit to playlist index, then log it (or mark the playlist for rewrite)
+    bool applyEdit(size_t index, const PlaylistJournal::Edit& edit, PlaylistJournal::Kind kind);
+
+    // Read/write the smart playlist rules file
+    void loadSmartPlaylists();
+    bool saveSmartPlaylists() const;
+
+    // Append records to a playlist's journal file (writer thread)
+    static bool appendJournal(const std::string& journalPath, const std::string& records);
 };
 
 #endif // PLAYLISTMANAGER_H
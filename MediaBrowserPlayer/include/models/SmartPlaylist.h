@@ -0,0 +1,48 @@
+#ifndef SMARTPLAYLIST_H
+#define SMARTPLAYLIST_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SmartQuery.h"
+#include "TrackCatalog.h"
+
+// A named rule whose tracks are whatever in the library currently matches it.
+// The match set is kept between refreshes: only rows added or changed since the
+// last refresh are re-checked, unless the library was rescanned from scratch.
+class SmartPlaylist {
+public:
+    SmartPlaylist();
+    SmartPlaylist(const std::string& name, const SmartQuery& query);
+    
+    const std::string& getName() const;
+    const SmartQuery& getQuery() const;
+    
+    // Bring the match set up to date with the catalog. Returns true if it had to start over
+    bool refresh(const TrackCatalog& catalog);
+    
+    // Matching library indices in rule order (call refresh() first)
+    const std::vector<size_t>& getRows(const TrackCatalog& catalog);
+    
+    // Number of matches as of the last refresh
+    size_t getMatchCount() const;
+    
+private:
+    std::string name;
+    SmartQuery query;
+    
+    // matches[row] != 0 if library row matches
+    std::vector<uint8_t> matches;
+    size_t matchCount;
+    
+    // Catalog state the match set reflects
+    uint64_t evaluatedEpoch;
+    uint64_t evaluatedVersion;
+    bool evaluated;
+    
+    // Sorted result, rebuilt when the match set changed
+    std::vector<size_t> rows;
+    bool rowsValid;
+};
+
+#endif // SMARTPLAYLIST_H
@@ -0,0 +1,76 @@
+#ifndef SMARTQUERY_H
+#define SMARTQUERY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "TrackCatalog.h"
+
+// A smart playlist rule, compiled once from text such as
+//   genre = rap AND year >= 2015 AND duration < 300 SORT BY artist LIMIT 100
+// Comparisons: = != < <= > >= and ~ (contains); text is compared case-insensitively.
+// Clauses combine with AND, OR, NOT and parentheses.
+//
+// Rules run against a TrackCatalog a column at a time: a text comparison is first
+// decided once per distinct value of its column, after which every clause is a
+// flat loop over one column, and clauses are combined byte-wise.
+class SmartQuery {
+public:
+    SmartQuery();
+    
+    // Compile rule text. On failure returns false and describes the problem in error
+    static bool parse(const std::string& text, SmartQuery& query, std::string& error);
+    
+    // Rule as written
+    const std::string& getText() const;
+    
+    // Mark every catalog row that matches (matches is resized to the row count)
+    void evaluate(const TrackCatalog& catalog, std::vector<uint8_t>& matches) const;
+    
+    // Re-check only the given rows (for incremental updates)
+    void evaluateRows(const TrackCatalog& catalog, const std::vector<size_t>& rows,
+                      std::vector<uint8_t>& matches) const;
+    
+    // Matching rows in rule order (SORT BY / LIMIT applied)
+    std::vector<size_t> orderRows(const TrackCatalog& catalog, const std::vector<uint8_t>& matches) const;
+    
+private:
+    enum class Compare { EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, CONTAINS };
+    
+    struct Node {
+        enum class Type { AND, OR, NOT, COMPARE };
+        Type type = Type::COMPARE;
+        int left = -1;
+        int right = -1;
+        TrackCatalog::Column column = TrackCatalog::Column::TITLE;
+        Compare compare = Compare::EQUAL;
+        std::string text;   // Lowercased, text columns
+        float number = 0.0f; // Numeric columns
+    };
+    
+    // Per-evaluation state: for text comparisons, the verdict for each distinct column value
+    struct Context {
+        std::vector<std::vector<uint8_t>> stringMatches;
+    };
+    
+    std::string text;
+    std::vector<Node> nodes;
+    int root;
+    
+    bool hasSort;
+    TrackCatalog::Column sortColumn;
+    bool sortDescending;
+    size_t limit;
+    
+    void prepare(const TrackCatalog& catalog, Context& context) const;
+    void evaluateNode(int node, const TrackCatalog& catalog, const Context& context,
+                      std::vector<uint8_t>& out) const;
+    bool matchRow(int node, const TrackCatalog& catalog, const Context& context, size_t row) const;
+    
+    static bool compareText(Compare compare, const std::string& value, const std::string& operand);
+    static bool compareNumber(Compare compare, float value, float operand);
+    
+    friend class SmartQueryParser;
+};
+
+#endif // SMARTQUERY_H
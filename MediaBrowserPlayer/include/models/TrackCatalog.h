@@ -0,0 +1,89 @@
+#ifndef TRACKCATALOG_H
+#define TRACKCATALOG_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "MediaFile.h"
+
+// Column-oriented copy of the library's queryable tags, one row per library entry
+// (row i == library index i). Text columns hold ids into a per-column dictionary
+// of lowercased strings, numeric columns hold floats (NaN = tag missing), so rules
+// can be checked with tight loops instead of per-track map lookups.
+class TrackCatalog {
+public:
+    enum class Column {
+        // Text
+        TITLE,
+        ARTIST,
+        ALBUM,
+        GENRE,
+        TYPE,       // "audio" / "video"
+        // Numeric
+        YEAR,
+        DURATION,
+        BITRATE,
+        TRACK_NUMBER
+    };
+    
+    static constexpr size_t TEXT_COLUMNS = 5;
+    static constexpr size_t NUMBER_COLUMNS = 4;
+    static constexpr uint32_t NO_STRING = UINT32_MAX;
+    
+    TrackCatalog();
+    
+    // Column by rule name ("genre", "year", "track", ...), case-insensitive
+    static bool parseColumn(std::string_view name, Column& column);
+    static const char* getColumnName(Column column);
+    static bool isText(Column column);
+    
+    // Number of rows
+    size_t getRowCount() const;
+    
+    // Set row from a media file; row == getRowCount() appends
+    void setRow(size_t row, const MediaFile& file);
+    
+    // Drop the last row; to remove another row, set it from the last one first
+    void removeLastRow();
+    
+    // Drop all rows (starts a new epoch: every rule has to be evaluated from scratch)
+    void clear();
+    
+    // Dictionary ids of a text column / values of a numeric column, indexed by row
+    const std::vector<uint32_t>& getTextColumn(Column column) const;
+    const std::vector<float>& getNumberColumn(Column column) const;
+    
+    // Distinct values of a text column
+    size_t getStringCount(Column column) const;
+    const std::string& getString(Column column, uint32_t id) const;
+    
+    // Change tracking: the version grows with every change, the epoch with every clear().
+    // Rows changed in place or removed after a version are listed by getChangedRows(); appended
+    // rows show up as a larger row count. Returns false if the log no longer reaches back that far
+    uint64_t getVersion() const;
+    uint64_t getEpoch() const;
+    bool getChangedRows(uint64_t sinceVersion, std::vector<size_t>& rows) const;
+    
+private:
+    std::vector<uint32_t> text[TEXT_COLUMNS];
+    std::vector<float> numbers[NUMBER_COLUMNS];
+    size_t rowCount;
+    
+    std::vector<std::string> strings[TEXT_COLUMNS];
+    std::unordered_map<std::string, uint32_t> stringIds[TEXT_COLUMNS];
+    
+    uint64_t version;
+    uint64_t epoch;
+    
+    // (version after the change, row) for rows changed in place or removed, oldest first
+    std::vector<std::pair<uint64_t, size_t>> changeLog;
+    uint64_t changeLogStart;
+    
+    void logChange(size_t row);
+    uint32_t intern(Column column, const std::string& value);
+    static float parseNumber(const std::string& value);
+};
+
+#endif // TRACKCATALOG_H
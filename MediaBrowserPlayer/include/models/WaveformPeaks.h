@@ -0,0 +1,49 @@
+#ifndef WAVEFORMPEAKS_H
+#define WAVEFORMPEAKS_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Min/max overview of a track's waveform at WAVEFORM_LEVELS zoom levels. Level 0
+// summarizes every WAVEFORM_BASE_BIN samples in one bin, each further level
+// WAVEFORM_LEVEL_FACTOR times as many; peaks are stored as signed 8-bit values
+// (127 = full scale), so a five-minute track needs about 35 KB.
+//
+// Sidecar file (little-endian): "MBPW", version byte, level count byte, two zero
+// bytes, u32 sample rate, u64 sample count, then per level u32 samples per bin,
+// u32 bin count, the bin minimums and the bin maximums.
+class WaveformPeaks {
+public:
+    struct Level {
+        uint32_t samplesPerBin = 0;
+        std::vector<int8_t> minimum;
+        std::vector<int8_t> maximum;
+    };
+
+    WaveformPeaks();
+
+    // Peaks of mono samples in [-1, 1]
+    static WaveformPeaks compute(const float* samples, size_t count, int sampleRate);
+
+    // Track length the peaks cover, in seconds
+    double getDuration() const;
+
+    const std::vector<Level>& getLevels() const;
+
+    // Peak level (0..1) of each of columns equal slices of the track, taken from
+    // the coarsest level that still has a bin per column
+    std::vector<float> getEnvelope(size_t columns) const;
+
+    // Write to / read from a sidecar file; false on I/O error or a malformed file
+    bool save(const std::string& filePath) const;
+    static bool load(const std::string& filePath, WaveformPeaks& peaks);
+
+private:
+    int sampleRate;
+    uint64_t sampleCount;
+    std::vector<Level> levels;
+};
+
+#endif // WAVEFORMPEAKS_H
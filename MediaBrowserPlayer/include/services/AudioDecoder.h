@@ -0,0 +1,26 @@
+#ifndef AUDIODECODER_H
+#define AUDIODECODER_H
+
+#include <string>
+#include <vector>
+
+// Decodes audio files, whole or just their beginning, to PCM for offline analysis
+// (fingerprints, waveforms). It goes through SDL_mixer's sample loader, so it reads
+// every format the player can play, needs the mixer to be open
+// (AudioService::initialize) and returns samples at the mixer's rate. Each call
+// decodes into its own chunk, so several threads may decode at once.
+class AudioDecoder {
+public:
+    // Decode filePath, downmixed to mono floats in [-1, 1]. Returns false if the mixer
+    // isn't open, the file can't be decoded or the output format isn't 16-bit or float
+    static bool decodeMono(const std::string& filePath, std::vector<float>& samples, int& sampleRate);
+
+    // Like decodeMono, but stops once maxSeconds of audio follow the first sample at or
+    // above startLevel (leading quieter samples stay in samples). The file is read and
+    // decoded in growing prefixes, so a long track costs little more than the part that
+    // is used. complete is set to false when the file holds more audio than samples
+    static bool decodeMonoPrefix(const std::string& filePath, double maxSeconds, float startLevel,
+                                 std::vector<float>& samples, int& sampleRate, bool& complete);
+};
+
+#endif // AUDIODECODER_H
@@ -2,9 +2,11 @@
 #define AUDIOSERVICE_H
 
 #include <string>
+#include <chrono>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
 #include "../models/MediaFile.h"
+#include "../utils/Metrics.h"
 
 class AudioService {
 public:
@@ -44,8 +46,8 @@ public:
     // Get the duration of the current audio file (in seconds)
     double getDuration() const;
     
-    // // Set playback position (in seconds)
-    // void setPosition(double position);
+    // Jump to position (in seconds, clamped to the track); false if nothing is loaded or the format can't seek
+    bool setPosition(double position);
     
 private:
     Mix_Music* music;
@@ -54,6 +56,14 @@ private:
     Uint32 pauseTime;
     bool paused;
     
+    // Output monitoring, touched only by the SDL audio thread after initialize()
+    double outputBytesPerSecond;
+    std::chrono::steady_clock::time_point lastMixTime;
+    Metrics::Counter& underrunCount;
+    
+    // Post-mix effect: counts underruns from the spacing of mixer callbacks (the stream is not modified)
+    static void monitorOutput(int channel, void* stream, int length, void* userData);
+    
     // Calculate current position based on SDL ticks
     double calculatePosition() const;
     
@@ -0,0 +1,25 @@
+#ifndef FINGERPRINTSERVICE_H
+#define FINGERPRINTSERVICE_H
+
+#include <functional>
+#include <cstddef>
+#include "../models/MediaLibrary.h"
+#include "../models/FingerprintIndex.h"
+
+// Fills a FingerprintIndex for the library's audio files: each file is decoded
+// (AudioDecoder) and fingerprinted (AudioFingerprint) on one of several worker
+// threads. Files with an up-to-date fingerprint are skipped.
+class FingerprintService {
+public:
+    // Called on the calling thread as files finish
+    using Progress = std::function<void(size_t done, size_t total)>;
+
+    FingerprintService();
+
+    // Fingerprint every audio file of library that index has no current fingerprint
+    // for, on up to jobs threads. Returns the number of files processed
+    size_t update(const MediaLibrary& library, FingerprintIndex& index, unsigned jobs,
+                  const Progress& progress = nullptr);
+};
+
+#endif // FINGERPRINTSERVICE_H
@@ -0,0 +1,106 @@
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "MetadataService.h"
+#include "../models/MediaFile.h"
+#include "../models/MediaLibrary.h"
+
+// Keeps the library in step with the scanned directories using inotify.
+// File events are collected on a background thread until the tree has been
+// quiet for LIBRARY_WATCH_DEBOUNCE_MS (or LIBRARY_WATCH_MAX_DELAY_MS passed),
+// then the affected files are tagged on that thread as well. The results are
+// picked up with takeChanges() by the thread that owns the MediaLibrary.
+class LibraryWatcher {
+public:
+    struct Change {
+        enum class Type {
+            UPDATED,            // file is new or was rewritten; file holds its fresh metadata
+            REMOVED,            // file is gone
+            REMOVED_DIRECTORY   // directory and everything below it is gone
+        };
+
+        Type type;
+        std::string path;
+        MediaFile file;
+    };
+
+    LibraryWatcher();
+    ~LibraryWatcher();
+
+    // Watch directory and everything below it. Files already in it are not reported
+    bool watch(const std::string& directory);
+
+    // Stop the watcher thread and drop all watches
+    void stop();
+
+    // Move the changes processed so far into changes; false if there were none
+    bool takeChanges(std::vector<Change>& changes);
+
+    // Take the changes and apply them to library; false if there were none
+    bool applyChanges(MediaLibrary& library);
+
+    // Number of directories being watched
+    size_t getWatchCount() const;
+
+private:
+    // What happened to a path since the last batch; the latest event wins
+    enum class Pending {
+        FILE_CHANGED,
+        FILE_REMOVED,
+        DIRECTORY_ADDED,
+        DIRECTORY_REMOVED
+    };
+
+    int inotifyFd;
+    int epollFd;
+    int wakeFd;
+    std::thread watchThread;
+    std::atomic<bool> stopThread;
+    std::atomic<size_t> watchCount;
+
+    // Roots passed to watch() that the thread still has to add, and finished changes
+    std::mutex mutex;
+    std::vector<std::string> newRoots;
+    std::vector<Change> ready;
+
+    // Watch thread state: watch descriptor -> directory, and events of the current batch
+    std::unordered_map<int, std::string> watchPaths;
+    std::map<std::string, Pending> pending;
+    std::chrono::steady_clock::time_point firstEvent;
+    std::chrono::steady_clock::time_point lastEvent;
+    bool reportedWatchLimit;
+    MetadataService metadataService;
+
+    // Thread loop: sleeps in epoll until inotify has events, watch() is called or a batch is due
+    void watchLoop();
+
+    // Drain the inotify descriptor into pending
+    void readEvents();
+    void addPending(const std::string& path, Pending what);
+
+    // Turn the pending batch into changes and publish them
+    void processPending();
+
+    // Watch one directory / a whole tree; with changes set, media files found in the tree are reported
+    bool addWatch(const std::string& directory);
+    void addTree(const std::string& directory, std::vector<Change>* changes);
+
+    // Forget the watches of a directory and everything below it
+    void removeTree(const std::string& directory);
+
+    // Tag a file for the library; false if it is not a media file or can't be read
+    bool makeUpdate(const std::string& path, std::vector<Change>& changes);
+
+    // Interrupt epoll_wait()
+    void wakeUp();
+};
+
+#endif // LIBRARYWATCHER_H
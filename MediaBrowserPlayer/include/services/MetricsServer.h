@@ -0,0 +1,42 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+
+// Serves Metrics::renderPrometheus() on a local Unix domain socket, one response
+// per connection. A client that sends an HTTP GET gets an HTTP response (for
+// curl --unix-socket or a scraping proxy); one that sends nothing within
+// METRICS_REQUEST_TIMEOUT_MS gets the plain text (socat, nc -U).
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    // Listen on path (a stale socket file there is replaced) and serve from a background thread;
+    // false if another instance already serves on path
+    bool start(const std::string& path);
+
+    // Stop serving and remove the socket file
+    void stop();
+
+    // $MBP_METRICS_SOCKET if set (empty disables the server), else METRICS_SOCKET_PATH
+    static std::string getDefaultPath();
+
+private:
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    std::string socketPath;
+    std::thread serverThread;
+    std::atomic<bool> stopThread;
+
+    // Thread loop: sleeps in epoll until a client connects or stop() is called
+    void serveLoop();
+
+    // Answer one client and close it
+    void serveClient(int clientFd);
+};
+
+#endif // METRICSSERVER_H
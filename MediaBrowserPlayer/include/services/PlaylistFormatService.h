@@ -0,0 +1,60 @@
+#ifndef PLAYLISTFORMATSERVICE_H
+#define PLAYLISTFORMATSERVICE_H
+
+#include <string>
+#include <string_view>
+#include "../models/Playlist.h"
+
+// Reads and writes playlists in formats other players use (M3U/M3U8, PLS).
+// Files are parsed line by line straight out of a memory mapping; every entry
+// is resolved through the caller's TrackResolver (the library path index), so
+// tracks the library already knows are never re-tagged.
+class PlaylistFormatService {
+public:
+    enum class Format {
+        M3U,    // .m3u / .m3u8 (extended M3U with #EXTINF)
+        PLS,    // .pls
+        UNKNOWN
+    };
+    
+    PlaylistFormatService();
+    ~PlaylistFormatService();
+    
+    // Detect the format from the file extension
+    Format detectFormat(const std::string& filePath) const;
+    
+    // Read a playlist file into playlist (named after the file). Returns false if the
+    // file can't be read or isn't a supported format
+    bool importPlaylist(const std::string& filePath, const Playlist::TrackResolver& resolver, Playlist& playlist);
+    
+    // Write playlist in the format given by the file extension
+    bool exportPlaylist(const Playlist& playlist, const std::string& filePath);
+    
+    // File contents of playlist in format (empty for UNKNOWN)
+    std::string formatPlaylist(const Playlist& playlist, Format format) const;
+    
+private:
+    // One entry as it appears in the file
+    struct Entry {
+        std::string path;
+        std::string title;
+        double duration = -1.0; // -1 = not given
+    };
+    
+    bool readM3U(std::string_view data, const std::string& baseDir,
+                 const Playlist::TrackResolver& resolver, Playlist& playlist);
+    bool readPLS(std::string_view data, const std::string& baseDir,
+                 const Playlist::TrackResolver& resolver, Playlist& playlist);
+    
+    std::string writeM3U(const Playlist& playlist) const;
+    std::string writePLS(const Playlist& playlist) const;
+    
+    // Turn an entry into a MediaFile: library copy if known, otherwise the
+    // file's own title/duration from the playlist
+    MediaFile resolveEntry(const Entry& entry, const Playlist::TrackResolver& resolver) const;
+    
+    // Make a playlist location absolute (relative paths are relative to the playlist file)
+    std::string resolvePath(std::string_view location, const std::string& baseDir) const;
+};
+
+#endif // PLAYLISTFORMATSERVICE_H
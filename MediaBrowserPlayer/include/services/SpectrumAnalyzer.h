@@ -0,0 +1,69 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "../utils/FFT.h"
+#include "../utils/SampleRing.h"
+
+// Live spectrum and level of what the mixer outputs. A post-mix effect (beside
+// AudioService's underrun monitor) downmixes each output buffer to mono and
+// pushes it into a SampleRing; the audio callback never locks or allocates. An
+// analysis thread takes the samples at playback pace every SPECTRUM_REFRESH_MS,
+// runs a Hann-windowed FFT of the last SPECTRUM_FFT_SIZE samples and folds the
+// power into SPECTRUM_BANDS log-spaced bands.
+class SpectrumAnalyzer {
+public:
+    // Heights in 0..1, where 0 is SPECTRUM_FLOOR_DB and 1 full scale
+    struct Frame {
+        std::vector<float> bands;
+        float level = 0.0f;     // RMS of the latest samples
+        float peak = 0.0f;      // Largest sample of the latest samples
+    };
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer();
+
+    // Tap the mixer output and start analysing; false if the mixer isn't open or its
+    // format isn't 16-bit or float. Does nothing if already running
+    bool start();
+
+    // Remove the tap and stop the analysis thread
+    void stop();
+
+    bool isRunning() const;
+
+    // Latest analysis (all zero before the first one)
+    Frame getFrame();
+
+private:
+    SampleRing ring;
+    FFT fft;
+    std::vector<float> window;
+    std::vector<size_t> bandEdges;      // Band b covers power bins [bandEdges[b], bandEdges[b + 1])
+
+    // Output format, fixed while the tap is registered
+    int sampleRate;
+    int channels;
+    bool isFloat;
+
+    std::thread analysisThread;
+    bool running;
+    bool stopThread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    Frame frame;
+
+    // Post-mix effect, on the SDL audio thread: downmix stream into the ring
+    static void tapOutput(int channel, void* stream, int length, void* userData);
+
+    // Analysis thread loop
+    void analysisLoop();
+
+    // Band edges for the current sample rate
+    void computeBandEdges();
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,65 @@
+#ifndef WAVEFORMSERVICE_H
+#define WAVEFORMSERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "../models/WaveformPeaks.h"
+
+// Prepares WaveformPeaks for the player's seek bar on a background thread. Each
+// file is decoded once (AudioDecoder) and its peaks are stored in a sidecar
+// cache directory under the file's content signature, so later plays, and moved
+// or renamed copies, load them instead; the least recently used sidecars are
+// deleted once the cache outgrows WAVEFORM_CACHE_MAX_BYTES. The thread runs at
+// idle CPU and I/O priority, so decoding only uses time playback doesn't need.
+// It can be preempted for long while holding the queue lock, so request() and
+// getPeaks() never wait for it. The audio mixer must stay open while the
+// service is running; stop() it before closing it.
+class WaveformService {
+public:
+    explicit WaveformService(const std::string& cacheDirectory = getDefaultCacheDir());
+    ~WaveformService();
+
+    // Prepare peaks for these files, first one first, ahead of anything queued
+    // earlier. Files that are ready, queued or failed before are skipped. Returns
+    // false without queueing anything if the worker holds the queue; call again later
+    bool request(const std::vector<std::string>& filePaths);
+
+    // Peaks of filePath if they are ready, else nullptr (also while the worker holds the lock)
+    std::shared_ptr<const WaveformPeaks> getPeaks(const std::string& filePath);
+
+    // Stop the worker thread after the file in progress; queued files are dropped
+    void stop();
+
+    // MBP_WAVEFORM_DIR if set, else the user's cache directory, else WAVEFORM_CACHE_DIR
+    static std::string getDefaultCacheDir();
+
+private:
+    std::string cacheDirectory;
+    std::thread worker;             // Started by the first request()
+    bool stopWorker;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::string> queue;
+    std::unordered_map<std::string, std::shared_ptr<const WaveformPeaks>> resident;
+    std::deque<std::string> residentOrder;   // Oldest first; trimmed to WAVEFORM_MAX_RESIDENT
+    std::unordered_set<std::string> failed;
+
+    // Worker thread: take queued files until stopped
+    void workerLoop();
+
+    // Peaks of filePath from the sidecar cache, or decoded and written to it; nullptr on failure
+    std::shared_ptr<const WaveformPeaks> prepare(const std::string& filePath);
+
+    // Delete the least recently used sidecars until the cache fits WAVEFORM_CACHE_MAX_BYTES
+    void trimCache();
+};
+
+#endif // WAVEFORMSERVICE_H
@@ -0,0 +1,26 @@
+#ifndef AUDIOFINGERPRINT_H
+#define AUDIOFINGERPRINT_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Compact acoustic fingerprints that survive re-encoding at another bitrate.
+// The signal is decimated to about FINGERPRINT_SAMPLE_RATE, cut into overlapping
+// Hann-windowed blocks and split into 33 log-spaced bands between 300 and 2000 Hz.
+// Each block after the first yields one 32-bit word: bit b is set when the energy
+// difference between bands b and b+1 grew since the previous block. Lossy coding
+// changes band energies only slightly, so copies of a recording differ in few bits
+// while unrelated audio differs in about half of them.
+namespace AudioFingerprint {
+    // Fingerprint of mono samples at sampleRate, starting at the first sample above
+    // FINGERPRINT_SILENCE and covering FINGERPRINT_SECONDS. Empty if the audio is
+    // shorter than one block
+    std::vector<uint32_t> compute(const float* samples, size_t count, int sampleRate);
+
+    // Fraction of differing bits over the overlap, at the best shift within
+    // FINGERPRINT_MAX_SHIFT words; 1.0 if the fingerprints are too short to compare
+    double compare(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+}
+
+#endif // AUDIOFINGERPRINT_H
@@ -0,0 +1,44 @@
+#ifndef BYTERINGBUFFER_H
+#define BYTERINGBUFFER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Fixed-capacity FIFO of bytes, used to reassemble serial frames
+class ByteRingBuffer {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    ByteRingBuffer(size_t capacity);
+
+    // Append up to size bytes, returns how many were stored
+    size_t write(const char* data, size_t size);
+
+    // Number of bytes stored / free space left
+    size_t size() const;
+    size_t available() const;
+    bool isEmpty() const;
+
+    // Byte at an offset from the oldest stored byte
+    char peek(size_t offset) const;
+
+    // Offset of the first occurrence of a byte at or after start, or npos
+    size_t find(char value, size_t start = 0) const;
+
+    // Remove count bytes from the front, copying them into out
+    void read(size_t count, std::string& out);
+
+    // Remove count bytes from the front
+    void discard(size_t count);
+
+    // Drop everything
+    void clear();
+
+private:
+    std::vector<char> buffer;
+    size_t head;    // Index of the oldest byte
+    size_t count;   // Number of stored bytes
+};
+
+#endif // BYTERINGBUFFER_H
@@ -0,0 +1,21 @@
+#ifndef CONTENTSIGNATURE_H
+#define CONTENTSIGNATURE_H
+
+#include <string>
+#include <cstdint>
+
+// Cheap identity of a media file's contents that survives moves, renames and tag
+// edits. The payload is the audio without the tags around it: the data/SSND chunk
+// of WAV and AIFF files, the mdat box of MP4, the Ogg pages after the header packets
+// (sequence numbers and CRCs masked), otherwise the file minus leading ID3v2 tags and
+// FLAC metadata blocks and trailing ID3v1/APEv2 tags. The signature is XXH64 of the
+// payload length and its first and last CONTENT_SIGNATURE_BLOCK bytes, so at most two
+// blocks are read however large the file is. Formats not listed here (Matroska/WebM,
+// ASF) still have their tags hashed with the audio, and of a fragmented MP4 only the
+// first mdat counts.
+namespace ContentSignature {
+    // Signature of filePath, or 0 if it can't be read (a real signature is never 0)
+    uint64_t compute(const std::string& filePath);
+}
+
+#endif // CONTENTSIGNATURE_H
@@ -0,0 +1,38 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Power spectrum of real input blocks. A block of N real samples is packed into
+// N/2 complex values and transformed with an iterative radix-2 FFT; twiddles are
+// precomputed per stage and stored contiguously, and real/imaginary parts live in
+// separate arrays, so the butterfly loops vectorize. One instance per thread:
+// transform() uses internal scratch buffers.
+class FFT {
+public:
+    // size must be a power of two, at least 4
+    explicit FFT(size_t size);
+
+    size_t getSize() const;
+
+    // power[k] = |X[k]|^2 for k = 0..size/2, where X is the DFT of input[0..size-1]
+    void powerSpectrum(const float* input, float* power);
+
+    // Periodic Hann window of the given length
+    static std::vector<float> makeHannWindow(size_t size);
+
+private:
+    size_t size;
+    size_t half;                        // Length of the complex transform
+    std::vector<uint32_t> bitReverse;   // Input permutation of the complex transform
+    std::vector<float> stageCos;        // Twiddles, stage by stage: len/2 entries for each len = 2..half
+    std::vector<float> stageSin;
+    std::vector<float> splitCos;        // e^(-2*pi*i*k/size), k = 0..half-1, to unpack the real spectrum
+    std::vector<float> splitSin;
+    std::vector<float> re;
+    std::vector<float> im;
+};
+
+#endif // FFT_H
@@ -0,0 +1,20 @@
+#ifndef FILESTAMP_H
+#define FILESTAMP_H
+
+#include <string>
+
+// Size and modification time of a file, used to tell whether results derived from
+// its contents (index tags, fingerprints) are still valid. The time is Unix
+// nanoseconds, so stamps taken on another machine compare correctly
+struct FileStamp {
+    long long size = 0;
+    long long modified = 0;
+
+    // Stamp of filePath; false if it can't be stat'ed
+    static bool read(const std::string& filePath, FileStamp& stamp);
+
+    bool operator==(const FileStamp& other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+#endif // FILESTAMP_H
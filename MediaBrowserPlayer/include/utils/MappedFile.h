@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map a file, replacing any previous mapping. Returns false if it can't be opened
+    bool open(const std::string& filePath);
+
+    // Unmap
+    void close();
+
+    // File contents (empty for an empty file); valid until close()
+    std::string_view data() const;
+
+    bool isOpen() const;
+
+private:
+    void* address;
+    size_t length;
+    bool opened;
+};
+
+#endif // MAPPEDFILE_H
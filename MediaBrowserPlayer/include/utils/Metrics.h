@@ -0,0 +1,105 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "../Constants.h"
+
+// Runtime counters, gauges and latency histograms, rendered in the Prometheus text
+// format (see services/MetricsServer.h). Updates are relaxed atomic adds on a
+// per-thread shard, so threads don't fight over a cache line; reads sum the shards.
+//
+// Look a metric up once and keep the reference; registering is the only locked path:
+//   static Metrics::Counter& scanned = Metrics::counter("mbp_library_scanned_files_total", "Files examined by scans");
+//   scanned.add();
+namespace Metrics {
+    // Shard of the calling thread, assigned round-robin on first use
+    inline size_t shardIndex() {
+        static std::atomic<size_t> nextShard{0};
+        thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % Constants::METRICS_SHARDS;
+        return shard;
+    }
+
+    // Monotonic count (events, bytes...); rates are left to the scraper
+    class Counter {
+    public:
+        void add(uint64_t amount = 1) {
+            shards[shardIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        // Sum over all shards
+        uint64_t getValue() const;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+        Shard shards[Constants::METRICS_SHARDS];
+    };
+
+    // Current level of something; last write wins, so not sharded
+    class Gauge {
+    public:
+        void set(int64_t newValue) { value.store(newValue, std::memory_order_relaxed); }
+        void add(int64_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+
+        // Current value
+        int64_t getValue() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value{0};
+    };
+
+    // Latency distribution over fixed buckets from 50 us to 10 s
+    class Histogram {
+    public:
+        static constexpr size_t BUCKET_COUNT = 16;
+        static constexpr uint64_t BUCKET_BOUNDS_NS[BUCKET_COUNT] = {
+            50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+            25000000, 50000000, 100000000, 250000000, 500000000, 1000000000, 2500000000, 10000000000
+        };
+
+        void observe(std::chrono::nanoseconds duration);
+
+        // Summed over shards: per-bucket (non-cumulative) counts, the last one past every bound
+        struct Snapshot {
+            uint64_t counts[BUCKET_COUNT + 1] = {};
+            uint64_t sumNs = 0;
+        };
+        Snapshot getSnapshot() const;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> counts[BUCKET_COUNT + 1] = {};
+            std::atomic<uint64_t> sumNs{0};
+        };
+        Shard shards[Constants::METRICS_SHARDS];
+    };
+
+    // Observes the time until it goes out of scope
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { histogram.observe(std::chrono::steady_clock::now() - start); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Find or create a metric. labels is the inside of {...}, e.g. "view=\"player\"".
+    // Throws std::invalid_argument if name is already registered with another type
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Every registered metric in the Prometheus text exposition format (version 0.0.4)
+    std::string renderPrometheus();
+}
+
+#endif // METRICS_H
@@ -0,0 +1,48 @@
+#ifndef RECORDREADER_H
+#define RECORDREADER_H
+
+#include <string>
+#include <string_view>
+
+// One-pass reader for '|'-separated, newline-terminated records.
+//
+// Fields are returned as views into the input; only a field containing an
+// escape ("\|", "\\", "\n", "\r") is unescaped, into a scratch buffer that is
+// reused for the whole input. A backslash before any other character is kept
+// literally, so records written before escaping existed read back unchanged.
+class RecordReader {
+public:
+    static constexpr char FIELD_SEPARATOR = '|';
+    static constexpr char ESCAPE = '\\';
+
+    explicit RecordReader(std::string_view data);
+
+    // Advance to the next record (line). Returns false at end of input
+    bool nextRecord();
+
+    // Current record, raw (escapes not processed)
+    std::string_view getRecord() const;
+
+    // Next field of the current record. The view is valid until the next call
+    bool nextField(std::string_view& field);
+
+    // Next field converted to a number; false if missing or malformed
+    bool nextNumber(long long& value);
+    bool nextNumber(double& value);
+
+    // Next field parsed as hexadecimal
+    bool nextHex(unsigned long long& value);
+
+    // True when the current record has no more fields
+    bool atRecordEnd() const;
+
+private:
+    std::string_view data;
+    size_t position;        // Start of the next record in data
+    std::string_view record;
+    size_t fieldPosition;   // Start of the next field in record
+    bool fieldsLeft;
+    std::string scratch;
+};
+
+#endif // RECORDREADER_H
@@ -0,0 +1,32 @@
+#ifndef RECORDWRITER_H
+#define RECORDWRITER_H
+
+#include <string>
+#include <string_view>
+
+// Appends '|'-separated, newline-terminated records to a string, escaping
+// field contents so RecordReader gets every field back exactly
+class RecordWriter {
+public:
+    explicit RecordWriter(std::string& out);
+
+    // Append one field to the current record
+    void field(std::string_view value);
+    void field(long long value);
+    void field(double value);
+
+    // Append a number as zero-padded 16-digit hexadecimal
+    void hexField(unsigned long long value);
+
+    // Terminate the current record with a newline
+    void endRecord();
+
+private:
+    std::string& out;
+    bool firstField;
+
+    // Write the separator unless this is the first field of the record
+    void separate();
+};
+
+#endif // RECORDWRITER_H
@@ -3,32 +3,85 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <atomic>
 #include <thread>
+#include <termios.h>
+#include "ByteRingBuffer.h"
+#include "S32K144Protocol.h"
+#include "../Constants.h"
 
 class S32K144Communication {
 public:
     S32K144Communication();
     ~S32K144Communication();
-    
+
     // Open serial connection to S32K144 board
-    bool connect();
+    bool connect(const std::string& port = Constants::S32K144_PORT,
+                 int baudrate = Constants::S32K144_BAUDRATE);
 
     // Initialize UART
-    bool initializeUART();
+    bool initializeUART(int baudrate);
 
     // Check if S32K144 is connected
     bool isConnected() const;
-    
+
     // Close serial connection
     void disconnect();
 
-    // Read incoming data from S32K144
-    std::string readData();
-    
+    // Block until the board sends data, wakeUp() is called or timeoutMs (-1 = forever) passes.
+    // Returns true if at least one decoded event is ready for readEvent()
+    bool waitForData(int timeoutMs);
+
+    // Pop the next decoded event (binary frame or legacy text message)
+    bool readEvent(S32K144Protocol::BoardEvent& event);
+
+    // Frames/messages dropped as corrupted so far
+    size_t getErrorCount() const;
+
+    // Interrupt waitForData() from another thread
+    void wakeUp();
+
+    // Start sending a frame without blocking. Must be called from the thread running waitForData().
+    // Returns false (frame dropped) while a previous frame is still going out or the UART is backed up,
+    // so the caller can retry later with fresher data instead of queueing stale frames
+    bool sendFrame(const std::vector<uint8_t>& frame);
+
 private:
     int serialPort;
-    bool connected;
-    std::string buffer;
+    std::atomic<bool> connected;
+
+    // epoll instance watching the serial port and the wake-up eventfd
+    int epollFd;
+    int wakeFd;
+
+    // Raw bytes received but not yet framed
+    ByteRingBuffer rxBuffer;
+
+    // Frame being transmitted and how much of it has been written; a started
+    // frame is always finished so the board never sees a torn frame
+    std::vector<uint8_t> txFrame;
+    size_t txOffset;
+
+    // Frame decoder and the events it produced, waiting to be dispatched
+    S32K144Protocol protocol;
+    std::deque<S32K144Protocol::BoardEvent> events;
+
+    // Drain the serial port into rxBuffer and decode complete frames.
+    // False if the port is gone (end of file or a read error such as EIO)
+    bool readAvailable();
+
+    // The board was unplugged: stop watching the port; disconnect() still closes it
+    void connectionLost();
+
+    // Write as much of txFrame as the port accepts; watch EPOLLOUT while some is left
+    void flushOutput();
+
+    // Enable/disable EPOLLOUT on the serial port
+    void watchWritable(bool enable);
+
+    // Map a baud rate to its termios constant (0 if unsupported)
+    static speed_t toSpeed(int baudrate);
 };
 
 #endif // S32K144COMMUNICATION_H
@@ -0,0 +1,87 @@
+#ifndef S32K144PROTOCOL_H
+#define S32K144PROTOCOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+#include "ByteRingBuffer.h"
+
+// Wire format shared by the host and the S32K144 firmware.
+//
+// Binary frame (version 1):
+//   SYNC(0xA5) VERSION TYPE LENGTH PAYLOAD[LENGTH] CRC16_HI CRC16_LO
+// The CRC is CRC-16/CCITT-FALSE over VERSION..PAYLOAD.
+//
+// Legacy text mode ("P.", "N.", "T.", "S.", "<volume>.") is still accepted,
+// so old firmware keeps working. The two can be mixed on the same stream
+// because SYNC is never a printable character.
+class S32K144Protocol {
+public:
+    static constexpr uint8_t SYNC = 0xA5;
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 4;
+    static constexpr size_t CRC_SIZE = 2;
+    static constexpr size_t MAX_PAYLOAD = 64;
+    static constexpr char TEXT_END = '.';
+    static constexpr size_t MAX_TITLE = 48;
+
+    // Frame types
+    enum class FrameType : uint8_t {
+        BUTTON = 0x01,      // board -> host, payload: 'P' | 'N' | 'T' | 'S'
+        VOLUME = 0x02,      // board -> host, payload: absolute volume 0-100
+        ENCODER = 0x03,     // board -> host, payload: signed volume delta
+        NOW_PLAYING = 0x10  // host -> board, payload: see NowPlaying
+    };
+
+    // A decoded input event from the board
+    struct BoardEvent {
+        FrameType type;
+        int value;
+    };
+
+    // Player state pushed to the board.
+    // Payload: STATE VOLUME POSITION_HI POSITION_LO DURATION_HI DURATION_LO TITLE[<= MAX_TITLE]
+    struct NowPlaying {
+        uint8_t state;      // 0 = playing, 1 = paused, 2 = stopped
+        uint8_t volume;     // 0-100
+        uint16_t position;  // seconds
+        uint16_t duration;  // seconds
+        std::string title;  // UTF-8, cut to at most MAX_TITLE bytes on a character boundary
+
+        bool operator==(const NowPlaying& other) const;
+        bool operator!=(const NowPlaying& other) const;
+    };
+
+    S32K144Protocol();
+
+    // Decode every complete frame/message in the buffer, consuming it
+    void decode(ByteRingBuffer& buffer, std::deque<BoardEvent>& events);
+
+    // Build a binary frame around a payload
+    static std::vector<uint8_t> encodeFrame(FrameType type, const uint8_t* payload, size_t length);
+
+    // Build a NOW_PLAYING frame
+    static std::vector<uint8_t> encodeNowPlaying(const NowPlaying& state);
+
+    // CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+    // Frames dropped because of a bad CRC, version or length
+    size_t getErrorCount() const;
+
+private:
+    size_t errorCount;
+
+    // Try to decode a binary frame at the front; false if more bytes are needed
+    bool decodeBinary(ByteRingBuffer& buffer, std::deque<BoardEvent>& events);
+
+    // Try to decode a legacy text message at the front; false if more bytes are needed
+    bool decodeText(ByteRingBuffer& buffer, std::deque<BoardEvent>& events);
+
+    // Turn a legacy text message into an event
+    bool parseText(const std::vector<uint8_t>& text, BoardEvent& event) const;
+};
+
+#endif // S32K144PROTOCOL_H
@@ -0,0 +1,38 @@
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single-producer / single-consumer FIFO of float samples. write() never
+// blocks or allocates, so the audio callback can feed it; when the reader falls
+// behind, the newest samples are dropped rather than overwriting unread ones.
+// Exactly one thread may write and one (other) thread may read at a time.
+class SampleRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SampleRing(size_t capacity);
+
+    // Producer: append up to count samples, returns how many were stored
+    size_t write(const float* samples, size_t count);
+
+    // Consumer: remove up to count of the oldest samples into samples, returns how many
+    size_t read(float* samples, size_t count);
+
+    // Samples waiting to be read (exact for the consumer, a lower bound for the producer)
+    size_t size() const;
+
+    size_t getCapacity() const;
+
+private:
+    std::vector<float> buffer;
+    size_t mask;
+
+    // Free-running positions (index = position & mask); each is stored by one side only.
+    // Separate cache lines, so the two threads don't keep stealing each other's line
+    alignas(64) std::atomic<size_t> writePosition;
+    alignas(64) std::atomic<size_t> readPosition;
+};
+
+#endif // SAMPLERING_H
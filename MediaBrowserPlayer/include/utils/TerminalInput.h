@@ -0,0 +1,50 @@
+#ifndef TERMINALINPUT_H
+#define TERMINALINPUT_H
+
+#include <termios.h>
+
+class TerminalInput {
+public:
+    // What woke up a call to waitForEvent()
+    enum class Event {
+        KEY,        // A key was read from stdin
+        WAKE,       // Another thread called wakeUp()
+        TIMEOUT,    // Nothing happened before the timeout
+        CLOSED      // stdin reached end of file
+    };
+
+    TerminalInput();
+    ~TerminalInput();
+
+    // Switch stdin to raw mode (no line buffering, no echo)
+    bool enableRawMode();
+
+    // Restore the terminal settings saved by enableRawMode()
+    void disableRawMode();
+
+    // Check if raw mode is active
+    bool isRawMode() const;
+
+    // Wait up to timeoutMs (-1 = forever) for a keypress or a wake-up
+    Event waitForEvent(int timeoutMs, char& key);
+
+    // Interrupt waitForEvent() from another thread
+    void wakeUp();
+
+    // Put back the settings of whichever TerminalInput is in raw mode.
+    // Async-signal-safe, so SIGINT/SIGTERM handlers call it before exiting;
+    // it also runs from atexit() once raw mode has been entered
+    static void restoreTerminal();
+
+private:
+    termios originalSettings;
+    bool rawMode;
+
+    // Self-pipe used to wake up the poll loop
+    int wakePipe[2];
+
+    // Discard pending wake-up bytes
+    void drainWakePipe();
+};
+
+#endif // TERMINALINPUT_H
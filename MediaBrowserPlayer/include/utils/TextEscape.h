@@ -0,0 +1,20 @@
+#ifndef TEXTESCAPE_H
+#define TEXTESCAPE_H
+
+#include <string>
+#include <string_view>
+
+// Escaping for the text the player prints: tab-separated lines (CLI listings,
+// daemon replies) and JSON strings (CLI --json, trace dumps, benchmark reports).
+namespace TextEscape {
+    // Field of a tab-separated line: backslash, tab and newline become \\, \t and \n; CR is dropped
+    std::string field(std::string_view text);
+
+    // Contents of a JSON string (without the quotes); other control characters become \u00XX
+    std::string json(std::string_view text);
+
+    // Append json(text) to out
+    void appendJson(std::string& out, std::string_view text);
+}
+
+#endif // TEXTESCAPE_H
@@ -0,0 +1,74 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Scoped trace zones for finding out why a scan, track change or redraw was slow.
+// TRACE_ZONE("name") records when the enclosing scope started and ended into a
+// ring buffer owned by the calling thread: no locks and no allocation after the
+// thread's first zone. A thread's ring is handed to the next new thread once it
+// exits. Trace::dump() writes what is still in the rings as Chrome trace-event
+// JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Zones are compiled in when MBP_TRACE is defined (the default; build with
+// TRACE=0 to remove them entirely).
+namespace Trace {
+#ifdef MBP_TRACE
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    // Timestamp in clock ticks (TSC on x86, steady_clock nanoseconds elsewhere)
+    inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    // Append a finished zone to the calling thread's ring (name must be a string literal)
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    // Name the calling thread in dumps
+    void setThreadName(const char* name);
+
+    // Write all recorded zones as Chrome trace-event JSON
+    bool dump(const std::string& path);
+
+    // Where dumps go: $MBP_TRACE_FILE, or a per-process file in TRACE_DUMP_DIR
+    std::string getDefaultPath();
+
+    // Dump to getDefaultPath() whenever the process receives SIGUSR1
+    void installSignalHandler();
+
+    class Zone {
+    public:
+        explicit Zone(const char* name) : name(name), start(now()) {}
+        ~Zone() { record(name, start, now()); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+}
+
+#ifdef MBP_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) Trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define TRACE_ZONE(name) do {} while (0)
+#endif
+
+#endif // TRACE_H
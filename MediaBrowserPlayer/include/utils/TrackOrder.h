@@ -0,0 +1,74 @@
+#ifndef TRACKORDER_H
+#define TRACKORDER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Sequence of track handles (slot numbers in a playlist's track storage) kept in an
+// implicit treap: insert, erase, lookup and moving a whole block by position all
+// take O(log n), so reordering a long playlist never shifts the tracks themselves.
+// There is one node per handle; a handle may be in the sequence at most once.
+class TrackOrder {
+public:
+    TrackOrder();
+
+    // Number of handles in the sequence
+    size_t size() const;
+    bool isEmpty() const;
+
+    // Replace the sequence with handles 0..count-1 in order (O(n))
+    void assignIdentity(size_t count);
+
+    // Append a handle
+    void pushBack(uint32_t handle);
+
+    // Insert a handle so that it ends up at position
+    void insert(size_t position, uint32_t handle);
+
+    // Remove the handle at position and return it
+    uint32_t erase(size_t position);
+
+    // Handle at position
+    uint32_t at(size_t position) const;
+
+    // Move count handles starting at first so that the block starts at position toIndex
+    // of the resulting sequence
+    void moveRange(size_t first, size_t count, size_t toIndex);
+
+    // All handles in sequence order
+    void toVector(std::vector<uint32_t>& out) const;
+
+    // Drop everything
+    void clear();
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        uint32_t left = NIL;
+        uint32_t right = NIL;
+        uint32_t size = 1;
+        uint32_t priority = 0;
+    };
+
+    // Indexed by handle
+    std::vector<Node> nodes;
+    uint32_t root;
+    uint32_t seed;
+
+    uint32_t nextPriority();
+    uint32_t sizeOf(uint32_t node) const;
+    void update(uint32_t node);
+
+    // Fresh node for handle (grows the node table if needed)
+    uint32_t makeNode(uint32_t handle);
+
+    // Split node's sequence into the first count handles and the rest
+    void split(uint32_t node, size_t count, uint32_t& left, uint32_t& right);
+
+    // Concatenate two sequences
+    uint32_t merge(uint32_t left, uint32_t right);
+};
+
+#endif // TRACKORDER_H
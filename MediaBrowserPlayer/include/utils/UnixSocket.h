@@ -0,0 +1,14 @@
+#ifndef UNIXSOCKET_H
+#define UNIXSOCKET_H
+
+#include <string>
+
+// Local stream sockets for the control and metrics endpoints
+namespace UnixSocket {
+    // Non-blocking listening socket bound to path; a stale socket file left by a
+    // crashed run is replaced, anything else at path is not. -1 on error (errno set:
+    // EADDRINUSE if another process is listening on path, EEXIST if it isn't a socket)
+    int listen(const std::string& path, int backlog);
+}
+
+#endif // UNIXSOCKET_H
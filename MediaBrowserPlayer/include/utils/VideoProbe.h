@@ -0,0 +1,30 @@
+#ifndef VIDEOPROBE_H
+#define VIDEOPROBE_H
+
+#include <string>
+
+// Stream properties of a video file as recorded in its container headers
+struct VideoInfo {
+    std::string container;      // "MP4", "QuickTime", "Matroska", "WebM" or "AVI"
+    std::string videoCodec;     // e.g. "H.264"; empty if there is no video track
+    std::string audioCodec;     // e.g. "AAC"; empty if there is no audio track
+    double duration = 0.0;      // seconds
+    int width = 0;
+    int height = 0;
+    double frameRate = 0.0;     // frames per second, 0 if unknown
+    long long bitrate = 0;      // whole file, bits per second
+};
+
+// Native header parsers for ISO-BMFF (MP4/MOV: moov/mvhd/trak/mdhd/hdlr/stsd/stsz),
+// Matroska/WebM (EBML: SeekHead, Segment Info, Tracks) and RIFF AVI (avih, strh/strf).
+// The container is recognised by its magic bytes. Only headers are read, jumping
+// over media data with seeks: a faststart MP4 costs a few KB of reads, one with
+// its index at the end a few more seeks; Matroska uses the SeekHead to reach
+// Info and Tracks when they follow the clusters.
+namespace VideoProbe {
+    // Fill info from filePath's headers; false if the file can't be read or isn't
+    // one of the containers above (info may then be partly filled)
+    bool probe(const std::string& filePath, VideoInfo& info);
+}
+
+#endif // VIDEOPROBE_H
@@ -0,0 +1,30 @@
+#ifndef XXHASH64_H
+#define XXHASH64_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming XXH64 (same digests as the reference xxHash library). Used where a
+// fast non-cryptographic hash of file contents is needed
+class XXHash64 {
+public:
+    explicit XXHash64(uint64_t seed = 0);
+
+    // Append length bytes
+    void update(const void* data, size_t length);
+
+    // Hash of everything appended so far (the state is left unchanged)
+    uint64_t digest() const;
+
+    // One-shot hash of a buffer
+    static uint64_t hash(const void* data, size_t length, uint64_t seed = 0);
+
+private:
+    uint64_t lanes[4];
+    uint64_t seed;
+    uint64_t totalLength;
+    unsigned char buffer[32];   // Input not yet consumed in 32-byte stripes
+    size_t buffered;
+};
+
+#endif // XXHASH64_H
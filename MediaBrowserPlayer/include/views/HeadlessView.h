@@ -0,0 +1,28 @@
+#ifndef HEADLESSVIEW_H
+#define HEADLESSVIEW_H
+
+#include "PlayerView.h"
+
+// View for daemon mode: draws nothing and never reads the terminal.
+// Errors still go to stderr so they end up in the service log
+class HeadlessView : public PlayerView {
+public:
+    HeadlessView();
+
+    // IView implementation
+    void displayMessage(const std::string& message) override;
+    void displayError(const std::string& message) override;
+    std::string getInput(const std::string& prompt) override;
+    int getMenuChoice(int min, int max) override;
+    void clearScreen() override;
+    void waitForInput() override;
+    void displayHeader() override;
+    void displayCurrentDirectory(const std::string& directory) override;
+    void displayMainMenu() override;
+
+    // Player output the music thread produces
+    void displayPlayer(const AudioState& audioState) override;
+    void flashMessage(const std::string& message) override;
+};
+
+#endif // HEADLESSVIEW_H
@@ -0,0 +1,69 @@
+#ifndef LISTWINDOW_H
+#define LISTWINDOW_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "../Constants.h"
+
+// A paged window over a list of any size. Only the rows on the visible page
+// are ever formatted, and formatted rows are cached, so rendering a page
+// costs O(page size) no matter how long the underlying list is.
+class ListWindow {
+public:
+    // Format the row at the given index (called only for visible rows)
+    using RowFormatter = std::function<std::string(size_t index)>;
+
+    // Return the text used for jump-to-letter at the given index
+    using KeyExtractor = std::function<std::string(size_t index)>;
+
+    ListWindow(size_t pageSize = Constants::ITEMS_PER_PAGE);
+
+    // Point the window at a new list (resets page and caches)
+    void setSource(size_t itemCount, RowFormatter formatter, KeyExtractor keyOf = nullptr);
+
+    // Drop cached rows after the underlying list has changed
+    void invalidate();
+
+    // Get item/page counts
+    size_t getItemCount() const;
+    int getPageCount() const;
+
+    // Get/set current page (clamped to the valid range)
+    int getCurrentPage() const;
+    void setPage(int page);
+    bool nextPage();
+    bool previousPage();
+
+    // Index range of the visible rows: [first, end)
+    size_t getFirstVisible() const;
+    size_t getEndVisible() const;
+
+    // Move to the page holding the next item whose key starts with the letter
+    bool jumpToLetter(char letter);
+
+    // Render the visible rows, one per line, into a single string
+    std::string renderPage();
+
+private:
+    size_t pageSize;
+    size_t itemCount;
+    int currentPage;
+    RowFormatter formatter;
+    KeyExtractor keyOf;
+
+    // Formatted rows by index (bounded to a few pages)
+    std::unordered_map<size_t, std::string> rowCache;
+
+    // Item indices bucketed by first letter, built on the first jump
+    std::vector<std::vector<size_t>> letterIndex;
+
+    // Build letterIndex in one pass
+    void buildLetterIndex();
+
+    // Map a character to its letterIndex bucket (26 = everything else)
+    static size_t letterBucket(char c);
+};
+
+#endif // LISTWINDOW_H
@@ -3,6 +3,7 @@
 
 #include "IView.h"
 #include "../models/MediaFile.h"
+#include "ListWindow.h"
 #include <vector>
 
 class MediaListView : public IView {
@@ -20,8 +21,8 @@ public:
     void displayCurrentDirectory(const std::string& directory) override;
     void displayMainMenu() override;
     
-    // Display a list of media files with pagination
-    void displayMediaFiles(const std::vector<MediaFile>& files, int page);
+    // Display the visible page of a windowed media file list
+    void displayMediaFiles(ListWindow& window);
     
     // Display detailed metadata for a media file
     void displayMediaFileDetails(const MediaFile& file);
@@ -35,12 +36,14 @@ public:
     // Display media options menu
     void displayMediaOptionsMenu();
     
-private:
-    // Format a media file entry for display
-    std::string formatMediaFileEntry(const MediaFile& file, int index);
+    // Overwrite the current line with "label: done/total" (ends the line when done == total)
+    void displayProgress(const std::string& label, size_t done, size_t total);
     
-    // Helper method for pagination controls
-    void displayPaginationControls(int currentPage, int totalPages);
+    // Display groups of duplicate files; the first file of each group is the one kept
+    void displayDuplicateGroups(const std::vector<std::vector<MediaFile>>& groups);
+
+    // Format a media file entry for display
+    static std::string formatMediaFileEntry(const MediaFile& file, int index);
 };
 
 #endif // MEDIALISTVIEW_H
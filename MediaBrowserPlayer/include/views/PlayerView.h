@@ -1,10 +1,13 @@
 #ifndef PLAYERVIEW_H
 #define PLAYERVIEW_H
 
+#include <memory>
+#include <vector>
 #include "IView.h"
 #include "../models/AudioState.h"
 #include "../models/MediaFile.h"
 #include "../models/Playlist.h"
+#include "../models/WaveformPeaks.h"
 
 class PlayerView : public IView {
 public:
@@ -24,14 +27,22 @@ public:
 
     
     // Display player interface with current track info and controls
-    void displayPlayer(const AudioState& audioState);
+    virtual void displayPlayer(const AudioState& audioState);
     
     // Display player controls
     void displayPlayerControls();
     
-    // Display progress bar
+    // Display progress bar (the waveform of the track if one is set)
     void displayProgressBar(double current, double total);
     
+    // Peaks of the current track for the progress bar; nullptr for a plain bar
+    void setWaveform(std::shared_ptr<const WaveformPeaks> peaks);
+    
+    // Display spectrum bars (heights 0..1, one bar per band) and a level meter below
+    // the player. With inPlace the previous spectrum is overwritten instead, for
+    // refreshing it between full redraws
+    void displaySpectrum(const std::vector<float>& bands, float level, float peak, bool inPlace);
+    
     // Display volume level
     void displayVolume(int volume);
     
@@ -42,15 +53,21 @@ public:
     void displayQueue(const Playlist& playlist, int currentIndex);
     
     // Flash message (e.g., "Paused", "Next Track")
-    void flashMessage(const std::string& message);
+    virtual void flashMessage(const std::string& message);
     
 private:
+    std::shared_ptr<const WaveformPeaks> waveform;
+    
     // Format time (seconds to MM:SS)
     std::string formatTime(double seconds);
     
     // Helper to draw ASCII progress bar
     std::string drawProgressBar(double percentage, int width);
     
+    // Helper to draw the waveform as a progress bar: one block character per column,
+    // as high as the loudest peak in that slice of the track; the unplayed part is dimmed
+    std::string drawWaveformBar(double percentage, int width);
+    
     // Helper to draw ASCII volume bar
     std::string drawVolumeBar(int volume, int width);
 };
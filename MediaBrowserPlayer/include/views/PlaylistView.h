@@ -3,6 +3,8 @@
 
 #include "IView.h"
 #include "../models/Playlist.h"
+#include "../models/SmartPlaylist.h"
+#include "ListWindow.h"
 #include <vector>
 
 class PlaylistView : public IView {
@@ -21,10 +23,13 @@ public:
     void displayMainMenu() override;
     
     // Display list of playlists
-    void displayPlaylists(const std::vector<Playlist>& playlists);
+    void displayPlaylists(const std::vector<PlaylistHeader>& playlists);
+
+    // Display list of smart playlists with their rules
+    void displaySmartPlaylists(const std::vector<SmartPlaylist>& playlists);
 
     // Display list of playlists to add
-    void displayPlaylistsToAdd(const std::vector<Playlist>& playlists);
+    void displayPlaylistsToAdd(const std::vector<PlaylistHeader>& playlists);
     
     // Display a single playlist's tracks with pagination
     void displayPlaylist(const Playlist& playlist, int page);
@@ -37,13 +42,16 @@ public:
     
     // Display playlist options menu
     void displayPlaylistOptionsMenu();
+
+    // Display one page of a track list to pick from
+    void displayTrackPicker(const std::string& title, ListWindow& window);
+
+    // Format a track entry for display
+    static std::string formatTrackEntry(const MediaFile& track, int index);
     
 private:
     // Helper method for pagination controls
     void displayPaginationControls(int currentPage, int totalPages);
-    
-    // Format a track entry for display
-    std::string formatTrackEntry(const MediaFile& track, int index);
 };
 
 #endif // PLAYLISTVIEW_H
@@ -1,5 +1,7 @@
 #include "../../include/controllers/ApplicationController.h"
 #include "../../include/views/MainView.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/TerminalInput.h"
 #include <iostream>
 #include <csignal>
 #include <cstdlib>
@@ -11,6 +13,8 @@ static ApplicationController* g_appController = nullptr;
 
 // Signal handler function
 void signalHandler(int signal) {
+    // Leave raw mode first, in case shutdown below doesn't get that far
+    TerminalInput::restoreTerminal();
     if (g_appController) {
         std::cout << "\nReceived signal " << signal << ". Exiting gracefully..." << std::endl;
         g_appController->shutdown();
@@ -51,11 +55,17 @@ void ApplicationController::run() {
     // Register signal handlers
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+    if (Trace::ENABLED) {
+        Trace::setThreadName("ui");
+        Trace::installSignalHandler();
+    }
     
     running = true;
     
     while (running) {
+        applyLibraryChanges();
         int choice = showMainMenu();
+        applyLibraryChanges();
         handleMenuChoice(choice);
     }
 }
@@ -63,6 +73,10 @@ void ApplicationController::run() {
 void ApplicationController::shutdown() {
     running = false;
     
+    // Stop watching before the library goes away
+    libraryWatcher.reset();
+    metricsServer.reset();
+    
     // Clean up controllers
     mediaController.reset();
     playlistController.reset();
@@ -92,20 +106,41 @@ bool ApplicationController::initialize() {
         }
         currentDirectory = inputDirectory;
 
+        // Serve metrics from the start, so the initial scan shows up too
+        std::string metricsPath = MetricsServer::getDefaultPath();
+        if (!metricsPath.empty()) {
+            metricsServer = std::make_unique<MetricsServer>();
+            metricsServer->start(metricsPath);
+        }
+
+        // Initialize the media library with init directory
+        // (before PlaylistController loads playlists, so their track IDs resolve against it)
+        mediaLibrary->scanDirectory(inputDirectory);
+        libraryWatcher = std::make_unique<LibraryWatcher>();
+        libraryWatcher->watch(inputDirectory);
+        std::shared_ptr<MediaLibrary> library = mediaLibrary;
+        playlistManager->setTrackResolver([library](uint64_t trackId, const std::string& filePath) {
+            return library->resolveTrack(trackId, filePath);
+        });
+
         // Create controllers - must create playerController first for HardwareController
         playerController = std::make_shared<PlayerController>(view); 
         
         // Need to create MediaController and HardwareController after PlayerController and need to pass a shared_ptr
         mediaController = std::make_shared<MediaController>(view, mediaLibrary, playlistManager, playerController);
         playlistController = std::make_shared<PlaylistController>(view, mediaLibrary, playlistManager, playerController, mediaController);
+        relinkMovedFiles();
+
+        // Screens that stay open pick up watcher changes on every redraw, not only at the main menu
+        auto libraryRefresh = [this]() { return applyLibraryChanges(); };
+        playerController->setLibraryRefresh(libraryRefresh);
+        mediaController->setLibraryRefresh(libraryRefresh);
+        playlistController->setLibraryRefresh(libraryRefresh);
         hardwareController = std::make_unique<HardwareController>(playerController);
 
         // Initialize the Player controller
         playerController->initialize();
         
-        // Initialize the media library with init directory
-        mediaLibrary->scanDirectory(inputDirectory);
-        
         // Connect to the hardware (if available)
         hardwareController->initialize();
         
@@ -129,6 +164,10 @@ int ApplicationController::showMainMenu() {
     return view->getMenuChoice(0, 9);
 }
 
+bool ApplicationController::applyLibraryChanges() {
+    return libraryWatcher && libraryWatcher->applyChanges(*mediaLibrary);
+}
+
 void ApplicationController::handleMenuChoice(int choice) {
     switch (choice) {
         case 1: // Show Media Library
@@ -148,6 +187,9 @@ void ApplicationController::handleMenuChoice(int choice) {
             break;
         case 6: // MountUSBDevice
             
+            break;
+        case 9: // Dump Trace
+            dumpTrace();
             break;
         case 0: // Exit
             running = false;
@@ -159,6 +201,22 @@ void ApplicationController::handleMenuChoice(int choice) {
     }
 }
 
+void ApplicationController::dumpTrace() {
+    if (!Trace::ENABLED) {
+        view->displayError("Tracing is not compiled in (rebuild with TRACE=1).");
+        view->waitForInput();
+        return;
+    }
+    
+    std::string path = Trace::getDefaultPath();
+    if (Trace::dump(path)) {
+        view->displayMessage("Trace written to " + path + " (open it in ui.perfetto.dev or chrome://tracing)");
+    } else {
+        view->displayError("Could not write trace to " + path);
+    }
+    view->waitForInput();
+}
+
 void ApplicationController::showMediaLibrary() {
     mediaController->showMediaLibrary();
 }
@@ -221,13 +279,23 @@ void ApplicationController::changeDirectory() {
     // Update current directory
     currentDirectory = newDir;
     
-    // Rescan the directory
+    // Rescan the directory and keep it live from now on
     mediaLibrary->scanDirectory(currentDirectory);
+    relinkMovedFiles();
+    if (libraryWatcher) {
+        libraryWatcher->watch(currentDirectory);
+    }
     
     view->displayMessage("Directory changed to: " + currentDirectory);
     view->waitForInput();
 }
 
+void ApplicationController::relinkMovedFiles() {
+    if (playlistManager->relinkTracks(mediaLibrary->takeMovedFiles()) > 0) {
+        playlistManager->savePlaylists();
+    }
+}
+
 void ApplicationController::changeDirectory(const std::string& directory) {
     // Check if directory exists
     if (!std::filesystem::is_directory(directory)) {
@@ -238,8 +306,12 @@ void ApplicationController::changeDirectory(const std::string& directory) {
     // Update current directory
     currentDirectory = directory;
     
-    // Rescan the directory
+    // Rescan the directory and keep it live from now on
     mediaLibrary->scanDirectory(currentDirectory);
+    relinkMovedFiles();
+    if (libraryWatcher) {
+        libraryWatcher->watch(currentDirectory);
+    }
     
     view->displayMessage("Directory changed to: " + currentDirectory);
 }
@@ -0,0 +1,280 @@
+#include "../../include/controllers/CliController.h"
+#include "../../include/models/Playlist.h"
+#include "../../include/models/PlaylistHeader.h"
+#include "../../include/models/PlaylistJournal.h"
+#include "../../include/services/PlaylistFormatService.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/TextEscape.h"
+#include <iostream>
+#include <filesystem>
+#include <thread>
+#include <exception>
+
+namespace {
+    const char* const SUBCOMMANDS[] = {"scan", "index", "search", "playlist"};
+
+    const char* getTypeName(Constants::FileType type) {
+        switch (type) {
+            case Constants::FileType::AUDIO: return "audio";
+            case Constants::FileType::VIDEO: return "video";
+            default:                         return "unknown";
+        }
+    }
+}
+
+CliController::CliController(const std::string& programName, const std::vector<std::string>& arguments)
+    : programName(programName), arguments(arguments) {
+}
+
+bool CliController::isSubcommand(const std::string& name) {
+    for (const char* subcommand : SUBCOMMANDS) {
+        if (name == subcommand) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int CliController::run() {
+    if (arguments.empty() || !parseOptions()) {
+        return usage();
+    }
+
+    try {
+        const std::string& command = arguments[0];
+        if (command == "scan") {
+            return runScan();
+        } else if (command == "index") {
+            return runIndex();
+        } else if (command == "search") {
+            return runSearch();
+        } else if (command == "playlist") {
+            return runPlaylist();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return usage();
+}
+
+bool CliController::parseOptions() {
+    unsigned cpus = std::thread::hardware_concurrency();
+    options.jobs = cpus > 0 ? cpus : 1;
+
+    for (size_t i = 1; i < arguments.size(); ++i) {
+        const std::string& argument = arguments[i];
+        if (argument.compare(0, 2, "--") != 0) {
+            options.positional.push_back(argument);
+            continue;
+        }
+        if (argument == "--json") {
+            options.json = true;
+            continue;
+        }
+
+        // Every other option takes a value
+        if (i + 1 >= arguments.size()) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        const std::string& value = arguments[++i];
+        if (argument == "--jobs") {
+            try {
+                int jobs = std::stoi(value);
+                if (jobs < 1) {
+                    throw std::out_of_range(value);
+                }
+                options.jobs = static_cast<unsigned>(jobs);
+            } catch (const std::exception&) {
+                std::cerr << "Invalid --jobs value: " << value << std::endl;
+                return false;
+            }
+        } else if (argument == "--output") {
+            options.output = value;
+        } else if (argument == "--dir") {
+            options.directory = value;
+        } else if (argument == "--library") {
+            options.library = value;
+        } else if (argument == "--format") {
+            options.format = value;
+        } else if (argument == "--playlists") {
+            options.playlists = value;
+        } else {
+            std::cerr << "Unknown option: " << argument << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int CliController::runScan() {
+    if (options.positional.size() != 1) {
+        return usage();
+    }
+
+    // Files are written as the scan adds them, not after the whole tree is read
+    MediaLibrary library;
+    if (!scanLibrary(options.positional[0], library, [this](const MediaFile& file) { writeFile(std::cout, file); })) {
+        return 1;
+    }
+    std::cout.flush();
+    return 0;
+}
+
+int CliController::runIndex() {
+    if (options.positional.size() != 2 || options.positional[0] != "build") {
+        return usage();
+    }
+
+    const std::string& directory = options.positional[1];
+    MediaLibrary library;
+    if (!scanLibrary(directory, library)) {
+        return 1;
+    }
+
+    std::string indexPath = options.output;
+    if (indexPath.empty()) {
+        indexPath = (std::filesystem::path(directory) / Constants::LIBRARY_INDEX_FILE).string();
+    }
+    long long count = library.saveIndex(directory, indexPath);
+    if (count < 0) {
+        std::cerr << "Can't write index " << indexPath << std::endl;
+        return 1;
+    }
+    std::cout << "Indexed " << count << " files into " << indexPath << std::endl;
+    return 0;
+}
+
+int CliController::runSearch() {
+    if (options.positional.size() != 1) {
+        return usage();
+    }
+
+    MediaLibrary library;
+    if (!scanLibrary(options.directory.empty() ? "." : options.directory, library)) {
+        return 1;
+    }
+    for (const auto& file : library.searchMediaFiles(options.positional[0])) {
+        writeFile(std::cout, file);
+    }
+    std::cout.flush();
+    return 0;
+}
+
+int CliController::runPlaylist() {
+    if (options.positional.empty()) {
+        return usage();
+    }
+    const std::string& action = options.positional[0];
+    std::string directory = getPlaylistsDir();
+
+    if (action == "list" && options.positional.size() == 1) {
+        if (!std::filesystem::is_directory(directory)) {
+            return 0;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != Constants::PLAYLIST_EXT) {
+                continue;
+            }
+            // Truncated or unreadable files are skipped
+            std::string path = entry.path().string();
+            PlaylistHeader header;
+            try {
+                if (!Playlist::readHeader(path, header)) {
+                    // Old format: no summary line, count the tracks instead
+                    header = Playlist::load(path).getHeader(directory);
+                }
+            } catch (const std::exception&) {
+                continue;
+            }
+            std::cout << TextEscape::field(header.getName()) << "\t" << header.getTrackCount()
+                      << "\t" << static_cast<long long>(header.getTotalDuration()) << "\n";
+        }
+        std::cout.flush();
+        return 0;
+    }
+
+    if (action != "export" || options.positional.size() != 2) {
+        return usage();
+    }
+
+    PlaylistFormatService formatService;
+    PlaylistFormatService::Format format = formatService.detectFormat("playlist." + options.format);
+    if (format == PlaylistFormatService::Format::UNKNOWN) {
+        std::cerr << "Unknown playlist format: " << options.format << std::endl;
+        return 2;
+    }
+
+    std::string path = directory + "/" + options.positional[1] + Constants::PLAYLIST_EXT;
+    if (!std::filesystem::is_regular_file(path)) {
+        std::cerr << "No playlist named " << options.positional[1] << " in " << directory << std::endl;
+        return 1;
+    }
+
+    // Titles and durations live in the library, not in the playlist file
+    MediaLibrary library;
+    if (!options.library.empty() && !scanLibrary(options.library, library)) {
+        return 1;
+    }
+    Playlist::TrackResolver resolver = [&library](uint64_t trackId, const std::string& filePath) {
+        return library.resolveTrack(trackId, filePath);
+    };
+
+    Playlist playlist = Playlist::load(path, resolver);
+    std::string journalPath = PlaylistJournal::getJournalPath(path);
+    if (std::filesystem::exists(journalPath)) {
+        PlaylistJournal journal;
+        PlaylistJournal::replay(journalPath, playlist, resolver, journal);
+    }
+
+    std::string contents = formatService.formatPlaylist(playlist, format);
+    std::cout.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    std::cout.flush();
+    return std::cout ? 0 : 1;
+}
+
+bool CliController::scanLibrary(const std::string& directory, MediaLibrary& library,
+                                const std::function<void(const MediaFile&)>& onAdded) {
+    if (!std::filesystem::is_directory(directory)) {
+        std::cerr << "Not a directory: " << directory << std::endl;
+        return false;
+    }
+    library.scanDirectory(directory, true, options.jobs, onAdded);
+    return true;
+}
+
+std::string CliController::getPlaylistsDir() const {
+    return options.playlists.empty() ? Constants::PLAYLISTS_DIR : options.playlists;
+}
+
+void CliController::writeFile(std::ostream& out, const MediaFile& file) const {
+    const Metadata& metadata = file.getMetadata();
+    if (!options.json) {
+        out << getTypeName(file.getType()) << "\t" << metadata.getDuration()
+            << "\t" << TextEscape::field(metadata.getName()) << "\t" << TextEscape::field(file.getFilePath()) << "\n";
+        return;
+    }
+
+    out << "{\"path\":\"" << TextEscape::json(file.getFilePath())
+        << "\",\"type\":\"" << getTypeName(file.getType())
+        << "\",\"title\":\"" << TextEscape::json(metadata.getName())
+        << "\",\"duration\":" << metadata.getDuration()
+        << ",\"tags\":{";
+    bool first = true;
+    for (const auto& attribute : metadata.getAllAttributes()) {
+        out << (first ? "\"" : ",\"") << TextEscape::json(attribute.first) << "\":\"" << TextEscape::json(attribute.second) << "\"";
+        first = false;
+    }
+    out << "}}\n";
+}
+
+int CliController::usage() const {
+    std::cerr << "Usage: " << programName << " scan <dir> [--jobs N] [--json]\n"
+              << "       " << programName << " index build <dir> [--jobs N] [--output FILE]\n"
+              << "       " << programName << " search <query> [--dir DIR] [--jobs N] [--json]\n"
+              << "       " << programName << " playlist list [--playlists DIR]\n"
+              << "       " << programName << " playlist export <name> [--format m3u|pls] [--library DIR] [--jobs N] [--playlists DIR]"
+              << std::endl;
+    return 2;
+}
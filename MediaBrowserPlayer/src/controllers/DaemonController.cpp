@@ -0,0 +1,490 @@
+#include "../../include/controllers/DaemonController.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/TextEscape.h"
+#include "../../include/utils/UnixSocket.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cmath>
+#include <csignal>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+namespace {
+    constexpr size_t READ_CHUNK = 4096;
+
+    std::string formatSeconds(double seconds) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f", seconds);
+        return text;
+    }
+
+    // Whole-string integer parse
+    bool parseInt(const std::string& text, long& value) {
+        if (text.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtol(text.c_str(), &end, 10);
+        return errno == 0 && *end == '\0';
+    }
+
+    const char* stateName(Constants::PlayerState state) {
+        switch (state) {
+            case Constants::PlayerState::PLAYING: return "playing";
+            case Constants::PlayerState::PAUSED:  return "paused";
+            default:                              return "stopped";
+        }
+    }
+}
+
+DaemonController::DaemonController(const std::string& directory, const std::string& socketPath)
+    : directory(directory), socketPath(socketPath),
+      view(std::make_shared<HeadlessView>()),
+      mediaLibrary(std::make_shared<MediaLibrary>()),
+      listenFd(-1), epollFd(-1), signalFd(-1) {
+}
+
+DaemonController::~DaemonController() {
+    shutdown();
+}
+
+std::string DaemonController::getDefaultSocketPath() {
+    const char* path = std::getenv("MBP_CONTROL_SOCKET");
+    return path && *path ? path : Constants::DAEMON_SOCKET_PATH;
+}
+
+int DaemonController::run() {
+    // Block the stop signals before any thread starts, so all of them inherit the mask
+    // and the signals are only ever delivered through signalFd
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+    signalFd = signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    if (Trace::ENABLED) {
+        Trace::setThreadName("daemon");
+        Trace::installSignalHandler();
+    }
+
+    if (signalFd < 0 || !initialize()) {
+        shutdown();
+        return 1;
+    }
+
+    bool running = true;
+    epoll_event events[16];
+    while (running) {
+        int count = epoll_wait(epollFd, events, 16, Constants::DAEMON_POLL_MS);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "Daemon event loop failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        libraryWatcher->applyChanges(*mediaLibrary);
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == signalFd) {
+                running = false;
+            } else if (fd == listenFd) {
+                acceptClients();
+            } else {
+                auto client = clients.find(fd);
+                if (client == clients.end()) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readClient(fd, client->second);
+                } else if (events[i].events & EPOLLOUT) {
+                    flushClient(fd, client->second);
+                }
+            }
+        }
+    }
+
+    shutdown();
+    return 0;
+}
+
+bool DaemonController::initialize() {
+    if (!std::filesystem::is_directory(directory)) {
+        std::cerr << "Not a directory: " << directory << std::endl;
+        return false;
+    }
+
+    std::string metricsPath = MetricsServer::getDefaultPath();
+    if (!metricsPath.empty()) {
+        metricsServer = std::make_unique<MetricsServer>();
+        metricsServer->start(metricsPath);
+    }
+
+    mediaLibrary->scanDirectory(directory);
+    libraryWatcher = std::make_unique<LibraryWatcher>();
+    libraryWatcher->watch(directory);
+
+    playerController = std::make_shared<PlayerController>(view);
+    if (!playerController->initialize()) {
+        return false;
+    }
+
+    listenFd = UnixSocket::listen(socketPath, 16);
+    if (listenFd < 0 && errno == EADDRINUSE) {
+        std::cerr << "A daemon is already running on " << socketPath << std::endl;
+        return false;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (listenFd < 0 || epollFd < 0) {
+        std::cerr << "Can't listen on " << socketPath << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // Controlling the player is for the owner and its group
+    chmod(socketPath.c_str(), 0660);
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = signalFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+
+    std::cerr << "Serving " << mediaLibrary->getMediaFileCount() << " tracks from " << directory
+              << " on " << socketPath << std::endl;
+    return true;
+}
+
+void DaemonController::shutdown() {
+    while (!clients.empty()) {
+        closeClient(clients.begin()->first);
+    }
+
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (epollFd >= 0) close(epollFd);
+    if (signalFd >= 0) close(signalFd);
+    listenFd = epollFd = signalFd = -1;
+
+    // Stop watching before the library goes away, and the player before SDL is torn down
+    libraryWatcher.reset();
+    playerController.reset();
+    metricsServer.reset();
+}
+
+void DaemonController::acceptClients() {
+    static Metrics::Gauge& connected = Metrics::gauge("mbp_daemon_clients", "Clients connected to the control socket");
+
+    int fd;
+    while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (clients.size() >= Constants::DAEMON_MAX_CLIENTS) {
+            const char reply[] = "ERR too many clients\n";
+            ssize_t ignored = send(fd, reply, sizeof(reply) - 1, MSG_NOSIGNAL);
+            (void)ignored;
+            close(fd);
+            continue;
+        }
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        clients[fd] = Client();
+    }
+    connected.set(static_cast<int64_t>(clients.size()));
+}
+
+void DaemonController::readClient(int fd, Client& client) {
+    char chunk[READ_CHUNK];
+    bool endOfInput = false;
+
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            client.input.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeClient(fd); // Connection reset
+            return;
+        }
+        endOfInput = n == 0;
+        break;
+    }
+
+    // Commands are answered in order; nothing more is read from a client that is closing
+    size_t start = 0;
+    size_t newline;
+    while (!client.closing && (newline = client.input.find('\n', start)) != std::string::npos) {
+        std::string line = client.input.substr(start, newline - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        handleCommand(line, client);
+        start = newline + 1;
+    }
+    client.input.erase(0, start);
+
+    // The last command may lack its newline
+    if (endOfInput && !client.closing && !client.input.empty()) {
+        handleCommand(client.input, client);
+        client.input.clear();
+    }
+
+    if (client.input.size() > Constants::DAEMON_MAX_LINE) {
+        client.output += "ERR line too long\n";
+        client.closing = true;
+    }
+
+    // A client that shut down its side (echo status | socat ...) still gets its replies
+    if (endOfInput) {
+        client.closing = true;
+    }
+    flushClient(fd, client);
+}
+
+void DaemonController::flushClient(int fd, Client& client) {
+    while (!client.output.empty()) {
+        ssize_t n = send(fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            client.output.erase(0, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        closeClient(fd); // Peer is gone
+        return;
+    }
+
+    if ((client.output.empty() && client.closing) || client.output.size() > Constants::DAEMON_MAX_PENDING_OUTPUT) {
+        closeClient(fd);
+        return;
+    }
+
+    // Only ask for writability while there is something left to send, and stop
+    // reading once closing (a peer at end of input would keep EPOLLIN raised)
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = client.closing ? EPOLLOUT : client.output.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void DaemonController::closeClient(int fd) {
+    static Metrics::Gauge& connected = Metrics::gauge("mbp_daemon_clients", "Clients connected to the control socket");
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients.erase(fd);
+    connected.set(static_cast<int64_t>(clients.size()));
+}
+
+void DaemonController::handleCommand(const std::string& line, Client& client) {
+    TRACE_ZONE("daemon.command");
+
+    size_t begin = line.find_first_not_of(' ');
+    if (begin == std::string::npos) {
+        return; // Blank lines are ignored
+    }
+    size_t end = line.find(' ', begin);
+    std::string command = line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    std::string argument;
+    if (end != std::string::npos) {
+        size_t argumentBegin = line.find_first_not_of(' ', end);
+        if (argumentBegin != std::string::npos) {
+            argument = line.substr(argumentBegin);
+        }
+    }
+
+    std::string reply;
+    if (command == "status") {
+        reply = handleStatus();
+    } else if (command == "play") {
+        reply = handlePlay(argument);
+    } else if (command == "pause" || command == "resume") {
+        // Toggling is the only primitive: only toggle when it moves towards the requested state
+        Constants::PlayerState from = command == "pause" ? Constants::PlayerState::PLAYING : Constants::PlayerState::PAUSED;
+        if (playerController->getStateSnapshot().state == from) {
+            playerController->togglePlayPause();
+        }
+        reply = "OK";
+    } else if (command == "toggle") {
+        playerController->togglePlayPause();
+        reply = "OK";
+    } else if (command == "stop") {
+        playerController->stop();
+        reply = "OK";
+    } else if (command == "next") {
+        playerController->next();
+        reply = "OK";
+    } else if (command == "prev") {
+        playerController->previous();
+        reply = "OK";
+    } else if (command == "seek") {
+        reply = handleSeek(argument);
+    } else if (command == "volume") {
+        reply = handleVolume(argument);
+    } else if (command == "queue") {
+        reply = handleQueue(argument);
+    } else if (command == "search") {
+        reply = handleSearch(argument);
+    } else if (command == "help") {
+        reply = "OK status play pause resume toggle stop next prev seek volume queue search help quit";
+    } else if (command == "quit") {
+        reply = "OK";
+        client.closing = true;
+    } else {
+        reply = "ERR unknown command: " + command;
+    }
+
+    client.output += reply;
+    client.output += '\n';
+}
+
+std::string DaemonController::handleStatus() {
+    PlayerSnapshot snapshot = playerController->getStateSnapshot();
+    int track = playerController->getAudioState().getCurrentTrackIndex();
+
+    std::ostringstream reply;
+    reply << "OK state=" << stateName(snapshot.state)
+          << " volume=" << snapshot.volume
+          << " position=" << formatSeconds(snapshot.position)
+          << " duration=" << formatSeconds(snapshot.duration)
+          << " track=" << track
+          << " title=" << TextEscape::field(snapshot.title);
+    return reply.str();
+}
+
+std::string DaemonController::handlePlay(const std::string& argument) {
+    long index = 0;
+    if (!argument.empty() && (!parseInt(argument, index) || index < 0)) {
+        return "ERR usage: play [N]";
+    }
+
+    const Playlist& source = queue.isEmpty() ? mediaLibrary->getRoot() : queue;
+    if (source.isEmpty()) {
+        return "ERR nothing to play";
+    }
+    if (static_cast<size_t>(index) >= source.getTrackCount()) {
+        return "ERR no entry " + std::to_string(index);
+    }
+
+    return playerController->playPlaylist(source, static_cast<int>(index)) ? "OK" : "ERR playback failed";
+}
+
+std::string DaemonController::handleSeek(const std::string& argument) {
+    if (argument.empty()) {
+        return "ERR usage: seek <seconds> | seek +S | seek -S";
+    }
+
+    char* end = nullptr;
+    double value = std::strtod(argument.c_str(), &end);
+    if (*end != '\0' || !std::isfinite(value)) {
+        return "ERR invalid position: " + argument;
+    }
+
+    double position = value;
+    if (argument[0] == '+' || argument[0] == '-') {
+        position = playerController->getStateSnapshot().position + value;
+    }
+    return playerController->seek(position) ? "OK" : "ERR nothing is playing";
+}
+
+std::string DaemonController::handleVolume(const std::string& argument) {
+    if (!argument.empty()) {
+        long value = 0;
+        if (!parseInt(argument, value)) {
+            return "ERR usage: volume [N | +N | -N]";
+        }
+        bool relative = argument[0] == '+' || argument[0] == '-';
+        int current = playerController->getStateSnapshot().volume;
+        long target = relative ? current + value : value;
+        playerController->setVolume(static_cast<int>(std::max(0L, std::min(target, 100L))));
+    }
+    return "OK " + std::to_string(playerController->getStateSnapshot().volume);
+}
+
+std::string DaemonController::handleQueue(const std::string& argument) {
+    size_t split = argument.find(' ');
+    std::string action = argument.substr(0, split);
+    std::string rest;
+    if (split != std::string::npos && argument.find_first_not_of(' ', split) != std::string::npos) {
+        rest = argument.substr(argument.find_first_not_of(' ', split));
+    }
+
+    if (action.empty()) {
+        std::ostringstream reply;
+        reply << "OK " << queue.getTrackCount();
+        Playlist::TrackList tracks = queue.getTracks();
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            reply << "\n" << i << "\t" << formatSeconds(tracks[i].getMetadata().getDuration())
+                  << "\t" << TextEscape::field(tracks[i].getMetadata().getName())
+                  << "\t" << TextEscape::field(tracks[i].getFilePath());
+        }
+        return reply.str();
+    }
+
+    if (action == "add") {
+        const MediaFile* track = mediaLibrary->findByPath(rest);
+        if (!track) {
+            return "ERR not in the library: " + rest;
+        }
+        queue.addTrack(*track);
+        return "OK " + std::to_string(queue.getTrackCount());
+    }
+
+    if (action == "remove") {
+        long index = 0;
+        if (!parseInt(rest, index) || index < 0 || static_cast<size_t>(index) >= queue.getTrackCount()) {
+            return "ERR no entry " + rest;
+        }
+        queue.removeTrack(static_cast<size_t>(index));
+        return "OK " + std::to_string(queue.getTrackCount());
+    }
+
+    if (action == "clear") {
+        queue.clear();
+        return "OK 0";
+    }
+
+    return "ERR usage: queue [add <path> | remove <N> | clear]";
+}
+
+std::string DaemonController::handleSearch(const std::string& argument) {
+    if (argument.empty()) {
+        return "ERR usage: search <text>";
+    }
+
+    std::vector<MediaFile> results = mediaLibrary->searchMediaFiles(argument);
+    size_t count = std::min(results.size(), Constants::DAEMON_SEARCH_LIMIT);
+
+    std::ostringstream reply;
+    reply << "OK " << count;
+    for (size_t i = 0; i < count; ++i) {
+        reply << "\n" << formatSeconds(results[i].getMetadata().getDuration())
+              << "\t" << TextEscape::field(results[i].getMetadata().getName())
+              << "\t" << TextEscape::field(results[i].getFilePath());
+    }
+    return reply.str();
+}
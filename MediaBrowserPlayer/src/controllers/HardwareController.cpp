@@ -1,12 +1,15 @@
 #include "../../include/controllers/HardwareController.h"
 #include "../../include/controllers/PlayerController.h"
+#include "../../include/utils/Trace.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
 
 HardwareController::HardwareController(std::shared_ptr<PlayerController> playerCtrl)
-    : boardHandle(-1), playerController(playerCtrl), stopInputThread(false) {
+    : boardHandle(-1), playerController(playerCtrl), stopInputThread(false), hasSentTelemetry(false) {
 }
 
 HardwareController::~HardwareController() {
@@ -14,8 +17,18 @@ HardwareController::~HardwareController() {
 }
 
 bool HardwareController::initialize() {
+    // Port and baud rate can be overridden, e.g. to point at the pty simulator
+    const char* portEnv = std::getenv("S32K144_PORT");
+    const char* baudEnv = std::getenv("S32K144_BAUD");
+    std::string port = portEnv ? portEnv : Constants::S32K144_PORT;
+    int baudrate = baudEnv ? std::atoi(baudEnv) : Constants::S32K144_BAUDRATE;
+    if (baudrate <= 0 || baudrate > Constants::S32K144_MAX_BAUDRATE) {
+        std::cerr << "Invalid S32K144 baud rate, using " << Constants::S32K144_BAUDRATE << std::endl;
+        baudrate = Constants::S32K144_BAUDRATE;
+    }
+
     // Try to connect to the S32K144 board
-    if (!s32k144.connect()) {
+    if (!s32k144.connect(port, baudrate)) {
         std::cerr << "Failed to connect to S32K144 board" << std::endl;
         return false;
     }
@@ -25,15 +38,17 @@ bool HardwareController::initialize() {
     
     // Start thread to read input from hardware
     stopInputThread = false;
+    hasSentTelemetry = false;
     inputThread = std::thread(&HardwareController::readHardwareInput, this);
     
     return true;
 }
 
 void HardwareController::cleanup() {
-    // Stop input thread
+    // Stop input thread (wake it up if it is blocked waiting for the board)
     if (inputThread.joinable()) {
         stopInputThread = true;
+        s32k144.wakeUp();
         inputThread.join();
     }
     
@@ -47,29 +62,92 @@ bool HardwareController::isConnected() const {
 }
 
 void HardwareController::readHardwareInput() {
+    Trace::setThreadName("board-input");
+    const auto tick = std::chrono::milliseconds(Constants::S32K144_TELEMETRY_MS);
+    auto nextTelemetry = std::chrono::steady_clock::now();
+
     while (!stopInputThread && isConnected()) {
-        // Read data from the board
-        std::string data = s32k144.readData();
+        // Telemetry shares this thread, so writes never race with the reactor
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextTelemetry) {
+            publishTelemetry();
+            nextTelemetry = now + tick;
+        }
+
+        // Sleep until the board sends something, the next tick is due or cleanup() wakes us up
+        int timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            nextTelemetry - std::chrono::steady_clock::now()).count());
+        if (!s32k144.waitForData(std::max(timeoutMs, 0))) {
+            continue;
+        }
         
-        if (!data.empty() && playerController->_isDisplaying()) {
-            if (data == "P") {
+        // Dispatch every decoded event in arrival order
+        S32K144Protocol::BoardEvent event;
+        while (!stopInputThread && s32k144.readEvent(event)) {
+            handleBoardEvent(event);
+        }
+    }
+}
+
+void HardwareController::publishTelemetry() {
+    PlayerSnapshot snapshot = playerController->getStateSnapshot();
+
+    S32K144Protocol::NowPlaying state;
+    switch (snapshot.state) {
+        case Constants::PlayerState::PLAYING: state.state = 0; break;
+        case Constants::PlayerState::PAUSED:  state.state = 1; break;
+        default:                              state.state = 2; break;
+    }
+    state.volume = static_cast<uint8_t>(std::max(0, std::min(snapshot.volume, 100)));
+    state.position = static_cast<uint16_t>(std::min(std::max(snapshot.position, 0.0), 65535.0));
+    state.duration = static_cast<uint16_t>(std::min(std::max(snapshot.duration, 0.0), 65535.0));
+    state.title = snapshot.title;
+
+    // Only changes go out, plus a periodic keepalive so a board that reset catches up
+    auto now = std::chrono::steady_clock::now();
+    bool keepaliveDue = now - lastTelemetryTime >= std::chrono::milliseconds(Constants::S32K144_TELEMETRY_KEEPALIVE_MS);
+    if (hasSentTelemetry && state == lastTelemetry && !keepaliveDue) {
+        return;
+    }
+
+    // If the UART is busy the frame is dropped; the next tick sends a fresher one
+    if (s32k144.sendFrame(S32K144Protocol::encodeNowPlaying(state))) {
+        lastTelemetry = state;
+        hasSentTelemetry = true;
+        lastTelemetryTime = now;
+    }
+}
+
+void HardwareController::handleBoardEvent(const S32K144Protocol::BoardEvent& event) {
+    if (!playerController->_isDisplaying()) {
+        return;
+    }
+
+    switch (event.type) {
+        case S32K144Protocol::FrameType::BUTTON:
+            if (event.value == 'P') {
                 playerController->previous();
             }
-            else if (data == "N") {
+            else if (event.value == 'N') {
                 playerController->next();
             }
-            else if (data == "T") {
+            else if (event.value == 'T') {
                 playerController->togglePlayPause();
             }
-            else if (data == "S") {
+            else if (event.value == 'S') {
                 playerController->stop();
             }
-            else if(std::all_of(data.begin(), data.end(), ::isdigit)){
-                playerController->setVolume(std::stoi(data));
-            }
-        }
-        
-        // // Sleep to reduce CPU usage
-        // std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            break;
+
+        case S32K144Protocol::FrameType::VOLUME:
+            playerController->setVolume(event.value);
+            break;
+
+        case S32K144Protocol::FrameType::ENCODER:
+            playerController->setVolume(playerController->getAudioState().getVolume() + event.value);
+            break;
+
+        default:
+            break;
     }
 }
\ No newline at end of file
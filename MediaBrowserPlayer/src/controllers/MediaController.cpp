@@ -1,10 +1,14 @@
 #include "../../include/controllers/MediaController.h"
 #include "../../include/models/Playlist.h"
+#include "../../include/services/FingerprintService.h"
 #include <iostream>
 #include <cctype>
 #include <cmath>
 #include <filesystem>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
 
 // Use filesystem namespace for current_path() calls
 namespace fs = std::filesystem;
@@ -39,6 +43,8 @@ void MediaController::scanCurrentDirectory(const std::string& directoryPath, boo
     // Scan directory
     mediaLibrary->scanDirectory(directoryPath, recursive);
     
+    relinkPlaylists();
+    
     mediaListView->displayMessage("Found " + std::to_string(mediaLibrary->getMediaFileCount()) + " media files.");
     mediaListView->waitForInput();
 }
@@ -51,35 +57,59 @@ void MediaController::scanUSBDevice(const std::string& mountPoint, bool recursiv
     
     // Scan USB device
     mediaLibrary->scanUSBDevice(mountPoint, recursive);
+    relinkPlaylists();
     
     mediaListView->displayMessage("Found " + std::to_string(mediaLibrary->getMediaFileCount()) + " media files on USB device.");
     mediaListView->waitForInput();
 }
 
+void MediaController::relinkPlaylists() {
+    // Moved or renamed files keep their place in playlists
+    if (playlistManager->relinkTracks(mediaLibrary->takeMovedFiles()) > 0) {
+        playlistManager->savePlaylists();
+    }
+}
+
 void MediaController::showMediaLibrary(int page) {
     if (mediaLibrary->getRoot().isEmpty()) {
         mediaListView->displayMessage("Media library is empty. Try scanning a directory first.");
         mediaListView->waitForInput();
         return;
     }
-    std::vector<MediaFile> files = mediaLibrary->getRoot().getTracks();
+    // Window over the library itself: only the visible page is ever formatted
+    Playlist::TrackList files = mediaLibrary->getRoot().getTracks();
+    auto formatEntry = [&files](size_t i) { return MediaListView::formatMediaFileEntry(files[i], static_cast<int>(i)); };
+    auto entryName = [&files](size_t i) { return files[i].getMetadata().getName(); };
+    ListWindow window;
+    window.setSource(files.size(), formatEntry, entryName);
 
     // Ensure page is valid
-    int totalPages = calculateTotalPages();
-    if (page < 0) page = 0;
-    if (page >= totalPages) page = totalPages - 1;
-    
-    currentPage = page;
+    int totalPages = window.getPageCount();
+    window.setPage(page);
+    currentPage = window.getCurrentPage();
     
     while (true) {
+        // Files the watcher added or removed since the last redraw
+        if (refreshLibrary()) {
+            if (files.empty()) {
+                mediaListView->displayMessage("Media library is empty. Try scanning a directory first.");
+                mediaListView->waitForInput();
+                return;
+            }
+            window.setSource(files.size(), formatEntry, entryName);
+            totalPages = window.getPageCount();
+            currentPage = std::min(currentPage, totalPages - 1);
+        }
+
         // Display media files with pagination
-        mediaListView->displayMediaFiles(files, currentPage);
+        window.setPage(currentPage);
+        mediaListView->displayMediaFiles(window);
         
         char choice;
         std::string input;
         
         // Handle pagination and options
-        input = mediaListView->getInput("\nEnter option (0-5) or P/N for pagination: ");
+        input = mediaListView->getInput("\nEnter option (0-6) or P/N for pagination: ");
         
         if (input.empty()) continue;
         
@@ -93,6 +123,16 @@ void MediaController::showMediaLibrary(int page) {
             // Next page
             currentPage++;
             continue;
+        } else if (choice == 'J') {
+            // Jump to letter, either "JA" or "J" followed by a prompt
+            std::string letter = input.size() > 1 ? input.substr(1) : mediaListView->getInput("Jump to letter: ");
+            if (!letter.empty() && window.jumpToLetter(letter[0])) {
+                currentPage = window.getCurrentPage();
+            } else {
+                mediaListView->displayError("No file starts with that letter");
+                mediaListView->waitForInput();
+            }
+            continue;
         } else if (std::isdigit(choice)) {
             int option = choice - '0';
             
@@ -165,6 +205,17 @@ void MediaController::showMediaLibrary(int page) {
                     continue;
                 }
                 
+                case 6: { // Find duplicates
+                    if (findDuplicates()) {
+                        // Entries were removed: the window has to follow the library
+                        window.setSource(files.size(), formatEntry, entryName);
+                        totalPages = window.getPageCount();
+                        window.setPage(currentPage);
+                        currentPage = window.getCurrentPage();
+                    }
+                    continue;
+                }
+                
                 case 0: // Back to main menu
                     return;
                 
@@ -223,7 +274,7 @@ void MediaController::showMediaFileDetails(size_t index) {
     }
 }
 
-void MediaController::showMediaFileDetailsInPlaylist(size_t index, size_t playlistIndex) {
+void MediaController::showMediaFileDetailsInPlaylist(size_t index, size_t playlistIndex, size_t trackIndex) {
     try {
         const MediaFile& file = mediaLibrary->getMediaFile(index);
         
@@ -255,7 +306,13 @@ void MediaController::showMediaFileDetailsInPlaylist(size_t index, size_t playli
             }
                 
             case 3: { // Remove from playlist
-                playlistManager->getPlaylist(playlistIndex).removeTrack(index);
+                if (playlistManager->removeTrack(playlistIndex, trackIndex)) {
+                    playlistManager->savePlaylists();
+                    mediaListView->displayMessage("Track removed from playlist");
+                } else {
+                    mediaListView->displayError("Track is no longer in the playlist");
+                }
+                mediaListView->waitForInput();
                 break;
             }
                 
@@ -338,6 +395,52 @@ void MediaController::editMediaFileMetadata(size_t index) {
     }
 }
 
+bool MediaController::findDuplicates() {
+    FingerprintService fingerprintService;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    fingerprintService.update(*mediaLibrary, mediaLibrary->getFingerprints(), jobs,
+        [this](size_t done, size_t total) { mediaListView->displayProgress("Fingerprinting audio files", done, total); });
+    
+    std::vector<std::vector<size_t>> groups = mediaLibrary->getFingerprints().findDuplicates(*mediaLibrary);
+    if (groups.empty()) {
+        mediaListView->displayMessage("No duplicate audio files found.");
+        mediaListView->waitForInput();
+        return false;
+    }
+    
+    // Keep the highest bitrate copy of each recording
+    std::vector<std::vector<MediaFile>> duplicates;
+    size_t extraCount = 0;
+    for (const auto& group : groups) {
+        std::vector<MediaFile> files;
+        for (size_t index : group) {
+            files.push_back(mediaLibrary->getMediaFile(index));
+        }
+        std::stable_sort(files.begin(), files.end(), [](const MediaFile& a, const MediaFile& b) {
+            return std::atoi(a.getMetadata().getAttribute(Constants::MetadataKeys::BITRATE).c_str()) >
+                   std::atoi(b.getMetadata().getAttribute(Constants::MetadataKeys::BITRATE).c_str());
+        });
+        extraCount += files.size() - 1;
+        duplicates.push_back(std::move(files));
+    }
+    mediaListView->displayDuplicateGroups(duplicates);
+    
+    // Only the library entries go; the files stay on disk
+    std::string answer = mediaListView->getInput("\nRemove the " + std::to_string(extraCount) +
+                                                 " extra copies from the library? (y/n): ");
+    if (answer.empty() || std::tolower(answer[0]) != 'y') {
+        return false;
+    }
+    for (const auto& files : duplicates) {
+        for (size_t i = 1; i < files.size(); ++i) {
+            mediaLibrary->removeMediaFile(files[i].getFilePath());
+        }
+    }
+    mediaListView->displayMessage("Removed " + std::to_string(extraCount) + " duplicates from the library.");
+    mediaListView->waitForInput();
+    return true;
+}
+
 void MediaController::searchMediaFiles(const std::string& query) {
     if (query.empty()) {
         showMediaLibrary(0);
@@ -354,7 +457,7 @@ void MediaController::searchMediaFiles(const std::string& query) {
     }
     
     // Create a temporary copy of the current media library
-    std::vector<MediaFile> originalFiles = mediaLibrary->getRoot().getTracks();
+    std::vector<MediaFile> originalFiles = mediaLibrary->getRoot().getTracks().toVector();
     
     // Replace media library with search results for display
     mediaLibrary->clear();
@@ -384,7 +487,7 @@ void MediaController::filterMediaFilesByType(Constants::FileType type) {
     }
     
     // Create a temporary copy of the current media library
-    std::vector<MediaFile> originalFiles = mediaLibrary->getRoot().getTracks();
+    std::vector<MediaFile> originalFiles = mediaLibrary->getRoot().getTracks().toVector();
     
     // Replace media library with filtered results for display
     mediaLibrary->clear();
@@ -421,13 +524,16 @@ void MediaController::handleMediaMenuOption(int option) {
 }
 
 int MediaController::MediaFileExists(const MediaFile& file) const {
-    // Check if the file exists in the media library
-    for (size_t i = 0; i < mediaLibrary->getMediaFileCount(); ++i) {
-        if (mediaLibrary->getMediaFile(i).getFilePath() == file.getFilePath()) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1; // Not found
+    // Check if the file exists in the media library (-1 if not found)
+    return mediaLibrary->findIndexByPath(file.getFilePath());
+}
+
+void MediaController::setLibraryRefresh(const std::function<bool()>& refresh) {
+    libraryRefresh = refresh;
+}
+
+bool MediaController::refreshLibrary() {
+    return libraryRefresh && libraryRefresh();
 }
 
 int MediaController::calculateTotalPages() const {
@@ -517,7 +623,7 @@ void MediaController::browseFiles(const std::string& directoryPath) {
 }
 
 void MediaController::showPlaylistsToAdd(int mediaIndex) {
-    const auto& playlists = playlistManager->getPlaylists();
+    const auto& playlists = playlistManager->getPlaylistHeaders();
     
     playlistView->displayPlaylistsToAdd(playlists);
     
@@ -529,9 +635,8 @@ void MediaController::showPlaylistsToAdd(int mediaIndex) {
             try {
                 int index = std::stoi(indexStr) - 1; // Convert to 0-based index
                 if (index >= 0 && index < static_cast<int>(playlists.size())) {
-                    Playlist playlist = playlistManager->getPlaylist(index);
-                    playlist.addTrack(mediaLibrary->getMediaFile(mediaIndex));
-                    playlistManager->updatePlaylist(index, playlist);
+                    playlistManager->addTrack(index, mediaLibrary->getMediaFile(mediaIndex));
+                    playlistManager->savePlaylists();
                     playlistView->displayMessage("Track added to playlist: " + playlists[index].getName());
                     playlistView->waitForInput();
                 } else {
@@ -565,6 +670,7 @@ void MediaController::showPlaylistsToAdd(int mediaIndex) {
 
             // Add the new playlist to the manager
             playlistManager->addPlaylist(newPlaylist);
+            playlistManager->savePlaylists();
             playlistView->displayMessage("Playlist created: " + name);
             playlistView->waitForInput();
             break;
@@ -1,11 +1,13 @@
 #include "../../include/controllers/PlayerController.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
 #include <iostream>
 #include <chrono>
 #include <algorithm>
 #include <cmath>
 
 PlayerController::PlayerController(std::shared_ptr<IView> parentView)
-    : playerView(std::make_shared<PlayerView>()) {
+    : playerView(std::make_shared<PlayerView>()), musicThread(nullptr) {
     // Convert parent view to PlayerView if possible, otherwise create a new one
     if (parentView) {
         playerView = std::dynamic_pointer_cast<PlayerView>(parentView);
@@ -13,8 +15,6 @@ PlayerController::PlayerController(std::shared_ptr<IView> parentView)
             playerView = std::make_shared<PlayerView>();
         }
     }
-    mutex = SDL_CreateMutex();
-    condition = SDL_CreateCond();
 }
 
 PlayerController::~PlayerController() {
@@ -33,50 +33,20 @@ bool PlayerController::initialize() {
 
     // Create music Thread
     musicThread = SDL_CreateThread(musicThreadFunc, "MusicThread", this);
-
-    // Create display Thread
-    updateViewThread = SDL_CreateThread(updateViewThreadFunc, "ViewThread", this);
     
     return true;
 }
 
-int PlayerController::updateViewThreadFunc(void* data){
-    PlayerController* self = static_cast<PlayerController*>(data);
-
-    while(self->isRunning){
-        SDL_LockMutex(self->mutex);
-
-        // Wait for the signal if not displaying but still running
-        while(self->isRunning && !self->isDisplaying) {
-            SDL_CondWait(self->condition, self->mutex);
-        }
-        
-        // Break if app is about to end
-        if(!self->isRunning) {
-            SDL_UnlockMutex(self->mutex);
-            break;
-        }
-        
-        // Update view if both flags are set
-        if(self->isRunning && self->isDisplaying) {
-            // Temporarily unlock while updating
-            SDL_UnlockMutex(self->mutex);
-            
-            self->updatePlayerView();
-            SDL_Delay(500); // 500ms delay between updates
-            
-            SDL_LockMutex(self->mutex);
-        }
-        
-        SDL_UnlockMutex(self->mutex);
-    }
-    return 0;
-}
-
 int PlayerController::musicThreadFunc(void *data){
     PlayerController* self = static_cast<PlayerController*>(data);
+    Trace::setThreadName("music");
+    Metrics::Histogram& commandLatency = Metrics::histogram("mbp_command_seconds",
+        "Time from a player command (play, pause, next...) to the music thread finishing it");
     
     while(!self->stopMusicThread){
+        // Commands issued from here on are handled in this pass
+        int64_t issuedAt = self->commandIssuedAt.exchange(0);
+
         // Reload playlist if a new "Play" command is executed
         if(self->loadNewSource && self->playMusic){
             self->audioService.loadAndPlay(self->audioState.getCurrentTrack().getFilePath());
@@ -90,7 +60,7 @@ int PlayerController::musicThreadFunc(void *data){
             }
 
             // Update View
-            self->updatePlayerView();
+            self->requestViewUpdate();
         }
 
         // Toggle play/pause when toggleState flag triggered
@@ -115,7 +85,7 @@ int PlayerController::musicThreadFunc(void *data){
             }
 
             // Update View
-            self->updatePlayerView();
+            self->requestViewUpdate();
 
             // Reset flag when done
             self->toggleState = false;
@@ -143,7 +113,7 @@ int PlayerController::musicThreadFunc(void *data){
             }
 
             // Update View
-            self->updatePlayerView();
+            self->requestViewUpdate();
 
             // Reset flag when done
             self->nextMusic = false;
@@ -172,12 +142,30 @@ int PlayerController::musicThreadFunc(void *data){
                 self->stopMusic = true;
             }
 
-            self->updatePlayerView();
+            self->requestViewUpdate();
 
             // Reset flag when done
             self->preMusic = false;
         }
 
+        // Jump within the current track when seekMusic flag triggered
+        if(self->seekMusic){
+            self->seekMusic = false;
+            bool moved;
+            {
+                // The position timer is read under this lock by getStateSnapshot()
+                std::lock_guard<std::mutex> lock(self->audioStateMutex);
+                moved = self->audioState.getPlayerState() != Constants::PlayerState::STOPPED &&
+                        self->audioService.setPosition(self->seekPosition);
+            }
+            if (!moved) {
+                self->playerView->flashMessage("Can't seek in this track");
+            }
+
+            // Update View
+            self->requestViewUpdate();
+        }
+
         // Stop music when flag playMusic reset
         if(self->stopMusic){
             // Reset play flag
@@ -200,54 +188,44 @@ int PlayerController::musicThreadFunc(void *data){
             self->audioState.setCurrentPosition(0.0);
 
             // Update View
-            self->updatePlayerView();
+            self->requestViewUpdate();
 
             // Reset stop flag when done
             self->stopMusic = false;
         }
 
-        // Execute while loop once per 500ms
-        SDL_Delay(500);
+        if (issuedAt != 0) {
+            int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+            commandLatency.observe(std::chrono::steady_clock::duration(now - issuedAt));
+        }
+
+        // Sleep until a command arrives or 500ms pass (to detect end of track)
+        std::unique_lock<std::mutex> lock(self->commandMutex);
+        self->commandCondition.wait_for(lock, std::chrono::milliseconds(500), [self] {
+            return self->stopMusicThread || self->toggleState || self->nextMusic ||
+                   self->preMusic || self->stopMusic || self->loadNewSource || self->seekMusic;
+        });
     }
     return 0;
 }
 
 void PlayerController::cleanup() {
-
-    // Stop display thread
-    SDL_LockMutex(mutex);
-    isRunning = false;
     isDisplaying = false;
-    SDL_CondSignal(condition); // Signal thread to check condition
-    SDL_UnlockMutex(mutex);
-
-    if(updateViewThread != nullptr) {
-        SDL_WaitThread(updateViewThread, nullptr); // Wait for thread to end
-        updateViewThread = nullptr;
-    }
 
     // Stop music thread
     stopMusicThread = true;
+    notifyMusicThread();
 
     if (musicThread != nullptr) {
         SDL_WaitThread(musicThread, nullptr);  // Wait for thread to end
         musicThread = nullptr;  // reset pointer
     }
     
-    // Stop playing music and clean up
+    // Stop playing music and clean up (the waveform decoder and the spectrum tap need the mixer until they stop)
     stop();
+    waveformService.stop();
+    spectrumAnalyzer.stop();
     audioService.cleanup();
-
-    // Clean up synchronization objects
-    if(condition != nullptr) {
-        SDL_DestroyCond(condition);
-        condition = nullptr;
-    }
-
-    if(mutex != nullptr) {
-        SDL_DestroyMutex(mutex);
-        mutex = nullptr;
-    }
 }
 
 bool PlayerController::playPlaylist() {
@@ -273,28 +251,63 @@ bool PlayerController::playPlaylist() {
     // Set playerState to Playing
     audioState.setPlayerState(Constants::PlayerState::PLAYING);
 
+    notifyMusicThread();
     return true;
 }
 
+bool PlayerController::playPlaylist(const Playlist& playlist, int startIndex) {
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        audioState.setCurrentPlaylist(playlist);
+        audioState.setCurrentTrackIndex(startIndex);
+    }
+    return playPlaylist();
+}
+
 void PlayerController::togglePlayPause() {
-    std::lock_guard<std::mutex> lock(audioStateMutex);
-    toggleState = true;
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        toggleState = true;
+    }
+    notifyMusicThread();
 }
 
 void PlayerController::stop() {
-    std::lock_guard<std::mutex> lock(audioStateMutex);
-    playMusic = false;
-    stopMusic = true;
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        playMusic = false;
+        stopMusic = true;
+    }
+    notifyMusicThread();
 }
 
 void PlayerController::next() {
-    std::lock_guard<std::mutex> lock(audioStateMutex);
-    nextMusic = true;
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        nextMusic = true;
+    }
+    notifyMusicThread();
 }
 
 void PlayerController::previous() {
-    std::lock_guard<std::mutex> lock(audioStateMutex);
-    preMusic = true;
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        preMusic = true;
+    }
+    notifyMusicThread();
+}
+
+bool PlayerController::seek(double position) {
+    {
+        std::lock_guard<std::mutex> lock(audioStateMutex);
+        if (audioState.getPlayerState() == Constants::PlayerState::STOPPED) {
+            return false;
+        }
+        seekPosition = position;
+        seekMusic = true;
+    }
+    notifyMusicThread();
+    return true;
 }
 
 void PlayerController::setVolume(int volume) {
@@ -316,26 +329,49 @@ void PlayerController::decreaseVolume() {
 }
 
 void PlayerController::showPlayer() {
-    // Start View Thread
-    SDL_LockMutex(mutex);
     isDisplaying = true;
-    SDL_CondSignal(condition);
-    SDL_UnlockMutex(mutex);
-    
+
+    // Single keypresses without Enter; falls back to line input when stdin isn't a TTY
+    terminalInput.enableRawMode();
+    if (showSpectrum && !spectrumAnalyzer.start()) {
+        showSpectrum = false;
+    }
+    updatePlayerView();
+
+    auto nextRender = std::chrono::steady_clock::now() + std::chrono::milliseconds(Constants::PLAYER_REFRESH_MS);
+    auto nextSpectrum = std::chrono::steady_clock::now() + std::chrono::milliseconds(Constants::SPECTRUM_REFRESH_MS);
     bool continueRunning = true;
     while (continueRunning) {
-        // Get user input for controls
-        std::string input = playerView->getInput("");
-        
-        if (input.empty()) {
-            // Update player view again
+        // Sleep until a key, a redraw request or the next render tick (the spectrum's, if shown)
+        auto now = std::chrono::steady_clock::now();
+        auto wakeAt = showSpectrum ? std::min(nextRender, nextSpectrum) : nextRender;
+        int timeoutMs = static_cast<int>(std::max<long long>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - now).count()));
+
+        char key = 0;
+        TerminalInput::Event event = terminalInput.waitForEvent(timeoutMs, key);
+
+        if (event == TerminalInput::Event::TIMEOUT && showSpectrum && std::chrono::steady_clock::now() < nextRender) {
+            drawSpectrum(true);
+            nextSpectrum = std::chrono::steady_clock::now() + std::chrono::milliseconds(Constants::SPECTRUM_REFRESH_MS);
+            continue;
+        }
+
+        if (event == TerminalInput::Event::TIMEOUT || event == TerminalInput::Event::WAKE) {
+            if (libraryRefresh) {
+                libraryRefresh();
+            }
             updatePlayerView();
+            nextRender = std::chrono::steady_clock::now() + std::chrono::milliseconds(Constants::PLAYER_REFRESH_MS);
+            nextSpectrum = std::chrono::steady_clock::now() + std::chrono::milliseconds(Constants::SPECTRUM_REFRESH_MS);
             continue;
         }
+
+        if (event == TerminalInput::Event::CLOSED) {
+            key = 'Q';
+        }
         
-        char key = std::toupper(input[0]);
-        
-        switch (key) {
+        switch (std::toupper(static_cast<unsigned char>(key))) {
             case ' ': // Space - Play/Pause
                 togglePlayPause();
                 break;
@@ -354,17 +390,28 @@ void PlayerController::showPlayer() {
                 
             case '+': // Volume up
                 increaseVolume();
+                updatePlayerView();
                 break;
                 
             case '-': // Volume down
                 decreaseVolume();
+                updatePlayerView();
+                break;
+                
+            case 'V': // Spectrum on/off
+                if (showSpectrum) {
+                    spectrumAnalyzer.stop();
+                    showSpectrum = false;
+                } else if (spectrumAnalyzer.start()) {
+                    showSpectrum = true;
+                } else {
+                    playerView->flashMessage("Spectrum not available");
+                }
+                updatePlayerView();
                 break;
                 
             case 'Q': // Quit player view
                 continueRunning = false;
-                SDL_LockMutex(mutex);
-                isDisplaying = false;
-                SDL_UnlockMutex(mutex);
                 break;
                 
             default:
@@ -372,22 +419,100 @@ void PlayerController::showPlayer() {
                 break;
         }
     }
+
+    isDisplaying = false;
+    spectrumAnalyzer.stop();
+    terminalInput.disableRawMode();
 }
 
 void PlayerController::updatePlayerView() {
     std::lock_guard<std::mutex> lock(audioStateMutex);
     audioState.setCurrentPosition(audioService.getCurrentPosition());
+    updateWaveform();
     playerView->displayPlayer(audioState);
+    if (showSpectrum) {
+        drawSpectrum(false);
+    }
+}
+
+void PlayerController::drawSpectrum(bool inPlace) {
+    SpectrumAnalyzer::Frame frame = spectrumAnalyzer.getFrame();
+    playerView->displaySpectrum(frame.bands, frame.level, frame.peak, inPlace);
+}
+
+void PlayerController::updateWaveform() {
+    if (!audioState.hasValidTrack()) {
+        playerView->setWaveform(nullptr);
+        return;
+    }
+    
+    std::string path = audioState.getCurrentTrack().getFilePath();
+    if (path != waveformTrack) {
+        // The current track first, then the ones likely to play next
+        std::vector<std::string> paths;
+        const Playlist& playlist = audioState.getCurrentPlaylist();
+        for (size_t i = audioState.getCurrentTrackIndex();
+             i < playlist.getTrackCount() && paths.size() <= Constants::WAVEFORM_PREFETCH_TRACKS; ++i) {
+            MediaFile track = playlist.getTrack(i);
+            if (track.getType() != Constants::FileType::VIDEO) {
+                paths.push_back(track.getFilePath());
+            }
+        }
+        // Tried again on the next update if the worker held the queue
+        if (waveformService.request(paths)) {
+            waveformTrack = path;
+        }
+    }
+    playerView->setWaveform(waveformService.getPeaks(path));
 }
 
 AudioState& PlayerController::getAudioState() {
     return audioState;
 }
 
+PlayerSnapshot PlayerController::getStateSnapshot() {
+    std::lock_guard<std::mutex> lock(audioStateMutex);
+
+    PlayerSnapshot snapshot;
+    snapshot.state = audioState.getPlayerState();
+    snapshot.volume = audioState.getVolume();
+    snapshot.position = 0.0;
+    snapshot.duration = 0.0;
+
+    if (audioState.hasValidTrack()) {
+        const MediaFile& track = audioState.getCurrentTrack();
+        snapshot.title = track.getMetadata().getName();
+        snapshot.duration = track.getMetadata().getDuration();
+        if (snapshot.state != Constants::PlayerState::STOPPED) {
+            snapshot.position = audioService.getCurrentPosition();
+        }
+    }
+    return snapshot;
+}
+
 bool PlayerController::isPlaying() const {
     return audioState.getPlayerState() == Constants::PlayerState::PLAYING;
 }
 
 bool PlayerController::_isDisplaying() const {
     return isDisplaying;
-}
\ No newline at end of file
+}
+
+void PlayerController::setLibraryRefresh(const std::function<bool()>& refresh) {
+    libraryRefresh = refresh;
+}
+
+void PlayerController::notifyMusicThread() {
+    int64_t idle = 0;
+    commandIssuedAt.compare_exchange_strong(idle, std::chrono::steady_clock::now().time_since_epoch().count());
+    
+    // Take the lock so the wake-up can't slip in between the predicate check and the wait
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commandCondition.notify_one();
+}
+
+void PlayerController::requestViewUpdate() {
+    if (isDisplaying) {
+        terminalInput.wakeUp();
+    }
+}
@@ -33,11 +33,12 @@ void PlaylistController::setMediaLibrary(MediaLibrary& mediaLib) {
 
 void PlaylistController::showPlaylists() {
     while(true){
-        const auto& playlists = playlistManager->getPlaylists();
+        refreshLibrary();
+        const auto& playlists = playlistManager->getPlaylistHeaders();
         
         playlistView->displayPlaylists(playlists);
         
-        int choice = playlistView->getMenuChoice(0, 5);
+        int choice = playlistView->getMenuChoice(0, 8);
         
         switch (choice) {
             case 1: { // View playlist
@@ -100,7 +101,7 @@ void PlaylistController::showPlaylists() {
                 try {
                     int index = std::stoi(indexStr) - 1; // Convert to 0-based index
                     if (index >= 0 && index < static_cast<int>(playlists.size())) {
-                        Playlist playlist = playlistManager->getPlaylist(index);
+                        const Playlist& playlist = playlistManager->getPlaylist(index);
                         playerController->getAudioState().setCurrentPlaylist(playlist);
                         playerController->getAudioState().setCurrentTrackIndex(0);
                         playerController->getAudioState().setPlayerState(Constants::PlayerState::PLAYING);
@@ -118,6 +119,31 @@ void PlaylistController::showPlaylists() {
                 break;
             }
                 
+            case 6: // Import playlist
+                importPlaylist();
+                break;
+                
+            case 7: { // Export playlist
+                std::string indexStr = playlistView->getInput("Enter playlist number to export: ");
+                try {
+                    int index = std::stoi(indexStr) - 1; // Convert to 0-based index
+                    if (index >= 0 && index < static_cast<int>(playlists.size())) {
+                        exportPlaylist(index);
+                    } else {
+                        playlistView->displayError("Invalid playlist number");
+                        playlistView->waitForInput();
+                    }
+                } catch (const std::exception& e) {
+                    playlistView->displayError("Invalid input");
+                    playlistView->waitForInput();
+                }
+                break;
+            }
+                
+            case 8: // Smart playlists
+                showSmartPlaylists();
+                break;
+                
             case 0: // Back to main menu
                 return;
         }
@@ -125,10 +151,8 @@ void PlaylistController::showPlaylists() {
 }
 
 void PlaylistController::showPlaylist(size_t index, int page) {
-    const Playlist& playlist = playlistManager->getPlaylist(index);
-
     // Calculate total pages
-    int totalPages = calculateTotalPages(playlist);
+    int totalPages = calculateTotalPages(playlistManager->getPlaylist(index));
 
     // Ensure page is valid
     if (page < 0) page = 0;
@@ -137,7 +161,13 @@ void PlaylistController::showPlaylist(size_t index, int page) {
     currentPage = page;
 
     while(true){
+        refreshLibrary();
         try {
+            // Fetched again each time: edits below may have changed or unloaded it
+            const Playlist& playlist = playlistManager->getPlaylist(index);
+            totalPages = calculateTotalPages(playlist);
+            if (currentPage >= totalPages) currentPage = totalPages - 1;
+            
             // Display playlist with pagination
             playlistView->displayPlaylist(playlist, currentPage);
             
@@ -184,7 +214,7 @@ void PlaylistController::showPlaylist(size_t index, int page) {
                                 const MediaFile& track = playlist.getTrack(trackIndex);
                                     int mediaIndex = mediaController->MediaFileExists(track);
                                     if (mediaIndex != -1) {
-                                        mediaController->showMediaFileDetailsInPlaylist(mediaIndex, index);
+                                        mediaController->showMediaFileDetailsInPlaylist(mediaIndex, index, trackIndex);
                                     } else {
                                         playlistView->displayError("Media file not found in library");
                                     }
@@ -276,11 +306,11 @@ void PlaylistController::createPlaylist() {
 
 void PlaylistController::editPlaylist(size_t index) {
     try {
-        Playlist playlist = playlistManager->getPlaylist(index);
+        const Playlist& playlist = playlistManager->getPlaylist(index);
         
         playlistView->displayPlaylistEditMenu(playlist);
         
-        int choice = playlistView->getMenuChoice(0, 5);
+        int choice = playlistView->getMenuChoice(0, 7);
         
         switch (choice) {
             case 1: { // Rename playlist
@@ -302,8 +332,7 @@ void PlaylistController::editPlaylist(size_t index) {
                     return;
                 }
                 
-                playlist.setName(newName);
-                playlistManager->updatePlaylist(index, playlist);
+                playlistManager->renamePlaylist(index, newName);
                 savePlaylists();
                 
                 playlistView->displayMessage("Playlist renamed successfully");
@@ -312,10 +341,8 @@ void PlaylistController::editPlaylist(size_t index) {
             }
                 
             case 2: { // Add tracks
-                // Show media library for selection
-                playlistView->displayMessage("Showing media library for track selection");
-                
-                // Get media files
+                // Get media files (not refreshed again while the list below is open)
+                refreshLibrary();
                 const auto& files = mediaLibrary->getRoot().getTracks();
                 
                 if (files.empty()) {
@@ -324,42 +351,21 @@ void PlaylistController::editPlaylist(size_t index) {
                     break;
                 }
                 
-                // Display simple list of files
-                playlistView->clearScreen();
-                playlistView->displayMessage("Available Media Files:");
+                // Page through the library for selection
+                int fileIndex = pickTrack(files, "Available Media Files",
+                                          "\nEnter file number to add (0 to cancel): ");
                 
-                for (size_t i = 0; i < files.size(); i++) {
-                    playlistView->displayMessage(std::to_string(i + 1) + ". " + files[i].getMetadata().getName());
+                if (fileIndex == -1) {
+                    // User cancelled
+                    break;
                 }
                 
-                std::string fileIndexStr = playlistView->getInput("\nEnter file number to add (0 to cancel): ");
+                // Add the track to the playlist
+                playlistManager->addTrack(index, files[fileIndex]);
+                savePlaylists();
                 
-                try {
-                    int fileIndex = std::stoi(fileIndexStr) - 1; // Convert to 0-based index
-                    
-                    if (fileIndex == -1) {
-                        // User cancelled
-                        break;
-                    }
-                    
-                    if (fileIndex >= 0 && fileIndex < static_cast<int>(files.size())) {
-                        // Add the track to the playlist
-                        playlist.addTrack(files[fileIndex]);
-                        
-                        // Update the playlist
-                        playlistManager->updatePlaylist(index, playlist);
-                        savePlaylists();
-                        
-                        playlistView->displayMessage("Track added to playlist");
-                        playlistView->waitForInput();
-                    } else {
-                        playlistView->displayError("Invalid file number");
-                        playlistView->waitForInput();
-                    }
-                } catch (const std::exception& e) {
-                    playlistView->displayError("Invalid input");
-                    playlistView->waitForInput();
-                }
+                playlistView->displayMessage("Track added to playlist");
+                playlistView->waitForInput();
                 break;
             }
                 
@@ -370,43 +376,21 @@ void PlaylistController::editPlaylist(size_t index) {
                     break;
                 }
                 
-                // Display simple list of tracks
-                playlistView->clearScreen();
-                playlistView->displayMessage("Tracks in Playlist:");
+                // Page through the playlist for selection
+                int trackIndex = pickTrack(playlist.getTracks(), "Tracks in Playlist",
+                                           "\nEnter track number to remove (0 to cancel): ");
                 
-                const auto& tracks = playlist.getTracks();
-                for (size_t i = 0; i < tracks.size(); i++) {
-                    playlistView->displayMessage(std::to_string(i + 1) + ". " + tracks[i].getMetadata().getName());
+                if (trackIndex == -1) {
+                    // User cancelled
+                    break;
                 }
                 
-                std::string trackIndexStr = playlistView->getInput("\nEnter track number to remove (0 to cancel): ");
+                // Remove the track from the playlist
+                playlistManager->removeTrack(index, trackIndex);
+                savePlaylists();
                 
-                try {
-                    int trackIndex = std::stoi(trackIndexStr) - 1; // Convert to 0-based index
-                    
-                    if (trackIndex == -1) {
-                        // User cancelled
-                        break;
-                    }
-                    
-                    if (trackIndex >= 0 && trackIndex < static_cast<int>(tracks.size())) {
-                        // Remove the track from the playlist
-                        playlist.removeTrack(trackIndex);
-                        
-                        // Update the playlist
-                        playlistManager->updatePlaylist(index, playlist);
-                        savePlaylists();
-                        
-                        playlistView->displayMessage("Track removed from playlist");
-                        playlistView->waitForInput();
-                    } else {
-                        playlistView->displayError("Invalid track number");
-                        playlistView->waitForInput();
-                    }
-                } catch (const std::exception& e) {
-                    playlistView->displayError("Invalid input");
-                    playlistView->waitForInput();
-                }
+                playlistView->displayMessage("Track removed from playlist");
+                playlistView->waitForInput();
                 break;
             }
                 
@@ -417,52 +401,31 @@ void PlaylistController::editPlaylist(size_t index) {
                     break;
                 }
                 
-                // Display simple list of tracks
-                playlistView->clearScreen();
-                playlistView->displayMessage("Tracks in Playlist:");
-                
+                // Page through the playlist for selection
                 const auto& tracks = playlist.getTracks();
-                for (size_t i = 0; i < tracks.size(); i++) {
-                    playlistView->displayMessage(std::to_string(i + 1) + ". " + tracks[i].getMetadata().getName());
+                int fromIndex = pickTrack(tracks, "Tracks in Playlist",
+                                          "\nEnter track number to move (0 to cancel): ");
+                
+                if (fromIndex == -1) {
+                    // User cancelled
+                    break;
                 }
                 
-                std::string fromIndexStr = playlistView->getInput("\nEnter track number to move (0 to cancel): ");
+                std::string toIndexStr = playlistView->getInput("Enter new position (1-" + 
+                                                              std::to_string(tracks.size()) + "): ");
                 
                 try {
-                    int fromIndex = std::stoi(fromIndexStr) - 1; // Convert to 0-based index
-                    
-                    if (fromIndex == -1) {
-                        // User cancelled
-                        break;
-                    }
+                    int toIndex = std::stoi(toIndexStr) - 1; // Convert to 0-based index
                     
-                    if (fromIndex >= 0 && fromIndex < static_cast<int>(tracks.size())) {
-                        std::string toIndexStr = playlistView->getInput("Enter new position (1-" + 
-                                                                      std::to_string(tracks.size()) + "): ");
+                    if (toIndex >= 0 && toIndex < static_cast<int>(tracks.size())) {
+                        // Move the track
+                        playlistManager->moveTracks(index, {{static_cast<size_t>(fromIndex), static_cast<size_t>(toIndex)}});
+                        savePlaylists();
                         
-                        try {
-                            int toIndex = std::stoi(toIndexStr) - 1; // Convert to 0-based index
-                            
-                            if (toIndex >= 0 && toIndex < static_cast<int>(tracks.size())) {
-                                // Move the track
-                                playlist.moveTrack(fromIndex, toIndex);
-                                
-                                // Update the playlist
-                                playlistManager->updatePlaylist(index, playlist);
-                                savePlaylists();
-                                
-                                playlistView->displayMessage("Track moved successfully");
-                                playlistView->waitForInput();
-                            } else {
-                                playlistView->displayError("Invalid position");
-                                playlistView->waitForInput();
-                            }
-                        } catch (const std::exception& e) {
-                            playlistView->displayError("Invalid input");
-                            playlistView->waitForInput();
-                        }
+                        playlistView->displayMessage("Track moved successfully");
+                        playlistView->waitForInput();
                     } else {
-                        playlistView->displayError("Invalid track number");
+                        playlistView->displayError("Invalid position");
                         playlistView->waitForInput();
                     }
                 } catch (const std::exception& e) {
@@ -476,10 +439,7 @@ void PlaylistController::editPlaylist(size_t index) {
                 std::string confirm = playlistView->getInput("Are you sure you want to clear this playlist? (y/n): ");
                 
                 if (confirm == "y" || confirm == "Y") {
-                    playlist.clear();
-                    
-                    // Update the playlist
-                    playlistManager->updatePlaylist(index, playlist);
+                    playlistManager->clearPlaylist(index);
                     savePlaylists();
                     
                     playlistView->displayMessage("Playlist cleared");
@@ -488,9 +448,28 @@ void PlaylistController::editPlaylist(size_t index) {
                 break;
             }
                 
+            case 6: // Undo
+                if (playlistManager->undo(index)) {
+                    savePlaylists();
+                    playlistView->displayMessage("Last change undone");
+                } else {
+                    playlistView->displayError("Nothing to undo");
+                }
+                playlistView->waitForInput();
+                break;
+                
+            case 7: // Redo
+                if (playlistManager->redo(index)) {
+                    savePlaylists();
+                    playlistView->displayMessage("Change redone");
+                } else {
+                    playlistView->displayError("Nothing to redo");
+                }
+                playlistView->waitForInput();
+                break;
+                
             case 0: // Save and return
-                // Ensure the playlist is saved
-                playlistManager->updatePlaylist(index, playlist);
+                // Every change is already queued; make sure it is written
                 savePlaylists();
                 break;
         }
@@ -524,19 +503,151 @@ void PlaylistController::deletePlaylist(size_t index) {
     }
 }
 
-void PlaylistController::addTrackToPlaylist(size_t playlistIndex, size_t mediaFileIndex) {
+void PlaylistController::showSmartPlaylists() {
+    while (true) {
+        refreshLibrary();
+        // Cheap when the library hasn't changed: only new or edited entries are re-checked
+        playlistManager->refreshSmartPlaylists(*mediaLibrary);
+        const auto& smartPlaylists = playlistManager->getSmartPlaylists();
+        
+        playlistView->displaySmartPlaylists(smartPlaylists);
+        
+        int choice = playlistView->getMenuChoice(0, 4);
+        if (choice == 0) {
+            return;
+        }
+        
+        if (choice == 2) { // Create
+            std::string name = playlistView->getInput("Enter smart playlist name: ");
+            if (name.empty()) {
+                playlistView->displayError("Playlist name cannot be empty");
+                playlistView->waitForInput();
+                continue;
+            }
+            
+            std::string rule = playlistView->getInput("Enter rule: ");
+            std::string error;
+            if (playlistManager->addSmartPlaylist(name, rule, error)) {
+                playlistView->displayMessage("Smart playlist created");
+            } else {
+                playlistView->displayError(error);
+            }
+            playlistView->waitForInput();
+            continue;
+        }
+        
+        std::string indexStr = playlistView->getInput("Enter smart playlist number: ");
+        try {
+            int index = std::stoi(indexStr) - 1; // Convert to 0-based index
+            if (index < 0 || index >= static_cast<int>(smartPlaylists.size())) {
+                playlistView->displayError("Invalid playlist number");
+                playlistView->waitForInput();
+                continue;
+            }
+            
+            if (choice == 4) { // Delete
+                playlistManager->deleteSmartPlaylist(index);
+                continue;
+            }
+            
+            Playlist playlist = playlistManager->evaluateSmartPlaylist(index, *mediaLibrary);
+            
+            if (choice == 1) { // Play
+                if (playlist.isEmpty()) {
+                    playlistView->displayError("No tracks match this rule");
+                    playlistView->waitForInput();
+                    continue;
+                }
+                playerController->getAudioState().setCurrentPlaylist(playlist);
+                playerController->getAudioState().setCurrentTrackIndex(0);
+                playerController->getAudioState().setPlayerState(Constants::PlayerState::PLAYING);
+                playerController->playPlaylist();
+                playlistView->displayMessage("Playing smart playlist: " + playlist.getName());
+            } else { // Save as regular playlist
+                playlist.setName(playlistManager->makeUniqueName(playlist.getName()));
+                playlistManager->addPlaylist(playlist);
+                savePlaylists();
+                playlistView->displayMessage("Saved " + std::to_string(playlist.getTrackCount()) +
+                                             " tracks as playlist '" + playlist.getName() + "'");
+            }
+            playlistView->waitForInput();
+            
+        } catch (const std::exception& e) {
+            playlistView->displayError("Invalid input");
+            playlistView->waitForInput();
+        }
+    }
+}
+
+void PlaylistController::importPlaylist() {
+    std::string path = playlistView->getInput("Enter path of .m3u/.m3u8/.pls file: ");
+    if (path.empty()) {
+        return;
+    }
+    
+    if (playlistFormatService.detectFormat(path) == PlaylistFormatService::Format::UNKNOWN) {
+        playlistView->displayError("Unsupported playlist format (use .m3u, .m3u8 or .pls)");
+        playlistView->waitForInput();
+        return;
+    }
+    
+    // Entries are matched against the scanned library by path, so known tracks keep their tags
+    std::shared_ptr<MediaLibrary> library = mediaLibrary;
+    Playlist::TrackResolver resolver = [library](uint64_t trackId, const std::string& filePath) {
+        return library ? library->resolveTrack(trackId, filePath) : MediaFile(filePath);
+    };
+    
+    Playlist playlist;
+    if (!playlistFormatService.importPlaylist(path, resolver, playlist)) {
+        playlistView->displayError("Could not read playlist: " + path);
+        playlistView->waitForInput();
+        return;
+    }
+    
+    playlist.setName(playlistManager->makeUniqueName(playlist.getName()));
+    playlistManager->addPlaylist(playlist);
+    savePlaylists();
+    
+    playlistView->displayMessage("Imported " + std::to_string(playlist.getTrackCount()) +
+                                 " tracks into playlist '" + playlist.getName() + "'");
+    playlistView->waitForInput();
+}
+
+void PlaylistController::exportPlaylist(size_t index) {
     try {
-        // Get the playlist
-        Playlist playlist = playlistManager->getPlaylist(playlistIndex);
+        const Playlist& playlist = playlistManager->getPlaylist(index);
+        
+        std::string path = playlistView->getInput("Enter output file (.m3u, .m3u8 or .pls) [" +
+                                                  playlist.getName() + ".m3u8]: ");
+        if (path.empty()) {
+            path = playlist.getName() + ".m3u8";
+        }
+        
+        if (playlistFormatService.detectFormat(path) == PlaylistFormatService::Format::UNKNOWN) {
+            playlistView->displayError("Unsupported playlist format (use .m3u, .m3u8 or .pls)");
+        } else if (playlistFormatService.exportPlaylist(playlist, path)) {
+            playlistView->displayMessage("Exported " + std::to_string(playlist.getTrackCount()) +
+                                         " tracks to " + path);
+        } else {
+            playlistView->displayError("Could not write " + path);
+        }
+        playlistView->waitForInput();
         
+    } catch (const std::exception& e) {
+        playlistView->displayError("Error exporting playlist: " + std::string(e.what()));
+        playlistView->waitForInput();
+    }
+}
+
+void PlaylistController::addTrackToPlaylist(size_t playlistIndex, size_t mediaFileIndex) {
+    try {
         // Get the media file
         const MediaFile& mediaFile = mediaLibrary->getMediaFile(mediaFileIndex);
         
         // Add the track to the playlist
-        playlist.addTrack(mediaFile);
-        
-        // Update the playlist
-        playlistManager->updatePlaylist(playlistIndex, playlist);
+        if (!playlistManager->addTrack(playlistIndex, mediaFile)) {
+            throw std::out_of_range("Playlist index out of range");
+        }
         savePlaylists();
         
         playlistView->displayMessage("Track added to playlist");
@@ -550,14 +661,10 @@ void PlaylistController::addTrackToPlaylist(size_t playlistIndex, size_t mediaFi
 
 void PlaylistController::removeTrackFromPlaylist(size_t playlistIndex, size_t trackIndex) {
     try {
-        // Get the playlist
-        Playlist playlist = playlistManager->getPlaylist(playlistIndex);
-        
         // Remove the track
-        playlist.removeTrack(trackIndex);
-        
-        // Update the playlist
-        playlistManager->updatePlaylist(playlistIndex, playlist);
+        if (!playlistManager->removeTrack(playlistIndex, trackIndex)) {
+            throw std::out_of_range("Track index out of range");
+        }
         savePlaylists();
         
         playlistView->displayMessage("Track removed from playlist");
@@ -570,18 +677,18 @@ void PlaylistController::removeTrackFromPlaylist(size_t playlistIndex, size_t tr
 }
 
 void PlaylistController::moveTrackInPlaylist(size_t playlistIndex, size_t fromIndex, size_t toIndex) {
+    moveTracksInPlaylist(playlistIndex, {{fromIndex, toIndex}});
+}
+
+void PlaylistController::moveTracksInPlaylist(size_t playlistIndex, const std::vector<Playlist::TrackMove>& moves) {
     try {
-        // Get the playlist
-        Playlist playlist = playlistManager->getPlaylist(playlistIndex);
-        
-        // Move the track
-        playlist.moveTrack(fromIndex, toIndex);
-        
-        // Update the playlist
-        playlistManager->updatePlaylist(playlistIndex, playlist);
+        // Each move is O(log n) on the resident playlist and one journal record
+        if (!playlistManager->moveTracks(playlistIndex, moves)) {
+            throw std::out_of_range("Invalid playlist or track position");
+        }
         savePlaylists();
         
-        playlistView->displayMessage("Track moved successfully");
+        playlistView->displayMessage(moves.size() == 1 ? "Track moved successfully" : "Tracks moved successfully");
         playlistView->waitForInput();
         
     } catch (const std::exception& e) {
@@ -601,15 +708,24 @@ void PlaylistController::handlePlaylistMenuOption(int option) {
             showPlaylists();
             break;
             
-        case 3: { // Import playlist
-            playlistView->displayMessage("Playlist import functionality not implemented");
-            playlistView->waitForInput();
+        case 3: // Import playlist
+            importPlaylist();
             break;
-        }
             
         case 4: { // Export playlist
-            playlistView->displayMessage("Playlist export functionality not implemented");
-            playlistView->waitForInput();
+            std::string indexStr = playlistView->getInput("Enter playlist number to export: ");
+            try {
+                int index = std::stoi(indexStr) - 1; // Convert to 0-based index
+                if (index >= 0 && index < static_cast<int>(playlistManager->getPlaylistCount())) {
+                    exportPlaylist(index);
+                } else {
+                    playlistView->displayError("Invalid playlist number");
+                    playlistView->waitForInput();
+                }
+            } catch (const std::exception& e) {
+                playlistView->displayError("Invalid input");
+                playlistView->waitForInput();
+            }
             break;
         }
             
@@ -626,6 +742,14 @@ std::shared_ptr<PlaylistManager>& PlaylistController::getPlaylistManager() {
     return playlistManager;
 }
 
+void PlaylistController::setLibraryRefresh(const std::function<bool()>& refresh) {
+    libraryRefresh = refresh;
+}
+
+bool PlaylistController::refreshLibrary() {
+    return libraryRefresh && libraryRefresh();
+}
+
 int PlaylistController::calculateTotalPages(const Playlist& playlist) const {
     int totalTracks = playlist.getTrackCount();
     return static_cast<int>(std::ceil(static_cast<double>(totalTracks) / Constants::ITEMS_PER_PAGE));
@@ -639,6 +763,54 @@ void PlaylistController::showPlaylistOptionsMenu() {
     handlePlaylistMenuOption(choice);
 }
 
+int PlaylistController::pickTrack(const Playlist::TrackList& tracks, const std::string& title,
+                                  const std::string& prompt) {
+    ListWindow window;
+    window.setSource(tracks.size(),
+        [&tracks](size_t i) { return PlaylistView::formatTrackEntry(tracks[i], static_cast<int>(i)); },
+        [&tracks](size_t i) { return tracks[i].getMetadata().getName(); });
+    
+    while (true) {
+        playlistView->displayTrackPicker(title, window);
+        
+        std::string input = playlistView->getInput(prompt);
+        if (input.empty()) {
+            continue;
+        }
+        
+        char choice = std::toupper(static_cast<unsigned char>(input[0]));
+        
+        if (choice == 'P') {
+            window.previousPage();
+            continue;
+        } else if (choice == 'N') {
+            window.nextPage();
+            continue;
+        } else if (choice == 'J') {
+            std::string letter = input.size() > 1 ? input.substr(1) : playlistView->getInput("Jump to letter: ");
+            if (letter.empty() || !window.jumpToLetter(letter[0])) {
+                playlistView->displayError("No track starts with that letter");
+                playlistView->waitForInput();
+            }
+            continue;
+        }
+        
+        try {
+            int number = std::stoi(input);
+            if (number == 0) {
+                return -1;
+            }
+            if (number >= 1 && number <= static_cast<int>(tracks.size())) {
+                return number - 1; // Convert to 0-based index
+            }
+            playlistView->displayError("Invalid track number");
+        } catch (const std::exception& e) {
+            playlistView->displayError("Invalid input");
+        }
+        playlistView->waitForInput();
+    }
+}
+
 void PlaylistController::loadPlaylists() {
     playlistManager->loadPlaylists(Constants::PLAYLISTS_DIR);
 }
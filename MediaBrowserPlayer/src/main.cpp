@@ -1,15 +1,48 @@
 #include "../include/controllers/ApplicationController.h"
+#include "../include/controllers/DaemonController.h"
+#include "../include/controllers/CliController.h"
 #include <iostream>
 #include <filesystem>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <csignal>
+#include <vector>
+#include <string>
 
 // Forward declaration of signal handler
 void signalHandler(int signal);
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Batch subcommands (scan, index build, search, playlist export): print results and exit
+    if (argc > 1 && CliController::isSubcommand(argv[1])) {
+        CliController cli(argv[0], std::vector<std::string>(argv + 1, argv + argc));
+        return cli.run();
+    }
+
+    // Headless mode for kiosks: MediaBrowserPlayer --daemon DIRECTORY [--socket PATH]
+    if (argc > 1 && std::strcmp(argv[1], "--daemon") == 0) {
+        std::string directory;
+        std::string socketPath = DaemonController::getDefaultSocketPath();
+        for (int i = 2; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+                socketPath = argv[++i];
+            } else if (directory.empty()) {
+                directory = argv[i];
+            } else {
+                directory.clear();
+                break;
+            }
+        }
+        if (directory.empty()) {
+            std::cerr << "Usage: " << argv[0] << " --daemon DIRECTORY [--socket PATH]" << std::endl;
+            return 2;
+        }
+
+        DaemonController daemon(directory, socketPath);
+        return daemon.run();
+    }
+
     ApplicationController app;
     
     // Run the application
@@ -1,4 +1,5 @@
 #include "../../include/models/AudioState.h"
+#include "../../include/utils/Metrics.h"
 #include <stdexcept>
 
 AudioState::AudioState() 
@@ -44,7 +45,9 @@ Constants::PlayerState AudioState::getPlayerState() const {
 }
 
 void AudioState::setPlayerState(Constants::PlayerState state) {
+    static Metrics::Gauge& playing = Metrics::gauge("mbp_player_playing", "1 while a track is playing, 0 when paused or stopped");
     playerState = state;
+    playing.set(state == Constants::PlayerState::PLAYING ? 1 : 0);
 }
 
 const MediaFile& AudioState::getCurrentTrack() const {
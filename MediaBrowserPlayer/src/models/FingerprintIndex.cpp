@@ -0,0 +1,146 @@
+#include "../../include/models/FingerprintIndex.h"
+#include "../../include/models/MediaLibrary.h"
+#include "../../include/utils/AudioFingerprint.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/Constants.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+
+namespace {
+    // Bit positions (word * 32 + bit) sampled by each LSH table; fixed so keys are reproducible
+    const std::vector<uint32_t>& getSampledBits() {
+        static const std::vector<uint32_t> positions = [] {
+            std::mt19937 random(0x6d6270u);
+            std::uniform_int_distribution<uint32_t> position(0, Constants::FINGERPRINT_LSH_WORDS * 32 - 1);
+            std::vector<uint32_t> result(Constants::FINGERPRINT_LSH_TABLES * Constants::FINGERPRINT_LSH_BITS);
+            for (auto& bit : result) {
+                bit = position(random);
+            }
+            return result;
+        }();
+        return positions;
+    }
+
+    size_t findRoot(std::vector<size_t>& parent, size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+}
+
+FingerprintIndex::FingerprintIndex() {
+}
+
+const std::vector<uint32_t>* FingerprintIndex::find(const std::string& filePath) const {
+    auto it = entries.find(MediaFile::computeTrackId(filePath));
+    if (it == entries.end() || it->second.path != filePath) {
+        return nullptr;
+    }
+    FileStamp stamp;
+    if (!FileStamp::read(filePath, stamp) || stamp != it->second.stamp) {
+        return nullptr;
+    }
+    return &it->second.words;
+}
+
+void FingerprintIndex::store(const std::string& filePath, const FileStamp& stamp, std::vector<uint32_t> fingerprint) {
+    Entry& entry = entries[MediaFile::computeTrackId(filePath)];
+    entry.path = filePath;
+    entry.stamp = stamp;
+    entry.words = std::move(fingerprint);
+}
+
+void FingerprintIndex::relink(const std::string& oldPath, const std::string& newPath, const FileStamp& stamp) {
+    auto it = entries.find(MediaFile::computeTrackId(oldPath));
+    if (it == entries.end() || it->second.path != oldPath) {
+        return;
+    }
+    std::vector<uint32_t> words = std::move(it->second.words);
+    entries.erase(it);
+    store(newPath, stamp, std::move(words));
+}
+
+size_t FingerprintIndex::size() const {
+    return entries.size();
+}
+
+void FingerprintIndex::clear() {
+    entries.clear();
+}
+
+std::vector<std::vector<size_t>> FingerprintIndex::findDuplicates(const MediaLibrary& library) const {
+    TRACE_ZONE("fingerprint.findDuplicates");
+
+    // Library entries with a usable fingerprint; shorter ones (< ~6 s) are left out
+    std::vector<size_t> rows;
+    std::vector<const std::vector<uint32_t>*> prints;
+    Playlist::TrackList files = library.getRoot().getTracks();
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i].getType() != Constants::FileType::AUDIO) {
+            continue;
+        }
+        const std::vector<uint32_t>* words = find(files[i].getFilePath());
+        if (words && words->size() >= Constants::FINGERPRINT_LSH_WORDS) {
+            rows.push_back(i);
+            prints.push_back(words);
+        }
+    }
+
+    std::vector<size_t> parent(rows.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::unordered_set<uint64_t> compared;
+    const std::vector<uint32_t>& sampled = getSampledBits();
+    std::unordered_map<uint32_t, std::vector<size_t>> buckets;
+
+    for (size_t table = 0; table < Constants::FINGERPRINT_LSH_TABLES; ++table) {
+        const uint32_t* bits = sampled.data() + table * Constants::FINGERPRINT_LSH_BITS;
+        buckets.clear();
+        for (size_t i = 0; i < prints.size(); ++i) {
+            const std::vector<uint32_t>& words = *prints[i];
+            uint32_t key = 0;
+            for (size_t b = 0; b < Constants::FINGERPRINT_LSH_BITS; ++b) {
+                key = (key << 1) | ((words[bits[b] / 32] >> (bits[b] % 32)) & 1u);
+            }
+            buckets[key].push_back(i);
+        }
+
+        for (const auto& bucket : buckets) {
+            const std::vector<size_t>& members = bucket.second;
+            if (members.size() < 2 || members.size() > Constants::FINGERPRINT_LSH_MAX_BUCKET) {
+                continue;
+            }
+            for (size_t x = 0; x < members.size(); ++x) {
+                for (size_t y = x + 1; y < members.size(); ++y) {
+                    size_t a = members[x];
+                    size_t b = members[y];
+                    if (findRoot(parent, a) == findRoot(parent, b) ||
+                        !compared.insert(static_cast<uint64_t>(a) << 32 | b).second) {
+                        continue;
+                    }
+                    if (AudioFingerprint::compare(*prints[a], *prints[b]) <= Constants::FINGERPRINT_MAX_BIT_ERROR) {
+                        parent[findRoot(parent, b)] = findRoot(parent, a);
+                    }
+                }
+            }
+        }
+    }
+
+    // Members are visited in row order, so groups and their entries come out sorted
+    std::map<size_t, std::vector<size_t>> groupsByRoot;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        groupsByRoot[findRoot(parent, i)].push_back(rows[i]);
+    }
+    std::vector<std::vector<size_t>> groups;
+    for (auto& group : groupsByRoot) {
+        if (group.second.size() > 1) {
+            groups.push_back(std::move(group.second));
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+    return groups;
+}
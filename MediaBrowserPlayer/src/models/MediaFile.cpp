@@ -1,6 +1,7 @@
 #include "../../include/models/MediaFile.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
 #include <filesystem>
-#include <sstream>
 #include <algorithm>
 
 MediaFile::MediaFile() : type(Constants::FileType::UNKNOWN) {
@@ -45,30 +46,59 @@ std::string MediaFile::getFileName() const {
     return std::filesystem::path(filePath).filename().string();
 }
 
+uint64_t MediaFile::getTrackId() const {
+    return computeTrackId(filePath);
+}
+
+uint64_t MediaFile::computeTrackId(const std::string& filePath) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : filePath) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 bool MediaFile::exists() const {
     return std::filesystem::exists(filePath);
 }
 
 std::string MediaFile::toString() const {
-    std::stringstream ss;
-    ss << filePath << "|" << static_cast<int>(type) << "|" << metadata.toString();
-    return ss.str();
+    std::string out;
+    RecordWriter writer(out);
+    write(writer);
+    return out;
 }
 
 MediaFile MediaFile::fromString(const std::string& serialized) {
-    std::stringstream ss(serialized);
-    std::string path, metadataStr;
-    int typeInt;
-    
-    std::getline(ss, path, '|');
-    ss >> typeInt;
-    ss.ignore(); // Skip the '|'
-    std::getline(ss, metadataStr);
+    RecordReader reader(serialized);
+    MediaFile file;
+    if (reader.nextRecord()) {
+        read(reader, file);
+    }
+    return file;
+}
+
+void MediaFile::write(RecordWriter& writer) const {
+    writer.field(filePath);
+    writer.field(static_cast<long long>(type));
+    metadata.write(writer);
+}
+
+bool MediaFile::read(RecordReader& reader, MediaFile& file) {
+    std::string_view path;
+    if (!reader.nextField(path)) {
+        return false;
+    }
+    file.filePath.assign(path.data(), path.size());
     
-    Constants::FileType type = static_cast<Constants::FileType>(typeInt);
-    Metadata metadata = Metadata::fromString(metadataStr);
+    long long typeInt = static_cast<long long>(Constants::FileType::UNKNOWN);
+    if (!reader.nextNumber(typeInt)) {
+        return false;
+    }
+    file.type = static_cast<Constants::FileType>(typeInt);
     
-    return MediaFile(path, metadata, type);
+    return Metadata::read(reader, file.metadata);
 }
 
 Constants::FileType MediaFile::determineFileType(const std::string& filePath) {
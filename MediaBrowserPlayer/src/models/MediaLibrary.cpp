@@ -1,56 +1,272 @@
 #include "../../include/models/MediaLibrary.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
 #include <taglib/fileref.h>
 #include <taglib/audioproperties.h>
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/FileStamp.h"
+#include "../../include/utils/ContentSignature.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
 #include <algorithm>
 #include <stdexcept>
 #include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <unordered_set>
+
+namespace {
+    // One media file found by a scan, in directory order
+    struct ScanEntry {
+        std::string path;
+        Constants::FileType type = Constants::FileType::UNKNOWN;
+        Metadata metadata;
+        FileStamp stamp;
+        bool stamped = false;
+        uint64_t signature = 0;
+        uint64_t indexSignature = 0; // Signature the index lists for this path, to be confirmed
+        std::string movedFrom;      // Known file this one was recognised as, if any
+    };
+    
+    // Directory that index paths are relative to ("music/" and "music" give the same root)
+    std::filesystem::path getIndexRoot(const std::string& directoryPath) {
+        std::filesystem::path dir(directoryPath);
+        if (!dir.has_filename() && dir.has_parent_path()) {
+            dir = dir.parent_path();
+        }
+        return dir;
+    }
+    
+    // Whether a file still has the stamp recorded for it. A scan here saw the exact time;
+    // an index was built elsewhere and copies often keep only whole seconds
+    bool sameStamp(const FileStamp& recorded, bool fromIndex, const FileStamp& stamp) {
+        if (!fromIndex) {
+            return recorded == stamp;
+        }
+        return recorded.size == stamp.size && recorded.modified / 1000000000LL == stamp.modified / 1000000000LL;
+    }
+    
+    // Call work(service, i) for i = 0..count-1 on up to jobs new threads (the first
+    // uses service, the others their own). The caller joins the returned threads
+    std::vector<std::thread> startWorkers(size_t count, unsigned jobs, MetadataService& service,
+                                          const std::function<void(MetadataService&, size_t)>& work) {
+        auto next = std::make_shared<std::atomic<size_t>>(0);
+        auto drain = [count, next, work](MetadataService& reader) {
+            for (size_t i = (*next)++; i < count; i = (*next)++) {
+                work(reader, i);
+            }
+        };
+        
+        size_t threadCount = std::min<size_t>(std::max(jobs, 1u), count);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threadCount; ++t) {
+            workers.emplace_back([drain, &service, t] {
+                Trace::setThreadName("scan-worker");
+                if (t == 0) {
+                    drain(service);
+                } else {
+                    MetadataService reader;
+                    drain(reader);
+                }
+            });
+        }
+        return workers;
+    }
+}
 
 MediaLibrary::MediaLibrary() {
     root.setName("root");
 }
 
-void MediaLibrary::scanDirectory(const std::string& directoryPath, bool recursive) {
+void MediaLibrary::scanDirectory(const std::string& directoryPath, bool recursive, unsigned jobs,
+                                 const std::function<void(const MediaFile&)>& onAdded) {
+    TRACE_ZONE("library.scanDirectory");
+    static Metrics::Counter& scannedFiles = Metrics::counter("mbp_library_scanned_files_total", "Files examined by library scans");
+    static Metrics::Counter& indexHits = Metrics::counter("mbp_library_index_hits_total", "Scanned files whose tags came from the library index");
+    static Metrics::Counter& movedCount = Metrics::counter("mbp_library_moved_files_total", "Scanned files recognised by content as moved or renamed");
+    static Metrics::Histogram& scanTime = Metrics::histogram("mbp_library_scan_seconds", "Duration of library scans");
+    Metrics::ScopedTimer timer(scanTime);
 
     // Xem directory co ton tai khong?
     if (!std::filesystem::exists(directoryPath)) {
         return;
     }
     
-    std::filesystem::path dir(directoryPath);
+    std::filesystem::path dir = getIndexRoot(directoryPath);
+    
+    // Pre-built tags and signatures shipped with the directory
+    loadIndex((dir / Constants::LIBRARY_INDEX_FILE).string(), dir.string());
+    
+    // Walk the whole tree first, so the slow part (hashing, tag parsing) can be spread over threads
+    std::vector<ScanEntry> found;
+    std::vector<size_t> unknown;
+    auto visit = [&](const std::filesystem::directory_entry& entry) {
+        if (!entry.is_regular_file()) {
+            return;
+        }
+        scannedFiles.add();
+        std::string path = entry.path().string();
+        Constants::FileType type = metadataService.detectMediaType(path);
+        
+        // Check if the file is a valid media file
+        if (type == Constants::FileType::UNKNOWN) {
+            return;
+        }
+        
+        ScanEntry file;
+        file.path = path;
+        file.type = type;
+        file.stamped = FileStamp::read(path, file.stamp);
+        auto known = knownFiles.find(path);
+        if (file.stamped && known != knownFiles.end() && sameStamp(known->second.stamp, known->second.fromIndex, file.stamp)) {
+            indexHits.add();
+            file.metadata = known->second.metadata;
+            file.signature = known->second.signature;
+        } else {
+            // Index entry of the same size but another time: the signature decides below
+            if (file.stamped && known != knownFiles.end() && known->second.fromIndex &&
+                known->second.stamp.size == file.stamp.size) {
+                file.indexSignature = known->second.signature;
+            }
+            unknown.push_back(found.size());
+        }
+        found.push_back(std::move(file));
+    };
     
     try {
         if (recursive) {
             for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
-                if (entry.is_regular_file()) {
-                    std::string path = entry.path().string();
-                    Metadata scanMetadata = metadataService.extractMetadata(path);
-                    Constants::FileType type = metadataService.detectMediaType(path);
-                    MediaFile file(path, scanMetadata, type);
-
-                    // Check if the file is a valid media file
-                    if (file.getType() != Constants::FileType::UNKNOWN) {
-                        root.addTrack(file);
-                    }
-                }
+                visit(entry);
             }
         }
         else {
             for (const auto& entry : std::filesystem::directory_iterator(dir)) {
-                if (entry.is_regular_file()) {
-                    std::string path = entry.path().string();
-                    Metadata scanMetadata = metadataService.extractMetadata(path);
-                    Constants::FileType type = metadataService.detectMediaType(path);
-                    MediaFile file(path, scanMetadata, type);
-                    
-                    // Check if the file is a valid media file
-                    if (file.getType() != Constants::FileType::UNKNOWN) {
-                        root.addTrack(file);
-                    }
-                }
+                visit(entry);
             }
         }
     } catch (const std::filesystem::filesystem_error& e) {
-        // Handle filesystem errors
+        // Handle filesystem errors: keep the files found so far
+    }
+    
+    // New or changed paths: a known signature whose old path is gone means the file
+    // moved. Its audio is unchanged; its tags are too unless the size or modification
+    // time differs (a retag that fits in the tag's padding keeps the size)
+    auto readEntry = [this, &found](MetadataService& reader, size_t index) {
+        ScanEntry& file = found[index];
+        file.signature = ContentSignature::compute(file.path);
+        
+        if (file.indexSignature != 0 && file.signature == file.indexSignature) {
+            indexHits.add();
+            file.metadata = knownFiles.at(file.path).metadata;
+            return;
+        }
+        
+        auto match = file.signature ? signatureIndex.find(file.signature) : signatureIndex.end();
+        if (match != signatureIndex.end() && match->second != file.path) {
+            std::error_code error;
+            auto known = knownFiles.find(match->second);
+            if (known != knownFiles.end() && !std::filesystem::exists(match->second, error) && !error) {
+                file.movedFrom = match->second;
+                if (sameStamp(known->second.stamp, known->second.fromIndex, file.stamp)) {
+                    file.metadata = known->second.metadata;
+                    return;
+                }
+            }
+        }
+        
+        try {
+            file.metadata = reader.extractMetadata(file.path);
+        } catch (const std::exception& e) {
+            // Keep the file listed under its name, as an untagged file would be
+            file.metadata = Metadata(std::filesystem::path(file.path).filename().string());
+        }
+    };
+    
+    // Workers read tags while this thread adds finished files in directory order, so
+    // onAdded sees the first files long before the last ones are read
+    std::vector<char> ready(found.size(), 1);
+    for (size_t index : unknown) {
+        ready[index] = 0;
+    }
+    std::mutex readyMutex;
+    std::condition_variable readyCondition;
+    std::vector<std::thread> workers = startWorkers(unknown.size(), jobs, metadataService,
+        [&](MetadataService& reader, size_t i) {
+            readEntry(reader, unknown[i]);
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready[unknown[i]] = 1;
+            readyCondition.notify_all();
+        });
+    
+    std::unordered_set<std::string> claimed;
+    for (size_t i = 0; i < found.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCondition.wait(lock, [&ready, i] { return ready[i] != 0; });
+        }
+        ScanEntry& file = found[i];
+        
+        // Two copies of a moved file: the first one found takes over the old entry
+        if (!file.movedFrom.empty() && claimed.insert(file.movedFrom).second) {
+            movedCount.add();
+            movedFiles.emplace_back(file.movedFrom, file.path);
+            removeMediaFile(file.movedFrom);
+            fingerprints.relink(file.movedFrom, file.path, file.stamp);
+        } else {
+            file.movedFrom.clear();
+        }
+        addMediaFile(MediaFile(file.path, file.metadata, file.type));
+        if (onAdded) {
+            onAdded(root.getTracks().back());
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    // Workers look files up in knownFiles, so it only changes once they are done
+    for (const auto& file : found) {
+        if (!file.movedFrom.empty()) {
+            knownFiles.erase(file.movedFrom);
+        }
+        if (file.stamped) {
+            KnownFile& known = knownFiles[file.path];
+            known.stamp = file.stamp;
+            known.signature = file.signature;
+            known.metadata = file.metadata;
+            known.fromIndex = false;
+            if (file.signature) {
+                signatureIndex[file.signature] = file.path;
+            }
+        }
+    }
+    
+    // Forget files below dir that are gone and weren't found moved, so knownFiles
+    // doesn't grow with every file ever deleted
+    std::unordered_set<std::string> seen;
+    for (const auto& file : found) {
+        seen.insert(file.path);
+    }
+    std::string prefix = (dir / "").string();
+    for (auto known = knownFiles.begin(); known != knownFiles.end();) {
+        std::error_code error;
+        if (known->first.compare(0, prefix.size(), prefix) != 0 || seen.count(known->first) ||
+            std::filesystem::exists(known->first, error) || error) {
+            ++known;
+            continue;
+        }
+        auto entry = signatureIndex.find(known->second.signature);
+        if (entry != signatureIndex.end() && entry->second == known->first) {
+            signatureIndex.erase(entry);
+        }
+        known = knownFiles.erase(known);
     }
 }
 
@@ -64,7 +280,7 @@ const Playlist& MediaLibrary::getRoot() const {
 
 std::vector<MediaFile> MediaLibrary::getMediaFilesByType(Constants::FileType type) const {
     std::vector<MediaFile> result;
-    std::vector<MediaFile> mediaFiles = root.getTracks();
+    Playlist::TrackList mediaFiles = root.getTracks();
     
     for (const auto& file : mediaFiles) {
         if (file.getType() == type) {
@@ -77,7 +293,7 @@ std::vector<MediaFile> MediaLibrary::getMediaFilesByType(Constants::FileType typ
 
 std::vector<MediaFile> MediaLibrary::searchMediaFiles(const std::string& query) const {
     std::vector<MediaFile> result;
-    std::vector<MediaFile> mediaFiles = root.getTracks();
+    Playlist::TrackList mediaFiles = root.getTracks();
     std::string lowerQuery = query;
     std::transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
     
@@ -94,7 +310,7 @@ std::vector<MediaFile> MediaLibrary::searchMediaFiles(const std::string& query)
 }
 
 MediaFile MediaLibrary::getMediaFile(size_t index) const {
-    std::vector<MediaFile> mediaFiles = root.getTracks();
+    Playlist::TrackList mediaFiles = root.getTracks();
     if (index < mediaFiles.size()) {
         return mediaFiles[index];
     }
@@ -105,19 +321,227 @@ size_t MediaLibrary::getMediaFileCount() const {
     return root.getTracks().size();
 }
 
+const MediaFile* MediaLibrary::findByTrackId(uint64_t trackId) const {
+    auto it = trackIndex.find(trackId);
+    if (it == trackIndex.end()) {
+        return nullptr;
+    }
+    return &root.getTracks()[it->second];
+}
+
+const MediaFile* MediaLibrary::findByPath(const std::string& filePath) const {
+    const MediaFile* file = findByTrackId(MediaFile::computeTrackId(filePath));
+    
+    // Guard against a hash collision
+    if (file && file->getFilePath() != filePath) {
+        return nullptr;
+    }
+    return file;
+}
+
+int MediaLibrary::findIndexByPath(const std::string& filePath) const {
+    const MediaFile* file = findByPath(filePath);
+    if (!file) {
+        return -1;
+    }
+    return static_cast<int>(trackIndex.at(file->getTrackId()));
+}
+
+MediaFile MediaLibrary::resolveTrack(uint64_t trackId, const std::string& filePath) const {
+    const MediaFile* file = findByTrackId(trackId);
+    if (file && file->getFilePath() == filePath) {
+        return *file;
+    }
+    
+    // Not scanned (yet): keep the entry playable with what the path tells us
+    return MediaFile(filePath);
+}
+
+std::vector<std::pair<std::string, std::string>> MediaLibrary::takeMovedFiles() {
+    std::vector<std::pair<std::string, std::string>> moves;
+    moves.swap(movedFiles);
+    return moves;
+}
+
 void MediaLibrary::clear() {
     root.clear();
+    trackIndex.clear();
+    catalog.clear();
 }
 
 void MediaLibrary::addMediaFile(const MediaFile& file) {
+    // The first copy of a path wins, later duplicates are still listed
+    trackIndex.emplace(file.getTrackId(), root.getTrackCount());
+    catalog.setRow(root.getTrackCount(), file);
     root.addTrack(file);
 }
 
 bool MediaLibrary::updateMediaFileMetadata(size_t index, const Metadata& metadata) {
-    std::vector<MediaFile> mediaFiles = root.getTracks();
-    if (index < mediaFiles.size()) {
-        mediaFiles[index].setMetadata(metadata);
+    if (index < root.getTrackCount()) {
+        MediaFile file = root.getTrack(index);
+        file.setMetadata(metadata);
+        root.setTrack(index, file);
+        catalog.setRow(index, file);
         return true;
     }
     return false;
 }
+
+bool MediaLibrary::addOrUpdateMediaFile(const MediaFile& file) {
+    int index = findIndexByPath(file.getFilePath());
+    if (index < 0) {
+        addMediaFile(file);
+        return true;
+    }
+    root.setTrack(index, file);
+    catalog.setRow(index, file);
+    return false;
+}
+
+bool MediaLibrary::removeMediaFile(const std::string& filePath) {
+    int index = findIndexByPath(filePath);
+    if (index < 0) {
+        return false;
+    }
+    removeAt(index);
+    return true;
+}
+
+size_t MediaLibrary::removeDirectory(const std::string& directoryPath) {
+    std::string prefix = directoryPath;
+    if (prefix.empty() || prefix.back() != '/') {
+        prefix += '/';
+    }
+    
+    // Back to front: the entry moved into a freed slot has already been checked
+    size_t removed = 0;
+    for (size_t i = root.getTrackCount(); i-- > 0;) {
+        if (root.getTracks()[i].getFilePath().compare(0, prefix.size(), prefix) == 0) {
+            removeAt(i);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+void MediaLibrary::removeAt(size_t index) {
+    size_t last = root.getTrackCount() - 1;
+    
+    auto entry = trackIndex.find(root.getTracks()[index].getTrackId());
+    if (entry != trackIndex.end() && entry->second == index) {
+        trackIndex.erase(entry);
+    }
+    
+    if (index != last) {
+        MediaFile moved = root.getTrack(last);
+        root.setTrack(index, moved);
+        catalog.setRow(index, moved);
+        
+        auto movedEntry = trackIndex.find(moved.getTrackId());
+        if (movedEntry != trackIndex.end() && movedEntry->second == last) {
+            movedEntry->second = index;
+        }
+    }
+    root.removeTrack(last);
+    catalog.removeLastRow();
+}
+
+long long MediaLibrary::saveIndex(const std::string& directoryPath, const std::string& indexPath) const {
+    std::filesystem::path dir = getIndexRoot(directoryPath);
+    
+    std::string contents;
+    Playlist::TrackList mediaFiles = root.getTracks();
+    contents.reserve(64 + mediaFiles.size() * 128);
+    RecordWriter writer(contents);
+    contents += std::string(Constants::LIBRARY_INDEX_MAGIC) + " " + std::to_string(Constants::LIBRARY_INDEX_VERSION) + "\n";
+    
+    // One "<size>|<modified>|<signature>|<relative path>|<type>|<metadata...>" record per file
+    long long count = 0;
+    for (const auto& file : mediaFiles) {
+        std::filesystem::path relative = std::filesystem::path(file.getFilePath()).lexically_relative(dir);
+        FileStamp stamp;
+        
+        // Files outside the directory, or gone since the scan, could never be matched
+        if (relative.empty() || *relative.begin() == ".." || !FileStamp::read(file.getFilePath(), stamp)) {
+            continue;
+        }
+        auto known = knownFiles.find(file.getFilePath());
+        writer.field(stamp.size);
+        writer.field(stamp.modified);
+        writer.hexField(known != knownFiles.end() && known->second.stamp == stamp ? known->second.signature : 0);
+        MediaFile(relative.string(), file.getMetadata(), file.getType()).write(writer);
+        writer.endRecord();
+        count++;
+    }
+    
+    // Temp file and rename, so a device never sees a half-written index
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            std::remove(tempPath.c_str());
+            return -1;
+        }
+    }
+    if (std::rename(tempPath.c_str(), indexPath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return -1;
+    }
+    return count;
+}
+
+bool MediaLibrary::loadIndex(const std::string& indexPath, const std::string& directoryPath) {
+    MappedFile mapping;
+    if (!mapping.open(indexPath)) {
+        return false;
+    }
+    
+    // Version 1 indexes have no signature field; before version 3 videos were
+    // listed without probing, so their duration and resolution are never reused
+    RecordReader reader(mapping.data());
+    std::string magic = std::string(Constants::LIBRARY_INDEX_MAGIC) + " ";
+    int version = 0;
+    if (reader.nextRecord()) {
+        std::string header(reader.getRecord());
+        for (int known = 1; known <= Constants::LIBRARY_INDEX_VERSION; ++known) {
+            if (header == magic + std::to_string(known)) {
+                version = known;
+            }
+        }
+    }
+    if (version == 0) {
+        std::cerr << "Ignoring library index " << indexPath << ": unsupported format" << std::endl;
+        return false;
+    }
+    
+    std::filesystem::path dir(directoryPath);
+    while (reader.nextRecord()) {
+        KnownFile entry;
+        unsigned long long signature = 0;
+        MediaFile file;
+        if (reader.nextNumber(entry.stamp.size) && reader.nextNumber(entry.stamp.modified) &&
+            (version < 2 || reader.nextHex(signature)) && MediaFile::read(reader, file) &&
+            (version >= 3 || file.getType() != Constants::FileType::VIDEO)) {
+            entry.signature = signature;
+            entry.fromIndex = true;
+            entry.metadata = file.getMetadata();
+            std::string path = (dir / file.getFilePath()).string();
+            if (knownFiles.emplace(path, std::move(entry)).second && signature != 0) {
+                signatureIndex.emplace(signature, path);
+            }
+        }
+    }
+    return true;
+}
+
+const TrackCatalog& MediaLibrary::getCatalog() const {
+    return catalog;
+}
+
+FingerprintIndex& MediaLibrary::getFingerprints() {
+    return fingerprints;
+}
+
+const FingerprintIndex& MediaLibrary::getFingerprints() const {
+    return fingerprints;
+}
@@ -1,4 +1,6 @@
 #include "../../include/models/Metadata.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
 #include <sstream>
 #include <iomanip>
 
@@ -55,36 +57,57 @@ std::string Metadata::getDurationString() const {
 }
 
 std::string Metadata::toString() const {
-    std::stringstream ss;
-    ss << name << "|" << duration << "|" << attributes.size();
+    std::string out;
+    RecordWriter writer(out);
+    write(writer);
+    return out;
+}
+
+Metadata Metadata::fromString(const std::string& serialized) {
+    RecordReader reader(serialized);
+    Metadata metadata;
+    if (reader.nextRecord()) {
+        read(reader, metadata);
+    }
+    return metadata;
+}
+
+void Metadata::write(RecordWriter& writer) const {
+    writer.field(name);
+    writer.field(duration);
+    writer.field(static_cast<long long>(attributes.size()));
     
     for (const auto& attr : attributes) {
-        ss << "|" << attr.first << "|" << attr.second;
+        writer.field(attr.first);
+        writer.field(attr.second);
     }
-    
-    return ss.str();
 }
 
-Metadata Metadata::fromString(const std::string& serialized) {
-    std::stringstream ss(serialized);
-    std::string name;
-    double duration;
-    int attrCount;
-    
-    std::getline(ss, name, '|');
-    ss >> duration;
-    ss.ignore(); // Skip the '|'
-    ss >> attrCount;
-    ss.ignore(); // Skip the '|'
+bool Metadata::read(RecordReader& reader, Metadata& metadata) {
+    std::string_view field;
+    if (!reader.nextField(field)) {
+        return false;
+    }
+    metadata.name.assign(field.data(), field.size());
     
-    Metadata metadata(name, duration);
+    long long attrCount = 0;
+    if (!reader.nextNumber(metadata.duration) || !reader.nextNumber(attrCount)) {
+        return false;
+    }
     
-    for (int i = 0; i < attrCount; ++i) {
-        std::string key, value;
-        std::getline(ss, key, '|');
-        std::getline(ss, value, '|');
-        metadata.setAttribute(key, value);
+    // Hint-insert: attributes were written from a std::map, so they arrive sorted
+    metadata.attributes.clear();
+    for (long long i = 0; i < attrCount; ++i) {
+        // Copy the key out: the value may reuse the reader's scratch buffer
+        if (!reader.nextField(field)) {
+            return false;
+        }
+        std::string key(field);
+        if (!reader.nextField(field)) {
+            field = std::string_view();
+        }
+        metadata.attributes.emplace_hint(metadata.attributes.end(), std::move(key), std::string(field));
     }
     
-    return metadata;
+    return true;
 }
@@ -3,15 +3,37 @@
 #include <filesystem>
 #include <sstream>
 #include <stdexcept>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <charconv>
 #include "../../include/Constants.h"
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
+#include "../../include/utils/Trace.h"
 
-Playlist::Playlist() : name("New Playlist") {
+namespace {
+    // Flush a file (or directory entry table) to stable storage
+    bool syncPath(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = fsync(fd) == 0;
+        close(fd);
+        return ok;
+    }
+}
+
+Playlist::Playlist() : name("New Playlist"), generation(0), ordered(true) {
 }
 
-Playlist::Playlist(const std::string& name) : name(name) {
+Playlist::Playlist(const std::string& name) : name(name), generation(0), ordered(true) {
 }
 
-Playlist::Playlist(const std::string& name, std::vector<MediaFile> trackList) : name(name), tracks(trackList) {
+Playlist::Playlist(const std::string& name, std::vector<MediaFile> trackList)
+    : name(name), generation(0), tracks(std::move(trackList)), ordered(true) {
 }
 
 const std::string& Playlist::getName() const {
@@ -22,53 +44,135 @@ void Playlist::setName(const std::string& name) {
     this->name = name;
 }
 
+uint64_t Playlist::getGeneration() const {
+    return generation;
+}
+
+void Playlist::setGeneration(uint64_t generation) {
+    this->generation = generation;
+}
+
 void Playlist::addTrack(const MediaFile& track) {
+    if (!ordered) {
+        order.pushBack(static_cast<uint32_t>(tracks.size()));
+    }
+    tracks.push_back(track);
+}
+
+void Playlist::insertTrack(size_t index, const MediaFile& track) {
+    if (index >= getTrackCount()) {
+        addTrack(track);
+        return;
+    }
+    
+    detachOrder();
+    order.insert(index, static_cast<uint32_t>(tracks.size()));
     tracks.push_back(track);
 }
 
+void Playlist::setTrack(size_t index, const MediaFile& track) {
+    if (index < getTrackCount()) {
+        tracks[ordered ? index : order.at(index)] = track;
+    }
+}
+
 void Playlist::removeTrack(size_t index) {
-    if (index < tracks.size()) {
-        tracks.erase(tracks.begin() + index);
+    if (index >= getTrackCount()) {
+        return;
+    }
+    
+    // Dropping the last track needs no reordering
+    if (ordered && index + 1 == tracks.size()) {
+        tracks.pop_back();
+        return;
+    }
+    
+    detachOrder();
+    tracks[order.erase(index)] = MediaFile();
+    
+    // Reclaim the emptied slots once they outnumber the tracks (amortized O(1) per removal)
+    if (tracks.size() > 2 * order.size() + Constants::PLAYLIST_COMPACT_SLACK) {
+        compact();
     }
 }
 
 void Playlist::moveTrack(size_t fromIndex, size_t toIndex) {
-    if (fromIndex < tracks.size() && toIndex < tracks.size() && fromIndex != toIndex) {
-        MediaFile track = tracks[fromIndex];
-        tracks.erase(tracks.begin() + fromIndex);
-        
-        if (toIndex > fromIndex) {
-            toIndex--; // Adjust for the removal
-        }
-        
-        tracks.insert(tracks.begin() + toIndex, track);
+    moveRange(fromIndex, 1, toIndex);
+}
+
+void Playlist::moveTracks(const std::vector<TrackMove>& moves) {
+    for (const auto& move : moves) {
+        moveRange(move.fromIndex, 1, move.toIndex);
+    }
+}
+
+void Playlist::moveRange(size_t first, size_t count, size_t toIndex) {
+    size_t trackCount = getTrackCount();
+    if (count == 0 || first == toIndex || first + count > trackCount || toIndex + count > trackCount) {
+        return;
     }
+    
+    detachOrder();
+    order.moveRange(first, count, toIndex);
 }
 
-const std::vector<MediaFile>& Playlist::getTracks() const {
-    return tracks;
+Playlist::TrackList Playlist::getTracks() const {
+    std::vector<uint32_t> handles;
+    if (!ordered) {
+        order.toVector(handles);
+    }
+    return TrackList(tracks, std::move(handles), ordered);
 }
 
 MediaFile Playlist::getTrack(size_t index) const {
-    if (index < tracks.size()) {
-        return tracks[index];
+    if (index < getTrackCount()) {
+        return ordered ? tracks[index] : tracks[order.at(index)];
     }
     throw std::out_of_range("Track index out of range");
 }
 
 size_t Playlist::getTrackCount() const {
-    return tracks.size();
+    return ordered ? tracks.size() : order.size();
 }
 
 bool Playlist::isEmpty() const {
-    return tracks.empty();
+    return getTrackCount() == 0;
 }
 
 void Playlist::clear() {
     tracks.clear();
+    order.clear();
+    ordered = true;
+}
+
+void Playlist::detachOrder() {
+    if (ordered) {
+        order.assignIdentity(tracks.size());
+        ordered = false;
+    }
+}
+
+void Playlist::compact() {
+    if (ordered) {
+        return;
+    }
+    
+    std::vector<uint32_t> handles;
+    order.toVector(handles);
+    
+    std::vector<MediaFile> compacted;
+    compacted.reserve(handles.size());
+    for (uint32_t handle : handles) {
+        compacted.push_back(std::move(tracks[handle]));
+    }
+    
+    tracks.swap(compacted);
+    order.clear();
+    ordered = true;
 }
 
 bool Playlist::save(const std::string& directory) const {
+    TRACE_ZONE("playlist.save");
     std::string dir = directory.empty() ? Constants::PLAYLISTS_DIR : directory;
     
     // Create directory if it doesn't exist
@@ -76,61 +180,183 @@ bool Playlist::save(const std::string& directory) const {
         std::filesystem::create_directories(dir);
     }
     
-    std::string filename = name + Constants::PLAYLIST_EXT;
-    std::string filepath = dir + "/" + filename;
+    std::string filepath = getFilePath(dir);
+    std::string tempPath = filepath + ".tmp";
     
-    std::ofstream file(filepath);
-    if (!file.is_open()) {
-        return false;
-    }
+    // Build the whole file in memory, then write it in one go
+    std::string contents;
+    TrackList trackList = getTracks();
+    contents.reserve(64 + trackList.size() * 64);
+    RecordWriter writer(contents);
+    
+    // Format header
+    contents += std::string(Constants::PLAYLIST_MAGIC) + " " + std::to_string(Constants::PLAYLIST_FORMAT_VERSION) + "\n";
     
     // Write playlist name
-    file << name << std::endl;
+    writer.field(name);
+    writer.endRecord();
     
-    // Write number of tracks
-    file << tracks.size() << std::endl;
+    // Write number of tracks and total duration (lets a listing skip the track lines), then the generation
+    writer.field(static_cast<long long>(trackList.size()));
+    writer.endRecord();
+    writer.field(static_cast<long long>(getTotalDuration()));
+    writer.endRecord();
+    writer.field(static_cast<long long>(generation));
+    writer.endRecord();
     
-    // Write each track
-    for (const auto& track : tracks) {
-        file << track.toString() << std::endl;
+    // Write each track as "<track id>|<path>"; metadata lives in the library only
+    for (const auto& track : trackList) {
+        writer.hexField(track.getTrackId());
+        writer.field(track.getFilePath());
+        writer.endRecord();
     }
     
+    // Write a temp file and rename it over the old one, so a crash leaves either the old or the new playlist
+    std::ofstream file(tempPath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
     file.close();
+    if (file.fail() || !syncPath(tempPath) || std::rename(tempPath.c_str(), filepath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    syncPath(dir);
     return true;
 }
 
-Playlist Playlist::load(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
+std::string Playlist::getFilePath(const std::string& directory) const {
+    std::string dir = directory.empty() ? Constants::PLAYLISTS_DIR : directory;
+    return dir + "/" + name + Constants::PLAYLIST_EXT;
+}
+
+bool Playlist::readHeader(const std::string& filePath, PlaylistHeader& header) {
+    // Only the first page of the mapping is ever touched
+    MappedFile file;
+    if (!file.open(filePath)) {
+        throw std::runtime_error("Failed to open playlist file: " + filePath);
+    }
+    
+    RecordReader reader(file.data());
+    int version = 0;
+    if (!reader.nextRecord() || !parseFormatLine(reader.getRecord(), version)) {
+        return false;
+    }
+    
+    std::string_view field;
+    long long count = 0;
+    long long duration = 0;
+    if (!reader.nextRecord() || !reader.nextField(field)) {
+        throw std::runtime_error("Truncated playlist file: " + filePath);
+    }
+    std::string name(field);
+    if (!reader.nextRecord() || !reader.nextNumber(count) ||
+        !reader.nextRecord() || !reader.nextNumber(duration)) {
+        throw std::runtime_error("Truncated playlist file: " + filePath);
+    }
+    
+    header = PlaylistHeader(name, static_cast<size_t>(count), static_cast<double>(duration), filePath);
+    return true;
+}
+
+bool Playlist::parseFormatLine(std::string_view line, int& version) {
+    std::string_view magic = Constants::PLAYLIST_MAGIC;
+    if (line.size() <= magic.size() + 1 || line.substr(0, magic.size()) != magic || line[magic.size()] != ' ') {
+        return false;
+    }
+    
+    std::string_view number = line.substr(magic.size() + 1);
+    auto result = std::from_chars(number.data(), number.data() + number.size(), version);
+    return result.ec == std::errc();
+}
+
+PlaylistHeader Playlist::getHeader(const std::string& directory) const {
+    return PlaylistHeader(name, getTrackCount(), getTotalDuration(), getFilePath(directory));
+}
+
+Playlist Playlist::load(const std::string& filePath, const TrackResolver& resolver, bool* isLegacy) {
+    TRACE_ZONE("playlist.load");
+    // One pass over the mapped file; fields are views into it, so only the kept strings are allocated
+    MappedFile file;
+    if (!file.open(filePath)) {
         throw std::runtime_error("Failed to open playlist file: " + filePath);
     }
     
-    std::string name;
-    std::getline(file, name);
+    RecordReader reader(file.data());
+    std::string_view field;
+    if (!reader.nextRecord()) {
+        throw std::runtime_error("Empty playlist file: " + filePath);
+    }
+    
+    // Version 1 files have no header: the name is on the first line
+    int version = 1;
+    bool legacy = !parseFormatLine(reader.getRecord(), version);
+    if (isLegacy) {
+        *isLegacy = legacy;
+    }
+    if (!legacy) {
+        if (version > Constants::PLAYLIST_FORMAT_VERSION) {
+            throw std::runtime_error("Unsupported playlist format: " + filePath);
+        }
+        reader.nextRecord();
+    }
     
-    Playlist playlist(name);
+    // Legacy names were written raw; the whole line is the name
+    if (legacy) {
+        field = reader.getRecord();
+    } else {
+        reader.nextField(field);
+    }
+    Playlist playlist{std::string(field)};
     
-    size_t trackCount;
-    file >> trackCount;
-    file.ignore(); // Skip newline
+    long long trackCount = 0;
+    if (!reader.nextRecord() || !reader.nextNumber(trackCount) || trackCount < 0) {
+        throw std::runtime_error("Invalid playlist file: " + filePath);
+    }
     
-    for (size_t i = 0; i < trackCount; ++i) {
-        std::string trackStr;
-        std::getline(file, trackStr);
-        playlist.addTrack(MediaFile::fromString(trackStr));
+    if (!legacy) {
+        reader.nextRecord(); // Total duration, only needed by readHeader()
+    }
+    
+    // Version 2 files predate generations; their journals carry none either
+    long long generation = 0;
+    if (!legacy && version >= 3 && (!reader.nextRecord() || !reader.nextNumber(generation) || generation < 0)) {
+        throw std::runtime_error("Invalid playlist file: " + filePath);
+    }
+    playlist.generation = static_cast<uint64_t>(generation);
+    playlist.tracks.reserve(static_cast<size_t>(trackCount));
+    
+    for (long long i = 0; i < trackCount && reader.nextRecord(); ++i) {
+        if (legacy) {
+            MediaFile track;
+            if (MediaFile::read(reader, track)) {
+                playlist.tracks.push_back(std::move(track));
+            }
+            continue;
+        }
+        
+        unsigned long long trackId = 0;
+        if (!reader.nextHex(trackId) || !reader.nextField(field)) {
+            continue;
+        }
+        std::string path(field);
+        playlist.tracks.push_back(resolver ? resolver(trackId, path) : MediaFile(path));
     }
     
-    file.close();
     return playlist;
 }
 
 std::string Playlist::toString() const {
     std::stringstream ss;
-    ss << name << " (" << tracks.size() << " tracks, " << getTotalDurationString() << ")";
+    ss << name << " (" << getTrackCount() << " tracks, " << getTotalDurationString() << ")";
     return ss.str();
 }
 
 double Playlist::getTotalDuration() const {
+    // Order doesn't matter here and emptied slots have no duration, so no need to compact
     double total = 0.0;
     for (const auto& track : tracks) {
         total += track.getMetadata().getDuration();
@@ -139,7 +365,11 @@ double Playlist::getTotalDuration() const {
 }
 
 std::string Playlist::getTotalDurationString() const {
-    int totalSeconds = static_cast<int>(getTotalDuration());
+    return formatDuration(getTotalDuration());
+}
+
+std::string Playlist::formatDuration(double totalDuration) {
+    int totalSeconds = static_cast<int>(totalDuration);
     int hours = totalSeconds / 3600;
     int minutes = (totalSeconds % 3600) / 60;
     int seconds = totalSeconds % 60;
@@ -151,3 +381,43 @@ std::string Playlist::getTotalDurationString() const {
     ss << minutes << ":" << std::setw(2) << std::setfill('0') << seconds;
     return ss.str();
 }
+
+Playlist::TrackList::TrackList(const std::vector<MediaFile>& storage, std::vector<uint32_t> handles, bool ordered)
+    : storage(&storage), handles(std::move(handles)), ordered(ordered) {
+}
+
+size_t Playlist::TrackList::size() const {
+    return ordered ? storage->size() : handles.size();
+}
+
+bool Playlist::TrackList::empty() const {
+    return size() == 0;
+}
+
+const MediaFile& Playlist::TrackList::operator[](size_t position) const {
+    return (*storage)[ordered ? position : handles[position]];
+}
+
+const MediaFile& Playlist::TrackList::back() const {
+    return (*this)[size() - 1];
+}
+
+Playlist::TrackList::Iterator Playlist::TrackList::begin() const {
+    return Iterator(this, 0);
+}
+
+Playlist::TrackList::Iterator Playlist::TrackList::end() const {
+    return Iterator(this, size());
+}
+
+std::vector<MediaFile> Playlist::TrackList::toVector() const {
+    if (ordered) {
+        return *storage;
+    }
+    std::vector<MediaFile> copy;
+    copy.reserve(handles.size());
+    for (uint32_t handle : handles) {
+        copy.push_back((*storage)[handle]);
+    }
+    return copy;
+}
@@ -0,0 +1,30 @@
+#include "../../include/models/PlaylistHeader.h"
+#include "../../include/models/Playlist.h"
+
+PlaylistHeader::PlaylistHeader() : trackCount(0), totalDuration(0.0) {
+}
+
+PlaylistHeader::PlaylistHeader(const std::string& name, size_t trackCount, double totalDuration,
+                               const std::string& filePath)
+    : name(name), trackCount(trackCount), totalDuration(totalDuration), filePath(filePath) {
+}
+
+const std::string& PlaylistHeader::getName() const {
+    return name;
+}
+
+size_t PlaylistHeader::getTrackCount() const {
+    return trackCount;
+}
+
+double PlaylistHeader::getTotalDuration() const {
+    return totalDuration;
+}
+
+std::string PlaylistHeader::getTotalDurationString() const {
+    return Playlist::formatDuration(totalDuration);
+}
+
+const std::string& PlaylistHeader::getFilePath() const {
+    return filePath;
+}
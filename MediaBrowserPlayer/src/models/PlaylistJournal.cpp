@@ -0,0 +1,256 @@
+#include "../../include/models/PlaylistJournal.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
+#include <utility>
+#include <charconv>
+
+namespace {
+    // Record layout: <kind>|<generation>|I|<position>|<track id>|<path>
+    //                <kind>|<generation>|D|<position>|<track id>|<path>
+    //                <kind>|<generation>|M|<position>|<count>|<to index>
+    // Records written before generations existed have no such field and count as generation 0
+    constexpr char OP_INSERT = 'I';
+    constexpr char OP_REMOVE = 'D';
+    constexpr char OP_MOVE = 'M';
+}
+
+PlaylistJournal::PlaylistJournal() : cursor(0), loggedCount(0) {
+}
+
+void PlaylistJournal::record(const Edit& edit) {
+    history.erase(history.begin() + cursor, history.end());
+    history.push_back(edit);
+    
+    if (history.size() > Constants::PLAYLIST_UNDO_LIMIT) {
+        history.pop_front();
+    }
+    cursor = history.size();
+}
+
+const PlaylistJournal::Edit* PlaylistJournal::undo() {
+    if (!canUndo()) {
+        return nullptr;
+    }
+    return &history[--cursor];
+}
+
+const PlaylistJournal::Edit* PlaylistJournal::redo() {
+    if (!canRedo()) {
+        return nullptr;
+    }
+    return &history[cursor++];
+}
+
+bool PlaylistJournal::canUndo() const {
+    return cursor > 0;
+}
+
+bool PlaylistJournal::canRedo() const {
+    return cursor < history.size();
+}
+
+void PlaylistJournal::clear() {
+    history.clear();
+    cursor = 0;
+}
+
+void PlaylistJournal::log(Kind kind, uint64_t generation, const Edit& edit) {
+    if (!isLoggable(edit)) {
+        return; // The caller rewrites the playlist instead
+    }
+    
+    RecordWriter writer(unsaved);
+    char code = static_cast<char>(kind);
+    writer.field(std::string_view(&code, 1));
+    writer.field(static_cast<long long>(generation));
+    
+    switch (edit.type) {
+        case Edit::Type::INSERT:
+        case Edit::Type::REMOVE:
+            code = edit.type == Edit::Type::INSERT ? OP_INSERT : OP_REMOVE;
+            writer.field(std::string_view(&code, 1));
+            writer.field(static_cast<long long>(edit.position));
+            writer.hexField(edit.track.getTrackId());
+            writer.field(edit.track.getFilePath());
+            break;
+            
+        case Edit::Type::MOVE:
+            code = OP_MOVE;
+            writer.field(std::string_view(&code, 1));
+            writer.field(static_cast<long long>(edit.position));
+            writer.field(static_cast<long long>(edit.count));
+            writer.field(static_cast<long long>(edit.toIndex));
+            break;
+            
+        default:
+            break;
+    }
+    
+    writer.endRecord();
+    loggedCount++;
+}
+
+std::string PlaylistJournal::takeUnsaved() {
+    std::string records;
+    records.swap(unsaved);
+    return records;
+}
+
+void PlaylistJournal::resetLog() {
+    unsaved.clear();
+    loggedCount = 0;
+}
+
+size_t PlaylistJournal::getLoggedCount() const {
+    return loggedCount;
+}
+
+void PlaylistJournal::apply(Playlist& playlist, const Edit& edit) {
+    switch (edit.type) {
+        case Edit::Type::INSERT:
+            playlist.insertTrack(edit.position, edit.track);
+            break;
+        case Edit::Type::REMOVE:
+            playlist.removeTrack(edit.position);
+            break;
+        case Edit::Type::MOVE:
+            playlist.moveRange(edit.position, edit.count, edit.toIndex);
+            break;
+        case Edit::Type::RENAME:
+            playlist.setName(edit.newName);
+            break;
+        case Edit::Type::REPLACE:
+            playlist.clear();
+            for (const auto& track : edit.tracks) {
+                playlist.addTrack(track);
+            }
+            break;
+    }
+}
+
+PlaylistJournal::Edit PlaylistJournal::inverse(const Edit& edit) {
+    Edit undo = edit;
+    switch (edit.type) {
+        case Edit::Type::INSERT:
+            undo.type = Edit::Type::REMOVE;
+            break;
+        case Edit::Type::REMOVE:
+            undo.type = Edit::Type::INSERT;
+            break;
+        case Edit::Type::MOVE:
+            std::swap(undo.position, undo.toIndex);
+            break;
+        case Edit::Type::RENAME:
+            std::swap(undo.oldName, undo.newName);
+            break;
+        case Edit::Type::REPLACE:
+            std::swap(undo.oldTracks, undo.tracks);
+            break;
+    }
+    return undo;
+}
+
+bool PlaylistJournal::isLoggable(const Edit& edit) {
+    return edit.type == Edit::Type::INSERT || edit.type == Edit::Type::REMOVE || edit.type == Edit::Type::MOVE;
+}
+
+std::string PlaylistJournal::getJournalPath(const std::string& playlistPath) {
+    return playlistPath + Constants::PLAYLIST_JOURNAL_EXT;
+}
+
+size_t PlaylistJournal::replay(const std::string& journalPath, Playlist& playlist,
+                               const Playlist::TrackResolver& resolver, PlaylistJournal& journal) {
+    MappedFile file;
+    if (!file.open(journalPath)) {
+        return 0;
+    }
+    
+    // Every append ends with a newline, so anything after the last one is a torn write
+    std::string_view data = file.data();
+    data = data.substr(0, data.rfind('\n') == std::string_view::npos ? 0 : data.rfind('\n') + 1);
+    
+    RecordReader reader(data);
+    std::string_view field;
+    size_t applied = 0;
+    
+    while (reader.nextRecord()) {
+        if (!reader.nextField(field) || field.size() != 1) {
+            continue;
+        }
+        char kind = field[0];
+        
+        // A digit starts the generation; old records go straight to the operation
+        uint64_t generation = 0;
+        if (!reader.nextField(field) || field.empty()) {
+            continue;
+        }
+        if (field[0] >= '0' && field[0] <= '9') {
+            auto result = std::from_chars(field.data(), field.data() + field.size(), generation);
+            if (result.ec != std::errc() || result.ptr != field.data() + field.size() || !reader.nextField(field)) {
+                continue;
+            }
+        }
+        if (field.size() != 1) {
+            continue;
+        }
+        char op = field[0];
+        
+        // Already in the playlist file, or logged on top of a save that never landed
+        if (generation != playlist.getGeneration()) {
+            continue;
+        }
+        
+        Edit edit;
+        long long position = 0;
+        if (!reader.nextNumber(position) || position < 0) {
+            continue;
+        }
+        edit.position = static_cast<size_t>(position);
+        
+        if (op == OP_INSERT || op == OP_REMOVE) {
+            unsigned long long trackId = 0;
+            if (!reader.nextHex(trackId) || !reader.nextField(field)) {
+                continue;
+            }
+            std::string path(field);
+            edit.type = op == OP_INSERT ? Edit::Type::INSERT : Edit::Type::REMOVE;
+            
+            // A removed track is still in the playlist; no need to resolve it again
+            if (edit.type == Edit::Type::REMOVE && edit.position < playlist.getTrackCount()) {
+                edit.track = playlist.getTrack(edit.position);
+            } else {
+                edit.track = resolver ? resolver(trackId, path) : MediaFile(path);
+            }
+        } else if (op == OP_MOVE) {
+            long long count = 0, toIndex = 0;
+            if (!reader.nextNumber(count) || !reader.nextNumber(toIndex) || count <= 0 || toIndex < 0) {
+                continue;
+            }
+            edit.type = Edit::Type::MOVE;
+            edit.count = static_cast<size_t>(count);
+            edit.toIndex = static_cast<size_t>(toIndex);
+        } else {
+            continue;
+        }
+        
+        apply(playlist, edit);
+        applied++;
+        
+        // The log holds what was applied; the history holds the forward edits
+        switch (static_cast<Kind>(kind)) {
+            case Kind::UNDO:
+                journal.undo();
+                break;
+            case Kind::REDO:
+                journal.redo();
+                break;
+            default:
+                journal.record(edit);
+                break;
+        }
+    }
+    
+    return applied;
+}
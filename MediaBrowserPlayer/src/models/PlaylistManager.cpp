@@ -1,64 +1,483 @@
 #include "../../include/models/PlaylistManager.h"
 #include <filesystem>
 #include <stdexcept>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include "../../include/Constants.h"
+#include "../../include/models/MediaLibrary.h"
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/RecordReader.h"
+#include "../../include/utils/RecordWriter.h"
+#include "../../include/utils/Trace.h"
 
-PlaylistManager::PlaylistManager() {
+namespace {
+    // How long the writer waits for more edits before touching the disk
+    constexpr auto WRITE_COALESCE_DELAY = std::chrono::milliseconds(200);
+
+    // Removals waiting for from to be written wait for to instead (from was renamed or deleted too)
+    void retargetRemovals(std::map<std::string, std::string>& removals, const std::string& from, const std::string& to) {
+        for (auto& removal : removals) {
+            if (removal.second == from) {
+                removal.second = to;
+            }
+        }
+    }
+}
+
+PlaylistManager::PlaylistManager()
+    : useClock(0), residentCount(0), handleClock(0), writerBusy(false), stopWriter(false), flushWaiters(0) {
+    writerThread = std::thread(&PlaylistManager::writerLoop, this);
+}
+
+PlaylistManager::~PlaylistManager() {
+    // Don't lose edits that were never explicitly saved
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopWriter = true;
+    }
+    writerCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
 }
 
-const std::vector<Playlist>& PlaylistManager::getPlaylists() const {
-    return playlists;
+const std::vector<PlaylistHeader>& PlaylistManager::getPlaylistHeaders() const {
+    return headers;
 }
 
-Playlist PlaylistManager::getPlaylist(size_t index) const {
-    if (index < playlists.size()) {
-        return playlists[index];
+const Playlist& PlaylistManager::getPlaylist(size_t index) const {
+    if (index < headers.size()) {
+        return loadBody(index);
     }
     throw std::out_of_range("Playlist index out of range");
 }
 
+const Playlist* PlaylistManager::getPlaylist(Handle handle) const {
+    size_t index;
+    if (!findIndex(handle, index)) {
+        return nullptr;
+    }
+    return &loadBody(index);
+}
+
 Playlist* PlaylistManager::getPlaylistByName(const std::string& name) {
-    for (auto& playlist : playlists) {
-        if (playlist.getName() == name) {
-            return &playlist;
-        }
+    auto it = nameIndex.find(name);
+    if (it == nameIndex.end()) {
+        return nullptr;
+    }
+    return &loadBody(slotIndices[it->second]);
+}
+
+PlaylistManager::Handle PlaylistManager::getHandle(size_t index) const {
+    Handle handle;
+    if (index < slots.size()) {
+        handle.slot = slots[index];
+        handle.generation = slotGenerations[handle.slot];
+    }
+    return handle;
+}
+
+PlaylistManager::Handle PlaylistManager::findPlaylist(const std::string& name) const {
+    auto it = nameIndex.find(name);
+    if (it == nameIndex.end()) {
+        return Handle();
     }
-    return nullptr;
+    return getHandle(slotIndices[it->second]);
 }
 
-void PlaylistManager::addPlaylist(const Playlist& playlist) {
-    playlists.push_back(playlist);
+bool PlaylistManager::findIndex(Handle handle, size_t& index) const {
+    if (!handle.isValid() || handle.slot >= slotGenerations.size() ||
+        slotGenerations[handle.slot] != handle.generation) {
+        return false;
+    }
+    index = slotIndices[handle.slot];
+    return true;
+}
+
+PlaylistManager::Handle PlaylistManager::addPlaylist(const Playlist& playlist) {
+    removedNames.erase(playlist.getName());
+    return appendPlaylist(playlist.getHeader(getStorageDir()), std::make_shared<Playlist>(playlist), true,
+                          PlaylistJournal());
+}
+
+PlaylistManager::Handle PlaylistManager::appendPlaylist(const PlaylistHeader& header, std::shared_ptr<Playlist> body,
+                                                        bool isDirty, const PlaylistJournal& journal) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slotGenerations.size());
+        slotGenerations.push_back(0);
+        slotIndices.push_back(0);
+    }
+    
+    // Generations are never reused, not even across reloads
+    slotGenerations[slot] = ++handleClock;
+    slotIndices[slot] = headers.size();
+    slots.push_back(slot);
+    nameIndex.emplace(header.getName(), slot);
+    
+    if (body) {
+        residentCount++;
+    }
+    lastUsed.push_back(body ? ++useClock : 0);
+    headers.push_back(header);
+    bodies.push_back(std::move(body));
+    dirty.push_back(isDirty);
+    journals.push_back(journal);
+    return getHandle(headers.size() - 1);
+}
+
+void PlaylistManager::unindexName(const std::string& name, uint32_t slot) {
+    auto it = nameIndex.find(name);
+    if (it == nameIndex.end() || it->second != slot) {
+        return;
+    }
+    nameIndex.erase(it);
+    
+    // Names are unique unless two files on disk carry the same one; hand the name to the other
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (slots[i] != slot && headers[i].getName() == name) {
+            nameIndex.emplace(name, slots[i]);
+            break;
+        }
+    }
 }
 
 bool PlaylistManager::updatePlaylist(size_t index, const Playlist& playlist) {
-    if (index < playlists.size()) {
-        playlists[index] = playlist;
+    if (index < headers.size()) {
+        std::string oldName = headers[index].getName();
+        if (!bodies[index]) {
+            residentCount++;
+        }
+        bodies[index] = std::make_shared<Playlist>(playlist);
+        headers[index] = playlist.getHeader(getStorageDir());
+        lastUsed[index] = ++useClock;
+        if (oldName != playlist.getName()) {
+            unindexName(oldName, slots[index]);
+            nameIndex.emplace(playlist.getName(), slots[index]);
+        }
+        dirty[index] = true;
+
+        // Replaced wholesale: old undo steps no longer fit
+        journals[index].clear();
+        journals[index].resetLog();
+
+        // A rename leaves the old file behind
+        if (oldName != playlist.getName()) {
+            scheduleRemoval(oldName, playlist.getName());
+            removedNames.erase(playlist.getName());
+        }
         return true;
     }
     return false;
 }
 
 bool PlaylistManager::deletePlaylist(size_t index) {
-    if (index < playlists.size()) {
-        playlists.erase(playlists.begin() + index);
+    if (index < headers.size()) {
+        std::string name = headers[index].getName();
+        uint32_t slot = slots[index];
+        if (bodies[index]) {
+            residentCount--;
+        }
+        headers.erase(headers.begin() + index);
+        bodies.erase(bodies.begin() + index);
+        lastUsed.erase(lastUsed.begin() + index);
+        dirty.erase(dirty.begin() + index);
+        journals.erase(journals.begin() + index);
+        slots.erase(slots.begin() + index);
+        
+        // Retire the slot and renumber the playlists that moved up
+        slotGenerations[slot] = 0;
+        freeSlots.push_back(slot);
+        for (size_t i = index; i < slots.size(); ++i) {
+            slotIndices[slots[i]] = i;
+        }
+        unindexName(name, slot);
+        scheduleRemoval(name);
         return true;
     }
     return false;
 }
 
+void PlaylistManager::markDirty(size_t index) {
+    if (index < dirty.size() && bodies[index]) {
+        headers[index] = bodies[index]->getHeader(getStorageDir());
+        dirty[index] = true;
+        
+        // Positions in the undo history may no longer match
+        journals[index].clear();
+    }
+}
+
+bool PlaylistManager::addTrack(size_t index, const MediaFile& track) {
+    if (index >= headers.size()) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit;
+    edit.type = PlaylistJournal::Edit::Type::INSERT;
+    edit.position = headers[index].getTrackCount();
+    edit.track = track;
+    return applyEdit(index, edit, PlaylistJournal::Kind::EDIT);
+}
+
+bool PlaylistManager::removeTrack(size_t index, size_t position) {
+    if (index >= headers.size() || position >= headers[index].getTrackCount()) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit;
+    edit.type = PlaylistJournal::Edit::Type::REMOVE;
+    edit.position = position;
+    edit.track = loadBody(index).getTrack(position);
+    return applyEdit(index, edit, PlaylistJournal::Kind::EDIT);
+}
+
+bool PlaylistManager::moveTracks(size_t index, const std::vector<Playlist::TrackMove>& moves) {
+    if (index >= headers.size()) {
+        return false;
+    }
+    
+    // Each move is its own undo step and journal record
+    size_t trackCount = headers[index].getTrackCount();
+    bool moved = false;
+    for (const auto& move : moves) {
+        if (move.fromIndex >= trackCount || move.toIndex >= trackCount || move.fromIndex == move.toIndex) {
+            continue;
+        }
+        
+        PlaylistJournal::Edit edit;
+        edit.type = PlaylistJournal::Edit::Type::MOVE;
+        edit.position = move.fromIndex;
+        edit.toIndex = move.toIndex;
+        moved = applyEdit(index, edit, PlaylistJournal::Kind::EDIT) || moved;
+    }
+    return moved;
+}
+
+bool PlaylistManager::renamePlaylist(size_t index, const std::string& name) {
+    if (index >= headers.size() || name.empty() ||
+        (name != headers[index].getName() && playlistExists(name))) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit;
+    edit.type = PlaylistJournal::Edit::Type::RENAME;
+    edit.oldName = headers[index].getName();
+    edit.newName = name;
+    return applyEdit(index, edit, PlaylistJournal::Kind::EDIT);
+}
+
+bool PlaylistManager::clearPlaylist(size_t index) {
+    if (index >= headers.size()) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit;
+    edit.type = PlaylistJournal::Edit::Type::REPLACE;
+    edit.oldTracks = loadBody(index).getTracks().toVector();
+    return applyEdit(index, edit, PlaylistJournal::Kind::EDIT);
+}
+
+bool PlaylistManager::undo(size_t index) {
+    if (!canUndo(index)) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit = PlaylistJournal::inverse(*journals[index].undo());
+    if (!applyEdit(index, edit, PlaylistJournal::Kind::UNDO)) {
+        journals[index].redo(); // e.g. the old name was taken in the meantime
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistManager::redo(size_t index) {
+    if (!canRedo(index)) {
+        return false;
+    }
+    
+    PlaylistJournal::Edit edit = *journals[index].redo();
+    if (!applyEdit(index, edit, PlaylistJournal::Kind::REDO)) {
+        journals[index].undo();
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistManager::canUndo(size_t index) const {
+    return index < journals.size() && journals[index].canUndo();
+}
+
+bool PlaylistManager::canRedo(size_t index) const {
+    return index < journals.size() && journals[index].canRedo();
+}
+
+bool PlaylistManager::applyEdit(size_t index, const PlaylistJournal::Edit& edit, PlaylistJournal::Kind kind) {
+    using Type = PlaylistJournal::Edit::Type;
+    
+    if (edit.type == Type::RENAME && edit.newName != headers[index].getName() && playlistExists(edit.newName)) {
+        return false;
+    }
+    
+    Playlist& playlist = loadBody(index);
+    PlaylistJournal& journal = journals[index];
+    const PlaylistHeader& header = headers[index];
+    
+    PlaylistJournal::apply(playlist, edit);
+    if (kind == PlaylistJournal::Kind::EDIT) {
+        journal.record(edit);
+    }
+    
+    // Keep the summary current without summing every track again
+    switch (edit.type) {
+        case Type::INSERT:
+        case Type::REMOVE: {
+            double duration = edit.track.getMetadata().getDuration();
+            headers[index] = PlaylistHeader(header.getName(), playlist.getTrackCount(),
+                                             header.getTotalDuration() + (edit.type == Type::INSERT ? duration : -duration),
+                                             header.getFilePath());
+            break;
+        }
+        case Type::RENAME:
+            headers[index] = playlist.getHeader(getStorageDir());
+            unindexName(edit.oldName, slots[index]);
+            nameIndex.emplace(edit.newName, slots[index]);
+            scheduleRemoval(edit.oldName, edit.newName);
+            removedNames.erase(edit.newName);
+            break;
+        default:
+            headers[index] = playlist.getHeader(getStorageDir());
+            break;
+    }
+    
+    // Small edits go to the journal; everything else, or a journal that grew too long, rewrites the file
+    if (dirty[index]) {
+        return true;
+    }
+    if (!PlaylistJournal::isLoggable(edit) || journal.getLoggedCount() >= Constants::PLAYLIST_JOURNAL_MAX_EDITS) {
+        dirty[index] = true;
+    } else {
+        journal.log(kind, playlist.getGeneration(), edit);
+    }
+    return true;
+}
+
+bool PlaylistManager::appendJournal(const std::string& journalPath, const std::string& records) {
+    int fd = open(journalPath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    
+    // One write per batch; a crash can only tear the last record, which replay ignores
+    size_t written = 0;
+    while (written < records.size()) {
+        ssize_t n = write(fd, records.data() + written, records.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    
+    bool ok = written == records.size() && fdatasync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+size_t PlaylistManager::getResidentCount() const {
+    return residentCount;
+}
+
+void PlaylistManager::scheduleRemoval(const std::string& name, const std::string& replacement) {
+    // Another playlist may still own a file with this name
+    if (!playlistExists(name)) {
+        retargetRemovals(removedNames, name, replacement);
+        removedNames[name] = replacement;
+    }
+}
+
+std::string PlaylistManager::makeUniqueName(const std::string& base) const {
+    std::string name = base;
+    for (int suffix = 2; playlistExists(name); ++suffix) {
+        name = base + " (" + std::to_string(suffix) + ")";
+    }
+    return name;
+}
+
 bool PlaylistManager::playlistExists(const std::string& name) const {
-    for (const auto& playlist : playlists) {
-        if (playlist.getName() == name) {
-            return true;
+    return nameIndex.count(name) != 0;
+}
+
+void PlaylistManager::setTrackResolver(const Playlist::TrackResolver& resolver) {
+    trackResolver = resolver;
+}
+
+size_t PlaylistManager::relinkTracks(const std::vector<std::pair<std::string, std::string>>& moves) {
+    if (moves.empty()) {
+        return 0;
+    }
+    std::unordered_map<std::string, std::string> newPaths(moves.begin(), moves.end());
+    
+    size_t relinked = 0;
+    for (size_t i = 0; i < headers.size(); ++i) {
+        Playlist& playlist = loadBody(i);
+        std::vector<size_t> positions;
+        Playlist::TrackList tracks = playlist.getTracks();
+        for (size_t position = 0; position < tracks.size(); ++position) {
+            if (newPaths.count(tracks[position].getFilePath())) {
+                positions.push_back(position);
+            }
+        }
+        
+        for (size_t position : positions) {
+            const std::string& path = newPaths[playlist.getTrack(position).getFilePath()];
+            playlist.setTrack(position, trackResolver ? trackResolver(MediaFile::computeTrackId(path), path) : MediaFile(path));
+        }
+        if (!positions.empty()) {
+            markDirty(i);
+            relinked += positions.size();
         }
     }
-    return false;
+    return relinked;
 }
 
 void PlaylistManager::loadPlaylists(const std::string& directory) {
-    playlists.clear();
+    // Don't let queued writes from the previous state land after the reload
+    flush();
+
+    headers.clear();
+    bodies.clear();
+    lastUsed.clear();
+    dirty.clear();
+    journals.clear();
+    slots.clear();
+    slotIndices.clear();
+    slotGenerations.clear();
+    freeSlots.clear();
+    nameIndex.clear();
+    removedNames.clear();
+    {
+        // Held-back removals and failed saves belong to the directory being left
+        std::lock_guard<std::mutex> lock(writerMutex);
+        deferredRemovals.clear();
+        failedWrites.clear();
+    }
+    residentCount = 0;
     
     std::string dir = directory.empty() ? Constants::PLAYLISTS_DIR : directory;
+    storageDir = dir;
+    loadSmartPlaylists();
     
     if (!std::filesystem::exists(dir)) {
         return;
@@ -69,29 +488,398 @@ void PlaylistManager::loadPlaylists(const std::string& directory) {
             std::string ext = entry.path().extension().string();
             if (ext == Constants::PLAYLIST_EXT) {
                 try {
-                    Playlist playlist = Playlist::load(entry.path().string());
-                    playlists.push_back(playlist);
+                    // Only the summary lines are read; tracks are loaded on first access
+                    std::string path = entry.path().string();
+                    std::string journalPath = PlaylistJournal::getJournalPath(path);
+                    bool hasJournal = std::filesystem::exists(journalPath);
+                    
+                    PlaylistHeader header;
+                    if (!hasJournal && Playlist::readHeader(path, header)) {
+                        appendPlaylist(header, nullptr, false, PlaylistJournal());
+                        continue;
+                    }
+                    
+                    // Old format has no summary, and logged edits must be replayed: load it fully.
+                    // Only a replayed journal queues a rewrite (which also drops the journal). Old files
+                    // embed each track's tags, which the compact format leaves to the library, so they
+                    // are converted in memory and only rewritten when the playlist itself is next saved
+                    Playlist playlist = Playlist::load(path, trackResolver);
+                    PlaylistJournal journal;
+                    if (hasJournal) {
+                        PlaylistJournal::replay(journalPath, playlist, trackResolver, journal);
+                    }
+                    appendPlaylist(playlist.getHeader(dir), std::make_shared<Playlist>(playlist), hasJournal, journal);
                 } catch (const std::exception& e) {
                     // Skip invalid playlist files
                 }
             }
         }
     }
+    
+    // Fold replayed journals back into their playlists in the background
+    savePlaylists();
 }
 
-void PlaylistManager::savePlaylists(const std::string& directory) const {
-    std::string dir = directory.empty() ? Constants::PLAYLISTS_DIR : directory;
+Playlist& PlaylistManager::loadBody(size_t index) const {
+    lastUsed[index] = ++useClock;
+    if (bodies[index]) {
+        return *bodies[index];
+    }
     
-    // Create directory if it doesn't exist
-    if (!std::filesystem::exists(dir)) {
-        std::filesystem::create_directories(dir);
+    std::shared_ptr<Playlist> body;
+    const PlaylistHeader& header = headers[index];
+    {
+        // A copy that is queued or being written is newer than the file on disk
+        std::lock_guard<std::mutex> lock(writerMutex);
+        auto pending = pendingWrites.find(header.getName());
+        if (pending != pendingWrites.end()) {
+            body = std::make_shared<Playlist>(pending->second);
+        } else {
+            auto inFlight = inFlightWrites.find(header.getName());
+            auto failed = failedWrites.find(header.getName());
+            if (inFlight != inFlightWrites.end()) {
+                body = std::make_shared<Playlist>(inFlight->second);
+            } else if (failed != failedWrites.end()) {
+                body = std::make_shared<Playlist>(failed->second);
+            }
+        }
     }
     
-    for (const auto& playlist : playlists) {
-        playlist.save(dir);
+    if (!body) {
+        try {
+            body = std::make_shared<Playlist>(Playlist::load(header.getFilePath(), trackResolver));
+        } catch (const std::exception& e) {
+            // File vanished since startup: keep the playlist, just without tracks
+            body = std::make_shared<Playlist>(header.getName());
+        }
+    }
+    
+    bodies[index] = body;
+    residentCount++;
+    evictBodies(index);
+    return *bodies[index];
+}
+
+void PlaylistManager::evictBodies(size_t keepIndex) const {
+    while (residentCount > Constants::MAX_RESIDENT_PLAYLISTS) {
+        size_t victim = headers.size();
+        for (size_t i = 0; i < headers.size(); ++i) {
+            if (bodies[i] && !dirty[i] && journals[i].getLoggedCount() == 0 && i != keepIndex &&
+                (victim == headers.size() || lastUsed[i] < lastUsed[victim])) {
+                victim = i;
+            }
+        }
+        if (victim == headers.size()) {
+            break; // Everything left is dirty, journaled or in use
+        }
+        bodies[victim].reset();
+        journals[victim].clear();
+        residentCount--;
+    }
+}
+
+std::string PlaylistManager::getStorageDir() const {
+    return storageDir.empty() ? std::string(Constants::PLAYLISTS_DIR) : storageDir;
+}
+
+void PlaylistManager::savePlaylists(const std::string& directory) {
+    std::string dir = directory.empty() ? getStorageDir() : directory;
+    
+    // Playlists whose last save failed are written again in full; the resident body, if
+    // any, already holds the failed copy plus every edit since
+    std::map<std::string, Playlist> failed;
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        failed.swap(failedWrites);
+    }
+    for (auto& entry : failed) {
+        auto found = nameIndex.find(entry.first);
+        if (found == nameIndex.end()) {
+            continue; // Deleted or renamed since; the rename already rewrites it
+        }
+        size_t index = slotIndices[found->second];
+        if (!bodies[index]) {
+            bodies[index] = std::make_shared<Playlist>(std::move(entry.second));
+            residentCount++;
+        }
+        dirty[index] = true;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        
+        pendingDir = dir;
+        
+        for (const auto& removal : removedNames) {
+            pendingWrites.erase(removal.first);
+            failedWrites.erase(removal.first);
+            pendingAppends.erase(removal.first);
+            deferredRemovals.erase(removal.first);
+            retargetRemovals(pendingRemovals, removal.first, removal.second);
+            retargetRemovals(deferredRemovals, removal.first, removal.second);
+            pendingRemovals[removal.first] = removal.second;
+        }
+        removedNames.clear();
+        pendingRemovals.insert(deferredRemovals.begin(), deferredRemovals.end());
+        deferredRemovals.clear();
+        
+        // Only changed playlists are copied and written; a newer copy replaces a queued one.
+        // The copy contains every logged edit, so records still waiting for the journal are dropped.
+        // It gets the next generation, which edits logged from now on refer to; replay skips them
+        // until that copy is on disk. Bodies are compacted first, so the queued copy is plain
+        // storage the writer only reads
+        for (size_t i = 0; i < headers.size(); ++i) {
+            const std::string& name = headers[i].getName();
+            if (dirty[i]) {
+                pendingRemovals.erase(name);
+                pendingAppends.erase(name);
+                bodies[i]->compact();
+                bodies[i]->setGeneration(bodies[i]->getGeneration() + 1);
+                pendingWrites[name] = *bodies[i];
+                journals[i].resetLog();
+                dirty[i] = false;
+            } else {
+                std::string records = journals[i].takeUnsaved();
+                if (!records.empty()) {
+                    pendingAppends[name] += records;
+                }
+            }
+        }
+    }
+    writerCondition.notify_one();
+    
+    // Saved playlists can be dropped from memory again
+    evictBodies(headers.size());
+}
+
+void PlaylistManager::flush() {
+    savePlaylists();
+    
+    std::unique_lock<std::mutex> lock(writerMutex);
+    flushWaiters++;
+    writerCondition.notify_one();
+    idleCondition.wait(lock, [this] {
+        return pendingWrites.empty() && pendingRemovals.empty() && pendingAppends.empty() && !writerBusy;
+    });
+    flushWaiters--;
+}
+
+void PlaylistManager::writerLoop() {
+    Trace::setThreadName("playlist-writer");
+    std::unique_lock<std::mutex> lock(writerMutex);
+    
+    while (true) {
+        writerCondition.wait(lock, [this] {
+            return stopWriter || !pendingWrites.empty() || !pendingRemovals.empty() || !pendingAppends.empty();
+        });
+        if (stopWriter && pendingWrites.empty() && pendingRemovals.empty() && pendingAppends.empty()) {
+            break;
+        }
+        
+        // Let a burst of edits settle, unless someone is waiting in flush()/shutdown
+        writerCondition.wait_for(lock, WRITE_COALESCE_DELAY, [this] { return stopWriter || flushWaiters > 0; });
+        
+        // Writes stay visible in inFlightWrites until done, so loadBody() never reads a stale file
+        std::map<std::string, std::string> removals;
+        std::map<std::string, std::string> appends;
+        inFlightWrites.swap(pendingWrites);
+        removals.swap(pendingRemovals);
+        appends.swap(pendingAppends);
+        std::string dir = pendingDir;
+        writerBusy = true;
+        lock.unlock();
+        
+        std::error_code error;
+        std::filesystem::create_directories(dir, error);
+        
+        // Rewrites, then removals, then journal appends: a renamed playlist's old file only goes
+        // once the new one is on disk, and appends were queued after the rewritten copy was taken
+        std::set<std::string> failed;
+        for (const auto& entry : inFlightWrites) {
+            if (!entry.second.save(dir)) {
+                std::cerr << "Failed to save playlist: " << entry.first << std::endl;
+                failed.insert(entry.first);
+                continue;
+            }
+            std::filesystem::remove(PlaylistJournal::getJournalPath(entry.second.getFilePath(dir)), error);
+        }
+        std::map<std::string, std::string> deferred;
+        for (const auto& removal : removals) {
+            const std::string& replacement = removal.second;
+            if (!replacement.empty() &&
+                (failed.count(replacement) || !std::filesystem::exists(Playlist(replacement).getFilePath(dir), error))) {
+                deferred.insert(removal);
+                continue;
+            }
+            std::string path = Playlist(removal.first).getFilePath(dir);
+            std::filesystem::remove(path, error);
+            std::filesystem::remove(PlaylistJournal::getJournalPath(path), error);
+        }
+        for (const auto& entry : appends) {
+            if (!appendJournal(PlaylistJournal::getJournalPath(Playlist(entry.first).getFilePath(dir)), entry.second)) {
+                std::cerr << "Failed to write playlist journal: " << entry.first << std::endl;
+            }
+        }
+        
+        lock.lock();
+        for (const auto& removal : deferred) {
+            if (!pendingRemovals.count(removal.first)) {
+                deferredRemovals.insert(removal);
+            }
+        }
+        
+        // Keep failed copies for the next save unless a newer one is queued or the name is gone
+        for (auto& entry : inFlightWrites) {
+            if (failed.count(entry.first) && !pendingWrites.count(entry.first) &&
+                !pendingRemovals.count(entry.first) && !deferredRemovals.count(entry.first)) {
+                failedWrites[entry.first] = std::move(entry.second);
+            }
+        }
+        inFlightWrites.clear();
+        writerBusy = false;
+        idleCondition.notify_all();
     }
 }
 
 size_t PlaylistManager::getPlaylistCount() const {
-    return playlists.size();
+    return headers.size();
+}
+
+const std::vector<SmartPlaylist>& PlaylistManager::getSmartPlaylists() const {
+    return smartPlaylists;
+}
+
+bool PlaylistManager::addSmartPlaylist(const std::string& name, const std::string& rule, std::string& error) {
+    for (const auto& smart : smartPlaylists) {
+        if (smart.getName() == name) {
+            error = "A smart playlist with this name already exists";
+            return false;
+        }
+    }
+    
+    SmartQuery query;
+    if (!SmartQuery::parse(rule, query, error)) {
+        return false;
+    }
+    
+    smartPlaylists.emplace_back(name, query);
+    if (!saveSmartPlaylists()) {
+        error = "Could not save smart playlists";
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistManager::deleteSmartPlaylist(size_t index) {
+    if (index >= smartPlaylists.size()) {
+        return false;
+    }
+    smartPlaylists.erase(smartPlaylists.begin() + index);
+    saveSmartPlaylists();
+    return true;
+}
+
+void PlaylistManager::refreshSmartPlaylists(const MediaLibrary& library) {
+    for (auto& smart : smartPlaylists) {
+        smart.refresh(library.getCatalog());
+    }
+}
+
+Playlist PlaylistManager::evaluateSmartPlaylist(size_t index, const MediaLibrary& library) {
+    if (index >= smartPlaylists.size()) {
+        throw std::out_of_range("Smart playlist index out of range");
+    }
+    
+    SmartPlaylist& smart = smartPlaylists[index];
+    const TrackCatalog& catalog = library.getCatalog();
+    smart.refresh(catalog);
+    
+    Playlist::TrackList files = library.getRoot().getTracks();
+    Playlist playlist(smart.getName());
+    for (size_t row : smart.getRows(catalog)) {
+        if (row < files.size()) {
+            playlist.addTrack(files[row]);
+        }
+    }
+    return playlist;
+}
+
+void PlaylistManager::loadSmartPlaylists() {
+    smartPlaylists.clear();
+    
+    MappedFile file;
+    if (!file.open(getStorageDir() + "/" + Constants::SMART_PLAYLISTS_FILE)) {
+        return;
+    }
+    
+    // One "<name>|<rule>" record per smart playlist
+    RecordReader reader(file.data());
+    std::string_view field;
+    while (reader.nextRecord()) {
+        if (!reader.nextField(field)) {
+            continue;
+        }
+        std::string name(field);
+        if (!reader.nextField(field)) {
+            continue;
+        }
+        
+        SmartQuery query;
+        std::string error;
+        if (SmartQuery::parse(std::string(field), query, error)) {
+            smartPlaylists.emplace_back(name, query);
+        } else {
+            std::cerr << "Skipping smart playlist " << name << ": " << error << std::endl;
+        }
+    }
+}
+
+bool PlaylistManager::saveSmartPlaylists() const {
+    std::string contents;
+    RecordWriter writer(contents);
+    for (const auto& smart : smartPlaylists) {
+        writer.field(smart.getName());
+        writer.field(smart.getQuery().getText());
+        writer.endRecord();
+    }
+    
+    // Small file: written in place of the old one right away. Synced before the rename
+    // (and the directory after it), so a crash leaves either the old or the new list
+    std::string dir = getStorageDir();
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    std::string path = dir + "/" + Constants::SMART_PLAYLISTS_FILE;
+    std::string tempPath = path + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < contents.size()) {
+        ssize_t n = write(fd, contents.data() + written, contents.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool ok = written == contents.size() && fsync(fd) == 0;
+    close(fd);
+    if (!ok) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        return false;
+    }
+    int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
 }
@@ -0,0 +1,58 @@
+#include "../../include/models/SmartPlaylist.h"
+#include <algorithm>
+
+SmartPlaylist::SmartPlaylist()
+    : matchCount(0), evaluatedEpoch(0), evaluatedVersion(0), evaluated(false), rowsValid(false) {
+}
+
+SmartPlaylist::SmartPlaylist(const std::string& name, const SmartQuery& query)
+    : name(name), query(query), matchCount(0), evaluatedEpoch(0), evaluatedVersion(0),
+      evaluated(false), rowsValid(false) {
+}
+
+const std::string& SmartPlaylist::getName() const {
+    return name;
+}
+
+const SmartQuery& SmartPlaylist::getQuery() const {
+    return query;
+}
+
+bool SmartPlaylist::refresh(const TrackCatalog& catalog) {
+    if (evaluated && evaluatedEpoch == catalog.getEpoch() && evaluatedVersion == catalog.getVersion()) {
+        return false;
+    }
+    
+    // Rows appended since last time plus rows changed in place
+    std::vector<size_t> changed;
+    bool full = !evaluated || evaluatedEpoch != catalog.getEpoch() ||
+                !catalog.getChangedRows(evaluatedVersion, changed);
+    
+    if (full) {
+        query.evaluate(catalog, matches);
+    } else {
+        for (size_t row = matches.size(); row < catalog.getRowCount(); ++row) {
+            changed.push_back(row);
+        }
+        query.evaluateRows(catalog, changed, matches);
+    }
+    
+    matchCount = static_cast<size_t>(std::count(matches.begin(), matches.end(), 1));
+    evaluatedEpoch = catalog.getEpoch();
+    evaluatedVersion = catalog.getVersion();
+    evaluated = true;
+    rowsValid = false;
+    return full;
+}
+
+const std::vector<size_t>& SmartPlaylist::getRows(const TrackCatalog& catalog) {
+    if (!rowsValid) {
+        rows = query.orderRows(catalog, matches);
+        rowsValid = true;
+    }
+    return rows;
+}
+
+size_t SmartPlaylist::getMatchCount() const {
+    return matchCount;
+}
@@ -0,0 +1,434 @@
+#include "../../include/models/SmartQuery.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+    enum class TokenType { WORD, STRING, NUMBER, OPERATOR, LPAREN, RPAREN, END };
+    
+    struct Token {
+        TokenType type;
+        std::string text;
+    };
+    
+    std::string toLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+    
+    bool tokenize(const std::string& input, std::vector<Token>& tokens, std::string& error) {
+        size_t i = 0;
+        while (i < input.size()) {
+            unsigned char c = static_cast<unsigned char>(input[i]);
+            if (std::isspace(c)) {
+                ++i;
+            } else if (c == '(' || c == ')') {
+                tokens.push_back({c == '(' ? TokenType::LPAREN : TokenType::RPAREN, std::string(1, input[i])});
+                ++i;
+            } else if (c == '"' || c == '\'') {
+                size_t end = input.find(static_cast<char>(c), i + 1);
+                if (end == std::string::npos) {
+                    error = "Unterminated string";
+                    return false;
+                }
+                tokens.push_back({TokenType::STRING, input.substr(i + 1, end - i - 1)});
+                i = end + 1;
+            } else if (c != '\0' && std::strchr("=!<>~", c)) {
+                size_t length = (i + 1 < input.size() && (input[i + 1] == '=' || (c == '<' && input[i + 1] == '>'))) ? 2 : 1;
+                tokens.push_back({TokenType::OPERATOR, input.substr(i, length)});
+                i += length;
+            } else {
+                size_t start = i;
+                while (i < input.size() && !std::isspace(static_cast<unsigned char>(input[i])) &&
+                       (input[i] == '\0' || !std::strchr("()=!<>~\"'", input[i]))) {
+                    ++i;
+                }
+                std::string word = input.substr(start, i - start);
+                float number;
+                auto result = std::from_chars(word.data(), word.data() + word.size(), number);
+                bool numeric = result.ec == std::errc() && result.ptr == word.data() + word.size();
+                tokens.push_back({numeric ? TokenType::NUMBER : TokenType::WORD, word});
+            }
+        }
+        tokens.push_back({TokenType::END, ""});
+        return true;
+    }
+}
+
+// Recursive descent: or := and (OR and)* ; and := unary (AND unary)* ;
+// unary := NOT unary | '(' or ')' | column op value
+class SmartQueryParser {
+public:
+    SmartQueryParser(const std::vector<Token>& tokens, SmartQuery& query, std::string& error)
+        : tokens(tokens), position(0), query(query), error(error) {
+    }
+    
+    bool parse() {
+        query.root = parseOr();
+        if (query.root < 0) {
+            return false;
+        }
+        
+        if (isKeyword("sort")) {
+            ++position;
+            if (!isKeyword("by")) {
+                return fail("Expected BY after SORT");
+            }
+            ++position;
+            if (peek().type != TokenType::WORD || !TrackCatalog::parseColumn(peek().text, query.sortColumn)) {
+                return fail("Unknown sort field '" + peek().text + "'");
+            }
+            ++position;
+            query.hasSort = true;
+            if (isKeyword("asc") || isKeyword("desc")) {
+                query.sortDescending = isKeyword("desc");
+                ++position;
+            }
+        }
+        
+        if (isKeyword("limit")) {
+            ++position;
+            const std::string& count = peek().text;
+            size_t value = 0;
+            auto result = std::from_chars(count.data(), count.data() + count.size(), value);
+            if (result.ec != std::errc() || result.ptr != count.data() + count.size() || value == 0) {
+                return fail("LIMIT needs a positive number");
+            }
+            query.limit = value;
+            ++position;
+        }
+        
+        if (peek().type != TokenType::END) {
+            return fail("Unexpected '" + peek().text + "'");
+        }
+        return true;
+    }
+    
+private:
+    const std::vector<Token>& tokens;
+    size_t position;
+    SmartQuery& query;
+    std::string& error;
+    
+    const Token& peek() const {
+        return tokens[position];
+    }
+    
+    bool isKeyword(const char* keyword) const {
+        return peek().type == TokenType::WORD && toLower(peek().text) == keyword;
+    }
+    
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message;
+        }
+        return false;
+    }
+    
+    int addNode(SmartQuery::Node node) {
+        query.nodes.push_back(std::move(node));
+        return static_cast<int>(query.nodes.size()) - 1;
+    }
+    
+    int combine(SmartQuery::Node::Type type, int left, int right) {
+        SmartQuery::Node node;
+        node.type = type;
+        node.left = left;
+        node.right = right;
+        return addNode(node);
+    }
+    
+    int parseOr() {
+        int left = parseAnd();
+        while (left >= 0 && isKeyword("or")) {
+            ++position;
+            int right = parseAnd();
+            if (right < 0) {
+                return -1;
+            }
+            left = combine(SmartQuery::Node::Type::OR, left, right);
+        }
+        return left;
+    }
+    
+    int parseAnd() {
+        int left = parseUnary();
+        while (left >= 0 && isKeyword("and")) {
+            ++position;
+            int right = parseUnary();
+            if (right < 0) {
+                return -1;
+            }
+            left = combine(SmartQuery::Node::Type::AND, left, right);
+        }
+        return left;
+    }
+    
+    int parseUnary() {
+        if (isKeyword("not")) {
+            ++position;
+            int operand = parseUnary();
+            return operand < 0 ? -1 : combine(SmartQuery::Node::Type::NOT, operand, -1);
+        }
+        
+        if (peek().type == TokenType::LPAREN) {
+            ++position;
+            int inner = parseOr();
+            if (inner < 0) {
+                return -1;
+            }
+            if (peek().type != TokenType::RPAREN) {
+                fail("Missing ')'");
+                return -1;
+            }
+            ++position;
+            return inner;
+        }
+        
+        return parseComparison();
+    }
+    
+    int parseComparison() {
+        SmartQuery::Node node;
+        if (peek().type != TokenType::WORD || !TrackCatalog::parseColumn(peek().text, node.column)) {
+            fail(peek().type == TokenType::END ? "Rule is incomplete" : "Unknown field '" + peek().text + "'");
+            return -1;
+        }
+        std::string field = peek().text;
+        ++position;
+        
+        const std::string& op = peek().text;
+        if (peek().type == TokenType::OPERATOR) {
+            if (op == "=" || op == "==") node.compare = SmartQuery::Compare::EQUAL;
+            else if (op == "!=" || op == "<>") node.compare = SmartQuery::Compare::NOT_EQUAL;
+            else if (op == "<") node.compare = SmartQuery::Compare::LESS;
+            else if (op == "<=") node.compare = SmartQuery::Compare::LESS_EQUAL;
+            else if (op == ">") node.compare = SmartQuery::Compare::GREATER;
+            else if (op == ">=") node.compare = SmartQuery::Compare::GREATER_EQUAL;
+            else if (op == "~") node.compare = SmartQuery::Compare::CONTAINS;
+            else {
+                fail("Unknown operator '" + op + "'");
+                return -1;
+            }
+        } else if (isKeyword("contains")) {
+            node.compare = SmartQuery::Compare::CONTAINS;
+        } else {
+            fail("Expected an operator after '" + field + "'");
+            return -1;
+        }
+        ++position;
+        
+        const Token& value = peek();
+        if (value.type != TokenType::WORD && value.type != TokenType::STRING && value.type != TokenType::NUMBER) {
+            fail("Expected a value after '" + field + " " + op + "'");
+            return -1;
+        }
+        
+        if (TrackCatalog::isText(node.column)) {
+            node.text = toLower(value.text);
+        } else {
+            if (value.type != TokenType::NUMBER || node.compare == SmartQuery::Compare::CONTAINS) {
+                fail("'" + field + "' needs a number");
+                return -1;
+            }
+            std::from_chars(value.text.data(), value.text.data() + value.text.size(), node.number);
+        }
+        ++position;
+        return addNode(node);
+    }
+};
+
+SmartQuery::SmartQuery()
+    : root(-1), hasSort(false), sortColumn(TrackCatalog::Column::TITLE), sortDescending(false),
+      limit(0) {
+}
+
+bool SmartQuery::parse(const std::string& text, SmartQuery& query, std::string& error) {
+    error.clear();
+    query = SmartQuery();
+    query.text = text;
+    
+    std::vector<Token> tokens;
+    if (!tokenize(text, tokens, error)) {
+        return false;
+    }
+    
+    SmartQueryParser parser(tokens, query, error);
+    return parser.parse();
+}
+
+const std::string& SmartQuery::getText() const {
+    return text;
+}
+
+void SmartQuery::evaluate(const TrackCatalog& catalog, std::vector<uint8_t>& matches) const {
+    Context context;
+    prepare(catalog, context);
+    evaluateNode(root, catalog, context, matches);
+}
+
+void SmartQuery::evaluateRows(const TrackCatalog& catalog, const std::vector<size_t>& rows,
+                              std::vector<uint8_t>& matches) const {
+    Context context;
+    prepare(catalog, context);
+    matches.resize(catalog.getRowCount(), 0);
+    for (size_t row : rows) {
+        if (row < matches.size()) {
+            matches[row] = matchRow(root, catalog, context, row);
+        }
+    }
+}
+
+std::vector<size_t> SmartQuery::orderRows(const TrackCatalog& catalog, const std::vector<uint8_t>& matches) const {
+    std::vector<size_t> rows;
+    for (size_t row = 0; row < matches.size(); ++row) {
+        if (matches[row]) {
+            rows.push_back(row);
+        }
+    }
+    
+    if (hasSort && TrackCatalog::isText(sortColumn)) {
+        // Rank the dictionary once, then sort rows by integer rank
+        std::vector<uint32_t> order(catalog.getStringCount(sortColumn));
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [this, &catalog](uint32_t a, uint32_t b) {
+            return catalog.getString(sortColumn, a) < catalog.getString(sortColumn, b);
+        });
+        std::vector<uint32_t> rank(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            rank[order[i]] = static_cast<uint32_t>(i);
+        }
+        
+        const std::vector<uint32_t>& column = catalog.getTextColumn(sortColumn);
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            return sortDescending ? rank[column[a]] > rank[column[b]] : rank[column[a]] < rank[column[b]];
+        });
+    } else if (hasSort) {
+        // Missing values last either way
+        const std::vector<float>& column = catalog.getNumberColumn(sortColumn);
+        std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+            if (std::isnan(column[a]) || std::isnan(column[b])) {
+                return !std::isnan(column[a]) && std::isnan(column[b]);
+            }
+            return sortDescending ? column[a] > column[b] : column[a] < column[b];
+        });
+    }
+    
+    if (limit > 0 && rows.size() > limit) {
+        rows.resize(limit);
+    }
+    return rows;
+}
+
+void SmartQuery::prepare(const TrackCatalog& catalog, Context& context) const {
+    context.stringMatches.assign(nodes.size(), {});
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        if (node.type != Node::Type::COMPARE || !TrackCatalog::isText(node.column)) {
+            continue;
+        }
+        
+        std::vector<uint8_t>& verdicts = context.stringMatches[i];
+        verdicts.resize(catalog.getStringCount(node.column));
+        for (uint32_t id = 0; id < verdicts.size(); ++id) {
+            verdicts[id] = compareText(node.compare, catalog.getString(node.column, id), node.text);
+        }
+    }
+}
+
+void SmartQuery::evaluateNode(int index, const TrackCatalog& catalog, const Context& context,
+                              std::vector<uint8_t>& out) const {
+    const Node& node = nodes[index];
+    size_t rows = catalog.getRowCount();
+    out.resize(rows);
+    
+    switch (node.type) {
+        case Node::Type::AND:
+        case Node::Type::OR: {
+            std::vector<uint8_t> right;
+            evaluateNode(node.left, catalog, context, out);
+            evaluateNode(node.right, catalog, context, right);
+            if (node.type == Node::Type::AND) {
+                for (size_t row = 0; row < rows; ++row) out[row] &= right[row];
+            } else {
+                for (size_t row = 0; row < rows; ++row) out[row] |= right[row];
+            }
+            break;
+        }
+        
+        case Node::Type::NOT:
+            evaluateNode(node.left, catalog, context, out);
+            for (size_t row = 0; row < rows; ++row) out[row] ^= 1;
+            break;
+        
+        case Node::Type::COMPARE:
+            if (TrackCatalog::isText(node.column)) {
+                const std::vector<uint8_t>& verdicts = context.stringMatches[index];
+                const uint32_t* column = catalog.getTextColumn(node.column).data();
+                for (size_t row = 0; row < rows; ++row) out[row] = verdicts[column[row]];
+            } else {
+                // One tight loop per operator; NaN (missing tag) fails every comparison but !=
+                const float* column = catalog.getNumberColumn(node.column).data();
+                float operand = node.number;
+                switch (node.compare) {
+                    case Compare::EQUAL:         for (size_t r = 0; r < rows; ++r) out[r] = column[r] == operand; break;
+                    case Compare::NOT_EQUAL:     for (size_t r = 0; r < rows; ++r) out[r] = !(column[r] == operand); break;
+                    case Compare::LESS:          for (size_t r = 0; r < rows; ++r) out[r] = column[r] < operand; break;
+                    case Compare::LESS_EQUAL:    for (size_t r = 0; r < rows; ++r) out[r] = column[r] <= operand; break;
+                    case Compare::GREATER:       for (size_t r = 0; r < rows; ++r) out[r] = column[r] > operand; break;
+                    case Compare::GREATER_EQUAL: for (size_t r = 0; r < rows; ++r) out[r] = column[r] >= operand; break;
+                    case Compare::CONTAINS:      std::fill(out.begin(), out.end(), 0); break;
+                }
+            }
+            break;
+    }
+}
+
+bool SmartQuery::matchRow(int index, const TrackCatalog& catalog, const Context& context, size_t row) const {
+    const Node& node = nodes[index];
+    switch (node.type) {
+        case Node::Type::AND:
+            return matchRow(node.left, catalog, context, row) && matchRow(node.right, catalog, context, row);
+        case Node::Type::OR:
+            return matchRow(node.left, catalog, context, row) || matchRow(node.right, catalog, context, row);
+        case Node::Type::NOT:
+            return !matchRow(node.left, catalog, context, row);
+        case Node::Type::COMPARE:
+            if (TrackCatalog::isText(node.column)) {
+                return context.stringMatches[index][catalog.getTextColumn(node.column)[row]];
+            }
+            return compareNumber(node.compare, catalog.getNumberColumn(node.column)[row], node.number);
+    }
+    return false;
+}
+
+bool SmartQuery::compareText(Compare compare, const std::string& value, const std::string& operand) {
+    switch (compare) {
+        case Compare::EQUAL:         return value == operand;
+        case Compare::NOT_EQUAL:     return value != operand;
+        case Compare::LESS:          return value < operand;
+        case Compare::LESS_EQUAL:    return value <= operand;
+        case Compare::GREATER:       return value > operand;
+        case Compare::GREATER_EQUAL: return value >= operand;
+        case Compare::CONTAINS:      return value.find(operand) != std::string::npos;
+    }
+    return false;
+}
+
+bool SmartQuery::compareNumber(Compare compare, float value, float operand) {
+    switch (compare) {
+        case Compare::EQUAL:         return value == operand;
+        case Compare::NOT_EQUAL:     return !(value == operand);
+        case Compare::LESS:          return value < operand;
+        case Compare::LESS_EQUAL:    return value <= operand;
+        case Compare::GREATER:       return value > operand;
+        case Compare::GREATER_EQUAL: return value >= operand;
+        case Compare::CONTAINS:      return false;
+    }
+    return false;
+}
@@ -0,0 +1,222 @@
+#include "../../include/models/TrackCatalog.h"
+#include "../../include/Constants.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace {
+    struct ColumnName {
+        const char* name;
+        TrackCatalog::Column column;
+    };
+    
+    constexpr ColumnName COLUMN_NAMES[] = {
+        {"title", TrackCatalog::Column::TITLE},
+        {"name", TrackCatalog::Column::TITLE},
+        {"artist", TrackCatalog::Column::ARTIST},
+        {"album", TrackCatalog::Column::ALBUM},
+        {"genre", TrackCatalog::Column::GENRE},
+        {"type", TrackCatalog::Column::TYPE},
+        {"year", TrackCatalog::Column::YEAR},
+        {"duration", TrackCatalog::Column::DURATION},
+        {"bitrate", TrackCatalog::Column::BITRATE},
+        {"track", TrackCatalog::Column::TRACK_NUMBER}
+    };
+    
+    // The change log is trimmed once it is longer than this (rules older than that re-evaluate fully)
+    constexpr size_t MAX_CHANGE_LOG = 4096;
+    
+    std::string toLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+    
+    size_t textIndex(TrackCatalog::Column column) {
+        return static_cast<size_t>(column);
+    }
+    
+    size_t numberIndex(TrackCatalog::Column column) {
+        return static_cast<size_t>(column) - TrackCatalog::TEXT_COLUMNS;
+    }
+}
+
+TrackCatalog::TrackCatalog() : rowCount(0), version(0), epoch(0), changeLogStart(0) {
+}
+
+bool TrackCatalog::parseColumn(std::string_view name, Column& column) {
+    std::string lower = toLower(std::string(name));
+    for (const auto& entry : COLUMN_NAMES) {
+        if (lower == entry.name) {
+            column = entry.column;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* TrackCatalog::getColumnName(Column column) {
+    for (const auto& entry : COLUMN_NAMES) {
+        if (entry.column == column) {
+            return entry.name;
+        }
+    }
+    return "";
+}
+
+bool TrackCatalog::isText(Column column) {
+    return static_cast<size_t>(column) < TEXT_COLUMNS;
+}
+
+size_t TrackCatalog::getRowCount() const {
+    return rowCount;
+}
+
+void TrackCatalog::setRow(size_t row, const MediaFile& file) {
+    if (row > rowCount) {
+        return;
+    }
+    
+    bool append = row == rowCount;
+    if (append) {
+        for (auto& column : text) {
+            column.push_back(NO_STRING);
+        }
+        for (auto& column : numbers) {
+            column.push_back(std::numeric_limits<float>::quiet_NaN());
+        }
+        rowCount++;
+    }
+    
+    const Metadata& metadata = file.getMetadata();
+    std::string title = metadata.getAttribute(Constants::MetadataKeys::TITLE);
+    
+    text[textIndex(Column::TITLE)][row] = intern(Column::TITLE, toLower(title.empty() ? metadata.getName() : title));
+    text[textIndex(Column::ARTIST)][row] = intern(Column::ARTIST, toLower(metadata.getAttribute(Constants::MetadataKeys::ARTIST)));
+    text[textIndex(Column::ALBUM)][row] = intern(Column::ALBUM, toLower(metadata.getAttribute(Constants::MetadataKeys::ALBUM)));
+    text[textIndex(Column::GENRE)][row] = intern(Column::GENRE, toLower(metadata.getAttribute(Constants::MetadataKeys::GENRE)));
+    text[textIndex(Column::TYPE)][row] = intern(Column::TYPE, file.getType() == Constants::FileType::AUDIO ? "audio" :
+                                                              file.getType() == Constants::FileType::VIDEO ? "video" : "");
+    
+    numbers[numberIndex(Column::YEAR)][row] = parseNumber(metadata.getAttribute(Constants::MetadataKeys::YEAR));
+    numbers[numberIndex(Column::DURATION)][row] = metadata.getDuration() > 0.0 ?
+        static_cast<float>(metadata.getDuration()) : std::numeric_limits<float>::quiet_NaN();
+    numbers[numberIndex(Column::BITRATE)][row] = parseNumber(metadata.getAttribute(Constants::MetadataKeys::BITRATE));
+    numbers[numberIndex(Column::TRACK_NUMBER)][row] = parseNumber(metadata.getAttribute(Constants::MetadataKeys::TRACK_NUMBER));
+    
+    version++;
+    if (!append) {
+        logChange(row);
+    }
+}
+
+void TrackCatalog::removeLastRow() {
+    if (rowCount == 0) {
+        return;
+    }
+    
+    for (auto& column : text) {
+        column.pop_back();
+    }
+    for (auto& column : numbers) {
+        column.pop_back();
+    }
+    rowCount--;
+    
+    // Logged so a row appended later at the same index is not mistaken for the old one
+    version++;
+    logChange(rowCount);
+}
+
+void TrackCatalog::clear() {
+    for (auto& column : text) {
+        column.clear();
+    }
+    for (auto& column : numbers) {
+        column.clear();
+    }
+    rowCount = 0;
+    for (auto& dictionary : strings) {
+        dictionary.clear();
+    }
+    for (auto& ids : stringIds) {
+        ids.clear();
+    }
+    changeLog.clear();
+    version++;
+    changeLogStart = version;
+    epoch++;
+}
+
+const std::vector<uint32_t>& TrackCatalog::getTextColumn(Column column) const {
+    return text[textIndex(column)];
+}
+
+const std::vector<float>& TrackCatalog::getNumberColumn(Column column) const {
+    return numbers[numberIndex(column)];
+}
+
+size_t TrackCatalog::getStringCount(Column column) const {
+    return strings[textIndex(column)].size();
+}
+
+const std::string& TrackCatalog::getString(Column column, uint32_t id) const {
+    return strings[textIndex(column)][id];
+}
+
+uint64_t TrackCatalog::getVersion() const {
+    return version;
+}
+
+uint64_t TrackCatalog::getEpoch() const {
+    return epoch;
+}
+
+bool TrackCatalog::getChangedRows(uint64_t sinceVersion, std::vector<size_t>& rows) const {
+    rows.clear();
+    if (sinceVersion < changeLogStart) {
+        return false;
+    }
+    
+    auto first = std::upper_bound(changeLog.begin(), changeLog.end(), sinceVersion,
+        [](uint64_t value, const std::pair<uint64_t, size_t>& entry) { return value < entry.first; });
+    for (auto it = first; it != changeLog.end(); ++it) {
+        rows.push_back(it->second);
+    }
+    return true;
+}
+
+void TrackCatalog::logChange(size_t row) {
+    changeLog.emplace_back(version, row);
+    if (changeLog.size() > MAX_CHANGE_LOG) {
+        size_t drop = changeLog.size() / 2;
+        changeLogStart = changeLog[drop - 1].first;
+        changeLog.erase(changeLog.begin(), changeLog.begin() + drop);
+    }
+}
+
+uint32_t TrackCatalog::intern(Column column, const std::string& value) {
+    auto& ids = stringIds[textIndex(column)];
+    auto it = ids.find(value);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    
+    auto& dictionary = strings[textIndex(column)];
+    uint32_t id = static_cast<uint32_t>(dictionary.size());
+    dictionary.push_back(value);
+    ids.emplace(value, id);
+    return id;
+}
+
+float TrackCatalog::parseNumber(const std::string& value) {
+    // Tags like "2015-03-01" or "3/12" count by their leading number
+    float number = 0.0f;
+    auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (result.ec != std::errc() || result.ptr == value.data()) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    return number;
+}
@@ -0,0 +1,236 @@
+#include "../../include/models/WaveformPeaks.h"
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/Constants.h"
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    constexpr char MAGIC[4] = {'M', 'B', 'P', 'W'};
+    constexpr uint8_t VERSION = 1;
+
+    // Running minimum and maximum (both starting at 0) over n samples. Eight
+    // independent lanes keep the main loop free of a loop-carried dependency, so
+    // it compiles to packed min/max instructions
+    void findMinMax(const float* samples, size_t n, float& low, float& high) {
+        constexpr size_t LANES = 8;
+        float lanesLow[LANES] = {};
+        float lanesHigh[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            for (size_t j = 0; j < LANES; ++j) {
+                float x = samples[i + j];
+                lanesLow[j] = x < lanesLow[j] ? x : lanesLow[j];
+                lanesHigh[j] = x > lanesHigh[j] ? x : lanesHigh[j];
+            }
+        }
+        for (; i < n; ++i) {
+            lanesLow[0] = std::min(lanesLow[0], samples[i]);
+            lanesHigh[0] = std::max(lanesHigh[0], samples[i]);
+        }
+        low = *std::min_element(lanesLow, lanesLow + LANES);
+        high = *std::max_element(lanesHigh, lanesHigh + LANES);
+    }
+
+    int8_t quantize(float value) {
+        float scaled = std::max(-1.0f, std::min(1.0f, value)) * 127.0f;
+        return static_cast<int8_t>(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+    }
+
+    void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void putU64(std::string& out, uint64_t value) {
+        putU32(out, static_cast<uint32_t>(value));
+        putU32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    // Sequential little-endian reads from a mapped file; any read past the end fails
+    struct Cursor {
+        std::string_view data;
+        size_t offset = 0;
+
+        bool has(size_t length) const {
+            return data.size() - offset >= length;
+        }
+
+        bool u32(uint32_t& value) {
+            if (!has(4)) {
+                return false;
+            }
+            value = 0;
+            for (int i = 0; i < 4; ++i) {
+                value |= static_cast<uint32_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+            }
+            offset += 4;
+            return true;
+        }
+
+        bool u64(uint64_t& value) {
+            uint32_t low = 0;
+            uint32_t high = 0;
+            if (!u32(low) || !u32(high)) {
+                return false;
+            }
+            value = (static_cast<uint64_t>(high) << 32) | low;
+            return true;
+        }
+
+        bool bytes(std::vector<int8_t>& out, size_t length) {
+            if (!has(length)) {
+                return false;
+            }
+            out.resize(length);
+            std::memcpy(out.data(), data.data() + offset, length);
+            offset += length;
+            return true;
+        }
+    };
+}
+
+WaveformPeaks::WaveformPeaks() : sampleRate(0), sampleCount(0) {
+}
+
+WaveformPeaks WaveformPeaks::compute(const float* samples, size_t count, int sampleRate) {
+    TRACE_ZONE("waveform.compute");
+    WaveformPeaks peaks;
+    peaks.sampleRate = sampleRate;
+    peaks.sampleCount = count;
+    
+    // Finest level straight from the samples
+    Level base;
+    base.samplesPerBin = static_cast<uint32_t>(Constants::WAVEFORM_BASE_BIN);
+    size_t bins = (count + Constants::WAVEFORM_BASE_BIN - 1) / Constants::WAVEFORM_BASE_BIN;
+    base.minimum.resize(bins);
+    base.maximum.resize(bins);
+    for (size_t bin = 0; bin < bins; ++bin) {
+        size_t start = bin * Constants::WAVEFORM_BASE_BIN;
+        float low = 0.0f;
+        float high = 0.0f;
+        findMinMax(samples + start, std::min(Constants::WAVEFORM_BASE_BIN, count - start), low, high);
+        base.minimum[bin] = quantize(low);
+        base.maximum[bin] = quantize(high);
+    }
+    peaks.levels.push_back(std::move(base));
+    
+    // Each coarser level merges WAVEFORM_LEVEL_FACTOR bins of the one before
+    while (peaks.levels.size() < Constants::WAVEFORM_LEVELS) {
+        const Level& finer = peaks.levels.back();
+        Level level;
+        level.samplesPerBin = finer.samplesPerBin * static_cast<uint32_t>(Constants::WAVEFORM_LEVEL_FACTOR);
+        size_t finerBins = finer.minimum.size();
+        size_t coarseBins = (finerBins + Constants::WAVEFORM_LEVEL_FACTOR - 1) / Constants::WAVEFORM_LEVEL_FACTOR;
+        level.minimum.resize(coarseBins);
+        level.maximum.resize(coarseBins);
+        for (size_t bin = 0; bin < coarseBins; ++bin) {
+            size_t first = bin * Constants::WAVEFORM_LEVEL_FACTOR;
+            size_t last = std::min(first + Constants::WAVEFORM_LEVEL_FACTOR, finerBins);
+            level.minimum[bin] = *std::min_element(finer.minimum.begin() + first, finer.minimum.begin() + last);
+            level.maximum[bin] = *std::max_element(finer.maximum.begin() + first, finer.maximum.begin() + last);
+        }
+        peaks.levels.push_back(std::move(level));
+    }
+    return peaks;
+}
+
+double WaveformPeaks::getDuration() const {
+    return sampleRate > 0 ? static_cast<double>(sampleCount) / sampleRate : 0.0;
+}
+
+const std::vector<WaveformPeaks::Level>& WaveformPeaks::getLevels() const {
+    return levels;
+}
+
+std::vector<float> WaveformPeaks::getEnvelope(size_t columns) const {
+    std::vector<float> envelope(columns, 0.0f);
+    if (levels.empty() || levels[0].maximum.empty() || columns == 0) {
+        return envelope;
+    }
+    
+    const Level* level = &levels[0];
+    for (const auto& candidate : levels) {
+        if (candidate.maximum.size() >= columns) {
+            level = &candidate;
+        }
+    }
+    
+    size_t bins = level->maximum.size();
+    for (size_t column = 0; column < columns; ++column) {
+        size_t first = column * bins / columns;
+        size_t last = std::max(first + 1, (column + 1) * bins / columns);
+        int peak = 0;
+        for (size_t bin = first; bin < last && bin < bins; ++bin) {
+            peak = std::max({peak, -static_cast<int>(level->minimum[bin]), static_cast<int>(level->maximum[bin])});
+        }
+        envelope[column] = std::min(1.0f, static_cast<float>(peak) / 127.0f);
+    }
+    return envelope;
+}
+
+bool WaveformPeaks::save(const std::string& filePath) const {
+    std::string contents(MAGIC, sizeof(MAGIC));
+    contents += static_cast<char>(VERSION);
+    contents += static_cast<char>(levels.size());
+    contents += std::string(2, '\0');
+    putU32(contents, static_cast<uint32_t>(sampleRate));
+    putU64(contents, sampleCount);
+    for (const auto& level : levels) {
+        putU32(contents, level.samplesPerBin);
+        putU32(contents, static_cast<uint32_t>(level.minimum.size()));
+        contents.append(reinterpret_cast<const char*>(level.minimum.data()), level.minimum.size());
+        contents.append(reinterpret_cast<const char*>(level.maximum.data()), level.maximum.size());
+    }
+    
+    // Temp file and rename, so a reader never sees a half-written file
+    std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool WaveformPeaks::load(const std::string& filePath, WaveformPeaks& peaks) {
+    MappedFile mapping;
+    if (!mapping.open(filePath)) {
+        return false;
+    }
+    
+    Cursor cursor{mapping.data()};
+    if (!cursor.has(8) || std::memcmp(cursor.data.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+        static_cast<uint8_t>(cursor.data[4]) != VERSION) {
+        return false;
+    }
+    size_t levelCount = static_cast<uint8_t>(cursor.data[5]);
+    cursor.offset = 8;
+    
+    WaveformPeaks result;
+    uint32_t rate = 0;
+    if (!cursor.u32(rate) || !cursor.u64(result.sampleCount) || rate == 0 || levelCount == 0) {
+        return false;
+    }
+    result.sampleRate = static_cast<int>(rate);
+    
+    result.levels.resize(levelCount);
+    for (auto& level : result.levels) {
+        uint32_t bins = 0;
+        if (!cursor.u32(level.samplesPerBin) || !cursor.u32(bins) ||
+            !cursor.bytes(level.minimum, bins) || !cursor.bytes(level.maximum, bins)) {
+            return false;
+        }
+    }
+    peaks = std::move(result);
+    return true;
+}
@@ -0,0 +1,155 @@
+#include "../../include/services/AudioDecoder.h"
+#include "../../include/utils/Trace.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // First prefix decodeMonoPrefix reads (about a minute of 256 kbit/s MP3)
+    constexpr size_t FIRST_PREFIX_BYTES = 2 * 1024 * 1024;
+
+    // The last frame of a cut-off prefix may decode short; this much of its end is not counted
+    constexpr double PREFIX_TAIL_SECONDS = 0.5;
+
+    // The mixer's output format; false if it isn't open or isn't 16-bit or float
+    bool queryFormat(int& frequency, int& channels, bool& isFloat) {
+        Uint16 format = 0;
+        if (!Mix_QuerySpec(&frequency, &format, &channels) || channels < 1) {
+            return false;
+        }
+        isFloat = SDL_AUDIO_ISFLOAT(format) && SDL_AUDIO_BITSIZE(format) == 32;
+        return isFloat || SDL_AUDIO_BITSIZE(format) == 16;
+    }
+
+    // Replace samples with chunk downmixed to mono
+    void downmix(const Mix_Chunk* chunk, int channels, bool isFloat, std::vector<float>& samples) {
+        size_t sampleBytes = isFloat ? sizeof(float) : sizeof(int16_t);
+        size_t frames = chunk->alen / (sampleBytes * static_cast<size_t>(channels));
+        samples.resize(frames);
+        float scale = 1.0f / static_cast<float>(channels);
+        if (isFloat) {
+            const float* input = reinterpret_cast<const float*>(chunk->abuf);
+            for (size_t i = 0; i < frames; ++i) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; ++c) {
+                    sum += input[i * channels + c];
+                }
+                samples[i] = sum * scale;
+            }
+        } else {
+            const int16_t* input = reinterpret_cast<const int16_t*>(chunk->abuf);
+            scale /= 32768.0f;
+            for (size_t i = 0; i < frames; ++i) {
+                int sum = 0;
+                for (int c = 0; c < channels; ++c) {
+                    sum += input[i * channels + c];
+                }
+                samples[i] = static_cast<float>(sum) * scale;
+            }
+        }
+    }
+}
+
+bool AudioDecoder::decodeMono(const std::string& filePath, std::vector<float>& samples, int& sampleRate) {
+    TRACE_ZONE("audio.decode");
+    samples.clear();
+
+    int frequency = 0;
+    int channels = 0;
+    bool isFloat = false;
+    if (!queryFormat(frequency, channels, isFloat)) {
+        return false;
+    }
+
+    Mix_Chunk* chunk = Mix_LoadWAV(filePath.c_str());
+    if (!chunk) {
+        return false;
+    }
+    downmix(chunk, channels, isFloat, samples);
+    Mix_FreeChunk(chunk);
+    sampleRate = frequency;
+    return true;
+}
+
+bool AudioDecoder::decodeMonoPrefix(const std::string& filePath, double maxSeconds, float startLevel,
+                                    std::vector<float>& samples, int& sampleRate, bool& complete) {
+    TRACE_ZONE("audio.decodePrefix");
+    samples.clear();
+    complete = false;
+
+    int frequency = 0;
+    int channels = 0;
+    bool isFloat = false;
+    if (!queryFormat(frequency, channels, isFloat)) {
+        return false;
+    }
+
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    if (fileSize > static_cast<size_t>(INT_MAX)) {
+        // Too big for a memory source: decode it whole
+        complete = decodeMono(filePath, samples, sampleRate);
+        return complete;
+    }
+
+    size_t needed = static_cast<size_t>(maxSeconds * frequency);
+    size_t tail = static_cast<size_t>(PREFIX_TAIL_SECONDS * frequency);
+    std::vector<char> prefix;
+    size_t wanted = std::min(fileSize, FIRST_PREFIX_BYTES);
+    while (true) {
+        // Only the bytes added since the last attempt are read
+        size_t have = prefix.size();
+        prefix.resize(wanted);
+        if (!file.read(prefix.data() + have, static_cast<std::streamsize>(wanted - have))) {
+            return false;
+        }
+        bool whole = wanted == fileSize;
+
+        // The loader recognises the format from the data, so a cut-off file decodes up to the cut
+        SDL_RWops* source = SDL_RWFromConstMem(prefix.data(), static_cast<int>(prefix.size()));
+        Mix_Chunk* chunk = source ? Mix_LoadWAV_RW(source, 1) : nullptr;
+        if (chunk) {
+            downmix(chunk, channels, isFloat, samples);
+            Mix_FreeChunk(chunk);
+        }
+        if (whole) {
+            complete = chunk != nullptr;
+            sampleRate = frequency;
+            return complete;
+        }
+        if (!chunk) {
+            // Some decoders reject a cut-off file: take all of it
+            wanted = fileSize;
+            continue;
+        }
+
+        size_t usable = samples.size() > tail ? samples.size() - tail : 0;
+        size_t start = 0;
+        while (start < usable && std::fabs(samples[start]) < startLevel) {
+            start++;
+        }
+        if (usable - start >= needed) {
+            samples.resize(start + needed);
+            sampleRate = frequency;
+            return true;
+        }
+
+        // Next prefix: what the bytes per sample so far say is enough, with a second to
+        // spare; while everything decoded is quiet there is nothing to go by but doubling
+        size_t estimate = wanted * 2;
+        if (start < usable) {
+            double bytesPerSample = static_cast<double>(prefix.size()) / static_cast<double>(samples.size());
+            estimate = static_cast<size_t>((start + needed + tail + frequency) * bytesPerSample);
+        }
+        wanted = std::min(fileSize, std::max(estimate, wanted + wanted / 4));
+    }
+}
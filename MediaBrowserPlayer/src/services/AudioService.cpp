@@ -1,10 +1,14 @@
 #include "../../include/services/AudioService.h"
+#include "../../include/utils/Trace.h"
 #include <taglib/fileref.h>
 #include <taglib/audioproperties.h>
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 
-AudioService::AudioService() : music(nullptr), duration(0.0), startTime(0), pauseTime(0), paused(false) {
+AudioService::AudioService()
+    : music(nullptr), duration(0.0), startTime(0), pauseTime(0), paused(false), outputBytesPerSecond(0.0),
+      underrunCount(Metrics::counter("mbp_audio_underruns_total", "Mixer callbacks that came too late to keep the device fed")) {
 }
 
 AudioService::~AudioService() {
@@ -32,9 +36,32 @@ bool AudioService::initialize() {
         return false;
     }
     
+    int frequency = 0;
+    int channels = 0;
+    Uint16 format = 0;
+    if (Mix_QuerySpec(&frequency, &format, &channels)) {
+        outputBytesPerSecond = static_cast<double>(frequency) * channels * (SDL_AUDIO_BITSIZE(format) / 8);
+        Mix_RegisterEffect(MIX_CHANNEL_POST, monitorOutput, nullptr, this);
+    }
+    
     return true;
 }
 
+void AudioService::monitorOutput(int, void*, int length, void* userData) {
+    AudioService* self = static_cast<AudioService*>(userData);
+    auto now = std::chrono::steady_clock::now();
+    
+    // The device asks for the next buffer as it starts playing the previous one,
+    // so a callback much later than one buffer period means it ran dry in between
+    if (self->lastMixTime != std::chrono::steady_clock::time_point() && self->outputBytesPerSecond > 0.0) {
+        std::chrono::duration<double> period(length / self->outputBytesPerSecond);
+        if (now - self->lastMixTime > period * Constants::AUDIO_UNDERRUN_FACTOR) {
+            self->underrunCount.add();
+        }
+    }
+    self->lastMixTime = now;
+}
+
 void AudioService::cleanup() {
     stop();
     
@@ -44,10 +71,15 @@ void AudioService::cleanup() {
 }
 
 bool AudioService::loadAndPlay(const std::string& filePath) {
+    TRACE_ZONE("audio.loadAndPlay");
+    
     // Stop any currently playing music
     stop();
 
-    music = Mix_LoadMUS(filePath.c_str());
+    {
+        TRACE_ZONE("audio.Mix_LoadMUS");
+        music = Mix_LoadMUS(filePath.c_str());
+    }
     if (!music) {
         std::cerr << "Failed to load music! SDL_mixer Error: " << Mix_GetError() << std::endl;
         return false;
@@ -62,11 +94,14 @@ bool AudioService::loadAndPlay(const std::string& filePath) {
     }
 
     // Update Duration
-    TagLib::FileRef f(filePath.c_str());
-
-    if (!f.isNull() && f.audioProperties()) {
-        TagLib::AudioProperties* properties = f.audioProperties();
-        duration = properties->length(); // duration in second
+    {
+        TRACE_ZONE("taglib.readDuration");
+        TagLib::FileRef f(filePath.c_str());
+
+        if (!f.isNull() && f.audioProperties()) {
+            TagLib::AudioProperties* properties = f.audioProperties();
+            duration = properties->length(); // duration in second
+        }
     }
     
     // Reset timer
@@ -124,12 +159,28 @@ double AudioService::getDuration() const {
     return duration;
 }
 
-// void AudioService::setPosition(double position) {
-//     // SDL_mixer doesn't support seeking directly
-//     // This is a placeholder for future implementation
-//     // You could potentially restart the track and use Mix_SetMusicPosition()
-//     // for formats that support it
-// }
+bool AudioService::setPosition(double position) {
+    if (!music) {
+        return false;
+    }
+    
+    position = std::max(0.0, duration > 0.0 ? std::min(position, duration) : position);
+    
+    // Some decoders take the position relative to the current one: rewinding first makes it absolute for all
+    Mix_RewindMusic();
+    if (Mix_SetMusicPosition(position) != 0) {
+        std::cerr << "Failed to seek! SDL_mixer Error: " << Mix_GetError() << std::endl;
+        return false;
+    }
+    
+    // Keep the position timer in step
+    Uint32 now = SDL_GetTicks();
+    startTime = now - static_cast<Uint32>(position * 1000.0);
+    if (paused) {
+        pauseTime = now;
+    }
+    return true;
+}
 
 double AudioService::calculatePosition() const {
     if (!music) {
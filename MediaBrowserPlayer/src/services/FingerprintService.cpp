@@ -0,0 +1,80 @@
+#include "../../include/services/FingerprintService.h"
+#include "../../include/services/AudioDecoder.h"
+#include "../../include/utils/AudioFingerprint.h"
+#include "../../include/utils/FileStamp.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+    // Audio a fingerprint uses after the leading silence: FINGERPRINT_SECONDS and its last FFT frame
+    constexpr double DECODE_SECONDS = Constants::FINGERPRINT_SECONDS + 1.0;
+}
+
+FingerprintService::FingerprintService() {
+}
+
+size_t FingerprintService::update(const MediaLibrary& library, FingerprintIndex& index, unsigned jobs,
+                                  const Progress& progress) {
+    static Metrics::Counter& fingerprinted = Metrics::counter("mbp_fingerprints_total", "Audio files decoded and fingerprinted");
+    static Metrics::Histogram& fingerprintTime = Metrics::histogram("mbp_fingerprint_seconds", "Time to decode and fingerprint one file");
+
+    // Work list: audio files without a current fingerprint
+    struct Job {
+        std::string path;
+        FileStamp stamp;
+        std::vector<uint32_t> words;
+    };
+    std::vector<Job> work;
+    for (const auto& file : library.getRoot().getTracks()) {
+        Job job;
+        job.path = file.getFilePath();
+        if (file.getType() == Constants::FileType::AUDIO && !index.find(job.path) && FileStamp::read(job.path, job.stamp)) {
+            work.push_back(std::move(job));
+        }
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    auto runJobs = [&](bool reportProgress) {
+        std::vector<float> samples;
+        for (size_t i = next++; i < work.size(); i = next++) {
+            Metrics::ScopedTimer timer(fingerprintTime);
+            int sampleRate = 0;
+            bool complete = false;
+            if (AudioDecoder::decodeMonoPrefix(work[i].path, DECODE_SECONDS, Constants::FINGERPRINT_SILENCE,
+                                               samples, sampleRate, complete)) {
+                work[i].words = AudioFingerprint::compute(samples.data(), samples.size(), sampleRate);
+            }
+            fingerprinted.add();
+            size_t finished = ++done;
+            if (reportProgress && progress) {
+                progress(finished, work.size());
+            }
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(std::max(jobs, 1u), work.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threadCount; ++t) {
+        workers.emplace_back([&runJobs] {
+            Trace::setThreadName("fingerprint-worker");
+            runJobs(false);
+        });
+    }
+    runJobs(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (progress && !work.empty()) {
+        progress(work.size(), work.size());
+    }
+
+    // Failed files are stored too (empty), so they aren't decoded again until they change
+    for (auto& job : work) {
+        index.store(job.path, job.stamp, std::move(job.words));
+    }
+    return work.size();
+}
@@ -0,0 +1,368 @@
+#include "../../include/services/LibraryWatcher.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/Trace.h"
+#include <filesystem>
+#include <set>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+namespace {
+    // Directory events we care about. Files count once they are closed after writing or moved in,
+    // so a file that is still being copied is not tagged halfway
+    constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                    IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+    // Room for many events per read()
+    constexpr size_t EVENT_BUFFER_SIZE = 64 * 1024;
+
+    bool isBelow(const std::string& path, const std::string& directory) {
+        return path.size() > directory.size() && path[directory.size()] == '/' &&
+               path.compare(0, directory.size(), directory) == 0;
+    }
+
+    // Whether path is one of directories or below one of them
+    bool isInside(const std::string& path, const std::set<std::string>& directories) {
+        for (size_t end = path.size(); end != std::string::npos && end > 0; end = path.rfind('/', end - 1)) {
+            if (directories.count(path.substr(0, end))) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+LibraryWatcher::LibraryWatcher()
+    : inotifyFd(-1), epollFd(-1), wakeFd(-1), stopThread(false), watchCount(0), reportedWatchLimit(false) {
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    stop();
+}
+
+bool LibraryWatcher::watch(const std::string& directory) {
+    if (!std::filesystem::is_directory(directory)) {
+        return false;
+    }
+
+    if (inotifyFd < 0) {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotifyFd < 0 || epollFd < 0 || wakeFd < 0) {
+            std::cerr << "Can't watch the media library: " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = inotifyFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, inotifyFd, &event);
+        event.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+        stopThread = false;
+        watchThread = std::thread(&LibraryWatcher::watchLoop, this);
+    }
+
+    // Walking a large tree takes a while: the thread does it. Paths are kept as given,
+    // so they match the ones the library scan produced
+    std::string root = directory;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        newRoots.push_back(root);
+    }
+    wakeUp();
+    return true;
+}
+
+void LibraryWatcher::stop() {
+    if (watchThread.joinable()) {
+        stopThread = true;
+        wakeUp();
+        watchThread.join();
+    }
+
+    // Closing the inotify descriptor drops every watch
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    inotifyFd = epollFd = wakeFd = -1;
+
+    watchPaths.clear();
+    pending.clear();
+    watchCount = 0;
+}
+
+bool LibraryWatcher::takeChanges(std::vector<Change>& changes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.clear();
+    changes.swap(ready);
+    return !changes.empty();
+}
+
+bool LibraryWatcher::applyChanges(MediaLibrary& library) {
+    std::vector<Change> changes;
+    if (!takeChanges(changes)) {
+        return false;
+    }
+
+    // Metadata was read on the watcher thread; this only touches the in-memory library
+    for (const auto& change : changes) {
+        switch (change.type) {
+            case Change::Type::UPDATED:
+                library.addOrUpdateMediaFile(change.file);
+                break;
+            case Change::Type::REMOVED:
+                library.removeMediaFile(change.path);
+                break;
+            case Change::Type::REMOVED_DIRECTORY:
+                library.removeDirectory(change.path);
+                break;
+        }
+    }
+    return true;
+}
+
+size_t LibraryWatcher::getWatchCount() const {
+    return watchCount;
+}
+
+void LibraryWatcher::wakeUp() {
+    if (wakeFd < 0) {
+        return;
+    }
+
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void LibraryWatcher::watchLoop() {
+    Trace::setThreadName("library-watcher");
+    using Clock = std::chrono::steady_clock;
+    const auto debounce = std::chrono::milliseconds(Constants::LIBRARY_WATCH_DEBOUNCE_MS);
+    const auto maxDelay = std::chrono::milliseconds(Constants::LIBRARY_WATCH_MAX_DELAY_MS);
+
+    while (!stopThread) {
+        // Sleep until something happens, or until the pending batch is due
+        int timeoutMs = -1;
+        if (!pending.empty()) {
+            auto due = std::min(lastEvent + debounce, firstEvent + maxDelay);
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now()).count();
+            timeoutMs = wait > 0 ? static_cast<int>(wait) : 0;
+        }
+
+        epoll_event fired[2];
+        int ready = epoll_wait(epollFd, fired, 2, timeoutMs);
+        for (int i = 0; i < ready; ++i) {
+            if (fired[i].data.fd == wakeFd) {
+                uint64_t value;
+                ssize_t ignored = read(wakeFd, &value, sizeof(value));
+                (void)ignored;
+            } else {
+                readEvents();
+            }
+        }
+        if (stopThread) {
+            break;
+        }
+
+        std::vector<std::string> roots;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            roots.swap(newRoots);
+        }
+        for (const auto& root : roots) {
+            addTree(root, nullptr);
+        }
+
+        if (!pending.empty()) {
+            auto now = Clock::now();
+            if (now - lastEvent >= debounce || now - firstEvent >= maxDelay) {
+                processPending();
+            }
+        }
+    }
+}
+
+void LibraryWatcher::readEvents() {
+    alignas(inotify_event) char buffer[EVENT_BUFFER_SIZE];
+
+    while (true) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            break; // EAGAIN: drained
+        }
+
+        for (char* p = buffer; p < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost: look at every root again (files that vanished meanwhile stay listed)
+                std::cerr << "Library watcher fell behind; rescanning watched directories" << std::endl;
+                for (const auto& entry : watchPaths) {
+                    addPending(entry.second, Pending::DIRECTORY_ADDED);
+                }
+                continue;
+            }
+
+            auto watched = watchPaths.find(event->wd);
+            if (watched == watchPaths.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                // Directory deleted or unwatched
+                watchPaths.erase(watched);
+                watchCount = watchPaths.size();
+                continue;
+            }
+            if (event->len == 0) {
+                continue; // Event about the watched directory itself
+            }
+
+            std::string path = watched->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    // Watch it right away so files copied into it next are seen
+                    addWatch(path);
+                    addPending(path, Pending::DIRECTORY_ADDED);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    addPending(path, Pending::DIRECTORY_REMOVED);
+                }
+            } else if (metadataService.detectMediaType(path) != Constants::FileType::UNKNOWN) {
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    addPending(path, Pending::FILE_CHANGED);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    addPending(path, Pending::FILE_REMOVED);
+                }
+            }
+        }
+    }
+}
+
+void LibraryWatcher::addPending(const std::string& path, Pending what) {
+    auto now = std::chrono::steady_clock::now();
+    if (pending.empty()) {
+        firstEvent = now;
+    }
+    lastEvent = now;
+    pending[path] = what;
+}
+
+void LibraryWatcher::processPending() {
+    TRACE_ZONE("watcher.processPending");
+    std::vector<Change> changes;
+    std::map<std::string, Pending> batch;
+    batch.swap(pending);
+
+    // Removals first, so a directory moved within the tree is dropped under its old name
+    // before it is added under the new one
+    for (const auto& entry : batch) {
+        if (entry.second == Pending::DIRECTORY_REMOVED) {
+            removeTree(entry.first);
+            changes.push_back({Change::Type::REMOVED_DIRECTORY, entry.first, MediaFile()});
+        } else if (entry.second == Pending::FILE_REMOVED) {
+            changes.push_back({Change::Type::REMOVED, entry.first, MediaFile()});
+        }
+    }
+
+    // A new directory is scanned as a whole, so events for paths inside it are covered
+    std::set<std::string> scanned;
+    for (const auto& entry : batch) {
+        if (isInside(entry.first, scanned)) {
+            continue;
+        }
+        if (entry.second == Pending::DIRECTORY_ADDED) {
+            addTree(entry.first, &changes);
+            scanned.insert(entry.first);
+        } else if (entry.second == Pending::FILE_CHANGED && !makeUpdate(entry.first, changes)) {
+            // Gone again (or unreadable) before we got to it
+            std::error_code error;
+            if (!std::filesystem::exists(entry.first, error)) {
+                changes.push_back({Change::Type::REMOVED, entry.first, MediaFile()});
+            }
+        }
+    }
+
+    if (changes.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    ready.insert(ready.end(), std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+}
+
+bool LibraryWatcher::addWatch(const std::string& directory) {
+    int wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        if (errno == ENOSPC && !reportedWatchLimit) {
+            std::cerr << "Too many directories to watch; raise fs.inotify.max_user_watches" << std::endl;
+            reportedWatchLimit = true;
+        }
+        return false;
+    }
+
+    // Watching the same directory again returns its existing descriptor
+    watchPaths[wd] = directory;
+    watchCount = watchPaths.size();
+    return true;
+}
+
+void LibraryWatcher::addTree(const std::string& directory, std::vector<Change>* changes) {
+    if (!addWatch(directory)) {
+        return;
+    }
+
+    std::error_code error;
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, options, error);
+         !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        std::error_code typeError;
+        if (it->is_symlink(typeError)) {
+            continue;
+        }
+        if (it->is_directory(typeError)) {
+            addWatch(it->path().string());
+        } else if (changes && it->is_regular_file(typeError)) {
+            makeUpdate(it->path().string(), *changes);
+        }
+    }
+}
+
+void LibraryWatcher::removeTree(const std::string& directory) {
+    // A directory moved away keeps its watches (under a path that no longer exists)
+    for (auto it = watchPaths.begin(); it != watchPaths.end();) {
+        if (it->second == directory || isBelow(it->second, directory)) {
+            inotify_rm_watch(inotifyFd, it->first);
+            it = watchPaths.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    watchCount = watchPaths.size();
+}
+
+bool LibraryWatcher::makeUpdate(const std::string& path, std::vector<Change>& changes) {
+    Constants::FileType type = metadataService.detectMediaType(path);
+    std::error_code error;
+    if (type == Constants::FileType::UNKNOWN || !std::filesystem::is_regular_file(path, error)) {
+        return false;
+    }
+
+    changes.push_back({Change::Type::UPDATED, path, MediaFile(path, metadataService.extractMetadata(path), type)});
+    return true;
+}
@@ -1,5 +1,8 @@
 #include "../../include/services/MetadataService.h"
 #include "../../include/Constants.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/VideoProbe.h"
 #include <taglib/fileref.h>
 #include <taglib/tag.h>
 #include <taglib/tpropertymap.h>
@@ -11,6 +14,43 @@
 #include <taglib/wavfile.h>
 #include <filesystem>
 #include <iostream>
+#include <cstdio>
+
+namespace {
+    // "23.976", "25", "29.97"
+    std::string formatFrameRate(double frameRate) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", frameRate);
+        std::string formatted = text;
+        formatted.erase(formatted.find_last_not_of('0') + 1);
+        if (formatted.back() == '.') {
+            formatted.pop_back();
+        }
+        return formatted;
+    }
+
+    // Properties of a probed video as attribute values, keyed like Constants::MetadataKeys
+    std::map<std::string, std::string> describeVideo(const VideoInfo& info) {
+        std::map<std::string, std::string> details;
+        details["format"] = info.container;
+        if (!info.videoCodec.empty()) {
+            details[Constants::MetadataKeys::CODEC] = info.videoCodec;
+        }
+        if (!info.audioCodec.empty()) {
+            details[Constants::MetadataKeys::AUDIO_CODEC] = info.audioCodec;
+        }
+        if (info.width > 0 && info.height > 0) {
+            details[Constants::MetadataKeys::RESOLUTION] = std::to_string(info.width) + "x" + std::to_string(info.height);
+        }
+        if (info.frameRate > 0.0) {
+            details[Constants::MetadataKeys::FRAME_RATE] = formatFrameRate(info.frameRate) + " fps";
+        }
+        if (info.bitrate > 0) {
+            details[Constants::MetadataKeys::BITRATE] = std::to_string((info.bitrate + 500) / 1000) + " kbps";
+        }
+        return details;
+    }
+}
 
 MetadataService::MetadataService() {
     initializeTagLib();
@@ -77,10 +117,13 @@ double MetadataService::getFileDuration(const std::string& filePath) {
         if (!f.isNull() && f.audioProperties()) {
             return f.audioProperties()->lengthInSeconds();
         }
+    } else if (detectMediaType(filePath) == Constants::FileType::VIDEO) {
+        VideoInfo info;
+        if (VideoProbe::probe(filePath, info)) {
+            return info.duration;
+        }
     }
     
-    // For video files, this would need to be implemented with a video library
-    // For now, return 0 for non-audio files
     return 0.0;
 }
 
@@ -104,6 +147,11 @@ std::map<std::string, std::string> MetadataService::getFormatDetails(const std::
             else if (ext == ".flac") details["format"] = "FLAC";
             else details["format"] = ext.substr(1); // Remove the dot
         }
+    } else if (detectMediaType(filePath) == Constants::FileType::VIDEO) {
+        VideoInfo info;
+        if (VideoProbe::probe(filePath, info)) {
+            details = describeVideo(info);
+        }
     }
     
     return details;
@@ -118,6 +166,9 @@ void MetadataService::cleanupTagLib() {
 }
 
 Metadata MetadataService::extractAudioMetadata(const std::string& filePath) {
+    TRACE_ZONE("taglib.extractAudioMetadata");
+    static Metrics::Histogram& parseTime = Metrics::histogram("mbp_tag_parse_seconds", "Time to read the tags of one audio file");
+    Metrics::ScopedTimer timer(parseTime);
     TagLib::FileRef f(filePath.c_str());
     
     if (f.isNull() || !f.tag()) {
@@ -190,16 +241,30 @@ Metadata MetadataService::extractAudioMetadata(const std::string& filePath) {
 }
 
 Metadata MetadataService::extractVideoMetadata(const std::string& filePath) {
-    // For video files, we'd need a video metadata library
-    // For now, we'll just create basic metadata with the filename
-    
+    TRACE_ZONE("video.extractVideoMetadata");
     std::string fileName = std::filesystem::path(filePath).filename().string();
-    Metadata metadata(fileName);
-    
-    // Add basic file information
-    metadata.setAttribute(Constants::MetadataKeys::CODEC, "Unknown");
-    metadata.setAttribute(Constants::MetadataKeys::BITRATE, "Unknown");
-    
+
+    // Container headers only; the streams themselves are never decoded
+    VideoInfo info;
+    if (!VideoProbe::probe(filePath, info)) {
+        Metadata metadata(fileName);
+        metadata.setAttribute(Constants::MetadataKeys::CODEC, "Unknown");
+        metadata.setAttribute(Constants::MetadataKeys::BITRATE, "Unknown");
+        return metadata;
+    }
+
+    Metadata metadata(fileName, info.duration);
+    for (const auto& detail : describeVideo(info)) {
+        if (detail.first != "format") {
+            metadata.setAttribute(detail.first, detail.second);
+        }
+    }
+    if (info.videoCodec.empty()) {
+        metadata.setAttribute(Constants::MetadataKeys::CODEC, "Unknown");
+    }
+    if (info.bitrate <= 0) {
+        metadata.setAttribute(Constants::MetadataKeys::BITRATE, "Unknown");
+    }
     return metadata;
 }
 
@@ -0,0 +1,143 @@
+#include "../../include/services/MetricsServer.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/UnixSocket.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+MetricsServer::MetricsServer() : listenFd(-1), epollFd(-1), wakeFd(-1), stopThread(false) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& path) {
+    stop();
+
+    listenFd = UnixSocket::listen(path, 8);
+    if (listenFd < 0 && errno == EADDRINUSE) {
+        // Leave the running instance's socket alone
+        std::cerr << "Metrics are already served on " << path << " by another instance" << std::endl;
+        return false;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listenFd < 0 || epollFd < 0 || wakeFd < 0) {
+        std::cerr << "Can't serve metrics on " << path << ": " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    socketPath = path;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    stopThread = false;
+    serverThread = std::thread(&MetricsServer::serveLoop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (serverThread.joinable()) {
+        stopThread = true;
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+        serverThread.join();
+    }
+
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    listenFd = epollFd = wakeFd = -1;
+
+    if (!socketPath.empty()) {
+        unlink(socketPath.c_str());
+        socketPath.clear();
+    }
+}
+
+std::string MetricsServer::getDefaultPath() {
+    const char* path = std::getenv("MBP_METRICS_SOCKET");
+    return path ? path : Constants::METRICS_SOCKET_PATH;
+}
+
+void MetricsServer::serveLoop() {
+    epoll_event events[2];
+
+    while (!stopThread) {
+        int count = epoll_wait(epollFd, events, 2, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.fd != listenFd) {
+                continue; // wakeFd: loop condition decides
+            }
+
+            // Scrapes are rare and the response is small: clients are served one at a time
+            int clientFd;
+            while (!stopThread && (clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) {
+                serveClient(clientFd);
+                close(clientFd);
+            }
+        }
+    }
+}
+
+void MetricsServer::serveClient(int clientFd) {
+    timeval timeout;
+    timeout.tv_sec = Constants::METRICS_SEND_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (Constants::METRICS_SEND_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; the rest of the request is never read
+    char request[512];
+    ssize_t received = 0;
+    pollfd readable = {clientFd, POLLIN, 0};
+    if (poll(&readable, 1, Constants::METRICS_REQUEST_TIMEOUT_MS) > 0) {
+        received = recv(clientFd, request, sizeof(request), MSG_DONTWAIT);
+    }
+    bool isHttp = received >= 4 && memcmp(request, "GET ", 4) == 0;
+
+    std::string body = Metrics::renderPrometheus();
+    std::string response;
+    if (isHttp) {
+        response = "HTTP/1.0 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n";
+    }
+    response += body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break; // Client went away or stopped reading
+        }
+        sent += static_cast<size_t>(n);
+    }
+    shutdown(clientFd, SHUT_WR);
+}
@@ -0,0 +1,291 @@
+#include "../../include/services/PlaylistFormatService.h"
+#include "../../include/utils/MappedFile.h"
+#include "../../include/utils/RecordReader.h"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+
+namespace {
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+    
+    bool startsWithNoCase(std::string_view text, std::string_view prefix) {
+        if (text.size() < prefix.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < prefix.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(text[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Decode %XX escapes of a file:// URL
+    std::string decodeUrl(std::string_view url) {
+        std::string decoded;
+        decoded.reserve(url.size());
+        for (size_t i = 0; i < url.size(); ++i) {
+            int value = 0;
+            if (url[i] == '%' && i + 2 < url.size() &&
+                std::from_chars(url.data() + i + 1, url.data() + i + 3, value, 16).ptr == url.data() + i + 3) {
+                decoded.push_back(static_cast<char>(value));
+                i += 2;
+            } else {
+                decoded.push_back(url[i]);
+            }
+        }
+        return decoded;
+    }
+    
+    std::string formatSeconds(double duration) {
+        return std::to_string(static_cast<long long>(duration));
+    }
+}
+
+PlaylistFormatService::PlaylistFormatService() {
+}
+
+PlaylistFormatService::~PlaylistFormatService() {
+}
+
+PlaylistFormatService::Format PlaylistFormatService::detectFormat(const std::string& filePath) const {
+    std::string extension = std::filesystem::path(filePath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    
+    if (extension == ".m3u" || extension == ".m3u8") {
+        return Format::M3U;
+    }
+    if (extension == ".pls") {
+        return Format::PLS;
+    }
+    return Format::UNKNOWN;
+}
+
+bool PlaylistFormatService::importPlaylist(const std::string& filePath, const Playlist::TrackResolver& resolver,
+                                           Playlist& playlist) {
+    Format format = detectFormat(filePath);
+    if (format == Format::UNKNOWN) {
+        return false;
+    }
+    
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return false;
+    }
+    
+    std::filesystem::path path(filePath);
+    std::string baseDir = std::filesystem::absolute(path).parent_path().string();
+    playlist = Playlist(path.stem().string());
+    
+    std::string_view data = file.data();
+    
+    // UTF-8 byte order mark (common in .m3u8 files from Windows players)
+    if (data.substr(0, 3) == "\xEF\xBB\xBF") {
+        data.remove_prefix(3);
+    }
+    
+    return format == Format::M3U ? readM3U(data, baseDir, resolver, playlist)
+                                 : readPLS(data, baseDir, resolver, playlist);
+}
+
+bool PlaylistFormatService::exportPlaylist(const Playlist& playlist, const std::string& filePath) {
+    Format format = detectFormat(filePath);
+    if (format == Format::UNKNOWN) {
+        return false;
+    }
+    
+    std::string contents = formatPlaylist(playlist, format);
+    
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+std::string PlaylistFormatService::formatPlaylist(const Playlist& playlist, Format format) const {
+    switch (format) {
+        case Format::M3U: return writeM3U(playlist);
+        case Format::PLS: return writePLS(playlist);
+        default:          return std::string();
+    }
+}
+
+bool PlaylistFormatService::readM3U(std::string_view data, const std::string& baseDir,
+                                    const Playlist::TrackResolver& resolver, Playlist& playlist) {
+    RecordReader reader(data);
+    Entry entry;
+    
+    while (reader.nextRecord()) {
+        std::string_view line = trim(reader.getRecord());
+        if (line.empty()) {
+            continue;
+        }
+        
+        if (line[0] == '#') {
+            // #EXTINF:<seconds>[ attributes],<title> describes the next location line
+            if (startsWithNoCase(line, "#EXTINF:")) {
+                std::string_view info = line.substr(8);
+                size_t comma = info.find(',');
+                std::string_view seconds = info.substr(0, std::min(comma, info.find(' ')));
+                double duration = -1.0;
+                std::from_chars(seconds.data(), seconds.data() + seconds.size(), duration);
+                entry.duration = duration;
+                entry.title = comma == std::string_view::npos ? std::string() : std::string(trim(info.substr(comma + 1)));
+            }
+            continue; // #EXTM3U and other directives
+        }
+        
+        entry.path = resolvePath(line, baseDir);
+        if (!entry.path.empty()) {
+            playlist.addTrack(resolveEntry(entry, resolver));
+        }
+        entry = Entry();
+    }
+    
+    return true;
+}
+
+bool PlaylistFormatService::readPLS(std::string_view data, const std::string& baseDir,
+                                    const Playlist::TrackResolver& resolver, Playlist& playlist) {
+    // Keys are numbered (File3=, Title3=, Length3=) and may come in any order. Entries are
+    // keyed by that number rather than stored at it, so File100000000= costs one entry
+    std::map<size_t, Entry> entries;
+    RecordReader reader(data);
+    bool sawSection = false;
+    
+    while (reader.nextRecord()) {
+        std::string_view line = trim(reader.getRecord());
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            sawSection = startsWithNoCase(line, "[playlist]");
+            continue;
+        }
+        
+        size_t equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        std::string_view key = trim(line.substr(0, equals));
+        std::string_view value = trim(line.substr(equals + 1));
+        
+        size_t digits = key.size();
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(key[digits - 1]))) {
+            --digits;
+        }
+        size_t number = 0;
+        if (digits == key.size() ||
+            std::from_chars(key.data() + digits, key.data() + key.size(), number).ec != std::errc() || number == 0) {
+            continue; // NumberOfEntries, Version, ...
+        }
+        
+        Entry& entry = entries[number];
+        std::string_view name = key.substr(0, digits);
+        if (startsWithNoCase(name, "File") && name.size() == 4) {
+            entry.path = resolvePath(value, baseDir);
+        } else if (startsWithNoCase(name, "Title") && name.size() == 5) {
+            entry.title = std::string(value);
+        } else if (startsWithNoCase(name, "Length") && name.size() == 6) {
+            std::from_chars(value.data(), value.data() + value.size(), entry.duration);
+        }
+    }
+    
+    for (const auto& entry : entries) {
+        if (!entry.second.path.empty()) {
+            playlist.addTrack(resolveEntry(entry.second, resolver));
+        }
+    }
+    
+    return sawSection || !entries.empty();
+}
+
+std::string PlaylistFormatService::writeM3U(const Playlist& playlist) const {
+    std::string out = "#EXTM3U\n";
+    out.reserve(playlist.getTrackCount() * 96);
+    
+    for (const auto& track : playlist.getTracks()) {
+        const Metadata& metadata = track.getMetadata();
+        std::string artist = metadata.getAttribute(Constants::MetadataKeys::ARTIST);
+        
+        out += "#EXTINF:";
+        out += metadata.getDuration() > 0 ? formatSeconds(metadata.getDuration()) : "-1";
+        out += ',';
+        if (!artist.empty()) {
+            out += artist + " - ";
+        }
+        out += metadata.getName();
+        out += '\n';
+        out += track.getFilePath();
+        out += '\n';
+    }
+    return out;
+}
+
+std::string PlaylistFormatService::writePLS(const Playlist& playlist) const {
+    std::string out = "[playlist]\n";
+    out.reserve(playlist.getTrackCount() * 128);
+    
+    size_t number = 1;
+    for (const auto& track : playlist.getTracks()) {
+        const Metadata& metadata = track.getMetadata();
+        std::string n = std::to_string(number++);
+        out += "File" + n + "=" + track.getFilePath() + "\n";
+        out += "Title" + n + "=" + metadata.getName() + "\n";
+        out += "Length" + n + "=" + (metadata.getDuration() > 0 ? formatSeconds(metadata.getDuration()) : "-1") + "\n";
+    }
+    out += "NumberOfEntries=" + std::to_string(playlist.getTrackCount()) + "\n";
+    out += "Version=2\n";
+    return out;
+}
+
+MediaFile PlaylistFormatService::resolveEntry(const Entry& entry, const Playlist::TrackResolver& resolver) const {
+    MediaFile file = resolver ? resolver(MediaFile::computeTrackId(entry.path), entry.path) : MediaFile(entry.path);
+    
+    // Unknown to the library (no duration): use what the playlist says instead of opening the file
+    if (file.getMetadata().getDuration() <= 0.0) {
+        Metadata metadata = file.getMetadata();
+        if (!entry.title.empty()) {
+            metadata.setName(entry.title);
+        }
+        if (entry.duration > 0.0) {
+            metadata.setDuration(entry.duration);
+        }
+        file.setMetadata(metadata);
+    }
+    return file;
+}
+
+std::string PlaylistFormatService::resolvePath(std::string_view location, const std::string& baseDir) const {
+    if (startsWithNoCase(location, "file://")) {
+        return decodeUrl(location.substr(7));
+    }
+    
+    // Streams and other URLs can't be played from the library
+    if (location.find("://") != std::string_view::npos) {
+        return "";
+    }
+    
+    // Playlists written on Windows
+    std::string path(location);
+    std::replace(path.begin(), path.end(), '\\', '/');
+    
+    if (!path.empty() && path[0] != '/') {
+        path = (std::filesystem::path(baseDir) / path).lexically_normal().string();
+    }
+    return path;
+}
@@ -0,0 +1,226 @@
+#include "../../include/services/SpectrumAnalyzer.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/Constants.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    // Samples downmixed per push from the audio callback (stack buffer, no allocation)
+    constexpr size_t TAP_CHUNK = 256;
+
+    // dB value (power ratio) to 0..1 between SPECTRUM_FLOOR_DB and 0 dB
+    float toHeight(double power) {
+        double db = power > 0.0 ? 10.0 * std::log10(power) : Constants::SPECTRUM_FLOOR_DB;
+        double height = 1.0 - db / Constants::SPECTRUM_FLOOR_DB;
+        return static_cast<float>(std::max(0.0, std::min(1.0, height)));
+    }
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : ring(Constants::SPECTRUM_RING_SAMPLES), fft(Constants::SPECTRUM_FFT_SIZE),
+      window(FFT::makeHannWindow(Constants::SPECTRUM_FFT_SIZE)),
+      sampleRate(0), channels(0), isFloat(false), running(false), stopThread(false) {
+    frame.bands.assign(Constants::SPECTRUM_BANDS, 0.0f);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    stop();
+}
+
+bool SpectrumAnalyzer::start() {
+    if (running) {
+        return true;
+    }
+    
+    Uint16 format = 0;
+    if (!Mix_QuerySpec(&sampleRate, &format, &channels) || channels < 1 || sampleRate <= 0) {
+        return false;
+    }
+    isFloat = SDL_AUDIO_ISFLOAT(format) && SDL_AUDIO_BITSIZE(format) == 32;
+    if (!isFloat && SDL_AUDIO_BITSIZE(format) != 16) {
+        return false;
+    }
+    computeBandEdges();
+    
+    // Left over from an earlier run: the tap is gone, so this thread is the only user
+    float discard[TAP_CHUNK];
+    while (ring.read(discard, TAP_CHUNK) > 0) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frame = Frame();
+        frame.bands.assign(Constants::SPECTRUM_BANDS, 0.0f);
+        stopThread = false;
+    }
+    
+    if (!Mix_RegisterEffect(MIX_CHANNEL_POST, tapOutput, nullptr, this)) {
+        return false;
+    }
+    analysisThread = std::thread(&SpectrumAnalyzer::analysisLoop, this);
+    running = true;
+    return true;
+}
+
+void SpectrumAnalyzer::stop() {
+    if (!running) {
+        return;
+    }
+    
+    // Takes the audio lock, so the callback is not running once this returns
+    Mix_UnregisterEffect(MIX_CHANNEL_POST, tapOutput);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopThread = true;
+    }
+    condition.notify_one();
+    analysisThread.join();
+    running = false;
+}
+
+bool SpectrumAnalyzer::isRunning() const {
+    return running;
+}
+
+SpectrumAnalyzer::Frame SpectrumAnalyzer::getFrame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frame;
+}
+
+void SpectrumAnalyzer::tapOutput(int, void* stream, int length, void* userData) {
+    SpectrumAnalyzer* self = static_cast<SpectrumAnalyzer*>(userData);
+    size_t sampleBytes = self->isFloat ? sizeof(float) : sizeof(int16_t);
+    size_t frames = static_cast<size_t>(length) / (sampleBytes * static_cast<size_t>(self->channels));
+    int channels = self->channels;
+    float scale = 1.0f / static_cast<float>(channels);
+    
+    float mono[TAP_CHUNK];
+    for (size_t start = 0; start < frames; start += TAP_CHUNK) {
+        size_t count = std::min(TAP_CHUNK, frames - start);
+        if (self->isFloat) {
+            const float* input = static_cast<const float*>(stream) + start * channels;
+            for (size_t i = 0; i < count; ++i) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; ++c) {
+                    sum += input[i * channels + c];
+                }
+                mono[i] = sum * scale;
+            }
+        } else {
+            const int16_t* input = static_cast<const int16_t*>(stream) + start * channels;
+            for (size_t i = 0; i < count; ++i) {
+                int sum = 0;
+                for (int c = 0; c < channels; ++c) {
+                    sum += input[i * channels + c];
+                }
+                mono[i] = static_cast<float>(sum) * (scale / 32768.0f);
+            }
+        }
+        
+        // A full ring means the analysis thread is stalled; the rest of this buffer isn't needed
+        if (self->ring.write(mono, count) < count) {
+            break;
+        }
+    }
+}
+
+void SpectrumAnalyzer::analysisLoop() {
+    Trace::setThreadName("spectrum-analyzer");
+    static Metrics::Histogram& analysisTime = Metrics::histogram("mbp_spectrum_analysis_seconds", "Time to analyse one spectrum frame");
+    
+    const size_t size = Constants::SPECTRUM_FFT_SIZE;
+    std::vector<float> history(size, 0.0f);     // Latest samples, oldest first
+    std::vector<float> incoming(ring.getCapacity());
+    std::vector<float> windowed(size);
+    std::vector<float> power(size / 2 + 1);
+    std::vector<float> bands(Constants::SPECTRUM_BANDS, 0.0f);
+    
+    // Normalization: a full-scale sine through the Hann window peaks at (size / 4)^2
+    const double fullScale = static_cast<double>(size) * size / 16.0;
+    auto lastTick = std::chrono::steady_clock::now();
+    double owed = 0.0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (condition.wait_for(lock, std::chrono::milliseconds(Constants::SPECTRUM_REFRESH_MS), [this] { return stopThread; })) {
+                return;
+            }
+        }
+        TRACE_ZONE("spectrum.analyse");
+        Metrics::ScopedTimer timer(analysisTime);
+        
+        // The mixer hands over whole buffers ahead of time; take them at playback pace
+        // so the bars move smoothly, skipping ahead if the backlog grows too long
+        auto now = std::chrono::steady_clock::now();
+        owed += std::chrono::duration<double>(now - lastTick).count() * sampleRate;
+        lastTick = now;
+        size_t backlog = ring.size();
+        if (backlog > ring.getCapacity() / 2) {
+            owed = static_cast<double>(backlog - ring.getCapacity() / 4);
+        }
+        size_t taken = ring.read(incoming.data(), std::min(backlog, static_cast<size_t>(owed)));
+        owed = std::max(0.0, owed - static_cast<double>(taken));
+        if (taken == 0) {
+            owed = std::min(owed, static_cast<double>(size));
+        }
+        
+        if (taken >= size) {
+            std::copy(incoming.begin() + (taken - size), incoming.begin() + taken, history.begin());
+        } else {
+            std::copy(history.begin() + taken, history.end(), history.begin());
+            std::copy(incoming.begin(), incoming.begin() + taken, history.end() - taken);
+        }
+        
+        for (size_t i = 0; i < size; ++i) {
+            windowed[i] = history[i] * window[i];
+        }
+        fft.powerSpectrum(windowed.data(), power.data());
+        
+        // Bars jump up at once and fall back gradually
+        for (size_t b = 0; b < bands.size(); ++b) {
+            float strongest = 0.0f;
+            for (size_t bin = bandEdges[b]; bin < bandEdges[b + 1]; ++bin) {
+                strongest = std::max(strongest, power[bin]);
+            }
+            bands[b] = std::max(toHeight(strongest / fullScale), bands[b] * Constants::SPECTRUM_DECAY);
+        }
+        
+        // Level of what arrived since the last frame (the last window if nothing did)
+        size_t recent = std::min(std::max<size_t>(taken, 1), size);
+        double energy = 0.0;
+        float peak = 0.0f;
+        for (size_t i = size - recent; i < size; ++i) {
+            energy += static_cast<double>(history[i]) * history[i];
+            peak = std::max(peak, std::fabs(history[i]));
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        frame.bands = bands;
+        frame.level = toHeight(energy / recent);
+        frame.peak = toHeight(static_cast<double>(peak) * peak);
+    }
+}
+
+void SpectrumAnalyzer::computeBandEdges() {
+    // Log-spaced band limits as power bins; every band gets at least one bin
+    const size_t bins = Constants::SPECTRUM_FFT_SIZE / 2 + 1;
+    const double binHz = static_cast<double>(sampleRate) / Constants::SPECTRUM_FFT_SIZE;
+    const double ratio = Constants::SPECTRUM_MAX_HZ / Constants::SPECTRUM_MIN_HZ;
+    bandEdges.assign(Constants::SPECTRUM_BANDS + 1, 0);
+    
+    size_t previous = 0;
+    for (size_t b = 0; b <= Constants::SPECTRUM_BANDS; ++b) {
+        double hz = Constants::SPECTRUM_MIN_HZ * std::pow(ratio, static_cast<double>(b) / Constants::SPECTRUM_BANDS);
+        size_t bin = static_cast<size_t>(std::lround(hz / binHz));
+        if (b > 0) {
+            bin = std::max(bin, previous + 1);
+        }
+        bandEdges[b] = std::min(bin, bins);
+        previous = bandEdges[b];
+    }
+}
@@ -0,0 +1,217 @@
+#include "../../include/services/WaveformService.h"
+#include "../../include/services/AudioDecoder.h"
+#include "../../include/utils/ContentSignature.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/Constants.h"
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    constexpr int IOPRIO_WHO_PROCESS = 1;   // With id 0: the calling thread
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+
+    // Run the calling thread only when nothing else wants the CPU or the disk
+    void lowerPriority() {
+        sched_param param{};
+        pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#ifdef SYS_ioprio_set
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+    }
+}
+
+WaveformService::WaveformService(const std::string& cacheDirectory)
+    : cacheDirectory(cacheDirectory), stopWorker(false) {
+}
+
+WaveformService::~WaveformService() {
+    stop();
+}
+
+bool WaveformService::request(const std::vector<std::string>& filePaths) {
+    // The idle-priority worker may sit preempted holding the lock; the caller holds the player's
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    if (stopWorker) {
+        return true;
+    }
+    
+    // Back to front, so filePaths[0] ends up at the head of the queue
+    for (auto path = filePaths.rbegin(); path != filePaths.rend(); ++path) {
+        if (resident.count(*path) || failed.count(*path)) {
+            continue;
+        }
+        queue.erase(std::remove(queue.begin(), queue.end(), *path), queue.end());
+        queue.push_front(*path);
+    }
+    
+    if (!queue.empty()) {
+        if (!worker.joinable()) {
+            worker = std::thread(&WaveformService::workerLoop, this);
+        }
+        condition.notify_one();
+    }
+    return true;
+}
+
+std::shared_ptr<const WaveformPeaks> WaveformService::getPeaks(const std::string& filePath) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return nullptr;
+    }
+    auto it = resident.find(filePath);
+    return it != resident.end() ? it->second : nullptr;
+}
+
+void WaveformService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopWorker = true;
+        queue.clear();
+    }
+    condition.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::string WaveformService::getDefaultCacheDir() {
+    const char* directory = std::getenv("MBP_WAVEFORM_DIR");
+    if (directory && *directory) {
+        return directory;
+    }
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome && *cacheHome) {
+        return std::string(cacheHome) + "/MediaBrowserPlayer/waveforms";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/MediaBrowserPlayer/waveforms";
+    }
+    return Constants::WAVEFORM_CACHE_DIR;
+}
+
+void WaveformService::workerLoop() {
+    Trace::setThreadName("waveform-worker");
+    lowerPriority();
+    
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopWorker || !queue.empty(); });
+            if (stopWorker) {
+                return;
+            }
+            path = std::move(queue.front());
+            queue.pop_front();
+        }
+        
+        std::shared_ptr<const WaveformPeaks> peaks = prepare(path);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!peaks) {
+            failed.insert(path);
+            continue;
+        }
+        resident[path] = peaks;
+        residentOrder.push_back(path);
+        while (residentOrder.size() > Constants::WAVEFORM_MAX_RESIDENT) {
+            resident.erase(residentOrder.front());
+            residentOrder.pop_front();
+        }
+    }
+}
+
+std::shared_ptr<const WaveformPeaks> WaveformService::prepare(const std::string& filePath) {
+    static Metrics::Counter& cacheHits = Metrics::counter("mbp_waveform_cache_hits_total", "Waveforms loaded from the sidecar cache");
+    static Metrics::Counter& decoded = Metrics::counter("mbp_waveforms_decoded_total", "Audio files decoded for waveforms");
+    static Metrics::Histogram& decodeTime = Metrics::histogram("mbp_waveform_seconds", "Time to decode one file and compute its waveform");
+    
+    uint64_t signature = ContentSignature::compute(filePath);
+    if (signature == 0) {
+        return nullptr;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.peaks", static_cast<unsigned long long>(signature));
+    std::string sidecarPath = cacheDirectory + "/" + name;
+    
+    auto peaks = std::make_shared<WaveformPeaks>();
+    if (WaveformPeaks::load(sidecarPath, *peaks)) {
+        cacheHits.add();
+        // The modification time records the last use for trimCache()
+        std::error_code error;
+        std::filesystem::last_write_time(sidecarPath, std::filesystem::file_time_type::clock::now(), error);
+        return peaks;
+    }
+    
+    {
+        Metrics::ScopedTimer timer(decodeTime);
+        // A longer track would need its whole length in memory: it keeps the plain seek bar
+        std::vector<float> samples;
+        int sampleRate = 0;
+        bool complete = false;
+        if (!AudioDecoder::decodeMonoPrefix(filePath, Constants::WAVEFORM_MAX_SECONDS, 0.0f, samples, sampleRate, complete) ||
+            !complete) {
+            return nullptr;
+        }
+        *peaks = WaveformPeaks::compute(samples.data(), samples.size(), sampleRate);
+        decoded.add();
+    }
+    
+    // A cache that can't be written only costs a decode next time
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    if (peaks->save(sidecarPath)) {
+        trimCache();
+    }
+    return peaks;
+}
+
+void WaveformService::trimCache() {
+    static Metrics::Counter& evicted = Metrics::counter("mbp_waveform_cache_evictions_total", "Sidecar files deleted to keep the waveform cache small");
+    
+    struct Sidecar {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        uintmax_t size;
+    };
+    std::vector<Sidecar> sidecars;
+    uintmax_t total = 0;
+    std::error_code error;
+    for (std::filesystem::directory_iterator entry(cacheDirectory, error), end; !error && entry != end; entry.increment(error)) {
+        if (entry->path().extension() != ".peaks") {
+            continue;
+        }
+        std::error_code statError;
+        Sidecar sidecar{entry->path(), entry->last_write_time(statError), entry->file_size(statError)};
+        if (!statError) {
+            total += sidecar.size;
+            sidecars.push_back(std::move(sidecar));
+        }
+    }
+    if (total <= Constants::WAVEFORM_CACHE_MAX_BYTES) {
+        return;
+    }
+    
+    std::sort(sidecars.begin(), sidecars.end(), [](const Sidecar& a, const Sidecar& b) { return a.used < b.used; });
+    for (const auto& sidecar : sidecars) {
+        if (total <= Constants::WAVEFORM_CACHE_MAX_BYTES) {
+            break;
+        }
+        if (std::filesystem::remove(sidecar.path, error)) {
+            total -= sidecar.size;
+            evicted.add();
+        }
+    }
+}
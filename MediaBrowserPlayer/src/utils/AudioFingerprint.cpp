@@ -0,0 +1,116 @@
+#include "../../include/utils/AudioFingerprint.h"
+#include "../../include/utils/FFT.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr size_t BANDS = 33;
+    constexpr double LOWEST_FREQUENCY = 300.0;
+    constexpr double HIGHEST_FREQUENCY = 2000.0;
+
+    // Fewer words than this overlapping can't tell a match from chance
+    constexpr size_t MIN_OVERLAP = 16;
+}
+
+std::vector<uint32_t> AudioFingerprint::compute(const float* samples, size_t count, int sampleRate) {
+    TRACE_ZONE("fingerprint.compute");
+    std::vector<uint32_t> words;
+    if (sampleRate <= 0) {
+        return words;
+    }
+
+    // Start at the first audible sample, so encoder delay and padding don't shift the blocks
+    size_t start = 0;
+    while (start < count && std::fabs(samples[start]) < Constants::FINGERPRINT_SILENCE) {
+        start++;
+    }
+
+    // Decimate by averaging; aliasing from the crude filter is the same for every copy of a song
+    size_t factor = std::max<long>(1, std::lround(static_cast<double>(sampleRate) / Constants::FINGERPRINT_SAMPLE_RATE));
+    double rate = static_cast<double>(sampleRate) / static_cast<double>(factor);
+    size_t wanted = static_cast<size_t>(Constants::FINGERPRINT_SECONDS * rate) + Constants::FINGERPRINT_FRAME;
+    size_t available = (count - start) / factor;
+    std::vector<float> signal(std::min(wanted, available));
+    float scale = 1.0f / static_cast<float>(factor);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        const float* block = samples + start + i * factor;
+        float sum = 0.0f;
+        for (size_t j = 0; j < factor; ++j) {
+            sum += block[j];
+        }
+        signal[i] = sum * scale;
+    }
+    if (signal.size() < Constants::FINGERPRINT_FRAME) {
+        return words;
+    }
+
+    // FFT bin range of each band
+    size_t bandEdges[BANDS + 1];
+    for (size_t b = 0; b <= BANDS; ++b) {
+        double frequency = LOWEST_FREQUENCY * std::pow(HIGHEST_FREQUENCY / LOWEST_FREQUENCY, static_cast<double>(b) / BANDS);
+        bandEdges[b] = static_cast<size_t>(std::lround(frequency * Constants::FINGERPRINT_FRAME / rate));
+    }
+
+    FFT fft(Constants::FINGERPRINT_FRAME);
+    std::vector<float> window = FFT::makeHannWindow(Constants::FINGERPRINT_FRAME);
+    std::vector<float> block(Constants::FINGERPRINT_FRAME);
+    std::vector<float> power(Constants::FINGERPRINT_FRAME / 2 + 1);
+    float previous[BANDS - 1];
+    float current[BANDS - 1];
+
+    size_t blocks = (signal.size() - Constants::FINGERPRINT_FRAME) / Constants::FINGERPRINT_HOP + 1;
+    words.reserve(blocks - 1);
+    for (size_t n = 0; n < blocks; ++n) {
+        const float* input = signal.data() + n * Constants::FINGERPRINT_HOP;
+        for (size_t i = 0; i < Constants::FINGERPRINT_FRAME; ++i) {
+            block[i] = input[i] * window[i];
+        }
+        fft.powerSpectrum(block.data(), power.data());
+
+        float energy[BANDS];
+        for (size_t b = 0; b < BANDS; ++b) {
+            float sum = 0.0f;
+            for (size_t k = bandEdges[b]; k < bandEdges[b + 1]; ++k) {
+                sum += power[k];
+            }
+            energy[b] = sum;
+        }
+        for (size_t b = 0; b + 1 < BANDS; ++b) {
+            current[b] = energy[b] - energy[b + 1];
+        }
+
+        if (n > 0) {
+            uint32_t word = 0;
+            for (size_t b = 0; b + 1 < BANDS; ++b) {
+                word |= static_cast<uint32_t>(current[b] > previous[b]) << b;
+            }
+            words.push_back(word);
+        }
+        std::copy(current, current + BANDS - 1, previous);
+    }
+    return words;
+}
+
+double AudioFingerprint::compare(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    double best = 1.0;
+    for (int shift = -Constants::FINGERPRINT_MAX_SHIFT; shift <= Constants::FINGERPRINT_MAX_SHIFT; ++shift) {
+        size_t offsetA = shift > 0 ? static_cast<size_t>(shift) : 0;
+        size_t offsetB = shift < 0 ? static_cast<size_t>(-shift) : 0;
+        if (offsetA >= a.size() || offsetB >= b.size()) {
+            continue;
+        }
+        size_t overlap = std::min(a.size() - offsetA, b.size() - offsetB);
+        if (overlap < MIN_OVERLAP) {
+            continue;
+        }
+
+        size_t differing = 0;
+        for (size_t i = 0; i < overlap; ++i) {
+            differing += static_cast<size_t>(__builtin_popcount(a[offsetA + i] ^ b[offsetB + i]));
+        }
+        best = std::min(best, static_cast<double>(differing) / static_cast<double>(overlap * 32));
+    }
+    return best;
+}
@@ -0,0 +1,66 @@
+#include "../../include/utils/ByteRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+ByteRingBuffer::ByteRingBuffer(size_t capacity)
+    : buffer(capacity == 0 ? 1 : capacity), head(0), count(0) {
+}
+
+size_t ByteRingBuffer::write(const char* data, size_t size) {
+    size_t toWrite = std::min(size, available());
+    size_t tail = (head + count) % buffer.size();
+
+    // Copy in at most two pieces: up to the end of storage, then from the start
+    size_t firstPart = std::min(toWrite, buffer.size() - tail);
+    memcpy(&buffer[tail], data, firstPart);
+    memcpy(&buffer[0], data + firstPart, toWrite - firstPart);
+
+    count += toWrite;
+    return toWrite;
+}
+
+size_t ByteRingBuffer::size() const {
+    return count;
+}
+
+size_t ByteRingBuffer::available() const {
+    return buffer.size() - count;
+}
+
+bool ByteRingBuffer::isEmpty() const {
+    return count == 0;
+}
+
+char ByteRingBuffer::peek(size_t offset) const {
+    return buffer[(head + offset) % buffer.size()];
+}
+
+size_t ByteRingBuffer::find(char value, size_t start) const {
+    for (size_t i = start; i < count; ++i) {
+        if (peek(i) == value) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+void ByteRingBuffer::read(size_t n, std::string& out) {
+    n = std::min(n, count);
+
+    size_t firstPart = std::min(n, buffer.size() - head);
+    out.append(&buffer[head], firstPart);
+    out.append(&buffer[0], n - firstPart);
+
+    discard(n);
+}
+
+void ByteRingBuffer::discard(size_t n) {
+    n = std::min(n, count);
+    head = (head + n) % buffer.size();
+    count -= n;
+}
+
+void ByteRingBuffer::clear() {
+    head = 0;
+    count = 0;
+}
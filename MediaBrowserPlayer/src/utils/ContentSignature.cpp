@@ -0,0 +1,264 @@
+#include "../../include/utils/ContentSignature.h"
+#include "../../include/utils/XXHash64.h"
+#include "../../include/Constants.h"
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    // Walking container chunks or Ogg header pages gives up after this many (malformed or hostile files)
+    constexpr int MAX_CHUNKS = 256;
+    constexpr int MAX_HEADER_PAGES = 4096;
+    
+    // Read exactly length bytes at offset; false on error or end of file
+    bool readAt(int fd, unsigned char* buffer, size_t length, long long offset) {
+        while (length > 0) {
+            ssize_t n = pread(fd, buffer, length, static_cast<off_t>(offset));
+            if (n <= 0) {
+                return false;
+            }
+            buffer += n;
+            length -= static_cast<size_t>(n);
+            offset += n;
+        }
+        return true;
+    }
+
+    // Offset just past the tags and metadata blocks at the start of the file
+    long long findPayloadBegin(int fd, long long size) {
+        long long begin = 0;
+        unsigned char header[10];
+        
+        // ID3v2 tags, possibly several in a row: "ID3", version, flags, syncsafe size
+        while (begin + 10 <= size && readAt(fd, header, 10, begin) && std::memcmp(header, "ID3", 3) == 0) {
+            if (header[3] == 0xFF || header[4] == 0xFF || ((header[6] | header[7] | header[8] | header[9]) & 0x80)) {
+                break;
+            }
+            long long tagSize = (static_cast<long long>(header[6]) << 21) | (header[7] << 14) | (header[8] << 7) | header[9];
+            begin += 10 + tagSize + ((header[5] & 0x10) ? 10 : 0);
+        }
+        
+        // FLAC: "fLaC", then metadata blocks up to the one flagged last
+        if (begin + 4 <= size && readAt(fd, header, 4, begin) && std::memcmp(header, "fLaC", 4) == 0) {
+            long long position = begin + 4;
+            while (position + 4 <= size && readAt(fd, header, 4, position)) {
+                position += 4 + ((header[1] << 16) | (header[2] << 8) | header[3]);
+                if (header[0] & 0x80) {
+                    break;
+                }
+            }
+            begin = position;
+        }
+        return begin < size ? begin : size;
+    }
+
+    uint32_t readLittle32(const unsigned char* bytes) {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+    
+    uint32_t readBig32(const unsigned char* bytes) {
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+    }
+    
+    // Audio chunk of a RIFF/WAVE ("data") or AIFF ("SSND") file, so LIST/INFO and "id3 "
+    // chunks on either side are left out; false if the file isn't one or has no such chunk
+    bool findAudioChunk(int fd, long long begin, long long size, long long& payloadBegin, long long& payloadEnd) {
+        unsigned char header[12];
+        if (begin + 12 > size || !readAt(fd, header, 12, begin)) {
+            return false;
+        }
+        bool riff = std::memcmp(header, "RIFF", 4) == 0 && std::memcmp(header + 8, "WAVE", 4) == 0;
+        bool aiff = std::memcmp(header, "FORM", 4) == 0 &&
+                    (std::memcmp(header + 8, "AIFF", 4) == 0 || std::memcmp(header + 8, "AIFC", 4) == 0);
+        if (!riff && !aiff) {
+            return false;
+        }
+        
+        // Chunks: 4-byte ID, 4-byte size (little-endian in RIFF, big-endian in AIFF), body padded to even
+        long long position = begin + 12;
+        for (int chunk = 0; chunk < MAX_CHUNKS && position + 8 <= size && readAt(fd, header, 8, position); ++chunk) {
+            long long chunkSize = riff ? readLittle32(header + 4) : readBig32(header + 4);
+            if (std::memcmp(header, riff ? "data" : "SSND", 4) == 0) {
+                payloadBegin = position + 8;
+                payloadEnd = payloadBegin + chunkSize < size ? payloadBegin + chunkSize : size;
+                return true;
+            }
+            position += 8 + chunkSize + (chunkSize & 1);
+        }
+        return false;
+    }
+    
+    // Body of the first top-level "mdat" box of an MP4/M4A file, so "moov" (and the
+    // udta/ilst tags in it) is left out wherever it sits; false if there is none
+    bool findMediaData(int fd, long long begin, long long size, long long& payloadBegin, long long& payloadEnd) {
+        unsigned char header[16];
+        if (begin + 8 > size || !readAt(fd, header, 8, begin) || std::memcmp(header + 4, "ftyp", 4) != 0) {
+            return false;
+        }
+        
+        // Boxes: 4-byte size (1: 64-bit size follows, 0: to the end of the file), 4-byte type
+        long long position = begin;
+        for (int box = 0; box < MAX_CHUNKS && position + 8 <= size && readAt(fd, header, 8, position); ++box) {
+            long long headerSize = 8;
+            long long boxSize = readBig32(header);
+            if (boxSize == 1) {
+                if (position + 16 > size || !readAt(fd, header + 8, 8, position + 8)) {
+                    return false;
+                }
+                boxSize = (static_cast<long long>(readBig32(header + 8)) << 32) | readBig32(header + 12);
+                headerSize = 16;
+            } else if (boxSize == 0) {
+                boxSize = size - position;
+            }
+            if (boxSize < headerSize) {
+                return false;
+            }
+            if (std::memcmp(header + 4, "mdat", 4) == 0) {
+                payloadBegin = position + headerSize;
+                payloadEnd = boxSize <= size - position ? position + boxSize : size;
+                return true;
+            }
+            position += boxSize;
+        }
+        return false;
+    }
+    
+    // Offset of the first Ogg audio page, past the header pages (identification, comment
+    // and setup packets). Header pages carry granule position 0, or -1 where a long comment
+    // packet continues; begin if the file isn't Ogg
+    long long skipOggHeaders(int fd, long long begin, long long size, bool& isOgg) {
+        unsigned char header[27 + 255];
+        long long position = begin;
+        isOgg = false;
+        for (int page = 0; page < MAX_HEADER_PAGES && position + 27 <= size && readAt(fd, header, 27, position); ++page) {
+            if (std::memcmp(header, "OggS", 4) != 0) {
+                break;
+            }
+            bool zero = true, allOnes = true;
+            for (int i = 6; i < 14; ++i) {
+                zero = zero && header[i] == 0;
+                allOnes = allOnes && header[i] == 0xFF;
+            }
+            if (!zero && !allOnes) {
+                isOgg = true;
+                return position;
+            }
+            
+            unsigned segments = header[26];
+            if (!readAt(fd, header + 27, segments, position + 27)) {
+                break;
+            }
+            long long bodySize = 0;
+            for (unsigned i = 0; i < segments; ++i) {
+                bodySize += header[27 + i];
+            }
+            position += 27 + segments + bodySize;
+        }
+        return begin;
+    }
+    
+    // Clear the sequence number and CRC of the Ogg pages laid out from the start of data:
+    // a comment packet that now spans more or fewer pages renumbers every page after it
+    void maskOggPages(unsigned char* data, size_t length) {
+        size_t position = 0;
+        while (position + 27 <= length && std::memcmp(data + position, "OggS", 4) == 0) {
+            std::memset(data + position + 18, 0, 8);
+            size_t segments = data[position + 26];
+            if (position + 27 + segments > length) {
+                break;
+            }
+            size_t bodySize = 0;
+            for (size_t i = 0; i < segments; ++i) {
+                bodySize += data[position + 27 + i];
+            }
+            position += 27 + segments + bodySize;
+        }
+    }
+    
+    // Offset of the first tag byte at the end of the file (size if there are none)
+    long long findPayloadEnd(int fd, long long begin, long long size) {
+        long long end = size;
+        unsigned char footer[32];
+        
+        // ID3v1: fixed 128 bytes starting with "TAG"
+        if (end - begin >= 128 && readAt(fd, footer, 3, end - 128) && std::memcmp(footer, "TAG", 3) == 0) {
+            end -= 128;
+        }
+        
+        // APEv2: 32-byte footer; its size covers items and footer, plus a 32-byte header if flagged
+        if (end - begin >= 32 && readAt(fd, footer, 32, end - 32) && std::memcmp(footer, "APETAGEX", 8) == 0) {
+            long long tagSize = footer[12] | (footer[13] << 8) | (footer[14] << 16) | (static_cast<long long>(footer[15]) << 24);
+            if (footer[23] & 0x80) {
+                tagSize += 32;
+            }
+            end -= tagSize;
+        }
+        return end > begin ? end : begin;
+    }
+}
+
+namespace ContentSignature {
+    uint64_t compute(const std::string& filePath) {
+        int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+        
+        struct stat info;
+        uint64_t signature = 0;
+        if (fstat(fd, &info) == 0) {
+            // Containers that keep their tags inside are cut down to the audio itself
+            long long size = static_cast<long long>(info.st_size);
+            long long begin = findPayloadBegin(fd, size);
+            long long end = size;
+            bool isOgg = false;
+            if (!findAudioChunk(fd, begin, size, begin, end) && !findMediaData(fd, begin, size, begin, end)) {
+                begin = skipOggHeaders(fd, begin, size, isOgg);
+                end = findPayloadEnd(fd, begin, size);
+            }
+            long long length = end - begin;
+            
+            XXHash64 hasher;
+            unsigned char lengthBytes[8];
+            for (int i = 0; i < 8; ++i) {
+                lengthBytes[i] = static_cast<unsigned char>(static_cast<unsigned long long>(length) >> (8 * i));
+            }
+            hasher.update(lengthBytes, sizeof(lengthBytes));
+            
+            // First block, then the last one (not overlapping the first)
+            long long block = static_cast<long long>(Constants::CONTENT_SIGNATURE_BLOCK);
+            long long headLength = length < block ? length : block;
+            long long tailLength = length - headLength < block ? length - headLength : block;
+            std::vector<unsigned char> buffer(static_cast<size_t>(headLength > 0 ? headLength : 1));
+            
+            bool ok = readAt(fd, buffer.data(), static_cast<size_t>(headLength), begin);
+            if (ok) {
+                if (isOgg) {
+                    maskOggPages(buffer.data(), static_cast<size_t>(headLength));
+                }
+                hasher.update(buffer.data(), static_cast<size_t>(headLength));
+                ok = readAt(fd, buffer.data(), static_cast<size_t>(tailLength), end - tailLength);
+            }
+            if (ok) {
+                // The last block starts mid-page; hash it from the first page boundary in it
+                size_t skip = 0;
+                if (isOgg) {
+                    while (skip + 4 <= static_cast<size_t>(tailLength) && std::memcmp(buffer.data() + skip, "OggS", 4) != 0) {
+                        skip++;
+                    }
+                    skip = skip + 4 <= static_cast<size_t>(tailLength) ? skip : 0;
+                    maskOggPages(buffer.data() + skip, static_cast<size_t>(tailLength) - skip);
+                }
+                hasher.update(buffer.data() + skip, static_cast<size_t>(tailLength) - skip);
+                signature = hasher.digest();
+                if (signature == 0) {
+                    signature = 1;
+                }
+            }
+        }
+        close(fd);
+        return signature;
+    }
+}
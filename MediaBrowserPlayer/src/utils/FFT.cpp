@@ -0,0 +1,106 @@
+#include "../../include/utils/FFT.h"
+#include <cmath>
+#include <stdexcept>
+
+FFT::FFT(size_t size) : size(size), half(size / 2) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two >= 4");
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < half) {
+        bits++;
+    }
+    bitReverse.resize(half);
+    for (size_t i = 0; i < half; ++i) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= static_cast<uint32_t>((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    const double pi = std::acos(-1.0);
+    for (size_t len = 2; len <= half; len <<= 1) {
+        for (size_t j = 0; j < len / 2; ++j) {
+            double angle = -2.0 * pi * static_cast<double>(j) / static_cast<double>(len);
+            stageCos.push_back(static_cast<float>(std::cos(angle)));
+            stageSin.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    splitCos.resize(half);
+    splitSin.resize(half);
+    for (size_t k = 0; k < half; ++k) {
+        double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+        splitCos[k] = static_cast<float>(std::cos(angle));
+        splitSin[k] = static_cast<float>(std::sin(angle));
+    }
+
+    re.resize(half);
+    im.resize(half);
+}
+
+size_t FFT::getSize() const {
+    return size;
+}
+
+void FFT::powerSpectrum(const float* input, float* power) {
+    // z[n] = x[2n] + i*x[2n+1], stored in bit-reversed order
+    for (size_t n = 0; n < half; ++n) {
+        uint32_t target = bitReverse[n];
+        re[target] = input[2 * n];
+        im[target] = input[2 * n + 1];
+    }
+
+    float* real = re.data();
+    float* imag = im.data();
+    const float* cosines = stageCos.data();
+    const float* sines = stageSin.data();
+    for (size_t len = 2; len <= half; len <<= 1) {
+        size_t span = len / 2;
+        for (size_t start = 0; start < half; start += len) {
+            float* aRe = real + start;
+            float* aIm = imag + start;
+            float* bRe = aRe + span;
+            float* bIm = aIm + span;
+            for (size_t j = 0; j < span; ++j) {
+                float tRe = bRe[j] * cosines[j] - bIm[j] * sines[j];
+                float tIm = bRe[j] * sines[j] + bIm[j] * cosines[j];
+                bRe[j] = aRe[j] - tRe;
+                bIm[j] = aIm[j] - tIm;
+                aRe[j] += tRe;
+                aIm[j] += tIm;
+            }
+        }
+        cosines += span;
+        sines += span;
+    }
+
+    // X[k] = E[k] + W^k O[k], with E/O the spectra of the even/odd samples:
+    // E[k] = (Z[k] + conj(Z[half-k])) / 2, O[k] = (Z[k] - conj(Z[half-k])) / 2i
+    power[0] = (real[0] + imag[0]) * (real[0] + imag[0]);
+    power[half] = (real[0] - imag[0]) * (real[0] - imag[0]);
+    for (size_t k = 1; k < half; ++k) {
+        float aRe = real[k];
+        float aIm = imag[k];
+        float bRe = real[half - k];
+        float bIm = imag[half - k];
+        float evenRe = 0.5f * (aRe + bRe);
+        float evenIm = 0.5f * (aIm - bIm);
+        float oddRe = 0.5f * (aIm + bIm);
+        float oddIm = -0.5f * (aRe - bRe);
+        float xRe = evenRe + splitCos[k] * oddRe - splitSin[k] * oddIm;
+        float xIm = evenIm + splitCos[k] * oddIm + splitSin[k] * oddRe;
+        power[k] = xRe * xRe + xIm * xIm;
+    }
+}
+
+std::vector<float> FFT::makeHannWindow(size_t size) {
+    const double pi = std::acos(-1.0);
+    std::vector<float> window(size);
+    for (size_t n = 0; n < size; ++n) {
+        window[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(n) / static_cast<double>(size)));
+    }
+    return window;
+}
@@ -0,0 +1,12 @@
+#include "../../include/utils/FileStamp.h"
+#include <sys/stat.h>
+
+bool FileStamp::read(const std::string& filePath, FileStamp& stamp) {
+    struct stat info;
+    if (stat(filePath.c_str(), &info) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<long long>(info.st_size);
+    stamp.modified = static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+    return true;
+}
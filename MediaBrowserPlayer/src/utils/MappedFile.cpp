@@ -0,0 +1,67 @@
+#include "../../include/utils/MappedFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile() : address(nullptr), length(0), opened(false) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filePath) {
+    close();
+
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // mmap() rejects zero-length mappings; an empty file is simply empty data
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        address = mapped;
+
+        // Parsed front to back exactly once
+        madvise(address, length, MADV_SEQUENTIAL);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (address) {
+        munmap(address, length);
+    }
+    address = nullptr;
+    length = 0;
+    opened = false;
+}
+
+std::string_view MappedFile::data() const {
+    if (!address) {
+        return std::string_view();
+    }
+    return std::string_view(static_cast<const char*>(address), length);
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
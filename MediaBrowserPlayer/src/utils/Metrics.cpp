@@ -0,0 +1,164 @@
+#include "../../include/utils/Metrics.h"
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    enum class Type {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    // All series sharing a name; keyed by their label string
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Metrics::Counter>> counters;
+        std::map<std::string, std::unique_ptr<Metrics::Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Metrics::Histogram>> histograms;
+    };
+
+    std::mutex registryMutex;
+    std::map<std::string, Family> families;
+
+    Family& getFamily(const std::string& name, const std::string& help, Type type) {
+        auto result = families.emplace(name, Family{type, help, {}, {}, {}});
+        if (result.first->second.type != type) {
+            throw std::invalid_argument("Metric registered twice with different types: " + name);
+        }
+        return result.first->second;
+    }
+
+    template <typename Metric>
+    Metric& getSeries(std::map<std::string, std::unique_ptr<Metric>>& series, const std::string& labels) {
+        std::unique_ptr<Metric>& metric = series[labels];
+        if (!metric) {
+            metric = std::make_unique<Metric>();
+        }
+        return *metric;
+    }
+
+    // name{labels} or name{labels,extra}
+    std::string seriesName(const std::string& name, const std::string& labels, const std::string& extra = "") {
+        if (labels.empty() && extra.empty()) {
+            return name;
+        }
+        std::string separator = labels.empty() || extra.empty() ? "" : ",";
+        return name + "{" + labels + separator + extra + "}";
+    }
+
+    std::string formatSeconds(uint64_t nanoseconds) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.9g", nanoseconds / 1e9);
+        return text;
+    }
+
+    void appendHelp(std::string& out, const std::string& help) {
+        for (char c : help) {
+            if (c == '\\') {
+                out += "\\\\";
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+    }
+}
+
+namespace Metrics {
+    uint64_t Counter::getValue() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void Histogram::observe(std::chrono::nanoseconds duration) {
+        uint64_t ns = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+        size_t bucket = 0;
+        while (bucket < BUCKET_COUNT && ns > BUCKET_BOUNDS_NS[bucket]) {
+            ++bucket;
+        }
+
+        Shard& shard = shards[shardIndex()];
+        shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        shard.sumNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    Histogram::Snapshot Histogram::getSnapshot() const {
+        Snapshot snapshot;
+        for (const auto& shard : shards) {
+            for (size_t i = 0; i <= BUCKET_COUNT; ++i) {
+                snapshot.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+            }
+            snapshot.sumNs += shard.sumNs.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return getSeries(getFamily(name, help, Type::COUNTER).counters, labels);
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return getSeries(getFamily(name, help, Type::GAUGE).gauges, labels);
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return getSeries(getFamily(name, help, Type::HISTOGRAM).histograms, labels);
+    }
+
+    std::string renderPrometheus() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::string out;
+
+        for (const auto& entry : families) {
+            const std::string& name = entry.first;
+            const Family& family = entry.second;
+
+            out += "# HELP " + name + " ";
+            appendHelp(out, family.help);
+            out += "\n";
+
+            switch (family.type) {
+                case Type::COUNTER:
+                    out += "# TYPE " + name + " counter\n";
+                    for (const auto& series : family.counters) {
+                        out += seriesName(name, series.first) + " " + std::to_string(series.second->getValue()) + "\n";
+                    }
+                    break;
+                case Type::GAUGE:
+                    out += "# TYPE " + name + " gauge\n";
+                    for (const auto& series : family.gauges) {
+                        out += seriesName(name, series.first) + " " + std::to_string(series.second->getValue()) + "\n";
+                    }
+                    break;
+                case Type::HISTOGRAM:
+                    out += "# TYPE " + name + " histogram\n";
+                    for (const auto& series : family.histograms) {
+                        Histogram::Snapshot snapshot = series.second->getSnapshot();
+                        uint64_t cumulative = 0;
+                        for (size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+                            cumulative += snapshot.counts[i];
+                            std::string le = "le=\"" + formatSeconds(Histogram::BUCKET_BOUNDS_NS[i]) + "\"";
+                            out += seriesName(name + "_bucket", series.first, le) + " " + std::to_string(cumulative) + "\n";
+                        }
+                        cumulative += snapshot.counts[Histogram::BUCKET_COUNT];
+                        out += seriesName(name + "_bucket", series.first, "le=\"+Inf\"") + " " + std::to_string(cumulative) + "\n";
+                        out += seriesName(name + "_sum", series.first) + " " + formatSeconds(snapshot.sumNs) + "\n";
+                        out += seriesName(name + "_count", series.first) + " " + std::to_string(cumulative) + "\n";
+                    }
+                    break;
+            }
+        }
+        return out;
+    }
+}
@@ -0,0 +1,110 @@
+#include "../../include/utils/RecordReader.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+RecordReader::RecordReader(std::string_view data)
+    : data(data), position(0), fieldPosition(0), fieldsLeft(false) {
+}
+
+bool RecordReader::nextRecord() {
+    if (position >= data.size()) {
+        return false;
+    }
+
+    // memchr is vectorised by libc; much faster than a byte loop on long files
+    const char* start = data.data() + position;
+    const void* newline = memchr(start, '\n', data.size() - position);
+    size_t end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data.data()) : data.size();
+
+    record = data.substr(position, end - position);
+    if (!record.empty() && record.back() == '\r') {
+        record.remove_suffix(1);
+    }
+    position = end + 1;
+    fieldPosition = 0;
+    fieldsLeft = true;
+    return true;
+}
+
+std::string_view RecordReader::getRecord() const {
+    return record;
+}
+
+bool RecordReader::nextField(std::string_view& field) {
+    if (!fieldsLeft) {
+        return false;
+    }
+
+    // Fast path: scan to the separator, noting whether any escape shows up
+    size_t i = fieldPosition;
+    bool escaped = false;
+    while (i < record.size() && record[i] != FIELD_SEPARATOR) {
+        if (record[i] == ESCAPE && i + 1 < record.size()) {
+            escaped = true;
+            ++i; // The escaped character can't end the field
+        }
+        ++i;
+    }
+
+    std::string_view raw = record.substr(fieldPosition, i - fieldPosition);
+    fieldsLeft = i < record.size();
+    fieldPosition = i + 1;
+
+    if (!escaped) {
+        field = raw;
+        return true;
+    }
+
+    scratch.clear();
+    for (size_t j = 0; j < raw.size(); ++j) {
+        char c = raw[j];
+        if (c == ESCAPE && j + 1 < raw.size()) {
+            char next = raw[j + 1];
+            if (next == FIELD_SEPARATOR || next == ESCAPE) {
+                c = next;
+                ++j;
+            } else if (next == 'n') {
+                c = '\n';
+                ++j;
+            } else if (next == 'r') {
+                c = '\r';
+                ++j;
+            }
+        }
+        scratch.push_back(c);
+    }
+    field = scratch;
+    return true;
+}
+
+bool RecordReader::nextNumber(long long& value) {
+    std::string_view field;
+    if (!nextField(field)) {
+        return false;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool RecordReader::nextNumber(double& value) {
+    std::string_view field;
+    if (!nextField(field)) {
+        return false;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool RecordReader::nextHex(unsigned long long& value) {
+    std::string_view field;
+    if (!nextField(field)) {
+        return false;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value, 16);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+bool RecordReader::atRecordEnd() const {
+    return !fieldsLeft;
+}
@@ -0,0 +1,69 @@
+#include "../../include/utils/RecordWriter.h"
+#include "../../include/utils/RecordReader.h"
+#include <charconv>
+#include <cstdio>
+
+RecordWriter::RecordWriter(std::string& out) : out(out), firstField(true) {
+}
+
+void RecordWriter::separate() {
+    if (!firstField) {
+        out.push_back(RecordReader::FIELD_SEPARATOR);
+    }
+    firstField = false;
+}
+
+void RecordWriter::field(std::string_view value) {
+    separate();
+
+    // Common case: nothing to escape, append in one go
+    if (value.find_first_of("|\\\n\r") == std::string_view::npos) {
+        out.append(value.data(), value.size());
+        return;
+    }
+
+    for (char c : value) {
+        switch (c) {
+            case RecordReader::FIELD_SEPARATOR:
+            case RecordReader::ESCAPE:
+                out.push_back(RecordReader::ESCAPE);
+                out.push_back(c);
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            default:
+                out.push_back(c);
+        }
+    }
+}
+
+void RecordWriter::field(long long value) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void RecordWriter::field(double value) {
+    separate();
+    // Same 6 significant digits operator<< used to write
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%g", value);
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+void RecordWriter::hexField(unsigned long long value) {
+    separate();
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", value);
+    out.append(buffer, 16);
+}
+
+void RecordWriter::endRecord() {
+    out.push_back('\n');
+    firstField = true;
+}
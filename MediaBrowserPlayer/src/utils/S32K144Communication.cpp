@@ -1,78 +1,130 @@
 #include "../../include/utils/S32K144Communication.h"
 #include "../../include/Constants.h"
+#include "../../include/utils/Metrics.h"
 #include <thread>
 #include <chrono>
 #include <sstream>
 #include <algorithm>
 #include <cstring>
+#include <cerrno>
+#include <cstdint>
 #include <iostream>
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
-S32K144Communication::S32K144Communication() : serialPort(-1), connected(false){
+namespace {
+    // Receive buffer and per-syscall read size
+    constexpr size_t RX_BUFFER_SIZE = 4096;
+    constexpr size_t READ_CHUNK = 256;
+}
+
+S32K144Communication::S32K144Communication()
+    : serialPort(-1), connected(false), epollFd(-1), wakeFd(-1), rxBuffer(RX_BUFFER_SIZE), txOffset(0) {
 }
 
 S32K144Communication::~S32K144Communication() {
     disconnect();
 }
 
-bool S32K144Communication::connect() {
+bool S32K144Communication::connect(const std::string& port, int baudrate) {
     if (connected) {
         return true;
     }
-    
-    // Open serial port
-    serialPort = open("/dev/ttyACM0", O_RDWR | O_NOCTTY | O_NDELAY);
+    disconnect(); // Close what a lost connection left behind
+
+    // Open serial port (non-blocking: epoll tells us when there is something to read)
+    serialPort = open(port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (serialPort < 0) {
-        std::cerr << "Can't open UART port" << std::endl;
-        return 1;
+        std::cerr << "Can't open UART port " << port << std::endl;
+        return false;
+    }
+
+    // Initialize UART
+    if (!initializeUART(baudrate)) {
+        close(serialPort);
+        serialPort = -1;
+        return false;
+    }
+
+    // Register the port and a wake-up eventfd with epoll
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::cerr << "Can't create UART event loop" << std::endl;
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+        close(serialPort);
+        epollFd = wakeFd = serialPort = -1;
+        return false;
     }
 
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = serialPort;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, serialPort, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    rxBuffer.clear();
+    events.clear();
+    txFrame.clear();
+    txOffset = 0;
     connected = true;
 
-    // Initialize UART
-    initializeUART();
-    
     return connected;
 }
 
 void S32K144Communication::disconnect() {
-    if (!connected) {
+    // Also runs after connectionLost(), which leaves the descriptors open
+    if (serialPort < 0) {
         return;
     }
-    
+
     std::cout << "Disconnecting from S32K144..." << std::endl;
-    
+
     // Set flag to stop the read thread
     connected = false;
-    
-    // In a real application, close the serial port here
+
     close(serialPort);
+    close(epollFd);
+    close(wakeFd);
+    serialPort = epollFd = wakeFd = -1;
 }
 
-bool S32K144Communication::initializeUART() {
+bool S32K144Communication::initializeUART(int baudrate) {
+    speed_t speed = toSpeed(baudrate);
+    if (speed == 0) {
+        std::cerr << "Unsupported baud rate: " << baudrate << std::endl;
+        return false;
+    }
+
     termios tty;
     memset(&tty, 0, sizeof(tty));
     if (tcgetattr(serialPort, &tty) != 0) {
         std::cerr << "Error in getting port attributes" << std::endl;
         return false;
     }
-    
-    cfsetospeed(&tty, B9600); // baudrate
-    cfsetispeed(&tty, B9600);
-    
+
+    cfsetospeed(&tty, speed); // baudrate
+    cfsetispeed(&tty, speed);
+
     tty.c_cflag |= (CLOCAL | CREAD);    // Enable read
     tty.c_cflag &= ~CSIZE;
     tty.c_cflag |= CS8;                 // 8 bit data
     tty.c_cflag &= ~PARENB;             // No parity
     tty.c_cflag &= ~CSTOPB;             // 1 stop bit
     tty.c_cflag &= ~CRTSCTS;            // No thread Control
-    
+
     tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG); // Turn off line mode
     tty.c_iflag &= ~(IXON | IXOFF | IXANY);         // Don't use XON/XOFF
+    tty.c_iflag &= ~(ICRNL | INLCR | IGNCR | ISTRIP); // Binary frames: don't touch bytes
     tty.c_oflag &= ~OPOST;                          // Turn off output handler
-    
+
     tcsetattr(serialPort, TCSANOW, &tty);
     return true;
 }
@@ -81,20 +133,162 @@ bool S32K144Communication::isConnected() const{
     return connected;
 }
 
-std::string S32K144Communication::readData() {
+bool S32K144Communication::waitForData(int timeoutMs) {
     if (!connected) {
-        return "";
+        return false;
+    }
+
+    if (!events.empty()) {
+        return true;
+    }
+
+    epoll_event fired[2];
+    int ready = epoll_wait(epollFd, fired, 2, timeoutMs);
+    if (ready < 0) {
+        return false; // EINTR: caller re-checks its stop flag and waits again
     }
 
-    char ch;
+    for (int i = 0; i < ready; ++i) {
+        if (fired[i].data.fd == wakeFd) {
+            uint64_t value;
+            ssize_t ignored = read(wakeFd, &value, sizeof(value));
+            (void)ignored;
+            continue;
+        }
 
-    while (read(serialPort, &ch, 1) == 1){
-        if(ch == '.') {
-            std::string result = buffer;
-            buffer.clear();
-            return result;
+        // An unplug reports EPOLLIN together with EPOLLHUP; read what is left first
+        if (fired[i].events & EPOLLOUT) {
+            flushOutput();
+        }
+        bool alive = true;
+        if (fired[i].events & EPOLLIN) {
+            alive = readAvailable();
+        }
+        if (!alive || (fired[i].events & (EPOLLHUP | EPOLLERR))) {
+            connectionLost();
+            break;
         }
-        buffer += ch;
     }
-    return "";
-}
\ No newline at end of file
+
+    return !events.empty();
+}
+
+bool S32K144Communication::readEvent(S32K144Protocol::BoardEvent& event) {
+    if (events.empty()) {
+        return false;
+    }
+
+    event = events.front();
+    events.pop_front();
+    return true;
+}
+
+size_t S32K144Communication::getErrorCount() const {
+    return protocol.getErrorCount();
+}
+
+void S32K144Communication::wakeUp() {
+    if (wakeFd < 0) {
+        return;
+    }
+
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool S32K144Communication::sendFrame(const std::vector<uint8_t>& frame) {
+    if (!connected || txOffset < txFrame.size()) {
+        return false;
+    }
+
+    // Bytes already queued in the driver would delay this frame: let the caller coalesce
+    int queued = 0;
+    if (ioctl(serialPort, TIOCOUTQ, &queued) == 0 && queued > Constants::S32K144_TX_BACKLOG_LIMIT) {
+        return false;
+    }
+
+    txFrame = frame;
+    txOffset = 0;
+    flushOutput();
+    return true;
+}
+
+void S32K144Communication::flushOutput() {
+    static Metrics::Counter& sentBytes = Metrics::counter("mbp_serial_sent_bytes_total", "Bytes written to the S32K144 board");
+    while (txOffset < txFrame.size()) {
+        ssize_t n = write(serialPort, txFrame.data() + txOffset, txFrame.size() - txOffset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                txOffset = txFrame.size(); // Port error: give up on this frame
+            }
+            break;
+        }
+        txOffset += static_cast<size_t>(n);
+        sentBytes.add(static_cast<uint64_t>(n));
+    }
+
+    watchWritable(txOffset < txFrame.size());
+}
+
+void S32K144Communication::watchWritable(bool enable) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.fd = serialPort;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, serialPort, &event);
+}
+
+bool S32K144Communication::readAvailable() {
+    static Metrics::Counter& receivedBytes = Metrics::counter("mbp_serial_received_bytes_total", "Bytes read from the S32K144 board");
+    char chunk[READ_CHUNK];
+
+    while (true) {
+        // Never read more than the ring buffer can take
+        size_t want = std::min(sizeof(chunk), rxBuffer.available());
+        if (want == 0) {
+            // A frame longer than the whole buffer can only be line noise
+            rxBuffer.clear();
+            want = sizeof(chunk);
+        }
+
+        ssize_t n = read(serialPort, chunk, want);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true; // Drained
+        }
+        if (n <= 0) {
+            return false; // End of file or EIO: the device went away
+        }
+
+        receivedBytes.add(static_cast<uint64_t>(n));
+        rxBuffer.write(chunk, static_cast<size_t>(n));
+        protocol.decode(rxBuffer, events);
+    }
+}
+
+void S32K144Communication::connectionLost() {
+    // Level-triggered HUP would otherwise fire on every epoll_wait
+    std::cerr << "S32K144 connection lost" << std::endl;
+    connected = false;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, serialPort, nullptr);
+}
+
+speed_t S32K144Communication::toSpeed(int baudrate) {
+    switch (baudrate) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return 0;
+    }
+}
@@ -0,0 +1,182 @@
+#include "../../include/utils/S32K144Protocol.h"
+#include <algorithm>
+#include <cctype>
+
+S32K144Protocol::S32K144Protocol() : errorCount(0) {
+}
+
+void S32K144Protocol::decode(ByteRingBuffer& buffer, std::deque<BoardEvent>& events) {
+    while (!buffer.isEmpty()) {
+        bool progressed = (static_cast<uint8_t>(buffer.peek(0)) == SYNC)
+            ? decodeBinary(buffer, events)
+            : decodeText(buffer, events);
+
+        if (!progressed) {
+            break; // Wait for more bytes
+        }
+    }
+}
+
+bool S32K144Protocol::decodeBinary(ByteRingBuffer& buffer, std::deque<BoardEvent>& events) {
+    if (buffer.size() < HEADER_SIZE) {
+        return false;
+    }
+
+    uint8_t version = static_cast<uint8_t>(buffer.peek(1));
+    uint8_t length = static_cast<uint8_t>(buffer.peek(3));
+    if (version != VERSION || length > MAX_PAYLOAD) {
+        // Not a real frame start: skip the SYNC byte and resynchronise
+        errorCount++;
+        buffer.discard(1);
+        return true;
+    }
+
+    size_t frameSize = HEADER_SIZE + length + CRC_SIZE;
+    if (buffer.size() < frameSize) {
+        return false;
+    }
+
+    // CRC covers VERSION, TYPE, LENGTH and the payload
+    uint8_t body[HEADER_SIZE - 1 + MAX_PAYLOAD];
+    for (size_t i = 0; i < HEADER_SIZE - 1 + length; ++i) {
+        body[i] = static_cast<uint8_t>(buffer.peek(1 + i));
+    }
+    uint16_t expected = static_cast<uint16_t>((static_cast<uint8_t>(buffer.peek(HEADER_SIZE + length)) << 8) |
+                                              static_cast<uint8_t>(buffer.peek(HEADER_SIZE + length + 1)));
+    if (crc16(body, HEADER_SIZE - 1 + length) != expected) {
+        errorCount++;
+        buffer.discard(1);
+        return true;
+    }
+
+    FrameType type = static_cast<FrameType>(body[1]);
+    const uint8_t* payload = body + (HEADER_SIZE - 1);
+
+    switch (type) {
+        case FrameType::BUTTON:
+        case FrameType::VOLUME:
+            if (length >= 1) {
+                events.push_back({type, payload[0]});
+            }
+            break;
+        case FrameType::ENCODER:
+            if (length >= 1) {
+                events.push_back({type, static_cast<int8_t>(payload[0])});
+            }
+            break;
+        default:
+            // Unknown or host-only type: valid frame, nothing to do
+            break;
+    }
+
+    buffer.discard(frameSize);
+    return true;
+}
+
+bool S32K144Protocol::decodeText(ByteRingBuffer& buffer, std::deque<BoardEvent>& events) {
+    // A SYNC byte before the terminator means the text was cut short by noise
+    size_t end = buffer.find(TEXT_END);
+    size_t sync = buffer.find(static_cast<char>(SYNC));
+    if (sync != ByteRingBuffer::npos && (end == ByteRingBuffer::npos || sync < end)) {
+        errorCount++;
+        buffer.discard(sync);
+        return true;
+    }
+
+    if (end == ByteRingBuffer::npos) {
+        return false;
+    }
+
+    std::vector<uint8_t> text;
+    text.reserve(end);
+    for (size_t i = 0; i < end; ++i) {
+        text.push_back(static_cast<uint8_t>(buffer.peek(i)));
+    }
+    buffer.discard(end + 1);
+
+    BoardEvent event;
+    if (parseText(text, event)) {
+        events.push_back(event);
+    } else if (!text.empty()) {
+        errorCount++;
+    }
+    return true;
+}
+
+bool S32K144Protocol::parseText(const std::vector<uint8_t>& text, BoardEvent& event) const {
+    if (text.size() == 1 && (text[0] == 'P' || text[0] == 'N' || text[0] == 'T' || text[0] == 'S')) {
+        event = {FrameType::BUTTON, text[0]};
+        return true;
+    }
+
+    if (!text.empty() && text.size() <= 3 && std::all_of(text.begin(), text.end(), ::isdigit)) {
+        int volume = 0;
+        for (uint8_t c : text) {
+            volume = volume * 10 + (c - '0');
+        }
+        event = {FrameType::VOLUME, volume};
+        return true;
+    }
+
+    return false;
+}
+
+std::vector<uint8_t> S32K144Protocol::encodeFrame(FrameType type, const uint8_t* payload, size_t length) {
+    length = std::min(length, MAX_PAYLOAD);
+
+    std::vector<uint8_t> frame;
+    frame.reserve(HEADER_SIZE + length + CRC_SIZE);
+    frame.push_back(SYNC);
+    frame.push_back(VERSION);
+    frame.push_back(static_cast<uint8_t>(type));
+    frame.push_back(static_cast<uint8_t>(length));
+    frame.insert(frame.end(), payload, payload + length);
+
+    uint16_t crc = crc16(frame.data() + 1, frame.size() - 1);
+    frame.push_back(static_cast<uint8_t>(crc >> 8));
+    frame.push_back(static_cast<uint8_t>(crc & 0xFF));
+    return frame;
+}
+
+std::vector<uint8_t> S32K144Protocol::encodeNowPlaying(const NowPlaying& state) {
+    uint8_t payload[6 + MAX_TITLE];
+    payload[0] = state.state;
+    payload[1] = state.volume;
+    payload[2] = static_cast<uint8_t>(state.position >> 8);
+    payload[3] = static_cast<uint8_t>(state.position & 0xFF);
+    payload[4] = static_cast<uint8_t>(state.duration >> 8);
+    payload[5] = static_cast<uint8_t>(state.duration & 0xFF);
+
+    // Cut on a code point boundary: back up over UTF-8 continuation bytes (10xxxxxx)
+    size_t titleLength = std::min(state.title.size(), MAX_TITLE);
+    while (titleLength > 0 && titleLength < state.title.size() &&
+           (static_cast<uint8_t>(state.title[titleLength]) & 0xC0) == 0x80) {
+        --titleLength;
+    }
+    std::copy(state.title.begin(), state.title.begin() + titleLength, payload + 6);
+
+    return encodeFrame(FrameType::NOW_PLAYING, payload, 6 + titleLength);
+}
+
+bool S32K144Protocol::NowPlaying::operator==(const NowPlaying& other) const {
+    return state == other.state && volume == other.volume && position == other.position &&
+           duration == other.duration && title == other.title;
+}
+
+bool S32K144Protocol::NowPlaying::operator!=(const NowPlaying& other) const {
+    return !(*this == other);
+}
+
+uint16_t S32K144Protocol::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t S32K144Protocol::getErrorCount() const {
+    return errorCount;
+}
@@ -0,0 +1,51 @@
+#include "../../include/utils/SampleRing.h"
+#include <algorithm>
+#include <cstring>
+
+SampleRing::SampleRing(size_t capacity) : writePosition(0), readPosition(0) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+size_t SampleRing::write(const float* samples, size_t count) {
+    size_t head = writePosition.load(std::memory_order_relaxed);
+    size_t tail = readPosition.load(std::memory_order_acquire);
+    count = std::min(count, buffer.size() - (head - tail));
+    
+    // At most two copies: up to the end of the buffer, then from its start
+    size_t index = head & mask;
+    size_t first = std::min(count, buffer.size() - index);
+    std::memcpy(buffer.data() + index, samples, first * sizeof(float));
+    std::memcpy(buffer.data(), samples + first, (count - first) * sizeof(float));
+    
+    // Publish the samples only after they are in place
+    writePosition.store(head + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRing::read(float* samples, size_t count) {
+    size_t tail = readPosition.load(std::memory_order_relaxed);
+    size_t head = writePosition.load(std::memory_order_acquire);
+    count = std::min(count, head - tail);
+    
+    size_t index = tail & mask;
+    size_t first = std::min(count, buffer.size() - index);
+    std::memcpy(samples, buffer.data() + index, first * sizeof(float));
+    std::memcpy(samples + first, buffer.data(), (count - first) * sizeof(float));
+    
+    // Hand the space back only after the samples are copied out
+    readPosition.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRing::size() const {
+    return writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_acquire);
+}
+
+size_t SampleRing::getCapacity() const {
+    return buffer.size();
+}
@@ -0,0 +1,142 @@
+#include "../../include/utils/TerminalInput.h"
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+    // Copy of the settings to restore, readable from a signal handler
+    termios savedSettings;
+    volatile sig_atomic_t savedActive = 0;
+}
+
+TerminalInput::TerminalInput() : rawMode(false), wakePipe{-1, -1} {
+    memset(&originalSettings, 0, sizeof(originalSettings));
+
+    if (pipe(wakePipe) == 0) {
+        // Both ends non-blocking so wakeUp() and drainWakePipe() never stall
+        fcntl(wakePipe[0], F_SETFL, fcntl(wakePipe[0], F_GETFL) | O_NONBLOCK);
+        fcntl(wakePipe[1], F_SETFL, fcntl(wakePipe[1], F_GETFL) | O_NONBLOCK);
+    } else {
+        wakePipe[0] = wakePipe[1] = -1;
+    }
+}
+
+TerminalInput::~TerminalInput() {
+    disableRawMode();
+
+    if (wakePipe[0] >= 0) close(wakePipe[0]);
+    if (wakePipe[1] >= 0) close(wakePipe[1]);
+}
+
+bool TerminalInput::enableRawMode() {
+    if (rawMode) {
+        return true;
+    }
+
+    // Not a terminal (e.g. piped input): keep reading in whatever mode stdin is in
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &originalSettings) != 0) {
+        return false;
+    }
+
+    termios raw = originalSettings;
+    raw.c_lflag &= ~(ICANON | ECHO);    // Deliver each key immediately, don't echo it
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+
+    // Ctrl-C still raises SIGINT (ISIG stays on); make sure any exit path
+    // leaves the terminal usable
+    static bool exitHookInstalled = false;
+    if (!exitHookInstalled) {
+        std::atexit(restoreTerminal);
+        exitHookInstalled = true;
+    }
+    savedSettings = originalSettings;
+    savedActive = 1;
+
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) {
+        savedActive = 0;
+        return false;
+    }
+
+    rawMode = true;
+    return true;
+}
+
+void TerminalInput::disableRawMode() {
+    if (!rawMode) {
+        return;
+    }
+
+    savedActive = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &originalSettings);
+    rawMode = false;
+}
+
+void TerminalInput::restoreTerminal() {
+    if (savedActive) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedSettings);
+        savedActive = 0;
+    }
+}
+
+bool TerminalInput::isRawMode() const {
+    return rawMode;
+}
+
+TerminalInput::Event TerminalInput::waitForEvent(int timeoutMs, char& key) {
+    pollfd fds[2];
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = wakePipe[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    int ready = poll(fds, wakePipe[0] >= 0 ? 2 : 1, timeoutMs);
+    if (ready < 0) {
+        // Interrupted by a signal: let the caller refresh and come back
+        return errno == EINTR ? Event::WAKE : Event::CLOSED;
+    }
+    if (ready == 0) {
+        return Event::TIMEOUT;
+    }
+
+    // Keys take priority so a burst of redraw requests can't starve the user
+    if (fds[0].revents & (POLLIN | POLLHUP)) {
+        ssize_t n = read(STDIN_FILENO, &key, 1);
+        if (n == 1) {
+            return Event::KEY;
+        }
+        if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+            return Event::CLOSED;
+        }
+    }
+
+    if (fds[1].revents & POLLIN) {
+        drainWakePipe();
+        return Event::WAKE;
+    }
+
+    return Event::TIMEOUT;
+}
+
+void TerminalInput::wakeUp() {
+    if (wakePipe[1] < 0) {
+        return;
+    }
+
+    // A full pipe already guarantees a pending wake-up, so EAGAIN is fine
+    char byte = 1;
+    ssize_t ignored = write(wakePipe[1], &byte, 1);
+    (void)ignored;
+}
+
+void TerminalInput::drainWakePipe() {
+    char buffer[64];
+    while (read(wakePipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+}
@@ -0,0 +1,45 @@
+#include "../../include/utils/TextEscape.h"
+#include <cstdio>
+
+std::string TextEscape::field(std::string_view text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': break;
+            default:   escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string TextEscape::json(std::string_view text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    appendJson(escaped, text);
+    return escaped;
+}
+
+void TextEscape::appendJson(std::string& out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                    out += code;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+}
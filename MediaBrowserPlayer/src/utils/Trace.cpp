@@ -0,0 +1,234 @@
+#include "../../include/utils/Trace.h"
+#include "../../include/Constants.h"
+#include "../../include/utils/TextEscape.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    static_assert((Constants::TRACE_RING_EVENTS & (Constants::TRACE_RING_EVENTS - 1)) == 0,
+                  "TRACE_RING_EVENTS must be a power of two");
+
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // One per thread that recorded a zone. Only the owning thread writes; head is
+    // published after each event so dump() can read from another thread
+    struct Ring {
+        std::atomic<uint64_t> head{0};
+        Event events[Constants::TRACE_RING_EVENTS];
+        uint64_t firstEvent = 0; // head when the current owner took the ring
+        long tid = 0;
+        std::string threadName;
+    };
+
+    // A finished thread's ring stays in the dump until a new thread reuses it, so
+    // memory is bounded by the most threads alive at once
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> freeRings;
+    thread_local Ring* currentRing = nullptr;
+    thread_local bool threadExiting = false;
+
+    // Hands the calling thread's ring back when the thread exits
+    struct RingOwner {
+        Ring* ring = nullptr;
+
+        ~RingOwner() {
+            currentRing = nullptr;
+            threadExiting = true; // Zones in later thread_local destructors are dropped
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            freeRings.push_back(ring);
+        }
+    };
+    thread_local RingOwner ringOwner;
+
+    // Tick -> time conversion: both clocks are sampled at startup and again at dump time
+    struct ClockBase {
+        uint64_t ticks;
+        std::chrono::steady_clock::time_point time;
+    };
+    const ClockBase startClock{Trace::now(), std::chrono::steady_clock::now()};
+
+    int signalPipe[2] = {-1, -1};
+
+    Ring* registerThread() {
+        long tid = static_cast<long>(syscall(SYS_gettid));
+
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        Ring* ring;
+        if (!freeRings.empty()) {
+            // Reuse a finished thread's ring; its old zones drop out of dumps
+            ring = freeRings.back();
+            freeRings.pop_back();
+            ring->firstEvent = ring->head.load(std::memory_order_relaxed);
+            ring->threadName.clear();
+        } else {
+            rings.push_back(std::make_unique<Ring>());
+            ring = rings.back().get();
+        }
+        ring->tid = tid;
+        ringOwner.ring = ring;
+        currentRing = ring;
+        return ring;
+    }
+
+    void handleSignal(int) {
+        // Only async-signal-safe work here: the dump thread does the rest
+        char byte = 1;
+        ssize_t ignored = write(signalPipe[1], &byte, 1);
+        (void)ignored;
+    }
+
+    void dumpOnSignal() {
+        Trace::setThreadName("trace-dump");
+        char byte;
+        while (true) {
+            ssize_t n = read(signalPipe[0], &byte, 1);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+
+            std::string path = Trace::getDefaultPath();
+            if (Trace::dump(path)) {
+                std::cerr << "Trace written to " << path << std::endl;
+            } else {
+                std::cerr << "Could not write trace to " << path << std::endl;
+            }
+        }
+    }
+}
+
+namespace Trace {
+    void record(const char* name, uint64_t start, uint64_t end) {
+        Ring* ring = currentRing;
+        if (!ring) {
+            if (threadExiting) {
+                return;
+            }
+            ring = registerThread();
+        }
+
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        Event& event = ring->events[head & (Constants::TRACE_RING_EVENTS - 1)];
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void setThreadName(const char* name) {
+        if (!ENABLED || threadExiting) {
+            return;
+        }
+        Ring* ring = currentRing ? currentRing : registerThread();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring->threadName = name;
+    }
+
+    bool dump(const std::string& path) {
+        ClockBase dumpClock{now(), std::chrono::steady_clock::now()};
+        double nsPerTick = 1.0;
+        if (dumpClock.ticks > startClock.ticks) {
+            double elapsedNs = std::chrono::duration<double, std::nano>(dumpClock.time - startClock.time).count();
+            nsPerTick = elapsedNs / static_cast<double>(dumpClock.ticks - startClock.ticks);
+        }
+        auto toMicros = [&](uint64_t ticks) {
+            return ticks > startClock.ticks ? (ticks - startClock.ticks) * nsPerTick / 1000.0 : 0.0;
+        };
+
+        std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        long pid = static_cast<long>(getpid());
+        bool first = true;
+        char buffer[160];
+
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        std::vector<Event> events;
+        for (const auto& ring : rings) {
+            // Copy the live part of the ring, then drop whatever the owner overwrote meanwhile
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t begin = head > Constants::TRACE_RING_EVENTS ? head - Constants::TRACE_RING_EVENTS : 0;
+            begin = std::max(begin, ring->firstEvent);
+            events.clear();
+            for (uint64_t i = begin; i < head; ++i) {
+                events.push_back(ring->events[i & (Constants::TRACE_RING_EVENTS - 1)]);
+            }
+            // The owner may be half way through writing slot headAfter (published only once
+            // complete), so count that slot as overwritten too
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t headAfter = ring->head.load(std::memory_order_relaxed) + 1;
+            uint64_t overwritten = headAfter > Constants::TRACE_RING_EVENTS ? headAfter - Constants::TRACE_RING_EVENTS : 0;
+            size_t skip = overwritten > begin ? static_cast<size_t>(std::min<uint64_t>(overwritten - begin, events.size())) : 0;
+
+            if (!ring->threadName.empty()) {
+                out += first ? "" : ",\n";
+                snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":\"",
+                         pid, ring->tid);
+                out += buffer;
+                TextEscape::appendJson(out, ring->threadName);
+                out += "\"}}";
+                first = false;
+            }
+
+            for (size_t i = skip; i < events.size(); ++i) {
+                const Event& event = events[i];
+                out += first ? "" : ",\n";
+                out += "{\"name\":\"";
+                TextEscape::appendJson(out, event.name);
+                double start = toMicros(event.start);
+                double duration = event.end > event.start ? (event.end - event.start) * nsPerTick / 1000.0 : 0.0;
+                snprintf(buffer, sizeof(buffer), "\",\"cat\":\"mbp\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld}",
+                         start, duration, pid, ring->tid);
+                out += buffer;
+                first = false;
+            }
+        }
+        out += "\n]}\n";
+
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) {
+            return false;
+        }
+        bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+        return fclose(file) == 0 && ok;
+    }
+
+    std::string getDefaultPath() {
+        const char* path = std::getenv("MBP_TRACE_FILE");
+        if (path && *path) {
+            return path;
+        }
+        return std::string(Constants::TRACE_DUMP_DIR) + "/MediaBrowserPlayer-" + std::to_string(getpid()) + ".trace.json";
+    }
+
+    void installSignalHandler() {
+        if (!ENABLED || signalPipe[0] >= 0 || pipe2(signalPipe, O_CLOEXEC) != 0) {
+            return;
+        }
+        std::thread(dumpOnSignal).detach();
+
+        struct sigaction action = {};
+        action.sa_handler = handleSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &action, nullptr);
+    }
+}
@@ -0,0 +1,199 @@
+#include "../../include/utils/TrackOrder.h"
+#include <stdexcept>
+
+TrackOrder::TrackOrder() : root(NIL), seed(0x9E3779B9u) {
+}
+
+size_t TrackOrder::size() const {
+    return sizeOf(root);
+}
+
+bool TrackOrder::isEmpty() const {
+    return root == NIL;
+}
+
+void TrackOrder::assignIdentity(size_t count) {
+    nodes.assign(count, Node());
+    root = NIL;
+    
+    // Build the treap left to right with a stack holding its right spine (O(n) instead of n merges)
+    std::vector<uint32_t> spine;
+    for (uint32_t handle = 0; handle < count; ++handle) {
+        nodes[handle].priority = nextPriority();
+        
+        uint32_t last = NIL;
+        while (!spine.empty() && nodes[spine.back()].priority < nodes[handle].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        nodes[handle].left = last;
+        if (!spine.empty()) {
+            nodes[spine.back()].right = handle;
+        }
+        spine.push_back(handle);
+    }
+    
+    if (!spine.empty()) {
+        root = spine.front();
+    }
+    
+    // Sizes bottom-up: children always come before their parent in post-order
+    std::vector<uint32_t> stack;
+    std::vector<uint32_t> postOrder;
+    postOrder.reserve(count);
+    if (root != NIL) {
+        stack.push_back(root);
+    }
+    while (!stack.empty()) {
+        uint32_t node = stack.back();
+        stack.pop_back();
+        postOrder.push_back(node);
+        if (nodes[node].left != NIL) stack.push_back(nodes[node].left);
+        if (nodes[node].right != NIL) stack.push_back(nodes[node].right);
+    }
+    for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it) {
+        update(*it);
+    }
+}
+
+void TrackOrder::pushBack(uint32_t handle) {
+    root = merge(root, makeNode(handle));
+}
+
+void TrackOrder::insert(size_t position, uint32_t handle) {
+    if (position > size()) {
+        throw std::out_of_range("Track position out of range");
+    }
+    
+    uint32_t left, right;
+    split(root, position, left, right);
+    root = merge(merge(left, makeNode(handle)), right);
+}
+
+uint32_t TrackOrder::erase(size_t position) {
+    if (position >= size()) {
+        throw std::out_of_range("Track position out of range");
+    }
+    
+    uint32_t left, middle, right;
+    split(root, position, left, middle);
+    split(middle, 1, middle, right);
+    root = merge(left, right);
+    return middle;
+}
+
+uint32_t TrackOrder::at(size_t position) const {
+    if (position >= size()) {
+        throw std::out_of_range("Track position out of range");
+    }
+    
+    uint32_t node = root;
+    while (true) {
+        size_t leftSize = sizeOf(nodes[node].left);
+        if (position < leftSize) {
+            node = nodes[node].left;
+        } else if (position == leftSize) {
+            return node;
+        } else {
+            position -= leftSize + 1;
+            node = nodes[node].right;
+        }
+    }
+}
+
+void TrackOrder::moveRange(size_t first, size_t count, size_t toIndex) {
+    size_t total = size();
+    if (count == 0 || first + count > total || toIndex + count > total) {
+        throw std::out_of_range("Track position out of range");
+    }
+    if (first == toIndex) {
+        return;
+    }
+    
+    uint32_t left, block, right;
+    split(root, first, left, block);
+    split(block, count, block, right);
+    
+    uint32_t before, after;
+    split(merge(left, right), toIndex, before, after);
+    root = merge(merge(before, block), after);
+}
+
+void TrackOrder::toVector(std::vector<uint32_t>& out) const {
+    out.clear();
+    out.reserve(size());
+    
+    // In-order walk without recursion
+    std::vector<uint32_t> stack;
+    uint32_t node = root;
+    while (node != NIL || !stack.empty()) {
+        while (node != NIL) {
+            stack.push_back(node);
+            node = nodes[node].left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        out.push_back(node);
+        node = nodes[node].right;
+    }
+}
+
+void TrackOrder::clear() {
+    nodes.clear();
+    root = NIL;
+}
+
+uint32_t TrackOrder::nextPriority() {
+    // xorshift32: cheap and good enough to keep the treap balanced
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+uint32_t TrackOrder::sizeOf(uint32_t node) const {
+    return node == NIL ? 0 : nodes[node].size;
+}
+
+void TrackOrder::update(uint32_t node) {
+    nodes[node].size = 1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right);
+}
+
+uint32_t TrackOrder::makeNode(uint32_t handle) {
+    if (handle >= nodes.size()) {
+        nodes.resize(static_cast<size_t>(handle) + 1);
+    }
+    nodes[handle] = Node();
+    nodes[handle].priority = nextPriority();
+    return handle;
+}
+
+void TrackOrder::split(uint32_t node, size_t count, uint32_t& left, uint32_t& right) {
+    if (node == NIL) {
+        left = right = NIL;
+        return;
+    }
+    
+    if (sizeOf(nodes[node].left) >= count) {
+        split(nodes[node].left, count, left, nodes[node].left);
+        right = node;
+    } else {
+        split(nodes[node].right, count - sizeOf(nodes[node].left) - 1, nodes[node].right, right);
+        left = node;
+    }
+    update(node);
+}
+
+uint32_t TrackOrder::merge(uint32_t left, uint32_t right) {
+    if (left == NIL) return right;
+    if (right == NIL) return left;
+    
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge(nodes[left].right, right);
+        update(left);
+        return left;
+    }
+    nodes[right].left = merge(left, nodes[right].left);
+    update(right);
+    return right;
+}
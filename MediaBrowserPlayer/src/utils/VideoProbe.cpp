@@ -0,0 +1,698 @@
+#include "../../include/utils/VideoProbe.h"
+#include "../../include/utils/Metrics.h"
+#include "../../include/utils/Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    // Largest header structure read into memory in one piece (Matroska Tracks, AVI hdrl)
+    constexpr size_t MAX_HEADER_BYTES = 1 << 20;
+
+    // Boxes/elements/chunks visited per level before giving up on a damaged file
+    constexpr int MAX_ENTRIES = 4096;
+
+    // Positioned reads from a file, counted for the metrics
+    class Source {
+    public:
+        explicit Source(const std::string& filePath) : fd(open(filePath.c_str(), O_RDONLY | O_CLOEXEC)), length(0), bytesRead(0) {
+            struct stat info;
+            if (fd >= 0 && fstat(fd, &info) == 0) {
+                length = static_cast<long long>(info.st_size);
+            }
+        }
+
+        ~Source() {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        bool isOpen() const { return fd >= 0; }
+        long long size() const { return length; }
+        long long getBytesRead() const { return bytesRead; }
+
+        // Exactly count bytes at offset; false at end of file or on error
+        bool read(long long offset, void* buffer, size_t count) {
+            unsigned char* out = static_cast<unsigned char*>(buffer);
+            while (count > 0) {
+                ssize_t n = pread(fd, out, count, static_cast<off_t>(offset));
+                if (n <= 0) {
+                    return false;
+                }
+                bytesRead += n;
+                out += n;
+                count -= static_cast<size_t>(n);
+                offset += n;
+            }
+            return true;
+        }
+
+        bool read(long long offset, size_t count, std::string& out) {
+            out.resize(count);
+            return read(offset, &out[0], count);
+        }
+
+    private:
+        int fd;
+        long long length;
+        long long bytesRead;
+    };
+
+    uint32_t be16(const unsigned char* p) { return (p[0] << 8) | p[1]; }
+    uint32_t be32(const unsigned char* p) { return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+    uint64_t be64(const unsigned char* p) { return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4); }
+    uint32_t le16(const unsigned char* p) { return p[0] | (p[1] << 8); }
+    uint32_t le32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+    const unsigned char* bytes(const std::string& data) {
+        return reinterpret_cast<const unsigned char*>(data.data());
+    }
+
+    // Four-character code without trailing spaces/NULs
+    std::string fourcc(const unsigned char* p) {
+        std::string code(reinterpret_cast<const char*>(p), 4);
+        while (!code.empty() && (code.back() == ' ' || code.back() == '\0')) {
+            code.pop_back();
+        }
+        return code;
+    }
+
+    std::string upper(std::string text) {
+        for (auto& c : text) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return text;
+    }
+
+    // ---- ISO-BMFF (MP4, MOV) ----
+
+    struct BmffTrack {
+        std::string handler;        // "vide", "soun", ...
+        std::string format;         // First sample entry's four-character code
+        uint32_t timescale = 0;
+        uint64_t duration = 0;
+        uint64_t sampleCount = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    // Header of the box at offset (inside [offset, limit)): its type, where its body
+    // starts and where it ends. False if there is no valid box there
+    bool readBox(Source& source, long long offset, long long limit, std::string& type, long long& body, long long& end) {
+        unsigned char header[16];
+        if (offset + 8 > limit || !source.read(offset, header, 8)) {
+            return false;
+        }
+        uint64_t size = be32(header);
+        type.assign(reinterpret_cast<const char*>(header + 4), 4);
+        body = offset + 8;
+        if (size == 1) {
+            // 64-bit size follows the type
+            if (offset + 16 > limit || !source.read(offset + 8, header + 8, 8)) {
+                return false;
+            }
+            size = be64(header + 8);
+            body = offset + 16;
+        } else if (size == 0) {
+            // Extends to the end of the enclosing box / file
+            size = static_cast<uint64_t>(limit - offset);
+        }
+        end = offset + static_cast<long long>(size);
+        return end >= body && end <= limit;
+    }
+
+    std::string bmffCodecName(const std::string& format) {
+        static const std::map<std::string, std::string> names = {
+            {"avc1", "H.264"}, {"avc3", "H.264"}, {"hvc1", "H.265"}, {"hev1", "H.265"},
+            {"av01", "AV1"}, {"vp09", "VP9"}, {"vp08", "VP8"}, {"mp4v", "MPEG-4 Visual"},
+            {"s263", "H.263"}, {"h263", "H.263"}, {"jpeg", "Motion JPEG"}, {"mjpa", "Motion JPEG"},
+            {"mjpb", "Motion JPEG"}, {"apcn", "ProRes"}, {"apch", "ProRes"}, {"apcs", "ProRes"},
+            {"apco", "ProRes"}, {"ap4h", "ProRes"},
+            {"mp4a", "AAC"}, {"ac-3", "AC-3"}, {"ec-3", "E-AC-3"}, {"Opus", "Opus"}, {"fLaC", "FLAC"},
+            {"alac", "ALAC"}, {".mp3", "MP3"}, {"sowt", "PCM"}, {"twos", "PCM"}, {"lpcm", "PCM"}, {"ipcm", "PCM"}
+        };
+        auto it = names.find(format);
+        return it != names.end() ? it->second : fourcc(reinterpret_cast<const unsigned char*>(format.c_str()));
+    }
+
+    // Walk the boxes of a trak (and the mdia/minf/stbl boxes inside it)
+    void parseTrak(Source& source, long long begin, long long end, BmffTrack& track) {
+        std::string type;
+        long long body = 0;
+        long long boxEnd = 0;
+        unsigned char data[44];
+        int entries = 0;
+        for (long long offset = begin; offset < end && entries++ < MAX_ENTRIES && readBox(source, offset, end, type, body, boxEnd); offset = boxEnd) {
+            long long bodySize = boxEnd - body;
+            if (type == "mdia" || type == "minf" || type == "stbl") {
+                parseTrak(source, body, boxEnd, track);
+            } else if (type == "tkhd" && bodySize >= 84 && source.read(boxEnd - 8, data, 8)) {
+                // Presentation size (16.16 fixed point) closes the box; stsd's coded size wins
+                if (track.width == 0) {
+                    track.width = static_cast<int>(be32(data) >> 16);
+                    track.height = static_cast<int>(be32(data + 4) >> 16);
+                }
+            } else if (type == "mdhd" && bodySize >= 24 && source.read(body, data, std::min<long long>(bodySize, 32))) {
+                if (data[0] == 1 && bodySize >= 32) {
+                    track.timescale = be32(data + 20);
+                    track.duration = be64(data + 24);
+                } else {
+                    track.timescale = be32(data + 12);
+                    track.duration = be32(data + 16);
+                }
+            } else if (type == "hdlr" && bodySize >= 12 && source.read(body, data, 12)) {
+                track.handler.assign(reinterpret_cast<const char*>(data + 8), 4);
+            } else if (type == "stsd" && bodySize >= 16 && source.read(body, data, std::min<long long>(bodySize, 44))) {
+                track.format.assign(reinterpret_cast<const char*>(data + 12), 4);
+                if (track.handler == "vide" && bodySize >= 44) {
+                    track.width = static_cast<int>(be16(data + 40));
+                    track.height = static_cast<int>(be16(data + 42));
+                }
+            } else if ((type == "stsz" || type == "stz2") && bodySize >= 12 && source.read(body, data, 12)) {
+                track.sampleCount = be32(data + 8);
+            }
+        }
+    }
+
+    bool probeBmff(Source& source, VideoInfo& info) {
+        info.container = "QuickTime";
+        std::string type;
+        long long body = 0;
+        long long end = 0;
+        unsigned char data[32];
+        int entries = 0;
+
+        // Top level: ftyp names the brand; moov may sit before or after mdat, which is skipped
+        for (long long offset = 0; offset < source.size() && entries++ < MAX_ENTRIES && readBox(source, offset, source.size(), type, body, end); offset = end) {
+            if (type == "ftyp" && end - body >= 4 && source.read(body, data, 4)) {
+                info.container = std::memcmp(data, "qt  ", 4) == 0 ? "QuickTime" : "MP4";
+                continue;
+            }
+            if (type != "moov") {
+                continue;
+            }
+
+            uint32_t movieScale = 0;
+            uint64_t movieDuration = 0;
+            double longestTrack = 0.0;
+            std::string child;
+            long long childBody = 0;
+            long long childEnd = 0;
+            int children = 0;
+            for (long long position = body; position < end && children++ < MAX_ENTRIES && readBox(source, position, end, child, childBody, childEnd); position = childEnd) {
+                long long childSize = childEnd - childBody;
+                if (child == "mvhd" && childSize >= 20 && source.read(childBody, data, std::min<long long>(childSize, 32))) {
+                    if (data[0] == 1 && childSize >= 32) {
+                        movieScale = be32(data + 20);
+                        movieDuration = be64(data + 24);
+                    } else {
+                        movieScale = be32(data + 12);
+                        movieDuration = be32(data + 16);
+                    }
+                } else if (child == "trak") {
+                    BmffTrack track;
+                    parseTrak(source, childBody, childEnd, track);
+                    double seconds = track.timescale ? static_cast<double>(track.duration) / track.timescale : 0.0;
+                    longestTrack = std::max(longestTrack, seconds);
+                    if (track.handler == "vide" && info.videoCodec.empty()) {
+                        info.videoCodec = bmffCodecName(track.format);
+                        info.width = track.width;
+                        info.height = track.height;
+                        if (seconds > 0.0 && track.sampleCount > 0) {
+                            info.frameRate = track.sampleCount / seconds;
+                        }
+                    } else if (track.handler == "soun" && info.audioCodec.empty()) {
+                        info.audioCodec = bmffCodecName(track.format);
+                    }
+                }
+            }
+            info.duration = movieScale ? static_cast<double>(movieDuration) / movieScale : 0.0;
+            if (info.duration <= 0.0) {
+                info.duration = longestTrack;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // ---- Matroska / WebM (EBML) ----
+
+    constexpr uint32_t EBML_HEADER = 0x1A45DFA3;
+    constexpr uint32_t EBML_DOCTYPE = 0x4282;
+    constexpr uint32_t MKV_SEGMENT = 0x18538067;
+    constexpr uint32_t MKV_SEEKHEAD = 0x114D9B74;
+    constexpr uint32_t MKV_SEEK = 0x4DBB;
+    constexpr uint32_t MKV_SEEK_ID = 0x53AB;
+    constexpr uint32_t MKV_SEEK_POSITION = 0x53AC;
+    constexpr uint32_t MKV_INFO = 0x1549A966;
+    constexpr uint32_t MKV_TIMECODE_SCALE = 0x2AD7B1;
+    constexpr uint32_t MKV_DURATION = 0x4489;
+    constexpr uint32_t MKV_TRACKS = 0x1654AE6B;
+    constexpr uint32_t MKV_TRACK_ENTRY = 0xAE;
+    constexpr uint32_t MKV_TRACK_TYPE = 0x83;
+    constexpr uint32_t MKV_CODEC_ID = 0x86;
+    constexpr uint32_t MKV_DEFAULT_DURATION = 0x23E383;
+    constexpr uint32_t MKV_VIDEO = 0xE0;
+    constexpr uint32_t MKV_PIXEL_WIDTH = 0xB0;
+    constexpr uint32_t MKV_PIXEL_HEIGHT = 0xBA;
+    constexpr uint32_t MKV_CLUSTER = 0x1F43B675;
+    constexpr uint64_t EBML_UNKNOWN_SIZE = ~0ULL;
+
+    // Variable-length integer at data[pos]: length from the leading zero bits of the
+    // first byte. IDs keep the marker bit, sizes drop it (all ones = unknown size)
+    bool readVint(const unsigned char* data, size_t available, size_t& pos, uint64_t& value, bool isId) {
+        if (pos >= available || data[pos] == 0) {
+            return false;
+        }
+        int length = 1;
+        while (!(data[pos] & (0x80 >> (length - 1)))) {
+            length++;
+        }
+        if (pos + length > available || (isId && length > 4)) {
+            return false;
+        }
+        uint64_t mask = (1ULL << (7 * length)) - 1;
+        value = isId ? data[pos] : (data[pos] & (0xFF >> length));
+        for (int i = 1; i < length; ++i) {
+            value = (value << 8) | data[pos + i];
+        }
+        if (!isId && value == mask) {
+            value = EBML_UNKNOWN_SIZE;
+        }
+        pos += length;
+        return true;
+    }
+
+    // Next child element of an in-memory body; false at its end
+    bool nextElement(const std::string& body, size_t& pos, uint32_t& id, size_t& start, size_t& size) {
+        uint64_t rawId = 0;
+        uint64_t rawSize = 0;
+        const unsigned char* data = bytes(body);
+        if (!readVint(data, body.size(), pos, rawId, true) || !readVint(data, body.size(), pos, rawSize, false) ||
+            rawSize > body.size() - pos) {
+            return false;
+        }
+        id = static_cast<uint32_t>(rawId);
+        start = pos;
+        size = static_cast<size_t>(rawSize);
+        pos += size;
+        return true;
+    }
+
+    uint64_t ebmlUnsigned(const std::string& body, size_t start, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size && i < 8; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(body[start + i]);
+        }
+        return value;
+    }
+
+    double ebmlFloat(const std::string& body, size_t start, size_t size) {
+        uint64_t bits = ebmlUnsigned(body, start, size);
+        if (size == 4) {
+            uint32_t narrow = static_cast<uint32_t>(bits);
+            float value;
+            std::memcpy(&value, &narrow, sizeof(value));
+            return value;
+        }
+        double value = 0.0;
+        if (size == 8) {
+            std::memcpy(&value, &bits, sizeof(value));
+        }
+        return value;
+    }
+
+    // ID and data size of the element at offset; dataStart is where its body begins
+    bool readElementHeader(Source& source, long long offset, uint32_t& id, uint64_t& size, long long& dataStart) {
+        unsigned char header[12];
+        size_t available = static_cast<size_t>(std::min<long long>(sizeof(header), source.size() - offset));
+        if (offset >= source.size() || !source.read(offset, header, available)) {
+            return false;
+        }
+        size_t pos = 0;
+        uint64_t rawId = 0;
+        if (!readVint(header, available, pos, rawId, true) || !readVint(header, available, pos, size, false)) {
+            return false;
+        }
+        id = static_cast<uint32_t>(rawId);
+        dataStart = offset + static_cast<long long>(pos);
+        return true;
+    }
+
+    std::string matroskaCodecName(const std::string& codecId) {
+        static const std::pair<const char*, const char*> prefixes[] = {
+            {"V_MPEG4/ISO/AVC", "H.264"}, {"V_MPEGH/ISO/HEVC", "H.265"}, {"V_AV1", "AV1"}, {"V_VP9", "VP9"},
+            {"V_VP8", "VP8"}, {"V_MPEG4/ISO", "MPEG-4 Visual"}, {"V_MPEG2", "MPEG-2"}, {"V_MJPEG", "Motion JPEG"},
+            {"V_THEORA", "Theora"}, {"A_AAC", "AAC"}, {"A_OPUS", "Opus"}, {"A_VORBIS", "Vorbis"}, {"A_EAC3", "E-AC-3"},
+            {"A_AC3", "AC-3"}, {"A_DTS", "DTS"}, {"A_FLAC", "FLAC"}, {"A_MPEG/L3", "MP3"}, {"A_MPEG/L2", "MP2"},
+            {"A_PCM", "PCM"}, {"A_TRUEHD", "TrueHD"}
+        };
+        for (const auto& prefix : prefixes) {
+            if (codecId.compare(0, std::strlen(prefix.first), prefix.first) == 0) {
+                return prefix.second;
+            }
+        }
+        return codecId;
+    }
+
+    void parseMatroskaInfo(const std::string& body, VideoInfo& info) {
+        uint64_t timecodeScale = 1000000;   // ns per tick unless stated
+        double duration = 0.0;
+        size_t pos = 0;
+        uint32_t id = 0;
+        size_t start = 0;
+        size_t size = 0;
+        while (nextElement(body, pos, id, start, size)) {
+            if (id == MKV_TIMECODE_SCALE) {
+                timecodeScale = ebmlUnsigned(body, start, size);
+            } else if (id == MKV_DURATION) {
+                duration = ebmlFloat(body, start, size);
+            }
+        }
+        info.duration = duration * static_cast<double>(timecodeScale) / 1e9;
+    }
+
+    void parseMatroskaTracks(const std::string& body, VideoInfo& info) {
+        size_t pos = 0;
+        uint32_t id = 0;
+        size_t start = 0;
+        size_t size = 0;
+        while (nextElement(body, pos, id, start, size)) {
+            if (id != MKV_TRACK_ENTRY) {
+                continue;
+            }
+            std::string entry = body.substr(start, size);
+            uint64_t trackType = 0;
+            uint64_t frameDuration = 0;
+            std::string codecId;
+            int width = 0;
+            int height = 0;
+            size_t entryPos = 0;
+            uint32_t field = 0;
+            size_t fieldStart = 0;
+            size_t fieldSize = 0;
+            while (nextElement(entry, entryPos, field, fieldStart, fieldSize)) {
+                if (field == MKV_TRACK_TYPE) {
+                    trackType = ebmlUnsigned(entry, fieldStart, fieldSize);
+                } else if (field == MKV_CODEC_ID) {
+                    codecId = entry.substr(fieldStart, fieldSize);
+                    codecId.erase(std::find(codecId.begin(), codecId.end(), '\0'), codecId.end());
+                } else if (field == MKV_DEFAULT_DURATION) {
+                    frameDuration = ebmlUnsigned(entry, fieldStart, fieldSize);
+                } else if (field == MKV_VIDEO) {
+                    std::string video = entry.substr(fieldStart, fieldSize);
+                    size_t videoPos = 0;
+                    uint32_t setting = 0;
+                    size_t settingStart = 0;
+                    size_t settingSize = 0;
+                    while (nextElement(video, videoPos, setting, settingStart, settingSize)) {
+                        if (setting == MKV_PIXEL_WIDTH) {
+                            width = static_cast<int>(ebmlUnsigned(video, settingStart, settingSize));
+                        } else if (setting == MKV_PIXEL_HEIGHT) {
+                            height = static_cast<int>(ebmlUnsigned(video, settingStart, settingSize));
+                        }
+                    }
+                }
+            }
+
+            // Track types: 1 video, 2 audio
+            if (trackType == 1 && info.videoCodec.empty()) {
+                info.videoCodec = matroskaCodecName(codecId);
+                info.width = width;
+                info.height = height;
+                if (frameDuration > 0) {
+                    info.frameRate = 1e9 / static_cast<double>(frameDuration);
+                }
+            } else if (trackType == 2 && info.audioCodec.empty()) {
+                info.audioCodec = matroskaCodecName(codecId);
+            }
+        }
+    }
+
+    bool probeMatroska(Source& source, VideoInfo& info) {
+        uint32_t id = 0;
+        uint64_t size = 0;
+        long long dataStart = 0;
+        std::string body;
+        if (!readElementHeader(source, 0, id, size, dataStart) || id != EBML_HEADER || size > MAX_HEADER_BYTES ||
+            !source.read(dataStart, static_cast<size_t>(size), body)) {
+            return false;
+        }
+        info.container = "Matroska";
+        size_t pos = 0;
+        uint32_t child = 0;
+        size_t start = 0;
+        size_t length = 0;
+        while (nextElement(body, pos, child, start, length)) {
+            if (child == EBML_DOCTYPE && body.compare(start, length, "webm") == 0) {
+                info.container = "WebM";
+            }
+        }
+
+        long long segment = dataStart + static_cast<long long>(size);
+        if (!readElementHeader(source, segment, id, size, dataStart) || id != MKV_SEGMENT) {
+            return false;
+        }
+        long long segmentData = dataStart;
+        long long segmentEnd = size == EBML_UNKNOWN_SIZE ? source.size() : std::min(source.size(), dataStart + static_cast<long long>(size));
+
+        // Top-level elements in file order, until Info and Tracks are both read or the
+        // clusters start; then the SeekHead says where any missing one is
+        std::map<uint32_t, long long> seekPositions;
+        bool haveInfo = false;
+        bool haveTracks = false;
+        auto readElement = [&](long long offset, uint32_t expected) {
+            uint32_t elementId = 0;
+            uint64_t elementSize = 0;
+            long long elementData = 0;
+            std::string element;
+            if (!readElementHeader(source, offset, elementId, elementSize, elementData) || elementId != expected ||
+                elementSize > MAX_HEADER_BYTES || !source.read(elementData, static_cast<size_t>(elementSize), element)) {
+                return false;
+            }
+            if (expected == MKV_INFO) {
+                parseMatroskaInfo(element, info);
+                haveInfo = true;
+            } else {
+                parseMatroskaTracks(element, info);
+                haveTracks = true;
+            }
+            return true;
+        };
+
+        long long offset = segmentData;
+        for (int entries = 0; offset < segmentEnd && !(haveInfo && haveTracks) && entries < MAX_ENTRIES; ++entries) {
+            if (!readElementHeader(source, offset, id, size, dataStart) || id == MKV_CLUSTER || size == EBML_UNKNOWN_SIZE) {
+                break;
+            }
+            if (id == MKV_INFO || id == MKV_TRACKS) {
+                readElement(offset, id);
+            } else if (id == MKV_SEEKHEAD && size <= MAX_HEADER_BYTES && source.read(dataStart, static_cast<size_t>(size), body)) {
+                size_t seekPos = 0;
+                while (nextElement(body, seekPos, child, start, length)) {
+                    if (child != MKV_SEEK) {
+                        continue;
+                    }
+                    std::string seek = body.substr(start, length);
+                    size_t fieldPos = 0;
+                    uint32_t field = 0;
+                    size_t fieldStart = 0;
+                    size_t fieldSize = 0;
+                    uint32_t target = 0;
+                    long long position = -1;
+                    while (nextElement(seek, fieldPos, field, fieldStart, fieldSize)) {
+                        if (field == MKV_SEEK_ID) {
+                            target = static_cast<uint32_t>(ebmlUnsigned(seek, fieldStart, fieldSize));
+                        } else if (field == MKV_SEEK_POSITION) {
+                            position = static_cast<long long>(ebmlUnsigned(seek, fieldStart, fieldSize));
+                        }
+                    }
+                    if (position >= 0) {
+                        seekPositions[target] = segmentData + position;
+                    }
+                }
+            }
+            offset = dataStart + static_cast<long long>(size);
+        }
+
+        if (!haveInfo && seekPositions.count(MKV_INFO)) {
+            readElement(seekPositions[MKV_INFO], MKV_INFO);
+        }
+        if (!haveTracks && seekPositions.count(MKV_TRACKS)) {
+            readElement(seekPositions[MKV_TRACKS], MKV_TRACKS);
+        }
+        return haveInfo || haveTracks;
+    }
+
+    // ---- RIFF AVI ----
+
+    std::string aviVideoCodecName(const std::string& code) {
+        std::string name = upper(code);
+        if (name.empty()) {
+            return "Uncompressed";
+        }
+        if (name == "H264" || name == "X264" || name == "AVC1") {
+            return "H.264";
+        }
+        if (name == "HEVC" || name == "H265" || name == "HVC1") {
+            return "H.265";
+        }
+        if (name == "XVID" || name == "DIVX" || name == "DX50" || name == "FMP4" || name == "MP4V") {
+            return "MPEG-4 Visual";
+        }
+        if (name == "MJPG") {
+            return "Motion JPEG";
+        }
+        return code;
+    }
+
+    std::string aviAudioCodecName(uint32_t formatTag) {
+        switch (formatTag) {
+            case 0x0001: return "PCM";
+            case 0x0050: return "MP2";
+            case 0x0055: return "MP3";
+            case 0x00FF:
+            case 0x1610: return "AAC";
+            case 0x0161: return "WMA";
+            case 0x2000: return "AC-3";
+            case 0x2001: return "DTS";
+            default: {
+                char code[8];
+                std::snprintf(code, sizeof(code), "0x%04x", formatTag);
+                return code;
+            }
+        }
+    }
+
+    // Chunks of an in-memory RIFF list body: id, start of data and data size
+    bool nextChunk(const std::string& body, size_t& pos, std::string& id, size_t& start, size_t& size) {
+        if (pos + 8 > body.size()) {
+            return false;
+        }
+        id = body.substr(pos, 4);
+        size = le32(bytes(body) + pos + 4);
+        start = pos + 8;
+        if (size > body.size() - start) {
+            return false;
+        }
+        pos = start + size + (size & 1);    // Chunks are padded to even length
+        return true;
+    }
+
+    void parseAviStream(const std::string& list, VideoInfo& info) {
+        std::string id;
+        size_t pos = 4;     // Skip the list type ("strl")
+        size_t start = 0;
+        size_t size = 0;
+        std::string streamType;
+        std::string handler;
+        uint32_t scale = 0;
+        uint32_t rate = 0;
+        uint32_t length = 0;
+        while (nextChunk(list, pos, id, start, size)) {
+            const unsigned char* data = bytes(list) + start;
+            if (id == "strh" && size >= 36) {
+                streamType.assign(reinterpret_cast<const char*>(data), 4);
+                handler = fourcc(data + 4);
+                scale = le32(data + 20);
+                rate = le32(data + 24);
+                length = le32(data + 32);
+                if (streamType == "vids" && info.frameRate <= 0.0 && scale > 0 && rate > 0) {
+                    info.frameRate = static_cast<double>(rate) / scale;
+                    info.duration = static_cast<double>(length) * scale / rate;
+                }
+            } else if (id == "strf" && streamType == "vids" && size >= 20 && info.videoCodec.empty()) {
+                uint32_t compression = le32(data + 16);
+                info.videoCodec = aviVideoCodecName(compression ? fourcc(data + 16) : handler);
+            } else if (id == "strf" && streamType == "auds" && size >= 2 && info.audioCodec.empty()) {
+                info.audioCodec = aviAudioCodecName(le16(data));
+            }
+        }
+    }
+
+    bool probeAvi(Source& source, VideoInfo& info) {
+        info.container = "AVI";
+        unsigned char header[12];
+
+        // Chunks of the RIFF body until the hdrl list; movi (the media data) is never read
+        long long offset = 12;
+        for (int entries = 0; offset + 12 <= source.size() && entries < MAX_ENTRIES; ++entries) {
+            if (!source.read(offset, header, 12)) {
+                return false;
+            }
+            long long size = le32(header + 4);
+            if (std::memcmp(header, "LIST", 4) != 0 || std::memcmp(header + 8, "hdrl", 4) != 0) {
+                offset += 8 + size + (size & 1);
+                continue;
+            }
+
+            std::string list;
+            if (size < 4 || size > static_cast<long long>(MAX_HEADER_BYTES) || !source.read(offset + 8, static_cast<size_t>(size), list)) {
+                return false;
+            }
+            std::string id;
+            size_t pos = 4;
+            size_t start = 0;
+            size_t chunkSize = 0;
+            uint32_t microSecondsPerFrame = 0;
+            uint32_t totalFrames = 0;
+            while (nextChunk(list, pos, id, start, chunkSize)) {
+                const unsigned char* data = bytes(list) + start;
+                if (id == "avih" && chunkSize >= 40) {
+                    microSecondsPerFrame = le32(data);
+                    totalFrames = le32(data + 16);
+                    info.width = static_cast<int>(le32(data + 32));
+                    info.height = static_cast<int>(le32(data + 36));
+                } else if (id == "LIST" && chunkSize >= 4 && list.compare(start, 4, "strl") == 0) {
+                    parseAviStream(list.substr(start, chunkSize), info);
+                }
+            }
+
+            // The video stream header is exact; avih only counts the first RIFF of large files
+            if (info.duration <= 0.0 && microSecondsPerFrame > 0) {
+                info.duration = static_cast<double>(totalFrames) * microSecondsPerFrame / 1e6;
+                info.frameRate = 1e6 / microSecondsPerFrame;
+            }
+            return true;
+        }
+        return false;
+    }
+}
+
+namespace VideoProbe {
+    bool probe(const std::string& filePath, VideoInfo& info) {
+        TRACE_ZONE("video.probe");
+        static Metrics::Counter& probedBytes = Metrics::counter("mbp_video_probe_bytes_total", "Header bytes read to probe video containers");
+
+        info = VideoInfo();
+        Source source(filePath);
+        unsigned char magic[12];
+        if (!source.isOpen() || source.size() < 12 || !source.read(0, magic, sizeof(magic))) {
+            return false;
+        }
+
+        bool parsed = false;
+        if (be32(magic) == EBML_HEADER) {
+            parsed = probeMatroska(source, info);
+        } else if (std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "AVI ", 4) == 0) {
+            parsed = probeAvi(source, info);
+        } else if (std::memcmp(magic + 4, "ftyp", 4) == 0 || std::memcmp(magic + 4, "moov", 4) == 0 ||
+                   std::memcmp(magic + 4, "mdat", 4) == 0 || std::memcmp(magic + 4, "wide", 4) == 0 ||
+                   std::memcmp(magic + 4, "free", 4) == 0 || std::memcmp(magic + 4, "skip", 4) == 0) {
+            parsed = probeBmff(source, info);
+        }
+        probedBytes.add(static_cast<uint64_t>(source.getBytesRead()));
+
+        if (parsed && info.duration > 0.0) {
+            info.bitrate = static_cast<long long>(static_cast<double>(source.size()) * 8.0 / info.duration);
+        }
+        return parsed;
+    }
+}
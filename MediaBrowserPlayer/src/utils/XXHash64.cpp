@@ -0,0 +1,121 @@
+#include "../../include/utils/XXHash64.h"
+#include <cstring>
+
+namespace {
+    constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Little-endian loads, independent of host byte order and alignment
+    inline uint64_t read64(const unsigned char* p) {
+        return static_cast<uint64_t>(p[0]) | static_cast<uint64_t>(p[1]) << 8 |
+               static_cast<uint64_t>(p[2]) << 16 | static_cast<uint64_t>(p[3]) << 24 |
+               static_cast<uint64_t>(p[4]) << 32 | static_cast<uint64_t>(p[5]) << 40 |
+               static_cast<uint64_t>(p[6]) << 48 | static_cast<uint64_t>(p[7]) << 56;
+    }
+
+    inline uint32_t read32(const unsigned char* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    inline uint64_t round(uint64_t lane, uint64_t input) {
+        lane += input * PRIME2;
+        return rotateLeft(lane, 31) * PRIME1;
+    }
+
+    inline uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+        hash ^= round(0, lane);
+        return hash * PRIME1 + PRIME4;
+    }
+}
+
+XXHash64::XXHash64(uint64_t seed) : seed(seed), totalLength(0), buffered(0) {
+    lanes[0] = seed + PRIME1 + PRIME2;
+    lanes[1] = seed + PRIME2;
+    lanes[2] = seed;
+    lanes[3] = seed - PRIME1;
+}
+
+void XXHash64::update(const void* data, size_t length) {
+    const unsigned char* input = static_cast<const unsigned char*>(data);
+    totalLength += length;
+
+    // Top up a partial stripe first
+    if (buffered > 0) {
+        size_t take = sizeof(buffer) - buffered;
+        if (length < take) {
+            std::memcpy(buffer + buffered, input, length);
+            buffered += length;
+            return;
+        }
+        std::memcpy(buffer + buffered, input, take);
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = round(lanes[i], read64(buffer + i * 8));
+        }
+        input += take;
+        length -= take;
+        buffered = 0;
+    }
+
+    while (length >= sizeof(buffer)) {
+        lanes[0] = round(lanes[0], read64(input));
+        lanes[1] = round(lanes[1], read64(input + 8));
+        lanes[2] = round(lanes[2], read64(input + 16));
+        lanes[3] = round(lanes[3], read64(input + 24));
+        input += sizeof(buffer);
+        length -= sizeof(buffer);
+    }
+
+    std::memcpy(buffer, input, length);
+    buffered = length;
+}
+
+uint64_t XXHash64::digest() const {
+    uint64_t hash;
+    if (totalLength >= sizeof(buffer)) {
+        hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            hash = mergeRound(hash, lanes[i]);
+        }
+    } else {
+        hash = seed + PRIME5;
+    }
+    hash += totalLength;
+
+    // Tail: 8, then 4, then 1 byte at a time
+    const unsigned char* p = buffer;
+    const unsigned char* end = buffer + buffered;
+    for (; p + 8 <= end; p += 8) {
+        hash ^= round(0, read64(p));
+        hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+        hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= *p * PRIME5;
+        hash = rotateLeft(hash, 11) * PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t XXHash64::hash(const void* data, size_t length, uint64_t seed) {
+    XXHash64 hasher(seed);
+    hasher.update(data, length);
+    return hasher.digest();
+}
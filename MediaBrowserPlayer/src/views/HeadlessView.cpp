@@ -0,0 +1,41 @@
+#include "../../include/views/HeadlessView.h"
+#include <iostream>
+
+HeadlessView::HeadlessView() {
+}
+
+void HeadlessView::displayMessage(const std::string&) {
+}
+
+void HeadlessView::displayError(const std::string& message) {
+    std::cerr << "ERROR: " << message << std::endl;
+}
+
+std::string HeadlessView::getInput(const std::string&) {
+    return "";
+}
+
+int HeadlessView::getMenuChoice(int min, int) {
+    return min;
+}
+
+void HeadlessView::clearScreen() {
+}
+
+void HeadlessView::waitForInput() {
+}
+
+void HeadlessView::displayHeader() {
+}
+
+void HeadlessView::displayCurrentDirectory(const std::string&) {
+}
+
+void HeadlessView::displayMainMenu() {
+}
+
+void HeadlessView::displayPlayer(const AudioState&) {
+}
+
+void HeadlessView::flashMessage(const std::string&) {
+}
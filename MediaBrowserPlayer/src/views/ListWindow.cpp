@@ -0,0 +1,130 @@
+#include "../../include/views/ListWindow.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // Keep at most this many pages of formatted rows around
+    constexpr size_t CACHED_PAGES = 8;
+    constexpr size_t LETTER_BUCKETS = 27;
+}
+
+ListWindow::ListWindow(size_t pageSize)
+    : pageSize(pageSize == 0 ? 1 : pageSize), itemCount(0), currentPage(0) {
+}
+
+void ListWindow::setSource(size_t count, RowFormatter rowFormatter, KeyExtractor keyExtractor) {
+    itemCount = count;
+    formatter = std::move(rowFormatter);
+    keyOf = std::move(keyExtractor);
+    currentPage = 0;
+    invalidate();
+}
+
+void ListWindow::invalidate() {
+    rowCache.clear();
+    letterIndex.clear();
+}
+
+size_t ListWindow::getItemCount() const {
+    return itemCount;
+}
+
+int ListWindow::getPageCount() const {
+    return static_cast<int>((itemCount + pageSize - 1) / pageSize);
+}
+
+int ListWindow::getCurrentPage() const {
+    return currentPage;
+}
+
+void ListWindow::setPage(int page) {
+    int lastPage = std::max(0, getPageCount() - 1);
+    currentPage = std::max(0, std::min(page, lastPage));
+}
+
+bool ListWindow::nextPage() {
+    if (currentPage + 1 >= getPageCount()) {
+        return false;
+    }
+    currentPage++;
+    return true;
+}
+
+bool ListWindow::previousPage() {
+    if (currentPage == 0) {
+        return false;
+    }
+    currentPage--;
+    return true;
+}
+
+size_t ListWindow::getFirstVisible() const {
+    return std::min(static_cast<size_t>(currentPage) * pageSize, itemCount);
+}
+
+size_t ListWindow::getEndVisible() const {
+    return std::min(getFirstVisible() + pageSize, itemCount);
+}
+
+bool ListWindow::jumpToLetter(char letter) {
+    if (!keyOf || itemCount == 0) {
+        return false;
+    }
+
+    if (letterIndex.empty()) {
+        buildLetterIndex();
+    }
+
+    const std::vector<size_t>& bucket = letterIndex[letterBucket(letter)];
+    if (bucket.empty()) {
+        return false;
+    }
+
+    // First match at or below the top of the page; if that one is already
+    // visible, repeated jumps cycle to the next page holding a match
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), getFirstVisible());
+    if (it != bucket.end() && *it < getEndVisible()) {
+        it = std::lower_bound(it, bucket.end(), getEndVisible());
+    }
+    size_t target = (it != bucket.end()) ? *it : bucket.front();
+
+    currentPage = static_cast<int>(target / pageSize);
+    return true;
+}
+
+std::string ListWindow::renderPage() {
+    size_t first = getFirstVisible();
+    size_t end = getEndVisible();
+
+    if (rowCache.size() > CACHED_PAGES * pageSize) {
+        rowCache.clear();
+    }
+
+    std::string out;
+    for (size_t i = first; i < end; ++i) {
+        auto it = rowCache.find(i);
+        if (it == rowCache.end()) {
+            it = rowCache.emplace(i, formatter ? formatter(i) : std::string()).first;
+        }
+        out += it->second;
+        out += '\n';
+    }
+    return out;
+}
+
+void ListWindow::buildLetterIndex() {
+    letterIndex.assign(LETTER_BUCKETS, std::vector<size_t>());
+
+    for (size_t i = 0; i < itemCount; ++i) {
+        std::string key = keyOf(i);
+        letterIndex[letterBucket(key.empty() ? '\0' : key[0])].push_back(i);
+    }
+}
+
+size_t ListWindow::letterBucket(char c) {
+    unsigned char uc = static_cast<unsigned char>(c);
+    if (std::isalpha(uc)) {
+        return static_cast<size_t>(std::tolower(uc) - 'a');
+    }
+    return LETTER_BUCKETS - 1;
+}
@@ -1,4 +1,5 @@
 #include "../../include/views/MainView.h"
+#include "../../include/utils/Trace.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
@@ -74,6 +75,9 @@ void MainView::displayMainMenu() {
     displayMenuItem(3, "Now Playing");
     displayMenuItem(4, "Play");
     displayMenuItem(5, "Change Directory");
+    if (Trace::ENABLED) {
+        displayMenuItem(9, "Dump Trace");
+    }
     displayMenuItem(0, "Exit");
     std::cout << "\n";
 }
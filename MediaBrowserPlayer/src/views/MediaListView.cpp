@@ -1,9 +1,12 @@
 #include "../../include/views/MediaListView.h"
 #include "../../include/Constants.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <cstdlib>
+#include <sstream>
 
 MediaListView::MediaListView() {
 }
@@ -59,46 +62,53 @@ void MediaListView::waitForInput() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-void MediaListView::displayMediaFiles(const std::vector<MediaFile>& files, int page) {
+void MediaListView::displayMediaFiles(ListWindow& window) {
+    TRACE_ZONE("view.mediaList");
+    static Metrics::Histogram& renderTime = Metrics::histogram("mbp_render_seconds", "Time to draw a screen", "view=\"media_list\"");
+    Metrics::ScopedTimer timer(renderTime);
     clearScreen();
     
-    std::cout << std::string(80, '=') << std::endl;
-    std::cout << std::setw(40) << std::right << "Media Files" << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
+    // Build the whole screen first and write it with a single flush
+    std::ostringstream out;
+    out << std::string(80, '=') << '\n';
+    out << std::setw(40) << std::right << "Media Files" << '\n';
+    out << std::string(80, '=') << '\n';
     
-    // Calculate pagination values
-    int totalFiles = files.size();
-    int totalPages = (totalFiles + Constants::ITEMS_PER_PAGE - 1) / Constants::ITEMS_PER_PAGE;
-    int startIndex = page * Constants::ITEMS_PER_PAGE;
-    int endIndex = std::min(startIndex + Constants::ITEMS_PER_PAGE, totalFiles);
-    
-    if (totalFiles == 0) {
-        std::cout << "\nNo media files found in this location." << std::endl;
+    if (window.getItemCount() == 0) {
+        out << "\nNo media files found in this location." << '\n';
     } else {
         // File list header
-        std::cout << std::left << std::setw(4) << "#" 
-                  << std::setw(40) << "Name" 
-                  << std::setw(15) << "Type" 
-                  << std::setw(10) << "Duration" 
-                  << std::endl;
-        std::cout << std::string(80, '-') << std::endl;
+        out << std::left << std::setw(4) << "#" 
+            << std::setw(40) << "Name" 
+            << std::setw(15) << "Type" 
+            << std::setw(10) << "Duration" 
+            << '\n';
+        out << std::string(80, '-') << '\n';
         
-        // List files for current page
-        for (int i = startIndex; i < endIndex; ++i) {
-            std::cout << formatMediaFileEntry(files[i], i) << std::endl;
-        }
+        // List files for current page only
+        out << window.renderPage();
         
-        std::cout << std::endl;
-        displayPaginationControls(page, totalPages);
+        out << '\n';
+        out << "Page " << (window.getCurrentPage() + 1) << " of " << window.getPageCount() << '\n';
+        if (window.getCurrentPage() > 0) {
+            out << "  [P] Previous page" << '\n';
+        }
+        if (window.getCurrentPage() < window.getPageCount() - 1) {
+            out << "  [N] Next page" << '\n';
+        }
+        out << "  [J<letter>] Jump to letter" << '\n';
     }
     
-    std::cout << "\nOptions:" << std::endl;
-    std::cout << "  1. View file details" << std::endl;
-    std::cout << "  2. Search files" << std::endl;
-    std::cout << "  3. Filter by type" << std::endl;
-    std::cout << "  4. Add to playlist" << std::endl;
-    std::cout << "  5. Change page" << std::endl;
-    std::cout << "  0. Back to main menu" << std::endl;
+    out << "\nOptions:" << '\n';
+    out << "  1. View file details" << '\n';
+    out << "  2. Search files" << '\n';
+    out << "  3. Filter by type" << '\n';
+    out << "  4. Add to playlist" << '\n';
+    out << "  5. Change page" << '\n';
+    out << "  6. Find duplicates" << '\n';
+    out << "  0. Back to main menu" << '\n';
+    
+    std::cout << out.str() << std::flush;
 }
 
 void MediaListView::displayMediaFileDetails(const MediaFile& file) {
@@ -187,6 +197,36 @@ void MediaListView::displayMediaOptionsMenu() {
     std::cout << "0. Back to main menu" << std::endl;
 }
 
+void MediaListView::displayProgress(const std::string& label, size_t done, size_t total) {
+    std::cout << '\r' << label << ": " << done << "/" << total;
+    if (done >= total) {
+        std::cout << '\n';
+    }
+    std::cout << std::flush;
+}
+
+void MediaListView::displayDuplicateGroups(const std::vector<std::vector<MediaFile>>& groups) {
+    clearScreen();
+    
+    std::ostringstream out;
+    out << std::string(80, '=') << '\n';
+    out << std::setw(40) << std::right << "Duplicate Files" << '\n';
+    out << std::string(80, '=') << '\n';
+    
+    for (size_t g = 0; g < groups.size(); ++g) {
+        out << "\nGroup " << (g + 1) << ":" << '\n';
+        for (size_t i = 0; i < groups[g].size(); ++i) {
+            const MediaFile& file = groups[g][i];
+            std::string bitrate = file.getMetadata().getAttribute(Constants::MetadataKeys::BITRATE);
+            out << (i == 0 ? "  keep   " : "  extra  ")
+                << std::left << std::setw(12) << (bitrate.empty() ? "?" : bitrate)
+                << file.getFilePath() << '\n';
+        }
+    }
+    
+    std::cout << out.str() << std::flush;
+}
+
 std::string MediaListView::formatMediaFileEntry(const MediaFile& file, int index) {
     std::stringstream ss;
     
@@ -201,18 +241,6 @@ std::string MediaListView::formatMediaFileEntry(const MediaFile& file, int index
     return ss.str();
 }
 
-void MediaListView::displayPaginationControls(int currentPage, int totalPages) {
-    std::cout << "Page " << (currentPage + 1) << " of " << totalPages << std::endl;
-    
-    if (currentPage > 0) {
-        std::cout << "  [P] Previous page" << std::endl;
-    }
-    
-    if (currentPage < totalPages - 1) {
-        std::cout << "  [N] Next page" << std::endl;
-    }
-}
-
 void MediaListView::displayHeader() {
     clearScreen();
     std::cout << std::string(80, '*') << std::endl;
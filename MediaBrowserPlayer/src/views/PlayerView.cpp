@@ -1,10 +1,14 @@
 #include "../../include/views/PlayerView.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <vector>
 
 PlayerView::PlayerView() {
 }
@@ -61,6 +65,9 @@ void PlayerView::waitForInput() {
 }
 
 void PlayerView::displayPlayer(const AudioState& audioState) {
+    TRACE_ZONE("view.player");
+    static Metrics::Histogram& renderTime = Metrics::histogram("mbp_render_seconds", "Time to draw a screen", "view=\"player\"");
+    Metrics::ScopedTimer timer(renderTime);
     clearScreen();
     
     std::cout << std::string(80, '=') << std::endl;
@@ -118,13 +125,52 @@ void PlayerView::displayPlayerControls() {
     std::cout << "  [P] Previous track" << std::endl;
     std::cout << "  [+] Volume up" << std::endl;
     std::cout << "  [-] Volume down" << std::endl;
+    std::cout << "  [V] Spectrum on/off" << std::endl;
     std::cout << "  [Q] Back to main menu" << std::endl;
-    std::cout << "Enter Command: " << std::endl;
+    std::cout << "Press a key: " << std::endl;
 }
 
 void PlayerView::displayProgressBar(double current, double total) {
     double percentage = (total > 0) ? (current / total) * 100.0 : 0.0;
-    std::cout << drawProgressBar(percentage, 60) << std::endl;
+    percentage = std::max(0.0, std::min(percentage, 100.0));
+    std::cout << (waveform ? drawWaveformBar(percentage, 60) : drawProgressBar(percentage, 60)) << std::endl;
+}
+
+void PlayerView::setWaveform(std::shared_ptr<const WaveformPeaks> peaks) {
+    waveform = std::move(peaks);
+}
+
+void PlayerView::displaySpectrum(const std::vector<float>& bands, float level, float peak, bool inPlace) {
+    static const char* const PARTIAL[] = {" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    const int height = Constants::SPECTRUM_HEIGHT;
+    
+    // Built in one piece and written at once, so a refresh doesn't flicker
+    std::string out;
+    if (inPlace) {
+        out += "\033[" + std::to_string(height + 1) + "A\r";
+    }
+    for (int row = height - 1; row >= 0; --row) {
+        out += "  ";
+        for (float band : bands) {
+            // Eighths of a row filled at this height
+            int eighths = static_cast<int>((band * height - row) * 8.0f + 0.5f);
+            const char* cell = PARTIAL[std::max(0, std::min(eighths, 8))];
+            out += cell;
+            out += cell;
+        }
+        out += "\n";
+    }
+    
+    const int width = static_cast<int>(bands.size()) * 2 - 8;
+    int filled = static_cast<int>(level * width + 0.5f);
+    int peakAt = std::min(width - 1, static_cast<int>(peak * width));
+    out += "  Level [";
+    for (int i = 0; i < width; ++i) {
+        out += i == peakAt ? "|" : (i < filled ? "█" : " ");
+    }
+    out += "]\n";
+    
+    std::cout << out << std::flush;
 }
 
 void PlayerView::displayVolume(int volume) {
@@ -159,6 +205,9 @@ void PlayerView::displayNowPlaying(const MediaFile& track) {
 }
 
 void PlayerView::displayQueue(const Playlist& playlist, int currentIndex) {
+    TRACE_ZONE("view.queue");
+    static Metrics::Histogram& renderTime = Metrics::histogram("mbp_render_seconds", "Time to draw a screen", "view=\"queue\"");
+    Metrics::ScopedTimer timer(renderTime);
     const auto& tracks = playlist.getTracks();
     int tracksToShow = 5; // Show 5 tracks before and after current
     
@@ -206,6 +255,28 @@ std::string PlayerView::drawProgressBar(double percentage, int width) {
     return bar;
 }
 
+std::string PlayerView::drawWaveformBar(double percentage, int width) {
+    static const char* const BLOCKS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    int pos = static_cast<int>((width * percentage) / 100.0);
+    std::vector<float> envelope = waveform->getEnvelope(static_cast<size_t>(width));
+    
+    std::string bar;
+    bar += "[";
+    for (int i = 0; i < width; ++i) {
+        if (i == pos) {
+            bar += "\033[2m";
+        }
+        int height = static_cast<int>(envelope[i] * 7.0f + 0.5f);
+        bar += BLOCKS[std::max(0, std::min(height, 7))];
+    }
+    if (pos < width) {
+        bar += "\033[0m";
+    }
+    bar += "] " + std::to_string(static_cast<int>(percentage)) + "%";
+    
+    return bar;
+}
+
 std::string PlayerView::drawVolumeBar(int volume, int width) {
     int pos = static_cast<int>((width * volume) / 100.0);
     
@@ -1,9 +1,12 @@
 #include "../../include/views/PlaylistView.h"
 #include "../../include/Constants.h"
+#include "../../include/utils/Trace.h"
+#include "../../include/utils/Metrics.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <cstdlib>
+#include <sstream>
 
 PlaylistView::PlaylistView() {
 }
@@ -59,7 +62,10 @@ void PlaylistView::waitForInput() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-void PlaylistView::displayPlaylists(const std::vector<Playlist>& playlists) {
+void PlaylistView::displayPlaylists(const std::vector<PlaylistHeader>& playlists) {
+    TRACE_ZONE("view.playlists");
+    static Metrics::Histogram& renderTime = Metrics::histogram("mbp_render_seconds", "Time to draw a screen", "view=\"playlists\"");
+    Metrics::ScopedTimer timer(renderTime);
     clearScreen();
     
     std::cout << std::string(80, '=') << std::endl;
@@ -79,7 +85,7 @@ void PlaylistView::displayPlaylists(const std::vector<Playlist>& playlists) {
         
         // List playlists
         for (size_t i = 0; i < playlists.size(); ++i) {
-            const Playlist& playlist = playlists[i];
+            const PlaylistHeader& playlist = playlists[i];
             std::cout << std::left << std::setw(4) << (i + 1) 
                       << std::setw(40) << (playlist.getName().length() > 37 
                                           ? playlist.getName().substr(0, 37) + "..." 
@@ -96,10 +102,54 @@ void PlaylistView::displayPlaylists(const std::vector<Playlist>& playlists) {
     std::cout << "  3. Edit playlist" << std::endl;
     std::cout << "  4. Delete playlist" << std::endl;
     std::cout << "  5. Play playlist" << std::endl;
+    std::cout << "  6. Import playlist (M3U/PLS)" << std::endl;
+    std::cout << "  7. Export playlist (M3U/PLS)" << std::endl;
+    std::cout << "  8. Smart playlists" << std::endl;
     std::cout << "  0. Back to main menu" << std::endl;
 }
 
-void PlaylistView::displayPlaylistsToAdd(const std::vector<Playlist>& playlists){
+void PlaylistView::displaySmartPlaylists(const std::vector<SmartPlaylist>& playlists) {
+    clearScreen();
+    
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << std::setw(40) << std::right << "Smart Playlists" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    
+    if (playlists.empty()) {
+        std::cout << "\nNo smart playlists found." << std::endl;
+    } else {
+        std::cout << std::left << std::setw(4) << "#" 
+                  << std::setw(25) << "Name" 
+                  << std::setw(10) << "Matches" 
+                  << "Rule" 
+                  << std::endl;
+        std::cout << std::string(80, '-') << std::endl;
+        
+        for (size_t i = 0; i < playlists.size(); ++i) {
+            const SmartPlaylist& playlist = playlists[i];
+            const std::string& rule = playlist.getQuery().getText();
+            std::cout << std::left << std::setw(4) << (i + 1) 
+                      << std::setw(25) << (playlist.getName().length() > 22 
+                                          ? playlist.getName().substr(0, 22) + "..." 
+                                          : playlist.getName())
+                      << std::setw(10) << playlist.getMatchCount() 
+                      << (rule.length() > 41 ? rule.substr(0, 38) + "..." : rule)
+                      << std::endl;
+        }
+    }
+    
+    std::cout << "\nRules look like: genre = rap AND year >= 2015 AND duration < 300 SORT BY artist" << std::endl;
+    std::cout << "Fields: title artist album genre type year duration bitrate track; ~ means contains" << std::endl;
+    
+    std::cout << "\nOptions:" << std::endl;
+    std::cout << "  1. Play smart playlist" << std::endl;
+    std::cout << "  2. Create smart playlist" << std::endl;
+    std::cout << "  3. Save as regular playlist" << std::endl;
+    std::cout << "  4. Delete smart playlist" << std::endl;
+    std::cout << "  0. Back" << std::endl;
+}
+
+void PlaylistView::displayPlaylistsToAdd(const std::vector<PlaylistHeader>& playlists){
     clearScreen();
     
     std::cout << std::string(80, '=') << std::endl;
@@ -119,7 +169,7 @@ void PlaylistView::displayPlaylistsToAdd(const std::vector<Playlist>& playlists)
         
         // List playlists
         for (size_t i = 0; i < playlists.size(); ++i) {
-            const Playlist& playlist = playlists[i];
+            const PlaylistHeader& playlist = playlists[i];
             std::cout << std::left << std::setw(4) << (i + 1) 
                       << std::setw(40) << (playlist.getName().length() > 37 
                                           ? playlist.getName().substr(0, 37) + "..." 
@@ -137,6 +187,9 @@ void PlaylistView::displayPlaylistsToAdd(const std::vector<Playlist>& playlists)
 }
 
 void PlaylistView::displayPlaylist(const Playlist& playlist, int page) {
+    TRACE_ZONE("view.playlist");
+    static Metrics::Histogram& renderTime = Metrics::histogram("mbp_render_seconds", "Time to draw a screen", "view=\"playlist\"");
+    Metrics::ScopedTimer timer(renderTime);
     clearScreen();
     
     std::cout << std::string(80, '=') << std::endl;
@@ -201,6 +254,8 @@ void PlaylistView::displayPlaylistEditMenu(const Playlist& playlist) {
     std::cout << "3. Remove tracks" << std::endl;
     std::cout << "4. Reorder tracks" << std::endl;
     std::cout << "5. Clear playlist" << std::endl;
+    std::cout << "6. Undo last change" << std::endl;
+    std::cout << "7. Redo" << std::endl;
     std::cout << "0. Save and return" << std::endl;
 }
 
@@ -218,6 +273,30 @@ void PlaylistView::displayPlaylistOptionsMenu() {
     std::cout << "0. Back to main menu" << std::endl;
 }
 
+void PlaylistView::displayTrackPicker(const std::string& title, ListWindow& window) {
+    clearScreen();
+    
+    // Build the whole screen first and write it with a single flush
+    std::ostringstream out;
+    out << std::string(80, '=') << '\n';
+    out << std::setw(40) << std::right << title << '\n';
+    out << std::string(80, '=') << '\n';
+    
+    out << std::left << std::setw(4) << "#" 
+        << std::setw(40) << "Title" 
+        << std::setw(15) << "Type" 
+        << std::setw(10) << "Duration" 
+        << '\n';
+    out << std::string(80, '-') << '\n';
+    
+    out << window.renderPage();
+    
+    out << "\nPage " << (window.getCurrentPage() + 1) << " of " << window.getPageCount() << '\n';
+    out << "  [P] Previous page  [N] Next page  [J<letter>] Jump to letter" << '\n';
+    
+    std::cout << out.str() << std::flush;
+}
+
 void PlaylistView::displayPaginationControls(int currentPage, int totalPages) {
     std::cout << "Page " << (currentPage + 1) << " of " << totalPages << std::endl;
     
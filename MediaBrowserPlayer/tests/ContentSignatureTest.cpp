@@ -0,0 +1,340 @@
+#include "TestSupport.h"
+#include "models/MediaLibrary.h"
+#include "utils/ContentSignature.h"
+#include "utils/XXHash64.h"
+#include <fstream>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace {
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    // Set the modification time to seconds after the epoch
+    void setModified(const std::string& path, long long seconds) {
+        timespec times[2];
+        times[0].tv_sec = seconds;
+        times[0].tv_nsec = 0;
+        times[1] = times[0];
+        utimensat(AT_FDCWD, path.c_str(), times, 0);
+    }
+
+    // Payload bytes that differ from block to block
+    std::string makePayload(size_t size, unsigned seed) {
+        std::string payload(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<char>((i * 131 + seed * 7 + (i >> 9)) & 0xFF);
+        }
+        return payload;
+    }
+
+    // ID3v2.4 tag of tagSize bytes after the header (syncsafe size, zero padding)
+    std::string makeId3v2(size_t tagSize) {
+        std::string tag = "ID3";
+        tag += '\x04';
+        tag += '\0';
+        tag += '\0';
+        tag += static_cast<char>((tagSize >> 21) & 0x7F);
+        tag += static_cast<char>((tagSize >> 14) & 0x7F);
+        tag += static_cast<char>((tagSize >> 7) & 0x7F);
+        tag += static_cast<char>(tagSize & 0x7F);
+        return tag + std::string(tagSize, '\0');
+    }
+
+    // ID3v1 tag: "TAG" and 125 bytes of fields
+    std::string makeId3v1(const std::string& title) {
+        std::string tag = "TAG" + title;
+        tag.resize(128, '\0');
+        return tag;
+    }
+
+    // APEv2 tag with one item, header and footer
+    std::string makeApe(const std::string& value) {
+        std::string item;
+        for (int i = 0; i < 4; ++i) {
+            item += static_cast<char>((value.size() >> (8 * i)) & 0xFF);
+        }
+        item += std::string(4, '\0');
+        item += "Title";
+        item += '\0';
+        item += value;
+
+        auto block = [&item](bool header) {
+            std::string bytes = "APETAGEX";
+            unsigned values[] = {2000, static_cast<unsigned>(item.size() + 32), 1, header ? 0xA0000000u : 0x80000000u};
+            for (unsigned value : values) {
+                for (int i = 0; i < 4; ++i) {
+                    bytes += static_cast<char>((value >> (8 * i)) & 0xFF);
+                }
+            }
+            return bytes + std::string(8, '\0');
+        };
+        return block(true) + item + block(false);
+    }
+
+    std::string little32(uint32_t value) {
+        std::string bytes;
+        for (int i = 0; i < 4; ++i) {
+            bytes += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return bytes;
+    }
+
+    std::string big32(uint32_t value) {
+        std::string bytes;
+        for (int i = 3; i >= 0; --i) {
+            bytes += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return bytes;
+    }
+
+    // RIFF chunk with little-endian size, padded to even length
+    std::string makeChunk(const std::string& id, const std::string& body) {
+        return id + little32(static_cast<uint32_t>(body.size())) + body + (body.size() % 2 ? std::string(1, '\0') : "");
+    }
+
+    // MP4 box with 32-bit size
+    std::string makeBox(const std::string& type, const std::string& body) {
+        return big32(static_cast<uint32_t>(body.size() + 8)) + type + body;
+    }
+
+    // Ogg page with the given granule position and sequence number; the CRC is made up
+    // but differs with the sequence number, as a real one would
+    std::string makeOggPage(uint64_t granule, uint32_t sequence, const std::string& body) {
+        std::string page = "OggS";
+        page += '\0';
+        page += sequence == 0 ? '\x02' : '\0';
+        for (int i = 0; i < 8; ++i) {
+            page += static_cast<char>((granule >> (8 * i)) & 0xFF);
+        }
+        page += little32(0x1234);
+        page += little32(sequence);
+        page += little32(sequence * 2654435761u + 1);
+        std::string lacing;
+        size_t left = body.size();
+        do {
+            lacing += static_cast<char>(left >= 255 ? 255 : left);
+            left = left >= 255 ? left - 255 : 0;
+        } while (lacing.back() == '\xff' || left > 0);
+        page += static_cast<char>(lacing.size());
+        return page + lacing + body;
+    }
+
+    // Ogg Vorbis-like stream: identification page, comment packet over commentPages
+    // pages (continued ones flagged with granule -1), then audio pages
+    std::string makeOgg(const std::string& comment, size_t commentPages, const std::vector<std::string>& audio) {
+        uint32_t sequence = 0;
+        std::string stream = makeOggPage(0, sequence++, "\x01vorbis" + std::string(22, 'i'));
+        size_t pieceSize = (comment.size() + commentPages - 1) / commentPages;
+        for (size_t page = 0; page < commentPages; ++page) {
+            uint64_t granule = page + 1 < commentPages ? ~0ULL : 0;
+            stream += makeOggPage(granule, sequence++, comment.substr(page * pieceSize, pieceSize));
+        }
+        for (size_t page = 0; page < audio.size(); ++page) {
+            stream += makeOggPage((page + 1) * 1024, sequence++, audio[page]);
+        }
+        return stream;
+    }
+
+    void testXXHash64Vectors() {
+        CHECK_EQ(XXHash64::hash("", 0), 0xef46db3751d8e999ULL);
+        CHECK_EQ(XXHash64::hash("a", 1), 0xd24ec4f1a98c6e5bULL);
+        CHECK_EQ(XXHash64::hash("abc", 3), 0x44bc2cf5ad770999ULL);
+        CHECK_EQ(XXHash64::hash("", 0, 1), 0xd5afba1336a3be4bULL);
+
+        std::string fox = "The quick brown fox jumps over the lazy dog";
+        CHECK_EQ(XXHash64::hash(fox.data(), fox.size()), 0x0b242d361fda71bcULL);
+
+        // Long enough for the four-lane stripes and a tail of every kind
+        std::string bytes;
+        for (int round = 0; round < 4; ++round) {
+            for (int i = 0; i < 256; ++i) {
+                bytes += static_cast<char>(i);
+            }
+        }
+        bytes += "xyz";
+        CHECK_EQ(XXHash64::hash(bytes.data(), bytes.size()), 0xe146cb31b65bc21aULL);
+        CHECK_EQ(XXHash64::hash(bytes.data(), bytes.size(), 0x9E3779B97F4A7C15ULL), 0x86b7211d04e93c1fULL);
+    }
+
+    void testXXHash64Streaming() {
+        std::string bytes = makePayload(1027, 3);
+        uint64_t expected = XXHash64::hash(bytes.data(), bytes.size(), 5);
+
+        // Pieces that start and end inside and across 32-byte stripes
+        const size_t pieces[] = {1, 7, 31, 33, 64, 3, 100, 0, 500};
+        XXHash64 hasher(5);
+        size_t offset = 0;
+        for (size_t piece : pieces) {
+            hasher.update(bytes.data() + offset, piece);
+            offset += piece;
+        }
+        hasher.update(bytes.data() + offset, bytes.size() - offset);
+        CHECK_EQ(hasher.digest(), expected);
+
+        // digest() leaves the state alone
+        CHECK_EQ(hasher.digest(), expected);
+    }
+
+    void testSignatureIgnoresTags() {
+        std::string dir = TestSupport::makeTempDir("content-signature");
+        std::string path = dir + "/song.mp3";
+        std::string payload = makePayload(200000, 1);
+
+        writeFile(path, payload);
+        uint64_t plain = ContentSignature::compute(path);
+        CHECK(plain != 0);
+
+        writeFile(path, makeId3v2(4096) + payload);
+        CHECK_EQ(ContentSignature::compute(path), plain);
+        writeFile(path, makeId3v2(100) + makeId3v2(2000) + payload + makeId3v1("Song"));
+        CHECK_EQ(ContentSignature::compute(path), plain);
+        writeFile(path, payload + makeApe("A longer title") + makeId3v1("Other"));
+        CHECK_EQ(ContentSignature::compute(path), plain);
+
+        // FLAC metadata blocks; the last one is flagged
+        std::string flac = "fLaC";
+        flac += std::string("\x00\x00\x00\x22", 4) + std::string(0x22, 's');
+        flac += std::string("\x84\x00\x00\x10", 4) + std::string(0x10, 'c');
+        writeFile(path, flac + payload);
+        uint64_t flacSignature = ContentSignature::compute(path);
+        flac[flac.size() - 1] = 'x';
+        writeFile(path, makeId3v2(50) + flac + payload);
+        CHECK_EQ(ContentSignature::compute(path), flacSignature);
+
+        // A change in the first or last block, or in the length, is a different file
+        std::string changed = payload;
+        changed[10] ^= 1;
+        writeFile(path, changed);
+        CHECK(ContentSignature::compute(path) != plain);
+        changed = payload;
+        changed[changed.size() - 10] ^= 1;
+        writeFile(path, changed);
+        CHECK(ContentSignature::compute(path) != plain);
+        writeFile(path, payload + "z");
+        CHECK(ContentSignature::compute(path) != plain);
+
+        CHECK_EQ(ContentSignature::compute(dir + "/missing.mp3"), 0ULL);
+    }
+
+    void testSignatureIgnoresContainerTags() {
+        std::string dir = TestSupport::makeTempDir("content-signature-containers");
+        std::string path = dir + "/song";
+        std::string audio = makePayload(150001, 5);
+        std::string changed = audio;
+        changed[100] ^= 1;
+
+        // WAV: LIST/INFO before the data chunk, "id3 " after it
+        std::string format = makeChunk("fmt ", std::string(16, 'f'));
+        auto wav = [&](const std::string& info, const std::string& id3, const std::string& samples) {
+            std::string chunks = "WAVE" + format + (info.empty() ? "" : makeChunk("LIST", "INFO" + info)) +
+                                 makeChunk("data", samples) + (id3.empty() ? "" : makeChunk("id3 ", id3));
+            return "RIFF" + little32(static_cast<uint32_t>(chunks.size())) + chunks;
+        };
+        writeFile(path, wav("", "", audio));
+        uint64_t wavSignature = ContentSignature::compute(path);
+        writeFile(path, wav("INAM" + std::string(9, 't'), makeId3v2(300), audio));
+        CHECK_EQ(ContentSignature::compute(path), wavSignature);
+        writeFile(path, wav("", "", changed));
+        CHECK(ContentSignature::compute(path) != wavSignature);
+
+        // MP4: tags live in moov/udta/meta/ilst, before or after mdat
+        std::string ftyp = makeBox("ftyp", "M4A " + std::string(4, '\0'));
+        auto moov = [](const std::string& title) {
+            return makeBox("moov", makeBox("mvhd", std::string(100, 'h')) +
+                                   makeBox("udta", makeBox("meta", std::string(4, '\0') + makeBox("ilst", title))));
+        };
+        writeFile(path, ftyp + moov("short") + makeBox("mdat", audio));
+        uint64_t mp4Signature = ContentSignature::compute(path);
+        writeFile(path, ftyp + moov("a much longer title than before") + makeBox("free", std::string(64, '\0')) + makeBox("mdat", audio));
+        CHECK_EQ(ContentSignature::compute(path), mp4Signature);
+        writeFile(path, ftyp + makeBox("mdat", audio) + moov("at the end"));
+        CHECK_EQ(ContentSignature::compute(path), mp4Signature);
+        writeFile(path, ftyp + moov("short") + makeBox("mdat", changed));
+        CHECK(ContentSignature::compute(path) != mp4Signature);
+
+        // Ogg: a longer comment packet takes more pages, renumbering every audio page
+        std::vector<std::string> pages;
+        for (size_t offset = 0; offset < audio.size(); offset += 4000) {
+            pages.push_back(audio.substr(offset, 4000));
+        }
+        writeFile(path, makeOgg("\x03vorbis" + std::string(40, 'c'), 1, pages));
+        uint64_t oggSignature = ContentSignature::compute(path);
+        CHECK(oggSignature != 0);
+        writeFile(path, makeOgg("\x03vorbis" + std::string(30000, 'C'), 3, pages));
+        CHECK_EQ(ContentSignature::compute(path), oggSignature);
+        pages[1][7] ^= 1;
+        writeFile(path, makeOgg("\x03vorbis" + std::string(40, 'c'), 1, pages));
+        CHECK(ContentSignature::compute(path) != oggSignature);
+        pages[1][7] ^= 1;
+        pages[pages.size() - 2][7] ^= 1;
+        writeFile(path, makeOgg("\x03vorbis" + std::string(40, 'c'), 1, pages));
+        CHECK(ContentSignature::compute(path) != oggSignature);
+    }
+
+    // Scan dir again with the same library; returns the moves it found
+    std::vector<std::pair<std::string, std::string>> rescan(MediaLibrary& library, const std::string& dir) {
+        library.clear();
+        library.scanDirectory(dir);
+        return library.takeMovedFiles();
+    }
+
+    void testMovedFiles() {
+        std::string dir = TestSupport::makeTempDir("content-signature-moves");
+        std::string first = dir + "/first.mp3";
+        std::string second = dir + "/second.mp3";
+        std::string third = dir + "/third.mp3";
+        writeFile(first, makeId3v2(1000) + makePayload(50000, 2));
+        setModified(first, 1700000000);
+
+        MediaLibrary library;
+        rescan(library, dir);
+
+        // A plain move keeps the tags read at the old path
+        std::rename(first.c_str(), second.c_str());
+        auto moves = rescan(library, dir);
+        CHECK_EQ(moves.size(), 1u);
+        CHECK(!moves.empty() && moves[0].first == first && moves[0].second == second);
+        const MediaFile* file = library.findByPath(second);
+        CHECK(file != nullptr);
+        CHECK_EQ(file ? file->getMetadata().getName() : "", std::string("first.mp3"));
+
+        // Moved and retagged within the padding: same size, new time, tags read again
+        std::rename(second.c_str(), third.c_str());
+        setModified(third, 1700000100);
+        moves = rescan(library, dir);
+        CHECK_EQ(moves.size(), 1u);
+        file = library.findByPath(third);
+        CHECK(file != nullptr);
+        CHECK_EQ(file ? file->getMetadata().getName() : "", std::string("third.mp3"));
+    }
+
+    void testDeletedFilesForgotten() {
+        std::string dir = TestSupport::makeTempDir("content-signature-deleted");
+        std::string contents = makePayload(30000, 4);
+        writeFile(dir + "/gone.mp3", contents);
+
+        MediaLibrary library;
+        rescan(library, dir);
+        std::remove((dir + "/gone.mp3").c_str());
+        rescan(library, dir);
+
+        // The same contents showing up after a scan saw the file gone are a new file
+        writeFile(dir + "/back.mp3", contents);
+        CHECK(rescan(library, dir).empty());
+        CHECK(library.findByPath(dir + "/back.mp3") != nullptr);
+    }
+}
+
+int main() {
+    testXXHash64Vectors();
+    testXXHash64Streaming();
+    testSignatureIgnoresTags();
+    testSignatureIgnoresContainerTags();
+    testMovedFiles();
+    testDeletedFilesForgotten();
+    return TestSupport::result("ContentSignatureTest");
+}
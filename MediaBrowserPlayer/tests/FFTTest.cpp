@@ -0,0 +1,117 @@
+#include "TestSupport.h"
+#include "utils/FFT.h"
+#include <cmath>
+#include <vector>
+#include <random>
+
+namespace {
+    // Reference: |X[k]|^2 of a direct DFT, in double precision
+    std::vector<double> directPower(const std::vector<float>& input) {
+        size_t n = input.size();
+        std::vector<double> power(n / 2 + 1);
+        for (size_t k = 0; k <= n / 2; ++k) {
+            double re = 0.0;
+            double im = 0.0;
+            for (size_t t = 0; t < n; ++t) {
+                double angle = -2.0 * M_PI * static_cast<double>(k * t % n) / static_cast<double>(n);
+                re += input[t] * std::cos(angle);
+                im += input[t] * std::sin(angle);
+            }
+            power[k] = re * re + im * im;
+        }
+        return power;
+    }
+
+    // Largest difference between the FFT and the direct DFT, relative to the total power
+    double maxError(FFT& fft, const std::vector<float>& input) {
+        std::vector<float> power(input.size() / 2 + 1);
+        fft.powerSpectrum(input.data(), power.data());
+        std::vector<double> expected = directPower(input);
+        double total = 1e-12;
+        for (double value : expected) {
+            total += value;
+        }
+        double worst = 0.0;
+        for (size_t k = 0; k < power.size(); ++k) {
+            worst = std::max(worst, std::fabs(power[k] - expected[k]) / total);
+        }
+        return worst;
+    }
+
+    void testKnownSpectra() {
+        const size_t n = 64;
+        FFT fft(n);
+        CHECK_EQ(fft.getSize(), n);
+        std::vector<float> input(n, 0.0f);
+        std::vector<float> power(n / 2 + 1);
+
+        // Impulse: flat spectrum of 1
+        input[0] = 1.0f;
+        fft.powerSpectrum(input.data(), power.data());
+        for (size_t k = 0; k <= n / 2; ++k) {
+            CHECK(std::fabs(power[k] - 1.0f) < 1e-5f);
+        }
+
+        // Constant: everything in bin 0, which holds n^2
+        std::fill(input.begin(), input.end(), 1.0f);
+        fft.powerSpectrum(input.data(), power.data());
+        CHECK(std::fabs(power[0] - static_cast<float>(n * n)) < 1e-2f);
+        for (size_t k = 1; k <= n / 2; ++k) {
+            CHECK(std::fabs(power[k]) < 1e-3f);
+        }
+
+        // Cosine on bin 5: (n/2)^2 there, nothing elsewhere; Nyquist alternates sign
+        for (size_t t = 0; t < n; ++t) {
+            input[t] = static_cast<float>(std::cos(2.0 * M_PI * 5.0 * t / n));
+        }
+        fft.powerSpectrum(input.data(), power.data());
+        for (size_t k = 0; k <= n / 2; ++k) {
+            float expected = k == 5 ? static_cast<float>((n / 2) * (n / 2)) : 0.0f;
+            CHECK(std::fabs(power[k] - expected) < 1e-2f);
+        }
+        for (size_t t = 0; t < n; ++t) {
+            input[t] = t % 2 ? -1.0f : 1.0f;
+        }
+        fft.powerSpectrum(input.data(), power.data());
+        CHECK(std::fabs(power[n / 2] - static_cast<float>(n * n)) < 1e-2f);
+    }
+
+    void testRandomBlocks() {
+        std::mt19937 random(46);
+        std::uniform_real_distribution<float> sample(-1.0f, 1.0f);
+        for (size_t n = 4; n <= 2048; n *= 2) {
+            FFT fft(n);
+            for (int round = 0; round < 3; ++round) {
+                std::vector<float> input(n);
+                for (auto& value : input) {
+                    value = sample(random);
+                }
+                double error = maxError(fft, input);
+                if (error > 1e-5) {
+                    std::cerr << "    size " << n << ": relative error " << error << std::endl;
+                }
+                CHECK(error <= 1e-5);
+            }
+        }
+    }
+
+    void testHannWindow() {
+        // Periodic: w[t] = 0.5 - 0.5 cos(2 pi t / size)
+        std::vector<float> window = FFT::makeHannWindow(4);
+        CHECK_EQ(window.size(), 4u);
+        const float expected[] = {0.0f, 0.5f, 1.0f, 0.5f};
+        for (size_t t = 0; t < 4; ++t) {
+            CHECK(std::fabs(window[t] - expected[t]) < 1e-6f);
+        }
+        window = FFT::makeHannWindow(2048);
+        CHECK(std::fabs(window[512] - 0.5f) < 1e-6f);
+        CHECK(std::fabs(window[1024] - 1.0f) < 1e-6f);
+    }
+}
+
+int main() {
+    testKnownSpectra();
+    testRandomBlocks();
+    testHannWindow();
+    return TestSupport::result("FFTTest");
+}
@@ -0,0 +1,145 @@
+#include "TestSupport.h"
+#include "models/MediaLibrary.h"
+#include "utils/RecordWriter.h"
+#include "Constants.h"
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace {
+    const char* INDEXED_TITLE = "Title from the index";
+
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    // Set the modification time to seconds + nanoseconds after the epoch
+    void setModified(const std::string& path, long long seconds, long nanoseconds) {
+        timespec times[2];
+        times[0].tv_sec = seconds;
+        times[0].tv_nsec = nanoseconds;
+        times[1] = times[0];
+        utimensat(AT_FDCWD, path.c_str(), times, 0);
+    }
+
+    // Scan dir, give every file INDEXED_TITLE and write the index
+    void buildIndex(const std::string& dir) {
+        MediaLibrary library;
+        library.scanDirectory(dir);
+        for (size_t i = 0; i < library.getMediaFileCount(); ++i) {
+            library.updateMediaFileMetadata(i, Metadata(INDEXED_TITLE, 42.0));
+        }
+        CHECK_EQ(library.saveIndex(dir, dir + "/" + Constants::LIBRARY_INDEX_FILE), static_cast<long long>(library.getMediaFileCount()));
+    }
+
+    // Title a fresh library gives path after scanning dir
+    std::string scannedTitle(const std::string& dir, const std::string& path) {
+        MediaLibrary library;
+        library.scanDirectory(dir);
+        const MediaFile* file = library.findByPath(path);
+        CHECK(file != nullptr);
+        return file ? file->getMetadata().getName() : "";
+    }
+
+    void testRoundTrip() {
+        std::string dir = TestSupport::makeTempDir("library-index");
+        writeFile(dir + "/one.mp3", std::string(5000, 'a'));
+        writeFile(dir + "/two.wav", std::string(7000, 'b'));
+        writeFile(dir + "/three.mp4", std::string(9000, 'v'));
+        buildIndex(dir);
+
+        std::string contents = readFile(dir + "/" + Constants::LIBRARY_INDEX_FILE);
+        std::string header = std::string(Constants::LIBRARY_INDEX_MAGIC) + " " + std::to_string(Constants::LIBRARY_INDEX_VERSION) + "\n";
+        CHECK_EQ(contents.substr(0, header.size()), header);
+
+        // Paths are stored relative to the directory
+        CHECK(contents.find(dir) == std::string::npos);
+        CHECK_EQ(scannedTitle(dir, dir + "/one.mp3"), std::string(INDEXED_TITLE));
+        CHECK_EQ(scannedTitle(dir, dir + "/two.wav"), std::string(INDEXED_TITLE));
+        CHECK_EQ(scannedTitle(dir, dir + "/three.mp4"), std::string(INDEXED_TITLE));
+    }
+
+    void testCopiedTimes() {
+        std::string dir = TestSupport::makeTempDir("library-index-times");
+        std::string path = dir + "/song.mp3";
+        writeFile(path, std::string(4096, 'c'));
+        setModified(path, 1700000000, 123456789);
+        buildIndex(dir);
+
+        // A copy that kept whole seconds only
+        setModified(path, 1700000000, 0);
+        CHECK_EQ(scannedTitle(dir, path), std::string(INDEXED_TITLE));
+
+        // A copy that took the time of copying: the content signature still matches
+        setModified(path, 1800000000, 5);
+        CHECK_EQ(scannedTitle(dir, path), std::string(INDEXED_TITLE));
+
+        // Same size, other contents: tags are read again
+        writeFile(path, std::string(4096, 'd'));
+        setModified(path, 1800000000, 5);
+        CHECK(scannedTitle(dir, path) != INDEXED_TITLE);
+    }
+
+    void testVersion1() {
+        std::string dir = TestSupport::makeTempDir("library-index-v1");
+        std::string path = dir + "/old.mp3";
+        writeFile(path, std::string(3000, 'e'));
+        setModified(path, 1600000000, 0);
+
+        // Version 1 records have no signature field
+        std::string contents = std::string(Constants::LIBRARY_INDEX_MAGIC) + " 1\n";
+        RecordWriter writer(contents);
+        writer.field(3000LL);
+        writer.field(1600000000LL * 1000000000LL + 250);
+        MediaFile("old.mp3", Metadata(INDEXED_TITLE, 42.0), Constants::FileType::AUDIO).write(writer);
+        writer.endRecord();
+        writeFile(dir + "/" + Constants::LIBRARY_INDEX_FILE, contents);
+
+        CHECK_EQ(scannedTitle(dir, path), std::string(INDEXED_TITLE));
+
+        // Without a signature only the time can vouch for the file
+        setModified(path, 1600000100, 0);
+        CHECK(scannedTitle(dir, path) != INDEXED_TITLE);
+    }
+
+    void testVersion2Videos() {
+        std::string dir = TestSupport::makeTempDir("library-index-v2");
+        writeFile(dir + "/song.mp3", std::string(3000, 'f'));
+        writeFile(dir + "/clip.mp4", std::string(6000, 'g'));
+        setModified(dir + "/song.mp3", 1600000000, 0);
+        setModified(dir + "/clip.mp4", 1600000000, 0);
+
+        // Version 2 listed videos without probing them
+        std::string contents = std::string(Constants::LIBRARY_INDEX_MAGIC) + " 2\n";
+        RecordWriter writer(contents);
+        const std::pair<const char*, Constants::FileType> entries[] = {
+            {"song.mp3", Constants::FileType::AUDIO}, {"clip.mp4", Constants::FileType::VIDEO}};
+        for (const auto& entry : entries) {
+            writer.field(entry.second == Constants::FileType::AUDIO ? 3000LL : 6000LL);
+            writer.field(1600000000LL * 1000000000LL);
+            writer.hexField(0);
+            MediaFile(entry.first, Metadata(INDEXED_TITLE, 0.0), entry.second).write(writer);
+            writer.endRecord();
+        }
+        writeFile(dir + "/" + Constants::LIBRARY_INDEX_FILE, contents);
+
+        CHECK_EQ(scannedTitle(dir, dir + "/song.mp3"), std::string(INDEXED_TITLE));
+        CHECK_EQ(scannedTitle(dir, dir + "/clip.mp4"), std::string("clip.mp4"));
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testCopiedTimes();
+    testVersion1();
+    testVersion2Videos();
+    return TestSupport::result("LibraryIndexTest");
+}
@@ -0,0 +1,150 @@
+#include "TestSupport.h"
+#include "models/Playlist.h"
+#include "models/PlaylistHeader.h"
+#include "models/PlaylistManager.h"
+#include "services/PlaylistFormatService.h"
+#include "utils/RecordWriter.h"
+#include "Constants.h"
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace {
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    MediaFile makeTrack(const std::string& path, const std::string& title, double duration) {
+        Metadata metadata(title, duration);
+        metadata.setAttribute(Constants::MetadataKeys::ARTIST, "Artist of " + title);
+        return MediaFile(path, metadata, Constants::FileType::AUDIO);
+    }
+
+    // Version 1 file: name, count, then each track with its metadata embedded
+    std::string writeLegacyPlaylist(const std::string& dir, const std::string& name, const std::vector<MediaFile>& tracks) {
+        std::string contents = name + "\n" + std::to_string(tracks.size()) + "\n";
+        RecordWriter writer(contents);
+        for (const auto& track : tracks) {
+            track.write(writer);
+            writer.endRecord();
+        }
+        std::string path = dir + "/" + name + Constants::PLAYLIST_EXT;
+        std::ofstream(path, std::ios::binary) << contents;
+        return path;
+    }
+
+    void testCompactRoundTrip() {
+        std::string dir = TestSupport::makeTempDir("playlist-format");
+        std::vector<MediaFile> tracks = {
+            makeTrack("/music/a|b.mp3", "Pipe", 61.0),
+            makeTrack("/music/new\nline.flac", "Newline", 120.5),
+            makeTrack("/music/plain.ogg", "Plain", 30.0)
+        };
+        Playlist playlist("Road Trip | 2024", tracks);
+        playlist.setGeneration(7);
+        CHECK(playlist.save(dir));
+
+        std::string path = playlist.getFilePath(dir);
+        PlaylistHeader header;
+        CHECK(Playlist::readHeader(path, header));
+        CHECK_EQ(header.getName(), playlist.getName());
+        CHECK_EQ(header.getTrackCount(), 3u);
+        CHECK_EQ(static_cast<long long>(header.getTotalDuration()), 211LL);
+
+        // Tracks come back through the resolver by ID and path, in order
+        std::map<uint64_t, MediaFile> library;
+        for (const auto& track : tracks) {
+            library[track.getTrackId()] = track;
+        }
+        size_t resolved = 0;
+        Playlist::TrackResolver resolver = [&](uint64_t trackId, const std::string& filePath) {
+            auto it = library.find(trackId);
+            CHECK(it != library.end() && it->second.getFilePath() == filePath);
+            resolved++;
+            return it != library.end() ? it->second : MediaFile(filePath);
+        };
+        bool legacy = true;
+        Playlist loaded = Playlist::load(path, resolver, &legacy);
+        CHECK(!legacy);
+        CHECK_EQ(resolved, 3u);
+        CHECK_EQ(loaded.getName(), playlist.getName());
+        CHECK_EQ(loaded.getGeneration(), 7u);
+        CHECK_EQ(loaded.getTrackCount(), 3u);
+        for (size_t i = 0; i < tracks.size() && i < loaded.getTrackCount(); ++i) {
+            CHECK_EQ(loaded.getTrack(i).getFilePath(), tracks[i].getFilePath());
+            CHECK_EQ(loaded.getTrack(i).getMetadata().getName(), tracks[i].getMetadata().getName());
+        }
+
+        // Without a resolver the paths still come back
+        Playlist bare = Playlist::load(path);
+        CHECK_EQ(bare.getTrackCount(), 3u);
+        CHECK_EQ(bare.getTrack(1).getFilePath(), tracks[1].getFilePath());
+    }
+
+    void testLegacyLoadKeepsEmbeddedMetadata() {
+        std::string dir = TestSupport::makeTempDir("playlist-legacy");
+        std::vector<MediaFile> tracks = {makeTrack("/elsewhere/one.mp3", "One", 200.0), makeTrack("/elsewhere/two.mp3", "Two", 100.0)};
+        std::string path = writeLegacyPlaylist(dir, "old", tracks);
+
+        PlaylistHeader header;
+        CHECK(!Playlist::readHeader(path, header));
+
+        bool legacy = false;
+        Playlist loaded = Playlist::load(path, nullptr, &legacy);
+        CHECK(legacy);
+        CHECK_EQ(loaded.getName(), std::string("old"));
+        CHECK_EQ(loaded.getTrackCount(), 2u);
+        CHECK_EQ(loaded.getTrack(0).getMetadata().getName(), std::string("One"));
+        CHECK_EQ(loaded.getTrack(0).getMetadata().getAttribute(Constants::MetadataKeys::ARTIST), std::string("Artist of One"));
+        CHECK_EQ(loaded.getTotalDuration(), 300.0);
+    }
+
+    void testManagerLeavesLegacyFilesAlone() {
+        std::string dir = TestSupport::makeTempDir("playlist-migrate");
+        std::vector<MediaFile> tracks = {makeTrack("/not/in/library.mp3", "Kept", 42.0)};
+        std::string path = writeLegacyPlaylist(dir, "old", tracks);
+        std::string before = readFile(path);
+
+        {
+            // Nothing resolves these tracks, so rewriting the file would lose their tags
+            PlaylistManager manager;
+            manager.setTrackResolver([](uint64_t, const std::string& filePath) { return MediaFile(filePath); });
+            manager.loadPlaylists(dir);
+            manager.flush();
+            CHECK_EQ(manager.getPlaylistCount(), 1u);
+            CHECK_EQ(manager.getPlaylist(0).getTotalDuration(), 42.0);
+        }
+        CHECK(readFile(path) == before);
+    }
+
+    void testPlsEntryNumbers() {
+        std::string dir = TestSupport::makeTempDir("playlist-pls");
+        std::string path = dir + "/radio.pls";
+
+        // Numbers need not be dense or in order; a huge one is just another entry
+        std::ofstream(path, std::ios::binary) << "[playlist]\nFile100000000=/music/last.mp3\n"
+                                                 "File2=/music/b.mp3\nTitle2=Bee\nLength2=90\n"
+                                                 "File1=/music/a.mp3\nNumberOfEntries=3\n";
+        PlaylistFormatService service;
+        Playlist playlist;
+        CHECK(service.importPlaylist(path, nullptr, playlist));
+        CHECK_EQ(playlist.getTrackCount(), 3u);
+        if (playlist.getTrackCount() == 3) {
+            CHECK_EQ(playlist.getTrack(0).getFilePath(), std::string("/music/a.mp3"));
+            CHECK_EQ(playlist.getTrack(1).getMetadata().getName(), std::string("Bee"));
+            CHECK_EQ(playlist.getTrack(1).getMetadata().getDuration(), 90.0);
+            CHECK_EQ(playlist.getTrack(2).getFilePath(), std::string("/music/last.mp3"));
+        }
+    }
+}
+
+int main() {
+    testCompactRoundTrip();
+    testLegacyLoadKeepsEmbeddedMetadata();
+    testManagerLeavesLegacyFilesAlone();
+    testPlsEntryNumbers();
+    return TestSupport::result("PlaylistFormatTest");
+}
@@ -0,0 +1,197 @@
+#include "TestSupport.h"
+#include "models/PlaylistJournal.h"
+#include "models/PlaylistManager.h"
+#include "Constants.h"
+#include <fstream>
+
+namespace {
+    std::vector<std::string> paths(const Playlist& playlist) {
+        std::vector<std::string> result;
+        for (const auto& track : playlist.getTracks()) {
+            result.push_back(track.getFilePath());
+        }
+        return result;
+    }
+
+    std::string join(const std::vector<std::string>& items) {
+        std::string text;
+        for (const auto& item : items) {
+            text += (text.empty() ? "" : ",") + item;
+        }
+        return text;
+    }
+
+    PlaylistJournal::Edit makeEdit(PlaylistJournal::Edit::Type type, size_t position) {
+        PlaylistJournal::Edit edit;
+        edit.type = type;
+        edit.position = position;
+        return edit;
+    }
+
+    void testLogReplayRoundTrip() {
+        std::string dir = TestSupport::makeTempDir("journal");
+        Playlist original("mix", {MediaFile("/a.mp3"), MediaFile("/b.mp3"), MediaFile("/c.mp3"), MediaFile("/d.mp3")});
+        CHECK(original.save(dir));
+        std::string path = original.getFilePath(dir);
+
+        // Apply edits to a live copy and log them the way PlaylistManager does
+        Playlist live = original;
+        PlaylistJournal journal;
+        PlaylistJournal::Edit insert = makeEdit(PlaylistJournal::Edit::Type::INSERT, 1);
+        insert.track = MediaFile("/e|pipe.mp3");
+        PlaylistJournal::Edit remove = makeEdit(PlaylistJournal::Edit::Type::REMOVE, 3);
+        remove.track = MediaFile("/c.mp3");
+        PlaylistJournal::Edit move = makeEdit(PlaylistJournal::Edit::Type::MOVE, 0);
+        move.count = 2;
+        move.toIndex = 2;
+        for (const auto& edit : {insert, remove, move}) {
+            PlaylistJournal::apply(live, edit);
+            journal.record(edit);
+            journal.log(PlaylistJournal::Kind::EDIT, live.getGeneration(), edit);
+        }
+        const PlaylistJournal::Edit* undone = journal.undo();
+        CHECK(undone != nullptr);
+        PlaylistJournal::Edit inverse = PlaylistJournal::inverse(*undone);
+        PlaylistJournal::apply(live, inverse);
+        journal.log(PlaylistJournal::Kind::UNDO, live.getGeneration(), inverse);
+        CHECK_EQ(journal.getLoggedCount(), 4u);
+
+        std::string journalPath = PlaylistJournal::getJournalPath(path);
+        std::ofstream(journalPath, std::ios::binary) << journal.takeUnsaved();
+
+        Playlist replayed = Playlist::load(path);
+        PlaylistJournal rebuilt;
+        CHECK_EQ(PlaylistJournal::replay(journalPath, replayed, nullptr, rebuilt), 4u);
+        CHECK_EQ(join(paths(replayed)), join(paths(live)));
+        CHECK(rebuilt.canUndo());
+        CHECK(rebuilt.canRedo());
+
+        // A torn final append (crash mid-write) is ignored
+        std::ofstream(journalPath, std::ios::binary | std::ios::app) << "E|I|0|00000000000000";
+        Playlist torn = Playlist::load(path);
+        PlaylistJournal tornJournal;
+        CHECK_EQ(PlaylistJournal::replay(journalPath, torn, nullptr, tornJournal), 4u);
+        CHECK_EQ(join(paths(torn)), join(paths(live)));
+    }
+
+    void testManagerReplaysAndFoldsJournal() {
+        std::string dir = TestSupport::makeTempDir("journal-manager");
+        std::string journalPath;
+        {
+            PlaylistManager manager;
+            manager.loadPlaylists(dir);
+            manager.addPlaylist(Playlist("mix", {MediaFile("/a.mp3"), MediaFile("/b.mp3"), MediaFile("/c.mp3")}));
+            manager.savePlaylists();
+            manager.flush();
+            journalPath = PlaylistJournal::getJournalPath(manager.getPlaylistHeaders()[0].getFilePath());
+
+            CHECK(manager.removeTrack(0, 1));
+            CHECK(manager.addTrack(0, MediaFile("/d.mp3")));
+            CHECK(manager.undo(0));
+            manager.savePlaylists();
+            manager.flush();
+            CHECK(std::filesystem::exists(journalPath));
+        }
+
+        PlaylistManager reloaded;
+        reloaded.loadPlaylists(dir);
+        CHECK_EQ(join(paths(reloaded.getPlaylist(0))), std::string("/a.mp3,/c.mp3"));
+        CHECK(reloaded.canRedo(0));
+        reloaded.flush();
+        CHECK(!std::filesystem::exists(journalPath));
+    }
+
+    void testStaleRecordsSkipped() {
+        std::string dir = TestSupport::makeTempDir("journal-generations");
+        Playlist original("gen", {MediaFile("/a.mp3"), MediaFile("/b.mp3")});
+        original.setGeneration(3);
+        CHECK(original.save(dir));
+        std::string path = original.getFilePath(dir);
+        std::string journalPath = PlaylistJournal::getJournalPath(path);
+
+        // Generation 2 is already in the file, 4 was logged on top of a save that never landed
+        PlaylistJournal journal;
+        PlaylistJournal::Edit insert = makeEdit(PlaylistJournal::Edit::Type::INSERT, 0);
+        insert.track = MediaFile("/old.mp3");
+        journal.log(PlaylistJournal::Kind::EDIT, 2, insert);
+        insert.track = MediaFile("/current.mp3");
+        journal.log(PlaylistJournal::Kind::EDIT, 3, insert);
+        insert.track = MediaFile("/unsaved.mp3");
+        journal.log(PlaylistJournal::Kind::EDIT, 4, insert);
+        std::ofstream(journalPath, std::ios::binary) << journal.takeUnsaved();
+
+        Playlist replayed = Playlist::load(path);
+        PlaylistJournal rebuilt;
+        CHECK_EQ(PlaylistJournal::replay(journalPath, replayed, nullptr, rebuilt), 1u);
+        CHECK_EQ(join(paths(replayed)), std::string("/current.mp3,/a.mp3,/b.mp3"));
+
+        // Records from before generations existed belong to a version 2 file
+        std::ofstream(path, std::ios::binary) << "#MBPLAYLIST 2\ngen\n2\n0\n0|/a.mp3\n0|/b.mp3\n";
+        std::ofstream(journalPath, std::ios::binary) << "E|D|0|0|/a.mp3\n";
+        Playlist legacy = Playlist::load(path);
+        CHECK_EQ(legacy.getGeneration(), 0u);
+        PlaylistJournal legacyJournal;
+        CHECK_EQ(PlaylistJournal::replay(journalPath, legacy, nullptr, legacyJournal), 1u);
+        CHECK_EQ(join(paths(legacy)), std::string("/b.mp3"));
+    }
+
+    void testFailedSaveRetried() {
+        std::string dir = TestSupport::makeTempDir("journal-failed-save");
+        PlaylistManager manager;
+        manager.loadPlaylists(dir);
+        manager.addPlaylist(Playlist("mix", {MediaFile("/a.mp3"), MediaFile("/b.mp3")}));
+        manager.flush();
+        std::string path = Playlist("mix").getFilePath(dir);
+        std::string journalPath = PlaylistJournal::getJournalPath(path);
+
+        // The rewrite fails (its temp path is taken); later edits are not logged against the old file
+        std::filesystem::create_directories(path + ".tmp");
+        CHECK(manager.clearPlaylist(0));
+        CHECK(manager.addTrack(0, MediaFile("/c.mp3")));
+        manager.flush();
+        CHECK(manager.addTrack(0, MediaFile("/d.mp3")));
+        manager.flush();
+        CHECK(!std::filesystem::exists(journalPath));
+        CHECK_EQ(join(paths(Playlist::load(path))), std::string("/a.mp3,/b.mp3"));
+
+        // Still dirty: the next save writes everything
+        std::filesystem::remove_all(path + ".tmp");
+        manager.flush();
+        CHECK(!std::filesystem::exists(journalPath));
+        PlaylistManager reloaded;
+        reloaded.loadPlaylists(dir);
+        CHECK_EQ(join(paths(reloaded.getPlaylist(0))), std::string("/c.mp3,/d.mp3"));
+    }
+
+    void testRenameKeepsOldFileUntilSaved() {
+        std::string dir = TestSupport::makeTempDir("journal-rename");
+        PlaylistManager manager;
+        manager.loadPlaylists(dir);
+        manager.addPlaylist(Playlist("first", {MediaFile("/a.mp3")}));
+        manager.flush();
+
+        // Renamed twice before the writer runs: only the last name is written, both old files go
+        CHECK(manager.renamePlaylist(0, "second"));
+        CHECK(manager.renamePlaylist(0, "third"));
+        manager.flush();
+        CHECK(!std::filesystem::exists(Playlist("first").getFilePath(dir)));
+        CHECK(!std::filesystem::exists(Playlist("second").getFilePath(dir)));
+        CHECK(std::filesystem::exists(Playlist("third").getFilePath(dir)));
+
+        // The new file can't be written (its temp path is taken), so the old one stays
+        std::filesystem::create_directories(Playlist("fourth").getFilePath(dir) + ".tmp");
+        CHECK(manager.renamePlaylist(0, "fourth"));
+        manager.flush();
+        CHECK(std::filesystem::exists(Playlist("third").getFilePath(dir)));
+        CHECK(!std::filesystem::exists(Playlist("fourth").getFilePath(dir)));
+    }
+}
+
+int main() {
+    testLogReplayRoundTrip();
+    testManagerReplaysAndFoldsJournal();
+    testStaleRecordsSkipped();
+    testFailedSaveRetried();
+    testRenameKeepsOldFileUntilSaved();
+    return TestSupport::result("PlaylistJournalTest");
+}
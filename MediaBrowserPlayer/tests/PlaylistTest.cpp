@@ -0,0 +1,61 @@
+#include "TestSupport.h"
+#include "models/Playlist.h"
+#include <vector>
+
+namespace {
+    std::vector<std::string> paths(const Playlist::TrackList& tracks) {
+        std::vector<std::string> result;
+        for (const auto& track : tracks) {
+            result.push_back(track.getFilePath());
+        }
+        return result;
+    }
+
+    Playlist makePlaylist(size_t count) {
+        Playlist playlist("order");
+        for (size_t i = 0; i < count; ++i) {
+            playlist.addTrack(MediaFile("/music/" + std::to_string(i) + ".mp3"));
+        }
+        return playlist;
+    }
+
+    void testViewAfterEdits() {
+        Playlist playlist = makePlaylist(5);
+        playlist.moveTrack(0, 4);
+        playlist.removeTrack(1);
+        playlist.insertTrack(0, MediaFile("/music/new.mp3"));
+
+        const std::vector<std::string> expected = {"/music/new.mp3", "/music/1.mp3", "/music/3.mp3", "/music/4.mp3", "/music/0.mp3"};
+        Playlist::TrackList tracks = playlist.getTracks();
+        CHECK_EQ(tracks.size(), expected.size());
+        CHECK(paths(tracks) == expected);
+        CHECK_EQ(tracks[2].getFilePath(), playlist.getTrack(2).getFilePath());
+        CHECK_EQ(tracks.back().getFilePath(), std::string("/music/0.mp3"));
+
+        // Reading never reorders: a copy taken afterwards has the same order, and so
+        // does the playlist once compacted
+        Playlist copy = playlist;
+        CHECK(paths(copy.getTracks()) == expected);
+        playlist.compact();
+        CHECK(paths(playlist.getTracks()) == expected);
+        CHECK_EQ(playlist.getTracks().toVector().size(), expected.size());
+    }
+
+    void testManyRemovals() {
+        // Emptied slots are reclaimed along the way; order and count stay right
+        Playlist playlist = makePlaylist(1000);
+        for (size_t i = 0; i < 900; ++i) {
+            playlist.removeTrack(0);
+        }
+        Playlist::TrackList tracks = playlist.getTracks();
+        CHECK_EQ(tracks.size(), 100u);
+        CHECK_EQ(tracks[0].getFilePath(), std::string("/music/900.mp3"));
+        CHECK_EQ(tracks.back().getFilePath(), std::string("/music/999.mp3"));
+    }
+}
+
+int main() {
+    testViewAfterEdits();
+    testManyRemovals();
+    return TestSupport::result("PlaylistTest");
+}
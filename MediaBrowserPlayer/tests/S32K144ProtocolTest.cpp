@@ -0,0 +1,141 @@
+#include "TestSupport.h"
+#include "utils/S32K144Protocol.h"
+#include "utils/ByteRingBuffer.h"
+#include <cstring>
+
+namespace {
+    using Protocol = S32K144Protocol;
+
+    void feed(ByteRingBuffer& buffer, const std::vector<uint8_t>& bytes) {
+        buffer.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    void feed(ByteRingBuffer& buffer, const char* text) {
+        buffer.write(text, std::strlen(text));
+    }
+
+    void testCrcReferenceVector() {
+        const char* check = "123456789";
+        CHECK_EQ(Protocol::crc16(reinterpret_cast<const uint8_t*>(check), 9), 0x29B1);
+    }
+
+    void testFrameRoundTrip() {
+        Protocol protocol;
+        ByteRingBuffer buffer(256);
+        std::deque<Protocol::BoardEvent> events;
+
+        uint8_t button = 'P';
+        int8_t delta = -3;
+        uint8_t volume = 77;
+        feed(buffer, Protocol::encodeFrame(Protocol::FrameType::BUTTON, &button, 1));
+        feed(buffer, Protocol::encodeFrame(Protocol::FrameType::ENCODER, reinterpret_cast<uint8_t*>(&delta), 1));
+        feed(buffer, Protocol::encodeFrame(Protocol::FrameType::VOLUME, &volume, 1));
+        protocol.decode(buffer, events);
+
+        CHECK_EQ(events.size(), 3u);
+        if (events.size() == 3) {
+            CHECK(events[0].type == Protocol::FrameType::BUTTON);
+            CHECK_EQ(events[0].value, 'P');
+            CHECK(events[1].type == Protocol::FrameType::ENCODER);
+            CHECK_EQ(events[1].value, -3);
+            CHECK(events[2].type == Protocol::FrameType::VOLUME);
+            CHECK_EQ(events[2].value, 77);
+        }
+        CHECK(buffer.isEmpty());
+        CHECK_EQ(protocol.getErrorCount(), 0u);
+    }
+
+    void testFrameSplitAcrossReads() {
+        Protocol protocol;
+        ByteRingBuffer buffer(256);
+        std::deque<Protocol::BoardEvent> events;
+
+        uint8_t button = 'N';
+        std::vector<uint8_t> frame = Protocol::encodeFrame(Protocol::FrameType::BUTTON, &button, 1);
+        feed(buffer, std::vector<uint8_t>(frame.begin(), frame.begin() + 3));
+        protocol.decode(buffer, events);
+        CHECK(events.empty());
+
+        feed(buffer, std::vector<uint8_t>(frame.begin() + 3, frame.end()));
+        protocol.decode(buffer, events);
+        CHECK_EQ(events.size(), 1u);
+    }
+
+    void testCorruptFrameIsDroppedAndStreamResyncs() {
+        Protocol protocol;
+        ByteRingBuffer buffer(256);
+        std::deque<Protocol::BoardEvent> events;
+
+        uint8_t button = 'T';
+        std::vector<uint8_t> bad = Protocol::encodeFrame(Protocol::FrameType::BUTTON, &button, 1);
+        bad.back() ^= 0xFF;
+        feed(buffer, bad);
+        feed(buffer, Protocol::encodeFrame(Protocol::FrameType::BUTTON, &button, 1));
+        protocol.decode(buffer, events);
+
+        CHECK_EQ(events.size(), 1u);
+        CHECK(protocol.getErrorCount() >= 1u);
+    }
+
+    void testLegacyText() {
+        Protocol protocol;
+        ByteRingBuffer buffer(256);
+        std::deque<Protocol::BoardEvent> events;
+
+        feed(buffer, "S.42.");
+        protocol.decode(buffer, events);
+        CHECK_EQ(events.size(), 2u);
+        if (events.size() == 2) {
+            CHECK(events[0].type == Protocol::FrameType::BUTTON);
+            CHECK_EQ(events[0].value, 'S');
+            CHECK(events[1].type == Protocol::FrameType::VOLUME);
+            CHECK_EQ(events[1].value, 42);
+        }
+    }
+
+    void testNowPlayingLayout() {
+        Protocol::NowPlaying state{1, 55, 0x0102, 0x0304, "Song"};
+        std::vector<uint8_t> frame = Protocol::encodeNowPlaying(state);
+
+        CHECK_EQ(frame.size(), Protocol::HEADER_SIZE + 6 + 4 + Protocol::CRC_SIZE);
+        CHECK_EQ(frame[0], Protocol::SYNC);
+        CHECK_EQ(frame[2], static_cast<uint8_t>(Protocol::FrameType::NOW_PLAYING));
+        CHECK_EQ(frame[3], 10);
+        const uint8_t* payload = frame.data() + Protocol::HEADER_SIZE;
+        CHECK_EQ(payload[0], 1);
+        CHECK_EQ(payload[1], 55);
+        CHECK_EQ(payload[2], 0x01);
+        CHECK_EQ(payload[3], 0x02);
+        CHECK_EQ(payload[4], 0x03);
+        CHECK_EQ(payload[5], 0x04);
+        CHECK(std::memcmp(payload + 6, "Song", 4) == 0);
+
+        uint16_t crc = Protocol::crc16(frame.data() + 1, frame.size() - 1 - Protocol::CRC_SIZE);
+        CHECK_EQ(frame[frame.size() - 2], crc >> 8);
+        CHECK_EQ(frame[frame.size() - 1], crc & 0xFF);
+    }
+
+    void testNowPlayingTitleCutOnCharacterBoundary() {
+        // 1 + 24 * 2 = 49 bytes: a byte cut at MAX_TITLE (48) would split the last "é"
+        Protocol::NowPlaying state{0, 0, 0, 0, "a"};
+        for (int i = 0; i < 24; ++i) {
+            state.title += "\xC3\xA9";
+        }
+        std::vector<uint8_t> frame = Protocol::encodeNowPlaying(state);
+        size_t titleLength = frame[3] - 6;
+        CHECK_EQ(titleLength, 47u);
+        CHECK(std::string(frame.begin() + Protocol::HEADER_SIZE + 6, frame.begin() + Protocol::HEADER_SIZE + 6 + titleLength) ==
+              state.title.substr(0, 47));
+    }
+}
+
+int main() {
+    testCrcReferenceVector();
+    testFrameRoundTrip();
+    testFrameSplitAcrossReads();
+    testCorruptFrameIsDroppedAndStreamResyncs();
+    testLegacyText();
+    testNowPlayingLayout();
+    testNowPlayingTitleCutOnCharacterBoundary();
+    return TestSupport::result("S32K144ProtocolTest");
+}
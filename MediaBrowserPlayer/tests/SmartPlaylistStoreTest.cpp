@@ -0,0 +1,41 @@
+#include "TestSupport.h"
+#include "models/PlaylistManager.h"
+#include "Constants.h"
+
+namespace {
+    void testSmartPlaylistsSurviveReload() {
+        std::string dir = TestSupport::makeTempDir("smart-playlists");
+        std::string error;
+        {
+            PlaylistManager manager;
+            manager.loadPlaylists(dir);
+            CHECK(manager.addSmartPlaylist("Recent rap", "genre = rap AND year >= 2015 SORT BY artist LIMIT 100", error));
+            CHECK(manager.addSmartPlaylist("Pipes | and ~ things", "title ~ \"a|b\" OR duration < 300", error));
+            CHECK(!manager.addSmartPlaylist("Broken", "year >=", error));
+            CHECK(!error.empty());
+        }
+        CHECK(std::filesystem::exists(dir + "/" + Constants::SMART_PLAYLISTS_FILE));
+        CHECK(!std::filesystem::exists(dir + "/" + Constants::SMART_PLAYLISTS_FILE + ".tmp"));
+
+        PlaylistManager reloaded;
+        reloaded.loadPlaylists(dir);
+        const std::vector<SmartPlaylist>& smart = reloaded.getSmartPlaylists();
+        CHECK_EQ(smart.size(), 2u);
+        if (smart.size() == 2) {
+            CHECK_EQ(smart[0].getName(), std::string("Recent rap"));
+            CHECK_EQ(smart[0].getQuery().getText(), std::string("genre = rap AND year >= 2015 SORT BY artist LIMIT 100"));
+            CHECK_EQ(smart[1].getName(), std::string("Pipes | and ~ things"));
+            CHECK_EQ(smart[1].getQuery().getText(), std::string("title ~ \"a|b\" OR duration < 300"));
+        }
+
+        CHECK(reloaded.deleteSmartPlaylist(0));
+        PlaylistManager afterDelete;
+        afterDelete.loadPlaylists(dir);
+        CHECK_EQ(afterDelete.getSmartPlaylists().size(), 1u);
+    }
+}
+
+int main() {
+    testSmartPlaylistsSurviveReload();
+    return TestSupport::result("SmartPlaylistStoreTest");
+}
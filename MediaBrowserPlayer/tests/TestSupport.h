@@ -0,0 +1,56 @@
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <iostream>
+#include <string>
+#include <filesystem>
+#include <unistd.h>
+
+// Minimal checks for the programs in tests/ (one per *Test.cpp, run by "make test").
+// A failed CHECK prints where it failed and is counted; main() returns
+// TestSupport::result(), so the exit status is 0 only if every check passed.
+namespace TestSupport {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& message) {
+        std::cerr << file << ":" << line << ": FAILED " << message << std::endl;
+        failures()++;
+    }
+
+    // Print a summary line and return the exit status
+    inline int result(const char* testName) {
+        std::cout << testName << ": " << (failures() == 0 ? "ok" : std::to_string(failures()) + " failed") << std::endl;
+        return failures() == 0 ? 0 : 1;
+    }
+
+    // Fresh, empty scratch directory under the system temp directory
+    inline std::string makeTempDir(const std::string& name) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() /
+                                    ("mbp-" + name + "-" + std::to_string(getpid()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir.string();
+    }
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            TestSupport::fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto actualValue_ = (actual); \
+        auto expectedValue_ = (expected); \
+        if (!(actualValue_ == expectedValue_)) { \
+            std::cerr << "    got " << actualValue_ << ", expected " << expectedValue_ << std::endl; \
+            TestSupport::fail(__FILE__, __LINE__, #actual " == " #expected); \
+        } \
+    } while (0)
+
+#endif // TESTSUPPORT_H
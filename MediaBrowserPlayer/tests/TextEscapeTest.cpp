@@ -0,0 +1,27 @@
+#include "TestSupport.h"
+#include "utils/TextEscape.h"
+
+namespace {
+    void testField() {
+        CHECK_EQ(TextEscape::field("plain"), std::string("plain"));
+        CHECK_EQ(TextEscape::field("a\tb\nc\\d\r"), std::string("a\\tb\\nc\\\\d"));
+        CHECK_EQ(TextEscape::field("\"quoted\""), std::string("\"quoted\""));
+    }
+
+    void testJson() {
+        CHECK_EQ(TextEscape::json("say \"hi\"\\"), std::string("say \\\"hi\\\"\\\\"));
+        CHECK_EQ(TextEscape::json("a\tb\nc\r"), std::string("a\\tb\\nc\\r"));
+        CHECK_EQ(TextEscape::json(std::string("\x01\x1f", 2)), std::string("\\u0001\\u001f"));
+        CHECK_EQ(TextEscape::json("caf\xc3\xa9"), std::string("caf\xc3\xa9"));
+
+        std::string out = "{\"name\":\"";
+        TextEscape::appendJson(out, "x\"y");
+        CHECK_EQ(out, std::string("{\"name\":\"x\\\"y"));
+    }
+}
+
+int main() {
+    testField();
+    testJson();
+    return TestSupport::result("TextEscapeTest");
+}
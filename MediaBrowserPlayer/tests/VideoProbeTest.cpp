@@ -0,0 +1,260 @@
+#include "TestSupport.h"
+#include "utils/VideoProbe.h"
+#include "utils/Metrics.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+// The samples are built the way the containers lay them out: only the headers
+// carry information, the media data is zeros
+namespace {
+    const size_t MEDIA_BYTES = 1000000;
+
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    std::string bigEndian(unsigned long long value, int bytes) {
+        std::string out;
+        for (int i = bytes - 1; i >= 0; --i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return out;
+    }
+
+    std::string littleEndian(unsigned long long value, int bytes) {
+        std::string out;
+        for (int i = 0; i < bytes; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return out;
+    }
+
+    // Header bytes the probe read for filePath
+    unsigned long long probedBytes(const std::string& filePath, VideoInfo& info, bool& ok) {
+        Metrics::Counter& counter = Metrics::counter("mbp_video_probe_bytes_total", "Header bytes read to probe video containers");
+        uint64_t before = counter.getValue();
+        ok = VideoProbe::probe(filePath, info);
+        return counter.getValue() - before;
+    }
+
+    // ISO-BMFF: size, type, body; full boxes add version and flags
+    std::string box(const char* type, const std::string& body) {
+        return bigEndian(8 + body.size(), 4) + type + body;
+    }
+
+    std::string fullBox(const char* type, const std::string& body) {
+        return box(type, std::string(4, '\0') + body);
+    }
+
+    std::string makeTrak(const char* handler, const char* format, unsigned timescale, unsigned duration,
+                         unsigned sampleCount, bool visual) {
+        std::string tkhd = fullBox("tkhd", std::string(72, '\0') + bigEndian(1920u << 16, 4) + bigEndian(1080u << 16, 4));
+        std::string mdhd = fullBox("mdhd", bigEndian(0, 8) + bigEndian(timescale, 4) + bigEndian(duration, 4) + std::string(4, '\0'));
+        std::string hdlr = fullBox("hdlr", std::string(4, '\0') + handler + std::string(12, '\0') + std::string("x\0", 2));
+        std::string entry = std::string(6, '\0') + std::string("\0\1", 2);
+        if (visual) {
+            entry += std::string(16, '\0') + bigEndian(1920, 2) + bigEndian(1080, 2) + std::string(50, '\0');
+        } else {
+            entry += std::string(20, '\0');
+        }
+        std::string stsd = fullBox("stsd", bigEndian(1, 4) + box(format, entry));
+        std::string stsz = fullBox("stsz", bigEndian(0, 4) + bigEndian(sampleCount, 4) + std::string(4 * sampleCount, '\0'));
+        std::string minf = box("minf", box("stbl", stsd + stsz));
+        return box("trak", tkhd + box("mdia", mdhd + hdlr + minf));
+    }
+
+    // 120.5 s of H.264 (2889 frames at a 24000 timescale) and AAC
+    std::string makeMp4(bool faststart, const char* brand) {
+        std::string ftyp = box("ftyp", std::string(brand) + std::string(4, '\0') + brand);
+        std::string mvhd = fullBox("mvhd", bigEndian(0, 8) + bigEndian(1000, 4) + bigEndian(120500, 4) + std::string(80, '\0'));
+        std::string moov = box("moov", mvhd + makeTrak("vide", "avc1", 24000, 2892000, 2889, true) +
+                                       makeTrak("soun", "mp4a", 48000, 5784000, 5648, false));
+        std::string mdat = box("mdat", std::string(MEDIA_BYTES, '\0'));
+        return ftyp + (faststart ? moov + mdat : mdat + moov);
+    }
+
+    // EBML: element ID as written, then the size as a variable-length integer
+    std::string ebmlSize(unsigned long long size) {
+        for (int length = 1; length <= 8; ++length) {
+            unsigned long long limit = (1ULL << (7 * length)) - 1;
+            if (size < limit) {
+                return bigEndian((1ULL << (7 * length)) | size, length);
+            }
+        }
+        return std::string();
+    }
+
+    std::string element(unsigned id, const std::string& body) {
+        int idBytes = id > 0xFFFFFF ? 4 : id > 0xFFFF ? 3 : id > 0xFF ? 2 : 1;
+        return bigEndian(id, idBytes) + ebmlSize(body.size()) + body;
+    }
+
+    std::string uintElement(unsigned id, unsigned long long value) {
+        int bytes = 1;
+        while (bytes < 8 && (value >> (8 * bytes)) != 0) {
+            ++bytes;
+        }
+        return element(id, bigEndian(value, bytes));
+    }
+
+    std::string seekHead(unsigned long long infoPosition, unsigned long long tracksPosition) {
+        return element(0x114D9B74,
+                       element(0x4DBB, element(0x53AB, bigEndian(0x1549A966, 4)) + uintElement(0x53AC, infoPosition)) +
+                       element(0x4DBB, element(0x53AB, bigEndian(0x1654AE6B, 4)) + uintElement(0x53AC, tracksPosition)));
+    }
+
+    // 95.25 s of VP9 at 1280x720, 23.976 fps, and Opus. With infoLast, Info and
+    // Tracks follow the cluster and only the SeekHead points at them
+    std::string makeMatroska(const std::string& docType, bool infoLast) {
+        std::string header = element(0x1A45DFA3, element(0x4286, "\1") + element(0x4282, docType));
+        double durationMs = 95250.0;
+        uint64_t durationBits = 0;
+        std::memcpy(&durationBits, &durationMs, sizeof(durationBits));
+        std::string info = element(0x1549A966, uintElement(0x2AD7B1, 1000000) + element(0x4489, bigEndian(durationBits, 8)));
+        std::string video = element(0xAE, uintElement(0xD7, 1) + uintElement(0x83, 1) + element(0x86, "V_VP9") +
+                                          uintElement(0x23E383, 41708333) +
+                                          element(0xE0, uintElement(0xB0, 1280) + uintElement(0xBA, 720)));
+        std::string audio = element(0xAE, uintElement(0xD7, 2) + uintElement(0x83, 2) + element(0x86, "A_OPUS"));
+        std::string tracks = element(0x1654AE6B, video + audio);
+        std::string cluster = element(0x1F43B675, std::string(MEDIA_BYTES, '\0'));
+
+        std::string body = info + tracks + cluster;
+        if (infoLast) {
+            // Positions are relative to the segment data and depend on the SeekHead's own size
+            std::string head = seekHead(0, 0);
+            for (int round = 0; round < 4; ++round) {
+                unsigned long long base = head.size() + cluster.size();
+                head = seekHead(base, base + info.size());
+            }
+            body = head + cluster + info + tracks;
+        }
+        std::string segment = bigEndian(0x18538067, 4) + "\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF" + body; // Unknown size
+        return header + segment;
+    }
+
+    // RIFF: id, little-endian size, body padded to even length
+    std::string chunk(const char* id, const std::string& body) {
+        return std::string(id) + littleEndian(body.size(), 4) + body + (body.size() % 2 ? std::string(1, '\0') : "");
+    }
+
+    std::string list(const char* type, const std::string& body) {
+        return chunk("LIST", type + body);
+    }
+
+    std::string streamHeader(const char* type, const char* handler, unsigned rate, unsigned length) {
+        std::string body = std::string(type) + std::string(handler, 4);
+        body += littleEndian(0, 4) + littleEndian(0, 2) + littleEndian(0, 2) + littleEndian(0, 4);
+        body += littleEndian(1, 4) + littleEndian(rate, 4) + littleEndian(0, 4) + littleEndian(length, 4);
+        body += littleEndian(0, 4) + littleEndian(0, 4) + littleEndian(0, 4) + std::string(8, '\0');
+        return chunk("strh", body);
+    }
+
+    // 60 s of XviD at 640x480, 25 fps (1500 frames), and MP3
+    std::string makeAvi() {
+        std::string avih;
+        for (unsigned value : {40000u, 0u, 0u, 0u, 1500u, 0u, 2u, 0u, 640u, 480u}) {
+            avih += littleEndian(value, 4);
+        }
+        std::string videoFormat = littleEndian(40, 4) + littleEndian(640, 4) + littleEndian(480, 4) +
+                                  littleEndian(1, 2) + littleEndian(24, 2) + "XVID" + std::string(20, '\0');
+        std::string audioFormat = littleEndian(0x55, 2) + littleEndian(2, 2) + littleEndian(44100, 4) +
+                                  littleEndian(16000, 4) + littleEndian(1, 2) + littleEndian(0, 2);
+        std::string hdrl = list("hdrl", chunk("avih", avih + std::string(16, '\0')) +
+                                        list("strl", streamHeader("vids", "XVID", 25, 1500) + chunk("strf", videoFormat)) +
+                                        list("strl", streamHeader("auds", "\0\0\0\0", 44100, 2646000) + chunk("strf", audioFormat)));
+        std::string body = "AVI " + hdrl + list("movi", std::string(MEDIA_BYTES, '\0'));
+        return "RIFF" + littleEndian(body.size(), 4) + body;
+    }
+
+    void checkMp4(const std::string& path, const std::string& container) {
+        VideoInfo info;
+        bool ok = false;
+        unsigned long long bytes = probedBytes(path, info, ok);
+        CHECK(ok);
+        CHECK_EQ(info.container, container);
+        CHECK_EQ(info.videoCodec, std::string("H.264"));
+        CHECK_EQ(info.audioCodec, std::string("AAC"));
+        CHECK(std::fabs(info.duration - 120.5) < 1e-9);
+        CHECK_EQ(info.width, 1920);
+        CHECK_EQ(info.height, 1080);
+        CHECK(std::fabs(info.frameRate - 2889 / 120.5) < 1e-3);
+        CHECK(info.bitrate > 0);
+
+        // Only the boxes are read; mdat is skipped with a seek
+        CHECK(bytes < 4096);
+    }
+
+    void testMp4() {
+        std::string dir = TestSupport::makeTempDir("video-probe-mp4");
+        writeFile(dir + "/fast.mp4", makeMp4(true, "isom"));
+        writeFile(dir + "/slow.mp4", makeMp4(false, "isom"));
+        writeFile(dir + "/clip.mov", makeMp4(true, "qt  "));
+        checkMp4(dir + "/fast.mp4", "MP4");
+        checkMp4(dir + "/slow.mp4", "MP4");
+        checkMp4(dir + "/clip.mov", "QuickTime");
+    }
+
+    void testMatroska() {
+        std::string dir = TestSupport::makeTempDir("video-probe-mkv");
+        writeFile(dir + "/seekhead.mkv", makeMatroska("matroska", true));
+        writeFile(dir + "/plain.webm", makeMatroska("webm", false));
+
+        const std::pair<const char*, const char*> samples[] = {{"/seekhead.mkv", "Matroska"}, {"/plain.webm", "WebM"}};
+        for (const auto& sample : samples) {
+            VideoInfo info;
+            bool ok = false;
+            unsigned long long bytes = probedBytes(dir + sample.first, info, ok);
+            CHECK(ok);
+            CHECK_EQ(info.container, std::string(sample.second));
+            CHECK_EQ(info.videoCodec, std::string("VP9"));
+            CHECK_EQ(info.audioCodec, std::string("Opus"));
+            CHECK(std::fabs(info.duration - 95.25) < 1e-9);
+            CHECK_EQ(info.width, 1280);
+            CHECK_EQ(info.height, 720);
+            CHECK(std::fabs(info.frameRate - 23.976) < 1e-3);
+            CHECK(info.bitrate > 0);
+            CHECK(bytes < 4096);
+        }
+    }
+
+    void testAvi() {
+        std::string dir = TestSupport::makeTempDir("video-probe-avi");
+        writeFile(dir + "/clip.avi", makeAvi());
+        VideoInfo info;
+        bool ok = false;
+        unsigned long long bytes = probedBytes(dir + "/clip.avi", info, ok);
+        CHECK(ok);
+        CHECK_EQ(info.container, std::string("AVI"));
+        CHECK_EQ(info.videoCodec, std::string("MPEG-4 Visual"));
+        CHECK_EQ(info.audioCodec, std::string("MP3"));
+        CHECK(std::fabs(info.duration - 60.0) < 1e-9);
+        CHECK_EQ(info.width, 640);
+        CHECK_EQ(info.height, 480);
+        CHECK(std::fabs(info.frameRate - 25.0) < 1e-9);
+        CHECK(info.bitrate > 0);
+        CHECK(bytes < 4096);
+    }
+
+    void testUnrecognised() {
+        std::string dir = TestSupport::makeTempDir("video-probe-bad");
+        writeFile(dir + "/noise.mp4", std::string(5000, 'n'));
+        std::string mp4 = makeMp4(true, "isom");
+        writeFile(dir + "/cut.mp4", mp4.substr(0, 300));
+
+        VideoInfo info;
+        CHECK(!VideoProbe::probe(dir + "/noise.mp4", info));
+        CHECK(!VideoProbe::probe(dir + "/missing.mkv", info));
+
+        // A moov box that runs past the end of the file is rejected, not read short
+        CHECK(!VideoProbe::probe(dir + "/cut.mp4", info));
+    }
+}
+
+int main() {
+    testMp4();
+    testMatroska();
+    testAvi();
+    testUnrecognised();
+    return TestSupport::result("VideoProbeTest");
+}
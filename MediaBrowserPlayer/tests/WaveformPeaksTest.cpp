@@ -0,0 +1,117 @@
+#include "TestSupport.h"
+#include "models/WaveformPeaks.h"
+#include "Constants.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void writeFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    // Rising sine: quiet at the start, full scale at the end, with a length that leaves a partial bin
+    std::vector<float> makeSamples(size_t count) {
+        std::vector<float> samples(count);
+        for (size_t i = 0; i < count; ++i) {
+            float level = static_cast<float>(i) / static_cast<float>(count);
+            samples[i] = level * static_cast<float>(std::sin(2.0 * M_PI * 440.0 * static_cast<double>(i) / 44100.0));
+        }
+        return samples;
+    }
+
+    void testCompute() {
+        std::vector<float> samples = makeSamples(44100 * 3 + 17);
+        WaveformPeaks peaks = WaveformPeaks::compute(samples.data(), samples.size(), 44100);
+        CHECK(std::fabs(peaks.getDuration() - samples.size() / 44100.0) < 1e-9);
+
+        const auto& levels = peaks.getLevels();
+        CHECK_EQ(levels.size(), Constants::WAVEFORM_LEVELS);
+        size_t bins = (samples.size() + Constants::WAVEFORM_BASE_BIN - 1) / Constants::WAVEFORM_BASE_BIN;
+        uint32_t samplesPerBin = static_cast<uint32_t>(Constants::WAVEFORM_BASE_BIN);
+        for (const auto& level : levels) {
+            CHECK_EQ(level.samplesPerBin, samplesPerBin);
+            CHECK_EQ(level.minimum.size(), bins);
+            CHECK_EQ(level.maximum.size(), bins);
+            bins = (bins + Constants::WAVEFORM_LEVEL_FACTOR - 1) / Constants::WAVEFORM_LEVEL_FACTOR;
+            samplesPerBin *= static_cast<uint32_t>(Constants::WAVEFORM_LEVEL_FACTOR);
+        }
+
+        // The envelope rises with the signal and ends near full scale
+        std::vector<float> envelope = peaks.getEnvelope(10);
+        CHECK_EQ(envelope.size(), 10u);
+        CHECK(envelope[0] < 0.15f);
+        CHECK(envelope[9] > 0.9f);
+        for (size_t column = 1; column < envelope.size(); ++column) {
+            CHECK(envelope[column] + 0.02f >= envelope[column - 1]);
+        }
+    }
+
+    void testRoundTrip() {
+        std::string dir = TestSupport::makeTempDir("waveform-peaks");
+        std::string path = dir + "/track.peaks";
+        std::vector<float> samples = makeSamples(48000 * 2 + 5);
+        WaveformPeaks peaks = WaveformPeaks::compute(samples.data(), samples.size(), 48000);
+        CHECK(peaks.save(path));
+
+        WaveformPeaks loaded;
+        CHECK(WaveformPeaks::load(path, loaded));
+        CHECK_EQ(loaded.getDuration(), peaks.getDuration());
+        CHECK_EQ(loaded.getLevels().size(), peaks.getLevels().size());
+        for (size_t i = 0; i < peaks.getLevels().size() && i < loaded.getLevels().size(); ++i) {
+            CHECK_EQ(loaded.getLevels()[i].samplesPerBin, peaks.getLevels()[i].samplesPerBin);
+            CHECK(loaded.getLevels()[i].minimum == peaks.getLevels()[i].minimum);
+            CHECK(loaded.getLevels()[i].maximum == peaks.getLevels()[i].maximum);
+        }
+        CHECK(loaded.getEnvelope(80) == peaks.getEnvelope(80));
+
+        // Header as documented: magic, version 1, level count, two zero bytes, rate, count
+        std::string contents = readFile(path);
+        CHECK_EQ(contents.substr(0, 4), std::string("MBPW"));
+        CHECK_EQ(static_cast<int>(contents[4]), 1);
+        CHECK_EQ(static_cast<size_t>(contents[5]), Constants::WAVEFORM_LEVELS);
+        CHECK_EQ(static_cast<unsigned char>(contents[8]) | (static_cast<unsigned char>(contents[9]) << 8), 48000);
+        CHECK(!std::ifstream(path + ".tmp").is_open());
+    }
+
+    void testMalformedFiles() {
+        std::string dir = TestSupport::makeTempDir("waveform-peaks-bad");
+        std::string path = dir + "/track.peaks";
+        std::vector<float> samples = makeSamples(20000);
+        CHECK(WaveformPeaks::compute(samples.data(), samples.size(), 44100).save(path));
+        std::string contents = readFile(path);
+
+        WaveformPeaks loaded;
+        CHECK(!WaveformPeaks::load(dir + "/missing.peaks", loaded));
+
+        // Every truncation fails, however much of the file is left
+        for (size_t length : {size_t(0), size_t(3), size_t(11), size_t(20), contents.size() / 2, contents.size() - 1}) {
+            writeFile(path, contents.substr(0, length));
+            CHECK(!WaveformPeaks::load(path, loaded));
+        }
+
+        std::string wrong = contents;
+        wrong[0] = 'X';
+        writeFile(path, wrong);
+        CHECK(!WaveformPeaks::load(path, loaded));
+        wrong = contents;
+        wrong[4] = 2;
+        writeFile(path, wrong);
+        CHECK(!WaveformPeaks::load(path, loaded));
+    }
+}
+
+int main() {
+    testCompute();
+    testRoundTrip();
+    testMalformedFiles();
+    return TestSupport::result("WaveformPeaksTest");
+}
@@ -0,0 +1,282 @@
+// Library benchmark suite: writes a synthetic corpus (see SyntheticCorpus.h) and
+// times library scanning, search, lookups, playlist I/O and metadata
+// serialization on it. Results are printed as JSON so runs can be compared
+// across releases.
+//
+//   make bench && ./bin/LibraryBench [options] > results.json
+//
+//   --files N          corpus size (default 2000)
+//   --formats LIST     comma-separated subset of mp3,flac,ogg,wav (default: all)
+//   --seed N           corpus seed; same seed, same corpus (default 1)
+//   --runs N           timed runs per benchmark (default 5)
+//   --corpus DIR       write the corpus to DIR and keep it (default: a temporary directory)
+//   --generate-only    write the corpus and exit
+//   --label TEXT       stored as "label" in the JSON, e.g. a release tag
+//   --output FILE      write the JSON to FILE instead of stdout
+//
+// MediaController::MediaFileExists is a thin wrapper over MediaLibrary::findIndexByPath,
+// which is what "library.findIndexByPath" measures.
+
+#include "SyntheticCorpus.h"
+#include "../include/models/MediaLibrary.h"
+#include "../include/models/Playlist.h"
+#include "../include/models/Metadata.h"
+#include "../include/utils/TextEscape.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    struct Result {
+        std::string name;
+        size_t items;           // Work items per run (files, queries, lookups...)
+        std::vector<double> ms; // Wall time of each run
+    };
+
+    // Keeps the optimizer from dropping work whose result is otherwise unused
+    volatile size_t sink = 0;
+
+    Result measure(const std::string& name, int runs, size_t items, const std::function<size_t()>& body) {
+        Result result{name, items, {}};
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            sink = sink + body();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            result.ms.push_back(elapsed.count());
+        }
+        std::cerr << name << ": " << *std::min_element(result.ms.begin(), result.ms.end()) << " ms" << std::endl;
+        return result;
+    }
+
+    std::string jsonString(const std::string& text) {
+        return "\"" + TextEscape::json(text) + "\"";
+    }
+
+    std::string jsonNumber(double value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.4f", value);
+        return text;
+    }
+
+    std::string toJson(const std::vector<Result>& results, const std::string& label, const SyntheticCorpus::Options& options,
+                       int runs, size_t corpusBytes) {
+        char timestamp[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        std::ostringstream out;
+        out << "{\n";
+        out << "  \"suite\": \"library\",\n";
+        out << "  \"schema\": 1,\n";
+        out << "  \"label\": " << jsonString(label) << ",\n";
+        out << "  \"timestamp\": " << jsonString(timestamp) << ",\n";
+        out << "  \"compiler\": " << jsonString(__VERSION__) << ",\n";
+        out << "  \"corpus\": {\"files\": " << options.fileCount << ", \"seed\": " << options.seed
+            << ", \"bytes\": " << corpusBytes << ", \"formats\": [";
+        for (size_t i = 0; i < options.formats.size(); ++i) {
+            out << (i ? ", " : "") << jsonString(SyntheticCorpus::getExtension(options.formats[i]));
+        }
+        out << "]},\n";
+        out << "  \"runs\": " << runs << ",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::vector<double> sorted = results[i].ms;
+            std::sort(sorted.begin(), sorted.end());
+            double best = sorted.front();
+            double median = sorted[sorted.size() / 2];
+            double mean = 0.0;
+            for (double ms : sorted) {
+                mean += ms;
+            }
+            mean /= sorted.size();
+
+            out << "    {\"name\": " << jsonString(results[i].name)
+                << ", \"items\": " << results[i].items
+                << ", \"best_ms\": " << jsonNumber(best)
+                << ", \"median_ms\": " << jsonNumber(median)
+                << ", \"mean_ms\": " << jsonNumber(mean)
+                << ", \"items_per_second\": " << jsonNumber(best > 0.0 ? results[i].items / (best / 1000.0) : 0.0)
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+        return out.str();
+    }
+
+    bool parseFormats(const std::string& list, std::vector<SyntheticCorpus::Format>& formats) {
+        formats.clear();
+        std::stringstream in(list);
+        std::string name;
+        while (std::getline(in, name, ',')) {
+            SyntheticCorpus::Format format;
+            if (!SyntheticCorpus::parseFormat(name, format)) {
+                return false;
+            }
+            formats.push_back(format);
+        }
+        return !formats.empty();
+    }
+
+    // Lowercase title words, used as search queries
+    std::vector<std::string> makeQueries(const std::vector<SyntheticCorpus::File>& files, size_t count) {
+        std::vector<std::string> queries;
+        for (size_t i = 0; i < files.size() && queries.size() < count; i += std::max<size_t>(1, files.size() / count)) {
+            std::string word = files[i].tags.title.substr(0, files[i].tags.title.find(' '));
+            std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+            queries.push_back(word.substr(0, 4));
+        }
+        queries.push_back("no such title");
+        return queries;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticCorpus::Options options;
+    options.fileCount = 2000;
+    int runs = 5;
+    std::string corpusDir;
+    std::string label;
+    std::string outputPath;
+    bool generateOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--files" && hasValue) options.fileCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--runs" && hasValue) runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--corpus" && hasValue) corpusDir = argv[++i];
+        else if (arg == "--label" && hasValue) label = argv[++i];
+        else if (arg == "--output" && hasValue) outputPath = argv[++i];
+        else if (arg == "--generate-only") generateOnly = true;
+        else if (arg == "--formats" && hasValue) {
+            if (!parseFormats(argv[++i], options.formats)) {
+                std::cerr << "Unknown format in " << argv[i] << " (use mp3,flac,ogg,wav)" << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << " (see tools/LibraryBench.cpp)" << std::endl;
+            return 2;
+        }
+    }
+
+    bool temporary = corpusDir.empty();
+    if (temporary) {
+        corpusDir = "/tmp/mbp-library-bench-" + std::to_string(getpid());
+    }
+    std::string workDir = corpusDir + ".work";
+    std::filesystem::create_directories(corpusDir);
+    std::filesystem::create_directories(workDir);
+
+    std::vector<Result> results;
+
+    // ---- Corpus ----
+    std::vector<SyntheticCorpus::File> files;
+    results.push_back(measure("corpus.generate", 1, options.fileCount, [&] {
+        files = SyntheticCorpus::generate(corpusDir, options);
+        return files.size();
+    }));
+    size_t corpusBytes = 0;
+    for (const auto& file : files) {
+        corpusBytes += std::filesystem::file_size(file.path);
+    }
+    if (generateOnly) {
+        std::cerr << "Wrote " << files.size() << " files (" << corpusBytes << " bytes) to " << corpusDir << std::endl;
+        std::filesystem::remove_all(workDir);
+        return 0;
+    }
+
+    // ---- Library ----
+    // A new library has to tag every file; a rescan only re-tags files that changed
+    results.push_back(measure("library.scanDirectory", runs, files.size(), [&] {
+        MediaLibrary fresh;
+        fresh.scanDirectory(corpusDir);
+        return fresh.getMediaFileCount();
+    }));
+    MediaLibrary library;
+    library.scanDirectory(corpusDir);
+    results.push_back(measure("library.rescanDirectory", runs, files.size(), [&] {
+        library.clear();
+        library.scanDirectory(corpusDir);
+        return library.getMediaFileCount();
+    }));
+    if (library.getMediaFileCount() != files.size()) {
+        std::cerr << "Warning: scan found " << library.getMediaFileCount() << " of " << files.size() << " files" << std::endl;
+    }
+
+    std::vector<std::string> queries = makeQueries(files, 100);
+    results.push_back(measure("library.searchMediaFiles", runs, queries.size(), [&] {
+        size_t matches = 0;
+        for (const auto& query : queries) {
+            matches += library.searchMediaFiles(query).size();
+        }
+        return matches;
+    }));
+
+    // Every path once, plus as many misses
+    results.push_back(measure("library.findIndexByPath", runs, files.size() * 2, [&] {
+        size_t found = 0;
+        for (const auto& file : files) {
+            found += library.findIndexByPath(file.path) >= 0;
+            found += library.findIndexByPath(file.path + ".missing") >= 0;
+        }
+        return found;
+    }));
+
+    // ---- Playlist I/O ----
+    Playlist playlist("bench", library.getRoot().getTracks().toVector());
+    std::string playlistPath = playlist.getFilePath(workDir);
+    results.push_back(measure("playlist.save", runs, playlist.getTrackCount(), [&] {
+        return static_cast<size_t>(playlist.save(workDir));
+    }));
+
+    Playlist::TrackResolver resolver = [&library](uint64_t trackId, const std::string& filePath) {
+        return library.resolveTrack(trackId, filePath);
+    };
+    results.push_back(measure("playlist.load", runs, playlist.getTrackCount(), [&] {
+        return Playlist::load(playlistPath, resolver).getTrackCount();
+    }));
+
+    // ---- Metadata serialization ----
+    std::vector<std::string> serialized(library.getMediaFileCount());
+    Playlist::TrackList tracks = library.getRoot().getTracks();
+    results.push_back(measure("metadata.toString", runs, tracks.size(), [&] {
+        size_t bytes = 0;
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            serialized[i] = tracks[i].getMetadata().toString();
+            bytes += serialized[i].size();
+        }
+        return bytes;
+    }));
+    results.push_back(measure("metadata.fromString", runs, serialized.size(), [&] {
+        size_t attributes = 0;
+        for (const auto& text : serialized) {
+            attributes += Metadata::fromString(text).getAllAttributes().size();
+        }
+        return attributes;
+    }));
+
+    std::string json = toJson(results, label, options, runs, corpusBytes);
+    if (outputPath.empty()) {
+        std::cout << json;
+    } else if (!(std::ofstream(outputPath) << json)) {
+        std::cerr << "Could not write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::filesystem::remove_all(workDir);
+    if (temporary) {
+        std::filesystem::remove_all(corpusDir);
+    }
+    return 0;
+}
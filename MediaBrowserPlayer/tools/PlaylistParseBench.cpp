@@ -0,0 +1,148 @@
+// Playlist parsing benchmark: the old stringstream-based record parser versus
+// the mmap + RecordReader path used by Playlist::load.
+//
+//   make bench && ./bin/PlaylistParseBench [lines] [runs]
+//
+// Writes a legacy (metadata-embedding) playlist of <lines> tracks to /tmp,
+// parses it <runs> times with each parser and prints the best time.
+
+#include "../include/models/Playlist.h"
+#include "../include/utils/RecordWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    // ---- The parser Playlist::load used before RecordReader, kept verbatim for comparison ----
+
+    Metadata oldMetadataFromString(const std::string& serialized) {
+        std::stringstream ss(serialized);
+        std::string name;
+        double duration;
+        int attrCount;
+
+        std::getline(ss, name, '|');
+        ss >> duration;
+        ss.ignore();
+        ss >> attrCount;
+        ss.ignore();
+
+        Metadata metadata(name, duration);
+        for (int i = 0; i < attrCount; ++i) {
+            std::string key, value;
+            std::getline(ss, key, '|');
+            std::getline(ss, value, '|');
+            metadata.setAttribute(key, value);
+        }
+        return metadata;
+    }
+
+    MediaFile oldMediaFileFromString(const std::string& serialized) {
+        std::stringstream ss(serialized);
+        std::string path, metadataStr;
+        int typeInt;
+
+        std::getline(ss, path, '|');
+        ss >> typeInt;
+        ss.ignore();
+        std::getline(ss, metadataStr);
+
+        return MediaFile(path, oldMetadataFromString(metadataStr), static_cast<Constants::FileType>(typeInt));
+    }
+
+    Playlist oldLoad(const std::string& filePath) {
+        std::ifstream file(filePath);
+        std::string name;
+        std::getline(file, name);
+
+        Playlist playlist(name);
+        size_t trackCount;
+        file >> trackCount;
+        file.ignore();
+
+        for (size_t i = 0; i < trackCount; ++i) {
+            std::string trackStr;
+            std::getline(file, trackStr);
+            playlist.addTrack(oldMediaFileFromString(trackStr));
+        }
+        return playlist;
+    }
+
+    // ---- Corpus ----
+
+    void writeLegacyPlaylist(const std::string& filePath, size_t lines) {
+        std::string contents = "bench\n" + std::to_string(lines) + "\n";
+        RecordWriter writer(contents);
+        for (size_t i = 0; i < lines; ++i) {
+            Metadata metadata("Track " + std::to_string(i) + " - Some Reasonably Long Song Title", 120.0 + i % 300);
+            metadata.setAttribute("album", "Album " + std::to_string(i / 12));
+            metadata.setAttribute("artist", "Artist " + std::to_string(i / 120));
+            metadata.setAttribute("bitrate", "320");
+            metadata.setAttribute("genre", "Rock");
+            metadata.setAttribute("track_number", std::to_string(i % 12 + 1));
+            metadata.setAttribute("year", std::to_string(1970 + i % 50));
+            MediaFile file("/media/music/Artist " + std::to_string(i / 120) + "/Album " +
+                           std::to_string(i / 12) + "/" + std::to_string(i) + ".mp3",
+                           metadata, Constants::FileType::AUDIO);
+            file.write(writer);
+            writer.endRecord();
+        }
+        std::ofstream(filePath, std::ios::binary) << contents;
+    }
+
+    // Best wall time of several runs, in seconds
+    double bestOf(int runs, const std::function<size_t()>& body, size_t& tracks) {
+        double best = 1e30;
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            tracks = body();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    void report(const char* label, double seconds, size_t tracks, size_t bytes) {
+        printf("%-28s %8.1f ms  %10.0f lines/s  %7.1f MB/s  (%zu tracks)\n", label, seconds * 1000.0,
+               tracks / seconds, bytes / seconds / (1024.0 * 1024.0), tracks);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::string dir = "/tmp/mbp-bench-" + std::to_string(getpid());
+    std::string legacyPath = dir + "/bench" + Constants::PLAYLIST_EXT;
+    std::string currentDir = dir + "/v2";
+    std::filesystem::create_directories(currentDir);
+
+    writeLegacyPlaylist(legacyPath, lines);
+    size_t legacyBytes = std::filesystem::file_size(legacyPath);
+
+    size_t tracks = 0;
+    double oldTime = bestOf(runs, [&] { return oldLoad(legacyPath).getTrackCount(); }, tracks);
+    report("legacy, stringstream", oldTime, tracks, legacyBytes);
+
+    double newTime = bestOf(runs, [&] { return Playlist::load(legacyPath).getTrackCount(); }, tracks);
+    report("legacy, mmap + RecordReader", newTime, tracks, legacyBytes);
+
+    // Same tracks in the current ID|path format
+    Playlist::load(legacyPath).save(currentDir);
+    std::string currentPath = currentDir + "/bench" + Constants::PLAYLIST_EXT;
+    size_t currentBytes = std::filesystem::file_size(currentPath);
+    double currentTime = bestOf(runs, [&] { return Playlist::load(currentPath).getTrackCount(); }, tracks);
+    report("v2, mmap + RecordReader", currentTime, tracks, currentBytes);
+
+    printf("speedup (legacy records): %.2fx\n", oldTime / newTime);
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
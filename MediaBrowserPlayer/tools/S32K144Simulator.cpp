@@ -0,0 +1,116 @@
+// Pseudo-terminal stand-in for the S32K144 board.
+//
+// Prints the slave pty path; point the player at it with
+//   S32K144_PORT=<path> S32K144_BAUD=921600 ./bin/MediaBrowserPlayer
+// then type commands on stdin:
+//   p | n | t | s       button press (binary frame)
+//   v <0-100>           absolute volume (binary frame)
+//   e <-128..127>       encoder delta (binary frame)
+//   x <text>            legacy text message, '.' is appended
+//   burst <count>       <count> encoder +1/-1 frames back to back
+//   corrupt             a frame with a broken CRC followed by a valid 'T'
+//   q                   quit
+
+#include "../include/utils/S32K144Protocol.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+    bool writeAll(int fd, const std::vector<uint8_t>& bytes) {
+        size_t written = 0;
+        while (written < bytes.size()) {
+            ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+            if (n < 0) {
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> frame(S32K144Protocol::FrameType type, uint8_t value) {
+        return S32K144Protocol::encodeFrame(type, &value, 1);
+    }
+}
+
+int main() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::cerr << "Can't create pseudo-terminal" << std::endl;
+        return 1;
+    }
+
+    // Raw mode on the master side too, so frame bytes pass through untouched
+    termios tty;
+    if (tcgetattr(master, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(master, TCSANOW, &tty);
+    }
+
+    std::cout << ptsname(master) << std::endl;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        std::vector<uint8_t> out;
+        if (command == "p" || command == "n" || command == "t" || command == "s") {
+            out = frame(S32K144Protocol::FrameType::BUTTON, static_cast<uint8_t>(toupper(command[0])));
+        }
+        else if (command == "v") {
+            int volume = 0;
+            in >> volume;
+            out = frame(S32K144Protocol::FrameType::VOLUME, static_cast<uint8_t>(volume));
+        }
+        else if (command == "e") {
+            int delta = 0;
+            in >> delta;
+            out = frame(S32K144Protocol::FrameType::ENCODER, static_cast<uint8_t>(static_cast<int8_t>(delta)));
+        }
+        else if (command == "x") {
+            std::string text;
+            std::getline(in >> std::ws, text);
+            text += S32K144Protocol::TEXT_END;
+            out.assign(text.begin(), text.end());
+        }
+        else if (command == "burst") {
+            int count = 0;
+            in >> count;
+            for (int i = 0; i < count; ++i) {
+                std::vector<uint8_t> f = frame(S32K144Protocol::FrameType::ENCODER,
+                                               static_cast<uint8_t>(static_cast<int8_t>(i % 2 ? -1 : 1)));
+                out.insert(out.end(), f.begin(), f.end());
+            }
+        }
+        else if (command == "corrupt") {
+            out = frame(S32K144Protocol::FrameType::VOLUME, 50);
+            out.back() ^= 0xFF;
+            std::vector<uint8_t> valid = frame(S32K144Protocol::FrameType::BUTTON, 'T');
+            out.insert(out.end(), valid.begin(), valid.end());
+        }
+        else if (command == "q") {
+            break;
+        }
+        else if (!command.empty()) {
+            std::cerr << "Unknown command: " << command << std::endl;
+            continue;
+        }
+
+        if (!out.empty() && !writeAll(master, out)) {
+            std::cerr << "Write failed: " << strerror(errno) << std::endl;
+        }
+    }
+
+    close(master);
+    return 0;
+}
@@ -0,0 +1,428 @@
+#include "SyntheticCorpus.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace {
+    const char* const WORDS[] = {
+        "Midnight", "Electric", "Silver", "Broken", "Golden", "Velvet", "Hollow", "Crimson",
+        "River", "Shadow", "Summer", "Echo", "Static", "Paper", "Neon", "Winter",
+        "Heart", "Signal", "Garden", "Machine", "Ocean", "Highway", "Mirror", "Thunder",
+        "Dream", "Fire", "Glass", "Stone", "Light", "Rain", "Ghost", "City"
+    };
+    const char* const GENRES[] = {
+        "Rock", "Pop", "Jazz", "Electronic", "Hip-Hop", "Classical", "Folk", "Metal", "Blues", "Ambient"
+    };
+
+    // MP3: MPEG-1 Layer III, 128 kbps, 44.1 kHz, stereo, no padding
+    constexpr unsigned char MPEG_HEADER[] = {0xFF, 0xFB, 0x90, 0x00};
+    constexpr size_t MPEG_FRAME_BYTES = 417;
+    constexpr double MPEG_FRAMES_PER_SECOND = 44100.0 / 1152.0;
+
+    // FLAC (native and in Ogg) and WAV: 8 kHz mono 16-bit keeps silent files small
+    constexpr uint32_t PCM_SAMPLE_RATE = 8000;
+    constexpr uint32_t FLAC_BLOCK_SIZE = 4096;
+
+    // ---- Byte helpers ----
+
+    void putBE(std::string& out, uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void putLE(std::string& out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    uint8_t crc8(const std::string& data) {
+        uint8_t crc = 0;
+        for (unsigned char byte : data) {
+            crc ^= byte;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    uint16_t crc16(const std::string& data) {
+        uint16_t crc = 0;
+        for (unsigned char byte : data) {
+            crc ^= static_cast<uint16_t>(byte << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    uint32_t oggCrc(const std::string& data) {
+        static uint32_t table[256];
+        static bool ready = false;
+        if (!ready) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t r = i << 24;
+                for (int bit = 0; bit < 8; ++bit) {
+                    r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+                }
+                table[i] = r;
+            }
+            ready = true;
+        }
+
+        uint32_t crc = 0;
+        for (unsigned char byte : data) {
+            crc = (crc << 8) ^ table[((crc >> 24) & 0xFF) ^ byte];
+        }
+        return crc;
+    }
+
+    bool writeBytes(const std::string& path, const std::string& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) && file.flush();
+    }
+
+    // ---- MP3 ----
+
+    void putId3Frame(std::string& out, const char* id, const std::string& text) {
+        out.append(id, 4);
+        putBE(out, text.size() + 1, 4);
+        putBE(out, 0, 2);       // Flags
+        out += '\0';            // ISO-8859-1
+        out += text;
+    }
+
+    std::string makeMp3(const SyntheticCorpus::Tags& tags, double seconds) {
+        std::string frames;
+        putId3Frame(frames, "TIT2", tags.title);
+        putId3Frame(frames, "TPE1", tags.artist);
+        putId3Frame(frames, "TALB", tags.album);
+        putId3Frame(frames, "TYER", std::to_string(tags.year));
+        putId3Frame(frames, "TCON", tags.genre);
+        putId3Frame(frames, "TRCK", std::to_string(tags.track));
+
+        // ID3v2.3 header; the tag size is stored 7 bits per byte
+        std::string out = "ID3";
+        out += '\x03';
+        out += '\x00';
+        out += '\x00';
+        size_t size = frames.size();
+        for (int shift = 21; shift >= 0; shift -= 7) {
+            out += static_cast<char>((size >> shift) & 0x7F);
+        }
+        out += frames;
+
+        // Silent frames: all-zero side info and main data decode to silence
+        size_t frameCount = static_cast<size_t>(std::ceil(seconds * MPEG_FRAMES_PER_SECOND));
+        std::string frame(MPEG_FRAME_BYTES, '\0');
+        frame.replace(0, sizeof(MPEG_HEADER), reinterpret_cast<const char*>(MPEG_HEADER), sizeof(MPEG_HEADER));
+        out.reserve(out.size() + frameCount * frame.size());
+        for (size_t i = 0; i < frameCount; ++i) {
+            out += frame;
+        }
+        return out;
+    }
+
+    // ---- FLAC ----
+
+    size_t flacFrameCount(double seconds) {
+        return std::max<size_t>(1, static_cast<size_t>(std::ceil(seconds * PCM_SAMPLE_RATE / FLAC_BLOCK_SIZE)));
+    }
+
+    void putMetadataBlockHeader(std::string& out, bool last, int type, size_t length) {
+        out += static_cast<char>((last ? 0x80 : 0x00) | type);
+        putBE(out, length, 3);
+    }
+
+    std::string makeStreamInfo(size_t frameCount) {
+        std::string info;
+        putBE(info, FLAC_BLOCK_SIZE, 2);    // Min block size
+        putBE(info, FLAC_BLOCK_SIZE, 2);    // Max block size
+        putBE(info, 0, 3);                  // Min frame size (unknown)
+        putBE(info, 0, 3);                  // Max frame size (unknown)
+        uint64_t totalSamples = static_cast<uint64_t>(frameCount) * FLAC_BLOCK_SIZE;
+        uint64_t packed = (static_cast<uint64_t>(PCM_SAMPLE_RATE) << 44) | (0ull << 41) | (15ull << 36) | totalSamples;
+        putBE(info, packed, 8);             // Sample rate, channels - 1, bits - 1, total samples
+        info.append(16, '\0');              // MD5 of the audio (not computed)
+        return info;
+    }
+
+    std::string makeVorbisComment(const SyntheticCorpus::Tags& tags) {
+        const std::string vendor = "SyntheticCorpus";
+        const std::string comments[] = {
+            "TITLE=" + tags.title, "ARTIST=" + tags.artist, "ALBUM=" + tags.album,
+            "GENRE=" + tags.genre, "DATE=" + std::to_string(tags.year), "TRACKNUMBER=" + std::to_string(tags.track)
+        };
+
+        std::string block;
+        putLE(block, vendor.size(), 4);
+        block += vendor;
+        putLE(block, sizeof(comments) / sizeof(comments[0]), 4);
+        for (const auto& comment : comments) {
+            putLE(block, comment.size(), 4);
+            block += comment;
+        }
+        return block;
+    }
+
+    // One frame of silence: fixed block size, 8 kHz, mono, 16-bit, a single CONSTANT subframe
+    std::string makeFlacFrame(uint64_t frameNumber) {
+        std::string frame = "\xFF\xF8";
+        frame += '\xC4';    // Block size 4096, sample rate 8 kHz
+        frame += '\x08';    // Mono, 16 bits per sample
+
+        // Frame number, UTF-8 style
+        if (frameNumber < 0x80) {
+            frame += static_cast<char>(frameNumber);
+        } else if (frameNumber < 0x800) {
+            frame += static_cast<char>(0xC0 | (frameNumber >> 6));
+            frame += static_cast<char>(0x80 | (frameNumber & 0x3F));
+        } else {
+            frame += static_cast<char>(0xE0 | (frameNumber >> 12));
+            frame += static_cast<char>(0x80 | ((frameNumber >> 6) & 0x3F));
+            frame += static_cast<char>(0x80 | (frameNumber & 0x3F));
+        }
+        frame += static_cast<char>(crc8(frame));
+
+        frame += '\x00';    // CONSTANT subframe, no wasted bits
+        putBE(frame, 0, 2); // The constant sample value
+        putBE(frame, crc16(frame), 2);
+        return frame;
+    }
+
+    std::string makeFlac(const SyntheticCorpus::Tags& tags, double seconds) {
+        size_t frameCount = flacFrameCount(seconds);
+        std::string streamInfo = makeStreamInfo(frameCount);
+        std::string comment = makeVorbisComment(tags);
+
+        std::string out = "fLaC";
+        putMetadataBlockHeader(out, false, 0, streamInfo.size());
+        out += streamInfo;
+        putMetadataBlockHeader(out, true, 4, comment.size());
+        out += comment;
+        for (size_t i = 0; i < frameCount; ++i) {
+            out += makeFlacFrame(i);
+        }
+        return out;
+    }
+
+    // ---- Ogg (FLAC mapping) ----
+
+    void putOggPage(std::string& out, const std::vector<std::string>& packets, int headerType,
+                    uint64_t granule, uint32_t sequence) {
+        std::string segments;
+        std::string body;
+        for (const auto& packet : packets) {
+            size_t left = packet.size();
+            while (left >= 255) {
+                segments += '\xFF';
+                left -= 255;
+            }
+            segments += static_cast<char>(left);
+            body += packet;
+        }
+
+        std::string page = "OggS";
+        page += '\0';                           // Version
+        page += static_cast<char>(headerType);
+        putLE(page, granule, 8);
+        putLE(page, 0x4D425053, 4);             // Stream serial number
+        putLE(page, sequence, 4);
+        putLE(page, 0, 4);                      // CRC, filled in below
+        page += static_cast<char>(segments.size());
+        page += segments;
+        page += body;
+
+        uint32_t crc = oggCrc(page);
+        for (int i = 0; i < 4; ++i) {
+            page[22 + i] = static_cast<char>((crc >> (8 * i)) & 0xFF);
+        }
+        out += page;
+    }
+
+    std::string makeOgg(const SyntheticCorpus::Tags& tags, double seconds) {
+        size_t frameCount = flacFrameCount(seconds);
+        std::string streamInfo = makeStreamInfo(frameCount);
+        std::string comment = makeVorbisComment(tags);
+
+        // First packet: mapping header, native signature and STREAMINFO
+        std::string first = "\x7F" "FLAC";
+        first += '\x01';        // Mapping version 1.0
+        first += '\x00';
+        putBE(first, 1, 2);     // One more header packet follows
+        first += "fLaC";
+        putMetadataBlockHeader(first, false, 0, streamInfo.size());
+        first += streamInfo;
+
+        std::string second;
+        putMetadataBlockHeader(second, true, 4, comment.size());
+        second += comment;
+
+        std::string out;
+        uint32_t sequence = 0;
+        putOggPage(out, {first}, 0x02, 0, sequence++);
+        putOggPage(out, {second}, 0x00, 0, sequence++);
+
+        // Audio: up to 64 frames per page, granule = samples up to the end of the page
+        constexpr size_t FRAMES_PER_PAGE = 64;
+        for (size_t start = 0; start < frameCount; start += FRAMES_PER_PAGE) {
+            size_t end = std::min(frameCount, start + FRAMES_PER_PAGE);
+            std::vector<std::string> packets;
+            for (size_t i = start; i < end; ++i) {
+                packets.push_back(makeFlacFrame(i));
+            }
+            putOggPage(out, packets, end == frameCount ? 0x04 : 0x00,
+                       static_cast<uint64_t>(end) * FLAC_BLOCK_SIZE, sequence++);
+        }
+        return out;
+    }
+
+    // ---- WAV ----
+
+    void putInfoChunk(std::string& out, const char* id, const std::string& text) {
+        std::string value = text + '\0';
+        out.append(id, 4);
+        putLE(out, value.size(), 4);
+        out += value;
+        if (value.size() % 2) {
+            out += '\0';
+        }
+    }
+
+    std::string makeWav(const SyntheticCorpus::Tags& tags, double seconds) {
+        std::string format;
+        putLE(format, 1, 2);                    // PCM
+        putLE(format, 1, 2);                    // Mono
+        putLE(format, PCM_SAMPLE_RATE, 4);
+        putLE(format, PCM_SAMPLE_RATE * 2, 4);  // Byte rate
+        putLE(format, 2, 2);                    // Block align
+        putLE(format, 16, 2);                   // Bits per sample
+
+        std::string info = "INFO";
+        putInfoChunk(info, "INAM", tags.title);
+        putInfoChunk(info, "IART", tags.artist);
+        putInfoChunk(info, "IPRD", tags.album);
+        putInfoChunk(info, "IGNR", tags.genre);
+        putInfoChunk(info, "ICRD", std::to_string(tags.year));
+        putInfoChunk(info, "IPRT", std::to_string(tags.track));
+
+        size_t dataBytes = static_cast<size_t>(seconds * PCM_SAMPLE_RATE) * 2;
+
+        std::string body = "WAVE";
+        body += "fmt ";
+        putLE(body, format.size(), 4);
+        body += format;
+        body += "LIST";
+        putLE(body, info.size(), 4);
+        body += info;
+        body += "data";
+        putLE(body, dataBytes, 4);
+        body.append(dataBytes, '\0');
+
+        std::string out = "RIFF";
+        putLE(out, body.size(), 4);
+        out += body;
+        return out;
+    }
+
+    // ---- Names ----
+
+    std::string pickWords(std::mt19937_64& rng, int count) {
+        std::uniform_int_distribution<size_t> word(0, sizeof(WORDS) / sizeof(WORDS[0]) - 1);
+        std::string text;
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) {
+                text += ' ';
+            }
+            text += WORDS[word(rng)];
+        }
+        return text;
+    }
+}
+
+namespace SyntheticCorpus {
+    bool writeFile(const std::string& path, Format format, const Tags& tags, double seconds) {
+        switch (format) {
+            case Format::MP3: return writeBytes(path, makeMp3(tags, seconds));
+            case Format::FLAC: return writeBytes(path, makeFlac(tags, seconds));
+            case Format::OGG: return writeBytes(path, makeOgg(tags, seconds));
+            case Format::WAV: return writeBytes(path, makeWav(tags, seconds));
+        }
+        return false;
+    }
+
+    std::vector<File> generate(const std::string& root, const Options& options) {
+        std::mt19937_64 rng(options.seed);
+        std::uniform_real_distribution<double> length(options.minSeconds, std::max(options.minSeconds, options.maxSeconds));
+        std::uniform_int_distribution<int> year(1960, 2024);
+        std::uniform_int_distribution<size_t> genre(0, sizeof(GENRES) / sizeof(GENRES[0]) - 1);
+        std::uniform_int_distribution<size_t> format(0, options.formats.empty() ? 0 : options.formats.size() - 1);
+        std::uniform_int_distribution<int> titleWords(1, 4);
+
+        std::vector<File> files;
+        if (options.formats.empty()) {
+            return files;
+        }
+        files.reserve(options.fileCount);
+
+        size_t tracksPerAlbum = std::max<size_t>(1, options.tracksPerAlbum);
+        size_t tracksPerArtist = tracksPerAlbum * std::max<size_t>(1, options.albumsPerArtist);
+
+        Tags album;
+        std::string albumDir;
+        for (size_t i = 0; i < options.fileCount; ++i) {
+            // New artist / album every so many tracks; the index keeps directory names unique
+            if (i % tracksPerArtist == 0) {
+                album.artist = pickWords(rng, 2);
+            }
+            if (i % tracksPerAlbum == 0) {
+                album.album = pickWords(rng, 1) + " of " + pickWords(rng, 1);
+                album.genre = GENRES[genre(rng)];
+                album.year = year(rng);
+                albumDir = root + "/" + album.artist + " " + std::to_string(i / tracksPerArtist) + "/" +
+                           album.album + " " + std::to_string(i / tracksPerAlbum);
+                std::filesystem::create_directories(albumDir);
+            }
+
+            File file;
+            file.tags = album;
+            file.tags.track = static_cast<int>(i % tracksPerAlbum) + 1;
+            file.tags.title = pickWords(rng, titleWords(rng));
+            Format fileFormat = options.formats[format(rng)];
+
+            char number[16];
+            snprintf(number, sizeof(number), "%02d", file.tags.track);
+            file.path = albumDir + "/" + number + " - " + file.tags.title + "." + getExtension(fileFormat);
+
+            if (writeFile(file.path, fileFormat, file.tags, length(rng))) {
+                files.push_back(file);
+            }
+        }
+        return files;
+    }
+
+    bool parseFormat(const std::string& name, Format& format) {
+        if (name == "mp3") format = Format::MP3;
+        else if (name == "flac") format = Format::FLAC;
+        else if (name == "ogg") format = Format::OGG;
+        else if (name == "wav") format = Format::WAV;
+        else return false;
+        return true;
+    }
+
+    const char* getExtension(Format format) {
+        switch (format) {
+            case Format::MP3: return "mp3";
+            case Format::FLAC: return "flac";
+            case Format::OGG: return "ogg";
+            case Format::WAV: return "wav";
+        }
+        return "";
+    }
+}
@@ -0,0 +1,59 @@
+// Synthetic media corpus for benchmarks: small but valid MP3, FLAC, Ogg and WAV
+// files with randomized tags, laid out as <root>/<artist>/<album>/<nn> - <title>.<ext>.
+//
+// The audio is silence, so the files are tiny, but every container is well
+// formed and carries real tags (ID3v2.3, Vorbis comments, RIFF INFO) that
+// TagLib reads back. Ogg files hold FLAC rather than Vorbis, which would need
+// an encoder; TagLib recognizes them by content.
+
+#ifndef SYNTHETICCORPUS_H
+#define SYNTHETICCORPUS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SyntheticCorpus {
+    enum class Format {
+        MP3,
+        FLAC,
+        OGG,
+        WAV
+    };
+
+    struct Tags {
+        std::string title;
+        std::string artist;
+        std::string album;
+        std::string genre;
+        int year = 0;
+        int track = 0;
+    };
+
+    struct Options {
+        size_t fileCount = 1000;
+        std::vector<Format> formats = {Format::MP3, Format::FLAC, Format::OGG, Format::WAV};
+        uint64_t seed = 1;
+        double minSeconds = 1.0;  // Audio length is picked uniformly in [minSeconds, maxSeconds]
+        double maxSeconds = 4.0;
+        size_t tracksPerAlbum = 12;
+        size_t albumsPerArtist = 4;
+    };
+
+    struct File {
+        std::string path;
+        Tags tags;
+    };
+
+    // Write one file; false if it could not be written
+    bool writeFile(const std::string& path, Format format, const Tags& tags, double seconds);
+
+    // Write options.fileCount files below root (created if needed). Same seed, same corpus
+    std::vector<File> generate(const std::string& root, const Options& options);
+
+    // "mp3", "flac", "ogg", "wav" <-> Format
+    bool parseFormat(const std::string& name, Format& format);
+    const char* getExtension(Format format);
+}
+
+#endif // SYNTHETICCORPUS_H